@@ -28,6 +28,7 @@
 # include  "Module.h"
 # include  "netmisc.h"
 # include  "util.h"
+# include  "pool_alloc.h"
 # include  <typeinfo>
 
 PExpr::PExpr()
@@ -42,6 +43,16 @@ PExpr::~PExpr()
 {
 }
 
+void* PExpr::operator new(size_t size)
+{
+      return pool_alloc(size);
+}
+
+void PExpr::operator delete(void*ptr, size_t size)
+{
+      pool_free(ptr, size);
+}
+
 void PExpr::declare_implicit_nets(LexicalScope*, NetNet::Type)
 {
 }
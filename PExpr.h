@@ -60,6 +60,11 @@ class PExpr : public LineInfo {
       PExpr();
       virtual ~PExpr();
 
+	// Parse tree expressions are small and numerous, so allocate
+	// them from the pool heap (see pool_alloc.h).
+      static void* operator new(size_t size);
+      static void  operator delete(void*ptr, size_t size);
+
       virtual void dump(ostream&) const;
 
         // This method tests whether the expression contains any identifiers
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Checkpoint test: save and resume across delayed clocks.
+ *
+ * The clock reaches the counters through a continuous assignment
+ * delay, a gate delay and a specify path. The checkpoint is taken at
+ * time 17, when none of the delayed clocks has a change pending, and
+ * all of them are high. A resumed run must print the same lines
+ * after time 17 as the run that saved it. If a delayed clock were
+ * restored as x and only then settled, the counter behind it would
+ * see a false posedge and count once too often.
+ */
+
+module delay_path (output o, input i);
+      buf (o, i);
+      specify
+	    (i => o) = (2, 2);
+      endspecify
+endmodule
+
+module main;
+      reg clk = 0;
+      wire aclk, gclk, pclk;
+      reg [7:0] acnt = 0, gcnt = 0, pcnt = 0;
+
+      assign #3 aclk = clk;
+      buf #5 (gclk, clk);
+      delay_path path (pclk, aclk);
+
+      always #10 clk = ~clk;
+
+      always @(posedge aclk) acnt <= acnt + 1;
+      always @(posedge gclk) gcnt <= gcnt + 1;
+      always @(posedge pclk) pcnt <= pcnt + 1;
+
+      always @(aclk or gclk or pclk)
+	    $display("%0t: aclk=%b gclk=%b pclk=%b", $time, aclk, gclk, pclk);
+
+      always @(acnt or gcnt or pcnt)
+	    $display("%0t: acnt=%0d gcnt=%0d pcnt=%0d", $time, acnt, gcnt, pcnt);
+
+      initial begin
+	    #17 $save("ckpt_delay.ckpt");
+	    #200 $finish;
+      end
+endmodule
@@ -0,0 +1,86 @@
+#!/bin/sh
+#
+# Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+#
+#    This source code is free software; you can redistribute it
+#    and/or modify it in source code form under the terms of the GNU
+#    General Public License as published by the Free Software
+#    Foundation; either version 2 of the License, or (at your option)
+#    any later version.
+#
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program; if not, write to the Free Software
+#    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+
+# Check that a simulation resumed from a checkpoint carries on as the
+# run that saved it. The script compiles ckpt_delay.v, runs it to the
+# end (it calls $save on the way), then resumes from the checkpoint
+# with vvp -r, and compares the lines that both runs print after the
+# time of the checkpoint.
+#
+# usage: ckpt_test.sh
+#
+# The IVERILOG and VVP environment variables select the programs to
+# run, and the work files go into bench_work, or into BENCH_WORK if it
+# is set.
+
+IVERILOG=${IVERILOG:-iverilog}
+VVP=${VVP:-vvp}
+WORK=${BENCH_WORK:-bench_work}
+
+srcdir=`dirname "$0"`
+name=ckpt_delay
+save_time=17
+
+mkdir -p "$WORK" || exit 1
+
+if ! $IVERILOG -gspecify -o "$WORK/$name.vvp" "$srcdir/$name.v" ; then
+      echo "$name: compile failed" >&2
+      exit 1
+fi
+
+rm -f "$WORK/$name.ckpt"
+if ! (cd "$WORK" && $VVP -n "$name.vvp") > "$WORK/$name.full" 2>&1 ; then
+      cat "$WORK/$name.full" >&2
+      echo "$name: run failed" >&2
+      exit 1
+fi
+if test ! -f "$WORK/$name.ckpt" ; then
+      cat "$WORK/$name.full" >&2
+      echo "$name: no checkpoint was saved" >&2
+      exit 1
+fi
+
+if ! (cd "$WORK" && $VVP -n -r "$name.ckpt" "$name.vvp") > "$WORK/$name.resumed" 2>&1 ; then
+      cat "$WORK/$name.resumed" >&2
+      echo "$name: resumed run failed" >&2
+      exit 1
+fi
+
+# Keep the lines after the time of the checkpoint. The lines of the
+# design start with the time and a colon.
+after() {
+      awk -v t=$save_time '/^[0-9]+:/ { if ($1 + 0 > t) print }' "$1"
+}
+
+after "$WORK/$name.full" > "$WORK/$name.full.after"
+after "$WORK/$name.resumed" > "$WORK/$name.resumed.after"
+
+if ! test -s "$WORK/$name.full.after" ; then
+      echo "$name: the run printed nothing after the checkpoint" >&2
+      exit 1
+fi
+
+if ! diff "$WORK/$name.full.after" "$WORK/$name.resumed.after" ; then
+      echo "$name: FAILED, the resumed run differs" >&2
+      exit 1
+fi
+
+echo "$name: passed"
+exit 0
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Benchmark: always @* combinational logic.
+ *
+ * Banks of 32 input multiplexers and priority encoders written as
+ * always @* blocks, the way RTL describes wide combinational logic.
+ * Every @* is sensitive to 33 or more separate signals, and each
+ * clock changes a few of the registers that feed them. This measures
+ * the event controls of wide sensitivity lists, and the threads that
+ * they wake.
+ */
+
+module mux32(input wire [4:0] sel,
+	     input wire [15:0] a0, a1, a2, a3, a4, a5, a6, a7,
+	     input wire [15:0] a8, a9, a10, a11, a12, a13, a14, a15,
+	     input wire [15:0] a16, a17, a18, a19, a20, a21, a22, a23,
+	     input wire [15:0] a24, a25, a26, a27, a28, a29, a30, a31,
+	     output reg [15:0] out);
+
+      always @* begin
+	 case (sel)
+	   5'd0:  out = a0;
+	   5'd1:  out = a1;
+	   5'd2:  out = a2;
+	   5'd3:  out = a3;
+	   5'd4:  out = a4;
+	   5'd5:  out = a5;
+	   5'd6:  out = a6;
+	   5'd7:  out = a7;
+	   5'd8:  out = a8;
+	   5'd9:  out = a9;
+	   5'd10: out = a10;
+	   5'd11: out = a11;
+	   5'd12: out = a12;
+	   5'd13: out = a13;
+	   5'd14: out = a14;
+	   5'd15: out = a15;
+	   5'd16: out = a16;
+	   5'd17: out = a17;
+	   5'd18: out = a18;
+	   5'd19: out = a19;
+	   5'd20: out = a20;
+	   5'd21: out = a21;
+	   5'd22: out = a22;
+	   5'd23: out = a23;
+	   5'd24: out = a24;
+	   5'd25: out = a25;
+	   5'd26: out = a26;
+	   5'd27: out = a27;
+	   5'd28: out = a28;
+	   5'd29: out = a29;
+	   5'd30: out = a30;
+	   5'd31: out = a31;
+	 endcase
+      end
+
+endmodule
+
+/* The index of the lowest set request bit, from separate request
+   signals, and whether any of them is set. */
+module prio32(input wire r0, r1, r2, r3, r4, r5, r6, r7,
+	      input wire r8, r9, r10, r11, r12, r13, r14, r15,
+	      input wire r16, r17, r18, r19, r20, r21, r22, r23,
+	      input wire r24, r25, r26, r27, r28, r29, r30, r31,
+	      output reg [4:0] idx, output reg valid);
+
+      always @* begin
+	 valid = 1;
+	 if      (r0)  idx = 0;
+	 else if (r1)  idx = 1;
+	 else if (r2)  idx = 2;
+	 else if (r3)  idx = 3;
+	 else if (r4)  idx = 4;
+	 else if (r5)  idx = 5;
+	 else if (r6)  idx = 6;
+	 else if (r7)  idx = 7;
+	 else if (r8)  idx = 8;
+	 else if (r9)  idx = 9;
+	 else if (r10) idx = 10;
+	 else if (r11) idx = 11;
+	 else if (r12) idx = 12;
+	 else if (r13) idx = 13;
+	 else if (r14) idx = 14;
+	 else if (r15) idx = 15;
+	 else if (r16) idx = 16;
+	 else if (r17) idx = 17;
+	 else if (r18) idx = 18;
+	 else if (r19) idx = 19;
+	 else if (r20) idx = 20;
+	 else if (r21) idx = 21;
+	 else if (r22) idx = 22;
+	 else if (r23) idx = 23;
+	 else if (r24) idx = 24;
+	 else if (r25) idx = 25;
+	 else if (r26) idx = 26;
+	 else if (r27) idx = 27;
+	 else if (r28) idx = 28;
+	 else if (r29) idx = 29;
+	 else if (r30) idx = 30;
+	 else if (r31) idx = 31;
+	 else begin
+	    idx = 0;
+	    valid = 0;
+	 end
+      end
+
+endmodule
+
+/* One slice: a bank of 32 registers, an LFSR that rewrites one of
+   them each clock, a priority encoder over the low bits of the
+   registers that picks the select, and the multiplexer. */
+module slice #(parameter [31:0] SEED = 32'h1) (input wire clk,
+					       output wire [15:0] out);
+
+      reg [15:0] q0, q1, q2, q3, q4, q5, q6, q7;
+      reg [15:0] q8, q9, q10, q11, q12, q13, q14, q15;
+      reg [15:0] q16, q17, q18, q19, q20, q21, q22, q23;
+      reg [15:0] q24, q25, q26, q27, q28, q29, q30, q31;
+      reg [31:0] lfsr;
+
+      wire [4:0] sel;
+      wire       valid;
+
+      prio32 enc(q0[0], q1[0], q2[0], q3[0], q4[0], q5[0], q6[0], q7[0],
+		 q8[0], q9[0], q10[0], q11[0], q12[0], q13[0], q14[0], q15[0],
+		 q16[0], q17[0], q18[0], q19[0], q20[0], q21[0], q22[0], q23[0],
+		 q24[0], q25[0], q26[0], q27[0], q28[0], q29[0], q30[0], q31[0],
+		 sel, valid);
+
+      mux32 mux(sel,
+		q0, q1, q2, q3, q4, q5, q6, q7,
+		q8, q9, q10, q11, q12, q13, q14, q15,
+		q16, q17, q18, q19, q20, q21, q22, q23,
+		q24, q25, q26, q27, q28, q29, q30, q31,
+		out);
+
+      initial begin
+	 lfsr = SEED;
+	 {q0, q1, q2, q3, q4, q5, q6, q7} = 0;
+	 {q8, q9, q10, q11, q12, q13, q14, q15} = 0;
+	 {q16, q17, q18, q19, q20, q21, q22, q23} = 0;
+	 {q24, q25, q26, q27, q28, q29, q30, q31} = 0;
+      end
+
+      always @(posedge clk) begin
+	 lfsr <= {lfsr[30:0], lfsr[31] ^ lfsr[21] ^ lfsr[1] ^ lfsr[0]};
+	 case (lfsr[4:0])
+	   5'd0:  q0  <= lfsr[20:5] ^ out;
+	   5'd1:  q1  <= lfsr[20:5] ^ out;
+	   5'd2:  q2  <= lfsr[20:5] ^ out;
+	   5'd3:  q3  <= lfsr[20:5] ^ out;
+	   5'd4:  q4  <= lfsr[20:5] ^ out;
+	   5'd5:  q5  <= lfsr[20:5] ^ out;
+	   5'd6:  q6  <= lfsr[20:5] ^ out;
+	   5'd7:  q7  <= lfsr[20:5] ^ out;
+	   5'd8:  q8  <= lfsr[20:5] ^ out;
+	   5'd9:  q9  <= lfsr[20:5] ^ out;
+	   5'd10: q10 <= lfsr[20:5] ^ out;
+	   5'd11: q11 <= lfsr[20:5] ^ out;
+	   5'd12: q12 <= lfsr[20:5] ^ out;
+	   5'd13: q13 <= lfsr[20:5] ^ out;
+	   5'd14: q14 <= lfsr[20:5] ^ out;
+	   5'd15: q15 <= lfsr[20:5] ^ out;
+	   5'd16: q16 <= lfsr[20:5] ^ out;
+	   5'd17: q17 <= lfsr[20:5] ^ out;
+	   5'd18: q18 <= lfsr[20:5] ^ out;
+	   5'd19: q19 <= lfsr[20:5] ^ out;
+	   5'd20: q20 <= lfsr[20:5] ^ out;
+	   5'd21: q21 <= lfsr[20:5] ^ out;
+	   5'd22: q22 <= lfsr[20:5] ^ out;
+	   5'd23: q23 <= lfsr[20:5] ^ out;
+	   5'd24: q24 <= lfsr[20:5] ^ out;
+	   5'd25: q25 <= lfsr[20:5] ^ out;
+	   5'd26: q26 <= lfsr[20:5] ^ out;
+	   5'd27: q27 <= lfsr[20:5] ^ out;
+	   5'd28: q28 <= lfsr[20:5] ^ out;
+	   5'd29: q29 <= lfsr[20:5] ^ out;
+	   5'd30: q30 <= lfsr[20:5] ^ out;
+	   5'd31: q31 <= lfsr[20:5] ^ out;
+	 endcase
+      end
+
+endmodule
+
+module main;
+
+      reg clk;
+      integer cycles;
+
+      wire [16*32-1:0] outs;
+      reg [15:0] mix;
+      integer idx;
+
+      genvar gdx;
+      generate
+	 for (gdx = 0 ; gdx < 32 ; gdx = gdx + 1) begin : slices
+	    slice #(.SEED(32'h9e3779b9 * (gdx + 1))) s(clk, outs[gdx*16 +: 16]);
+	 end
+      endgenerate
+
+      always #5 clk = ~clk;
+
+      initial begin
+	 if (! $value$plusargs("cycles=%d", cycles))
+	   cycles = 100000;
+
+	 clk = 0;
+	 repeat (cycles) @(posedge clk) ;
+
+	 @(negedge clk) ;
+	 mix = 0;
+	 for (idx = 0 ; idx < 32 ; idx = idx + 1)
+	   mix = mix ^ outs[idx*16 +: 16];
+	 $display("comb: %0d cycles, mix=%h", cycles, mix);
+	 $finish;
+      end
+
+endmodule
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Benchmark: constant functions.
+ *
+ * A generate loop of cells whose parameters are all computed by
+ * constant functions at elaboration time: a bitwise CRC, a 256 bit
+ * multiply and rotate mixer and a trial division prime count. The
+ * simulation itself is trivial, so this measures the compile time,
+ * which is mostly the compiler evaluating the functions with verinum
+ * arithmetic. Since the work is done at compile time, the size is
+ * set with macros instead of plusargs:
+ *
+ *    -DCF_CELLS=<N>    The number of cells (default 64).
+ *    -DCF_ROUNDS=<N>   The loop count of each function (default 256).
+ */
+
+`ifndef CF_CELLS
+`define CF_CELLS 64
+`endif
+`ifndef CF_ROUNDS
+`define CF_ROUNDS 256
+`endif
+
+module cf_cell #(parameter SEED = 1) (output wire [255:0] key,
+				      output wire [31:0] crc,
+				      output wire [31:0] primes);
+
+	// Bitwise CRC-32 of <rounds> words derived from the seed.
+      function [31:0] crc32;
+	 input [31:0] seed;
+	 input [31:0] rounds;
+	 reg [31:0] val, word;
+	 integer idx, bdx;
+	 begin
+	    val = 32'hffffffff;
+	    word = seed;
+	    for (idx = 0 ; idx < rounds ; idx = idx + 1) begin
+	       for (bdx = 0 ; bdx < 32 ; bdx = bdx + 1) begin
+		  if (val[0] ^ word[bdx])
+		    val = (val >> 1) ^ 32'hedb88320;
+		  else
+		    val = val >> 1;
+	       end
+	       word = word * 32'h9e3779b9 + idx;
+	    end
+	    crc32 = ~val;
+	 end
+      endfunction
+
+	// Multiply, add and rotate a 256 bit value <rounds> times.
+      function [255:0] mix256;
+	 input [31:0] seed;
+	 input [31:0] rounds;
+	 reg [255:0] val;
+	 integer idx;
+	 begin
+	    val = {8{seed}};
+	    for (idx = 0 ; idx < rounds ; idx = idx + 1) begin
+	       val = val * 256'h9e3779b97f4a7c15f39cc0605cedc8341082276bf3a27251f86c6a11d0c18e95
+		   + {224'd0, crc32(seed + idx, 1)};
+	       val = {val[12:0], val[255:13]} ^ (val >> 97);
+	    end
+	    mix256 = val;
+	 end
+      endfunction
+
+	// Count the primes below <limit> by trial division.
+      function [31:0] count_primes;
+	 input [31:0] limit;
+	 integer num, div, cnt;
+	 reg flag;
+	 begin
+	    cnt = 0;
+	    for (num = 2 ; num < limit ; num = num + 1) begin
+	       flag = 1;
+	       for (div = 2 ; flag && div * div <= num ; div = div + 1)
+		 if (num % div == 0)
+		   flag = 0;
+	       if (flag)
+		 cnt = cnt + 1;
+	    end
+	    count_primes = cnt;
+	 end
+      endfunction
+
+      localparam [255:0] KEY = mix256(SEED, `CF_ROUNDS);
+      localparam [31:0] CRC = crc32(SEED, `CF_ROUNDS);
+      localparam [31:0] PRIMES = count_primes(4 * `CF_ROUNDS + SEED);
+
+      assign key = KEY;
+      assign crc = CRC;
+      assign primes = PRIMES;
+
+endmodule
+
+module main;
+
+      wire [256*`CF_CELLS-1:0] key;
+      wire [32*`CF_CELLS-1:0] crc;
+      wire [32*`CF_CELLS-1:0] primes;
+
+      genvar gdx;
+      generate
+	 for (gdx = 0 ; gdx < `CF_CELLS ; gdx = gdx + 1) begin : cells
+	    cf_cell #(.SEED(gdx * 7919 + 1)) cell(.key(key[gdx*256 +: 256]),
+						  .crc(crc[gdx*32 +: 32]),
+						  .primes(primes[gdx*32 +: 32]));
+	 end
+      endgenerate
+
+      reg [255:0] mix;
+      reg [31:0] sum;
+      integer idx;
+
+      initial begin
+	 #1 mix = 0;
+	 sum = 0;
+	 for (idx = 0 ; idx < `CF_CELLS ; idx = idx + 1) begin
+	    mix = mix ^ key[idx*256 +: 256];
+	    sum = sum + crc[idx*32 +: 32] + primes[idx*32 +: 32];
+	 end
+	 $display("constfunc: %0d cells, sum=%h, mix=%h", `CF_CELLS, sum, mix[63:0]);
+	 $finish(0);
+      end
+
+endmodule
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Benchmark: behavioral CPU model.
+ *
+ * This is a small load/store machine with 16 registers and a 4K word
+ * memory, described at the RTL level with a single clocked always
+ * block that fetches, decodes and executes an instruction every
+ * cycle. The program in memory runs a checksum loop over a table
+ * forever, and the test bench stops it after +cycles=<N> clocks.
+ *
+ * Instruction format:
+ *    [31:28] opcode
+ *    [27:24] rd
+ *    [23:20] rs
+ *    [19:16] rt
+ *    [15:0]  immediate
+ */
+
+`define OP_LI   4'h0
+`define OP_ADD  4'h1
+`define OP_SUB  4'h2
+`define OP_XOR  4'h3
+`define OP_AND  4'h4
+`define OP_SHL  4'h5
+`define OP_SHR  4'h6
+`define OP_ADDI 4'h7
+`define OP_LD   4'h8
+`define OP_ST   4'h9
+`define OP_BNE  4'ha
+`define OP_JMP  4'hb
+`define OP_MUL  4'hc
+
+module cpu(input wire clk, input wire rst, output wire [31:0] r3_out);
+
+      reg [31:0] mem [0:4095];
+      reg [31:0] regs [0:15];
+      reg [11:0] pc;
+      reg [31:0] ir;
+
+      reg [3:0]  op, rd, rs, rt;
+      reg [15:0] imm;
+
+      assign r3_out = regs[3];
+
+      integer idx;
+
+      always @(posedge clk) begin
+	 if (rst) begin
+	    pc <= 0;
+	    for (idx = 0 ; idx < 16 ; idx = idx + 1)
+	      regs[idx] <= 0;
+	 end else begin
+	    ir = mem[pc];
+	    {op, rd, rs, rt, imm} = ir;
+	    pc <= pc + 1;
+	    case (op)
+	      `OP_LI:   regs[rd] <= {16'h0000, imm};
+	      `OP_ADD:  regs[rd] <= regs[rs] + regs[rt];
+	      `OP_SUB:  regs[rd] <= regs[rs] - regs[rt];
+	      `OP_XOR:  regs[rd] <= regs[rs] ^ regs[rt];
+	      `OP_AND:  regs[rd] <= regs[rs] & regs[rt];
+	      `OP_SHL:  regs[rd] <= regs[rs] << imm[4:0];
+	      `OP_SHR:  regs[rd] <= regs[rs] >> imm[4:0];
+	      `OP_ADDI: regs[rd] <= regs[rs] + {{16{imm[15]}}, imm};
+	      `OP_LD:   regs[rd] <= mem[regs[rs][11:0] + imm[11:0]];
+	      `OP_ST:   mem[regs[rs][11:0] + imm[11:0]] <= regs[rd];
+	      `OP_BNE:  if (regs[rd] != regs[rs]) pc <= imm[11:0];
+	      `OP_JMP:  pc <= imm[11:0];
+	      `OP_MUL:  regs[rd] <= regs[rs] * regs[rt];
+	      default:  ;
+	    endcase
+	 end
+      end
+
+endmodule
+
+module main;
+
+      reg clk, rst;
+      wire [31:0] r3;
+      integer cycles;
+      integer idx;
+      reg [11:0] pc;
+
+      cpu dut(.clk(clk), .rst(rst), .r3_out(r3));
+
+      task emit;
+	 input [3:0]  op;
+	 input [3:0]  rd;
+	 input [3:0]  rs;
+	 input [3:0]  rt;
+	 input [15:0] imm;
+	 begin
+	    dut.mem[pc] = {op, rd, rs, rt, imm};
+	    pc = pc + 1;
+	 end
+      endtask
+
+      always #5 clk = ~clk;
+
+      initial begin
+	 if (! $value$plusargs("cycles=%d", cycles))
+	   cycles = 2000000;
+
+	   // The data table that the program walks.
+	 for (idx = 0 ; idx < 4096 ; idx = idx + 1)
+	   dut.mem[idx] = idx * 32'h9e3779b9;
+
+	   // The program.
+	 pc = 0;
+	 emit(`OP_LI,   4'd1, 4'd0, 4'd0, 16'd0);      // 0: r1 = 0 (index)
+	 emit(`OP_LI,   4'd2, 4'd0, 4'd0, 16'd1024);   // 1: r2 = 1024 (count)
+	 emit(`OP_LI,   4'd3, 4'd0, 4'd0, 16'd0);      // 2: r3 = 0 (sum)
+	 emit(`OP_LI,   4'd5, 4'd0, 4'd0, 16'd3);      // 3: r5 = 3
+	   // loop:
+	 emit(`OP_LD,   4'd4, 4'd1, 4'd0, 16'h0800);   // 4: r4 = mem[r1+0x800]
+	 emit(`OP_ADD,  4'd3, 4'd3, 4'd4, 16'd0);      // 5: r3 += r4
+	 emit(`OP_SHL,  4'd6, 4'd3, 4'd0, 16'd5);      // 6: r6 = r3 << 5
+	 emit(`OP_SHR,  4'd7, 4'd3, 4'd0, 16'd3);      // 7: r7 = r3 >> 3
+	 emit(`OP_XOR,  4'd3, 4'd6, 4'd7, 16'd0);      // 8: r3 = r6 ^ r7
+	 emit(`OP_MUL,  4'd8, 4'd4, 4'd5, 16'd0);      // 9: r8 = r4 * 3
+	 emit(`OP_SUB,  4'd3, 4'd3, 4'd8, 16'd0);      // 10: r3 -= r8
+	 emit(`OP_ST,   4'd3, 4'd1, 4'd0, 16'h0800);   // 11: mem[r1+0x800] = r3
+	 emit(`OP_ADDI, 4'd1, 4'd1, 4'd0, 16'd1);      // 12: r1 += 1
+	 emit(`OP_BNE,  4'd1, 4'd2, 4'd0, 16'd4);      // 13: if r1 != r2 goto 4
+	 emit(`OP_LI,   4'd1, 4'd0, 4'd0, 16'd0);      // 14: r1 = 0
+	 emit(`OP_JMP,  4'd0, 4'd0, 4'd0, 16'd4);      // 15: goto 4
+
+	 clk = 0;
+	 rst = 1;
+	 @(posedge clk) ;
+	 @(negedge clk) rst = 0;
+
+	 repeat (cycles) @(posedge clk) ;
+
+	 $display("cpu: %0d cycles, r3=%h", cycles, r3);
+	 $finish;
+      end
+
+endmodule
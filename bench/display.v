@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Benchmark: $display heavy log output.
+ *
+ * Many test benches spend most of their time formatting log
+ * messages. This prints +lines=<N> lines with a mix of formats, so
+ * it measures the system task call path and the value formatting
+ * code. The bench script keeps the output only with -k.
+ */
+
+module main;
+
+      integer lines;
+      integer idx;
+      reg [63:0] value;
+      reg [7:0]  lowb;
+      reg [8*16:1] name;
+      real       ratio;
+
+      initial begin
+	 if (! $value$plusargs("lines=%d", lines))
+	   lines = 200000;
+
+	 value = 64'h0123_4567_89ab_cdef;
+	 name  = "display_bench";
+	 ratio = 0.0;
+
+	 for (idx = 0 ; idx < lines ; idx = idx + 1) begin
+	    value = {value[62:0], value[63] ^ value[62] ^ value[60] ^ value[59]};
+	    lowb  = value[7:0];
+	    ratio = ratio + 0.125;
+	    #1;
+	    case (idx % 4)
+	      0: $display("%t %s: idx=%0d value=%h", $time, name, idx, value);
+	      1: $display("%0t: lowb=%b dec=%d oct=%o", $time, lowb, value[31:0], value[15:0]);
+	      2: $display("[%0d] ratio=%f sci=%e mixed=%h/%d", idx, ratio, ratio, value[47:16], lowb);
+	      3: begin
+		 $write("%0d:", idx);
+		 $write(" %h", value[63:32]);
+		 $write(" %h", value[31:0]);
+		 $display;
+	      end
+	    endcase
+	 end
+
+	 $display("display: %0d lines, value=%h", lines, value);
+	 $finish;
+      end
+
+endmodule
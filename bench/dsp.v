@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Benchmark: wide datapath DSP.
+ *
+ * A 16 tap FIR filter with 24 bit samples and coefficients, a 64 bit
+ * accumulator, and a 256 bit wide mixing stage made of continuous
+ * assignments (adds, rotates and xors). This exercises the vector
+ * arithmetic in both the behavioral code and the netlist.
+ */
+
+module fir #(parameter TAPS = 16) (input wire clk, input wire [23:0] din,
+				   output reg [63:0] dout);
+
+      reg signed [23:0] delay [0:TAPS-1];
+      reg signed [23:0] coef  [0:TAPS-1];
+      reg signed [63:0] acc;
+      integer idx;
+
+      initial begin
+	 dout = 0;
+	 for (idx = 0 ; idx < TAPS ; idx = idx + 1) begin
+	    delay[idx] = 0;
+	    coef[idx]  = (idx+1) * 24'sd7919 - 24'sd50000;
+	 end
+      end
+
+      always @(posedge clk) begin
+	 for (idx = TAPS-1 ; idx > 0 ; idx = idx - 1)
+	   delay[idx] <= delay[idx-1];
+	 delay[0] <= din;
+
+	 acc = 0;
+	 for (idx = 0 ; idx < TAPS ; idx = idx + 1)
+	   acc = acc + delay[idx] * coef[idx];
+	 dout <= acc;
+      end
+
+endmodule
+
+module mixer(input wire clk, input wire [63:0] din, output reg [255:0] state);
+
+      wire [255:0] wide_in = {din, ~din, din ^ 64'h5555_aaaa_3333_cccc, din + 64'd1};
+      wire [255:0] rot1    = {state[254:0], state[255]};
+      wire [255:0] rot13   = {state[242:0], state[255:243]};
+      wire [255:0] sum     = rot1 + wide_in;
+      wire [255:0] mixed   = sum ^ rot13 ^ (state >> 7);
+
+      initial state = 256'h0;
+
+      always @(posedge clk)
+	state <= mixed;
+
+endmodule
+
+module main;
+
+      reg clk;
+      reg [23:0] sample;
+      integer cycles;
+
+      wire [63:0]  fir_out;
+      wire [255:0] state;
+
+      fir    filt (.clk(clk), .din(sample), .dout(fir_out));
+      mixer  mix  (.clk(clk), .din(fir_out), .state(state));
+
+      always #5 clk = ~clk;
+
+	/* The sample source is a 24 bit LFSR. */
+      always @(negedge clk)
+	sample <= {sample[22:0], sample[23] ^ sample[22] ^ sample[21] ^ sample[16]};
+
+      initial begin
+	 if (! $value$plusargs("cycles=%d", cycles))
+	   cycles = 200000;
+
+	 clk = 0;
+	 sample = 24'h000001;
+	 repeat (cycles) @(posedge clk) ;
+
+	 $display("dsp: %0d cycles, state=%h", cycles, state);
+	 $finish;
+      end
+
+endmodule
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Benchmark: waveform dumping.
+ *
+ * A bank of counters, gray code converters and shift registers with
+ * all the signals dumped with $dumpvars. The bench script runs this
+ * once with the default VCD output and once with the -fst flag, so
+ * it measures the cost of the value change callbacks and of each
+ * dumper.
+ */
+
+module cell #(parameter STEP = 1) (input wire clk, output reg [31:0] count,
+				   output wire [31:0] gray, output reg [15:0] shift);
+
+      assign gray = count ^ (count >> 1);
+
+      initial begin
+	 count = 0;
+	 shift = 16'h0001;
+      end
+
+      always @(posedge clk) begin
+	 count <= count + STEP;
+	 shift <= {shift[14:0], shift[15] ^ count[3]};
+      end
+
+endmodule
+
+module main;
+
+      reg clk;
+      integer cycles;
+
+      genvar idx;
+      generate for (idx = 0 ; idx < 64 ; idx = idx + 1) begin : bank
+	 wire [31:0] count, gray;
+	 wire [15:0] shift;
+	 cell #(.STEP(idx+1)) c (.clk(clk), .count(count), .gray(gray), .shift(shift));
+      end endgenerate
+
+      always #5 clk = ~clk;
+
+      initial begin
+	 if (! $value$plusargs("cycles=%d", cycles))
+	   cycles = 50000;
+
+	 $dumpfile("dump.vcd");
+	 $dumpvars(0, main);
+
+	 clk = 0;
+	 repeat (cycles) @(posedge clk) ;
+
+	 $display("dump: %0d cycles, count=%h", cycles, bank[63].count);
+	 $finish;
+      end
+
+endmodule
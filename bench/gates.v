@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Benchmark: gate level netlist with UDP cells.
+ *
+ * Each lane is a 32-bit LFSR built from UDP flip-flops and xnor
+ * gates, feeding a 32-bit ripple carry accumulator built from UDP
+ * full adder cells and UDP flip-flops. The lanes are combined with
+ * a tree of primitive gates. This is the kind of netlist that comes
+ * out of synthesis, and it exercises the functor network, UDP
+ * evaluation and the scheduling of gate outputs.
+ */
+
+primitive udp_sum (s, a, b, c);
+      output s;
+      input  a, b, c;
+      table
+	 // a b c : s
+	    0 0 0 : 0;
+	    0 0 1 : 1;
+	    0 1 0 : 1;
+	    0 1 1 : 0;
+	    1 0 0 : 1;
+	    1 0 1 : 0;
+	    1 1 0 : 0;
+	    1 1 1 : 1;
+      endtable
+endprimitive
+
+primitive udp_carry (co, a, b, c);
+      output co;
+      input  a, b, c;
+      table
+	 // a b c : co
+	    0 0 ? : 0;
+	    0 ? 0 : 0;
+	    ? 0 0 : 0;
+	    1 1 ? : 1;
+	    1 ? 1 : 1;
+	    ? 1 1 : 1;
+      endtable
+endprimitive
+
+/* D flip-flop with synchronous active high reset. */
+primitive udp_dff (q, d, clk, rst);
+      output q;
+      reg    q;
+      input  d, clk, rst;
+      table
+	 // d clk rst : q : q+
+	    0  r   ? : ? : 0;
+	    1  r   0 : ? : 1;
+	    ?  r   1 : ? : 0;
+	    ?  n   ? : ? : -;
+	    *  ?   ? : ? : -;
+	    ?  ?   * : ? : -;
+      endtable
+endprimitive
+
+module lane #(parameter [31:0] SEED = 32'h0) (input wire clk, input wire rst,
+					      output wire [31:0] acc);
+
+      wire [31:0] lfsr;
+      wire [31:0] lfsr_next;
+      wire [31:0] sum;
+      wire [32:0] carry;
+      wire        fb;
+
+	/* LFSR with taps 32,22,2,1 and xnor feedback, so that the
+	   reset state of all zeros is a valid state. The SEED is
+	   mixed into the adder input so the lanes differ. */
+      xnor fb_gate (fb, lfsr[31], lfsr[21], lfsr[1], lfsr[0]);
+      assign lfsr_next = {lfsr[30:0], fb};
+
+      assign carry[0] = 1'b0;
+
+      genvar idx;
+      generate for (idx = 0 ; idx < 32 ; idx = idx + 1) begin : slice
+	 wire addend;
+	 xor seed_gate (addend, lfsr[idx], SEED[idx]);
+	 udp_dff  lfsr_ff (lfsr[idx], lfsr_next[idx], clk, rst);
+	 udp_sum   add_s (sum[idx], acc[idx], addend, carry[idx]);
+	 udp_carry add_c (carry[idx+1], acc[idx], addend, carry[idx]);
+	 udp_dff  acc_ff (acc[idx], sum[idx], clk, rst);
+      end endgenerate
+
+endmodule
+
+module main;
+
+      reg clk, rst;
+      integer cycles;
+
+      wire [31:0] acc0, acc1, acc2, acc3, acc4, acc5, acc6, acc7;
+      wire [31:0] mix0, mix1, mix2, mix3, mix;
+
+      lane #(.SEED(32'h00000000)) l0 (clk, rst, acc0);
+      lane #(.SEED(32'h9e3779b9)) l1 (clk, rst, acc1);
+      lane #(.SEED(32'h7f4a7c15)) l2 (clk, rst, acc2);
+      lane #(.SEED(32'hf39cc060)) l3 (clk, rst, acc3);
+      lane #(.SEED(32'h5851f42d)) l4 (clk, rst, acc4);
+      lane #(.SEED(32'h4c957f2d)) l5 (clk, rst, acc5);
+      lane #(.SEED(32'h14057b7e)) l6 (clk, rst, acc6);
+      lane #(.SEED(32'hf767814f)) l7 (clk, rst, acc7);
+
+	/* Combine the lanes with a tree of vector gates. */
+      xor  m0 [31:0] (mix0, acc0, acc1);
+      and  m1 [31:0] (mix1, acc2, acc3);
+      or   m2 [31:0] (mix2, acc4, acc5);
+      nand m3 [31:0] (mix3, acc6, acc7);
+      xor  m4 [31:0] (mix, mix0, mix1, mix2, mix3);
+
+      always #5 clk = ~clk;
+
+      initial begin
+	 if (! $value$plusargs("cycles=%d", cycles))
+	   cycles = 100000;
+
+	 clk = 0;
+	 rst = 1;
+	 repeat (2) @(posedge clk) ;
+	 @(negedge clk) rst = 0;
+
+	 repeat (cycles) @(posedge clk) ;
+
+	 @(negedge clk) ;
+	 $display("gates: %0d cycles, mix=%h", cycles, mix);
+	 $finish;
+      end
+
+endmodule
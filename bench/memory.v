@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Benchmark: memory heavy test bench.
+ *
+ * A dual port 64K x 32 RAM model is driven with pseudo random
+ * addresses, and every few cycles the test bench also copies and
+ * checksums a block of a second memory with behavioral loops. This
+ * exercises array word access from both the netlist (array ports)
+ * and from threads.
+ */
+
+module ram #(parameter AW = 16, DW = 32)
+      (input wire clk,
+       input wire we, input wire [AW-1:0] waddr, input wire [DW-1:0] wdata,
+       input wire [AW-1:0] raddr, output wire [DW-1:0] rdata);
+
+      reg [DW-1:0] mem [0:(1<<AW)-1];
+
+      integer idx;
+      initial for (idx = 0 ; idx < (1<<AW) ; idx = idx + 1)
+	mem[idx] = idx;
+
+      assign rdata = mem[raddr];
+
+      always @(posedge clk)
+	if (we) mem[waddr] <= wdata;
+
+endmodule
+
+module main;
+
+      reg clk;
+      reg [31:0] lfsr;
+      reg [31:0] check;
+      integer cycles;
+      integer idx, blk;
+
+      wire [31:0] rdata;
+
+      ram dut (.clk(clk), .we(lfsr[0]), .waddr(lfsr[15:0]),
+	       .wdata(lfsr ^ check), .raddr(lfsr[31:16]), .rdata(rdata));
+
+      reg [31:0] buf_a [0:4095];
+      reg [31:0] buf_b [0:4095];
+
+      always #5 clk = ~clk;
+
+      always @(negedge clk) begin
+	 lfsr  <= {lfsr[30:0], lfsr[31] ^ lfsr[21] ^ lfsr[1] ^ lfsr[0]};
+	 check <= check + rdata;
+      end
+
+      initial begin
+	 if (! $value$plusargs("cycles=%d", cycles))
+	   cycles = 200000;
+
+	 for (idx = 0 ; idx < 4096 ; idx = idx + 1)
+	   buf_a[idx] = idx * 32'h01000193;
+
+	 clk = 0;
+	 lfsr = 32'hace1_2468;
+	 check = 0;
+
+	 for (blk = 0 ; blk < cycles ; blk = blk + 1000) begin
+	    repeat (1000) @(posedge clk) ;
+
+	      /* Copy a 1K word block of buf_a to buf_b, mixing in
+		 the running check value, then fold it back. */
+	    for (idx = 0 ; idx < 1024 ; idx = idx + 1)
+	      buf_b[idx] = buf_a[(blk/1000*1024 + idx) % 4096] ^ check;
+	    for (idx = 0 ; idx < 1024 ; idx = idx + 1)
+	      buf_a[(idx*7) % 4096] = buf_a[(idx*7) % 4096] + buf_b[idx];
+	 end
+
+	 $display("memory: %0d cycles, check=%h", cycles, check);
+	 $finish;
+      end
+
+endmodule
@@ -0,0 +1,137 @@
+#!/bin/sh
+#
+# Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+#
+#    This source code is free software; you can redistribute it
+#    and/or modify it in source code form under the terms of the GNU
+#    General Public License as published by the Free Software
+#    Foundation; either version 2 of the License, or (at your option)
+#    any later version.
+#
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program; if not, write to the Free Software
+#    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+
+# Measure the compiler front end on a project with many source files.
+# The script writes a project of <N> independent source files (2000
+# by default) that all include a common header, then compiles it with
+# the null target in each of the preprocessing modes of the driver:
+#
+#   pipe     The ivlpp program piped into ivl (the default).
+#   inproc   The preprocessor library inside ivl (iverilog -i).
+#   units    Each file a compilation unit, preprocessed in parallel
+#            (iverilog -u).
+#
+# and also runs the preprocessor alone (iverilog -E). Each mode is run
+# <R> times (3 by default) and the best wall time is reported.
+#
+# usage: pp_bench.sh [-n <files>] [-r <repeat>]
+#
+# The IVERILOG environment variable selects the compiler (the default
+# is the installed iverilog), BENCH_TARGET the target flag (default
+# -tnull) and BENCH_WORK the work directory (default bench_work).
+
+IVERILOG=${IVERILOG:-iverilog}
+TARGET=${BENCH_TARGET:--tnull}
+WORK=${BENCH_WORK:-bench_work}
+
+nfiles=2000
+repeat=3
+
+while getopts "n:r:" opt ; do
+      case $opt in
+	  n) nfiles=$OPTARG ;;
+	  r) repeat=$OPTARG ;;
+	  *) echo "usage: $0 [-n <files>] [-r <repeat>]" >&2
+	     exit 1 ;;
+      esac
+done
+
+now() {
+      t=`date +%s.%N 2>/dev/null`
+      case "$t" in
+	  *N*|"") date +%s ;;
+	  *) echo "$t" ;;
+      esac
+}
+
+proj="$WORK/pp_project"
+rm -rf "$proj"
+mkdir -p "$proj" || exit 1
+
+# The common header has the macros that every file uses, with an
+# include guard so that it works in both one compilation unit and
+# many.
+cat > "$proj/defs.vh" <<EOF
+\`ifndef DEFS_VH
+\`define DEFS_VH
+\`define WIDTH 16
+\`define REG(name) reg [\`WIDTH-1:0] name
+\`define NEXT(a, b) ((a) + (b) ^ ((a) >> 1))
+\`endif
+EOF
+
+echo "writing $nfiles files ..." >&2
+idx=0
+while test $idx -lt $nfiles ; do
+      cat > "$proj/cell$idx.v" <<EOF
+\`include "defs.vh"
+// Cell $idx of the preprocessor benchmark.
+module cell$idx(input wire clk, input wire [\`WIDTH-1:0] din,
+		output wire [\`WIDTH-1:0] dout);
+      \`REG(acc);
+      \`REG(tmp);
+\`ifdef WIDE_CELLS
+      reg [2*\`WIDTH-1:0] wide;
+\`endif
+      always @(posedge clk) begin
+	    tmp <= \`NEXT(din, $idx);
+	    acc <= \`NEXT(acc, tmp);
+      end
+      assign dout = acc ^ tmp;
+endmodule
+EOF
+      echo "$proj/cell$idx.v" >> "$proj/files.lst.tmp"
+      idx=`expr $idx + 1`
+done
+mv "$proj/files.lst.tmp" "$proj/files.lst"
+
+# Run one compile mode <repeat> times, and print the best wall time.
+run_mode() {
+      best=
+      n=0
+      while test $n -lt $repeat ; do
+	    t0=`now`
+	    if ! $IVERILOG -I"$proj" "$@" `cat "$proj/files.lst"` > "$WORK/pp.log" 2>&1 ; then
+		  tail -20 "$WORK/pp.log" >&2
+		  echo "compile failed: $*" >&2
+		  return 1
+	    fi
+	    t1=`now`
+	    best=`echo "$t0 $t1 $best" | awk '{ t = $2 - $1;
+		  if ($3 == "" || t < $3) print t; else print $3 }'`
+	    n=`expr $n + 1`
+      done
+      echo "$best"
+}
+
+printf "%-10s %9s\n" "mode" "wall"
+for mode in preproc pipe inproc units ; do
+      case $mode in
+	  preproc) args="-E -o $WORK/pp.out" ;;
+	  pipe)    args="$TARGET -o $WORK/pp.out" ;;
+	  inproc)  args="$TARGET -i -o $WORK/pp.out" ;;
+	  units)   args="$TARGET -u -o $WORK/pp.out" ;;
+      esac
+      t=`run_mode $args` || exit 1
+      printf "%-10s %9.3f\n" $mode $t
+done
+
+rm -rf "$proj" "$WORK/pp.log" "$WORK/pp.out"
+exit 0
@@ -0,0 +1,195 @@
+#!/bin/sh
+#
+# Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+#
+#    This source code is free software; you can redistribute it
+#    and/or modify it in source code form under the terms of the GNU
+#    General Public License as published by the Free Software
+#    Foundation; either version 2 of the License, or (at your option)
+#    any later version.
+#
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program; if not, write to the Free Software
+#    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+#
+
+# Run the simulation benchmarks and report the compile time, run
+# time, time step, event and instruction rates and the peak resident
+# set size of each.
+# See bench/README.txt for details.
+#
+# usage: run_bench.sh [-k] [-a <args>] [-s <file>] [-c <file>] [<bench>...]
+#
+#   -k          Keep the work files (compiled designs, logs, dumps).
+#   -a <args>   Extra vvp extended arguments (e.g. +word-ops) for every run.
+#   -s <file>   Save the results to <file>, to use as a baseline.
+#   -c <file>   Compare the results with the baseline in <file>.
+#
+# The environment variables IVERILOG and VVP select the programs to
+# use (the defaults are the installed iverilog and vvp) and
+# BENCH_WORK selects the work directory (default bench_work).
+
+srcdir=`dirname "$0"`
+
+IVERILOG=${IVERILOG:-iverilog}
+VVP=${VVP:-vvp}
+WORK=${BENCH_WORK:-bench_work}
+
+# The list of benchmarks: <name> <source file> [<vvp extended args>]
+ALL_BENCH="cpu:cpu.v
+gates:gates.v
+dsp:dsp.v
+memory:memory.v
+display:display.v
+dump_vcd:dump.v
+dump_fst:dump.v:-fst
+tran:tran.v
+comb:comb.v
+constfunc:constfunc.v"
+
+keep=no
+vvp_args=
+save=
+compare=
+
+while getopts "ka:s:c:" opt ; do
+      case $opt in
+	  k) keep=yes ;;
+	  a) vvp_args="$vvp_args $OPTARG" ;;
+	  s) save=$OPTARG ;;
+	  c) compare=$OPTARG ;;
+	  *) echo "usage: $0 [-k] [-a <args>] [-s <file>] [-c <file>] [<bench>...]" >&2
+	     exit 1 ;;
+      esac
+done
+shift `expr $OPTIND - 1`
+
+if test -n "$compare" && test ! -r "$compare" ; then
+      echo "$0: cannot read baseline $compare" >&2
+      exit 1
+fi
+
+# Select the benchmarks to run.
+if test $# -gt 0 ; then
+      list=
+      for name in "$@" ; do
+	    ent=`echo "$ALL_BENCH" | grep "^$name:"`
+	    if test -z "$ent" ; then
+		  echo "$0: unknown benchmark $name" >&2
+		  exit 1
+	    fi
+	    list="$list
+$ent"
+      done
+else
+      list=$ALL_BENCH
+fi
+
+# Print the current time in seconds, with a fraction if date can
+# provide one.
+now() {
+      t=`date +%s.%N 2>/dev/null`
+      case "$t" in
+	  *N*|"") date +%s ;;
+	  *) echo "$t" ;;
+      esac
+}
+
+mkdir -p "$WORK" || exit 1
+results="$WORK/results.txt"
+: > "$results"
+
+status=0
+for ent in $list ; do
+      name=`echo "$ent" | cut -d: -f1`
+      src=`echo "$ent" | cut -d: -f2`
+      args=`echo "$ent" | cut -d: -f3`
+
+      echo "$name ..." >&2
+
+      t0=`now`
+      if ! $IVERILOG -o "$WORK/$name.vvp" "$srcdir/$src" > "$WORK/$name.clog" 2>&1 ; then
+	    cat "$WORK/$name.clog" >&2
+	    echo "$name: compile failed" >&2
+	    status=1
+	    continue
+      fi
+      t1=`now`
+      if ! (cd "$WORK" && $VVP -v "$name.vvp" $args $vvp_args) > "$WORK/$name.log" 2>&1 ; then
+	    tail -20 "$WORK/$name.log" >&2
+	    echo "$name: run failed" >&2
+	    status=1
+	    continue
+      fi
+      t2=`now`
+
+	# Pick the statistics out of the vvp -v output. The second
+	# rusage line is the run time of the simulation itself. Time
+	# steps are counted apart from the events that are scheduled
+	# in them.
+      awk -v name="$name" -v t0="$t0" -v t1="$t1" -v t2="$t2" '
+	  /^ \.\.\. .* seconds,/ {
+		nrus += 1;
+		if (nrus == 2) cpu = $2;
+	  }
+	  /KBytes peak rss/        { peak = $2 }
+	  /time steps/             { steps = $1 }
+	  /thread schedule events/ { events += $1 }
+	  /assign events/          { events += $1 }
+	  /other events/           { events += $1 }
+	  /instructions executed/  { instr = $1 }
+	  END {
+		printf "%s %.3f %.3f %.3f %.0f %.0f %.0f %.0f\n", name,
+		       t1-t0, t2-t1, cpu, steps, events, instr, peak;
+	  }' "$WORK/$name.log" >> "$results"
+
+      if test $keep = no ; then
+	    rm -f "$WORK/$name.vvp" "$WORK/$name.clog" "$WORK/$name.log" \
+		  "$WORK/dump.vcd" "$WORK/dump.vcd.fst" "$WORK/dump.fst"
+      fi
+done
+
+# Print the report, and the comparison with the baseline if there
+# is one. The results file has one line per benchmark:
+#   <name> <compile> <wall> <cpu> <steps> <events> <instructions> <peak-KB>
+awk -v baseline="$compare" '
+      function rate(n, t) { return t > 0 ? n / t : 0 }
+      BEGIN {
+	    if (baseline != "") {
+		  while ((getline line < baseline) > 0) {
+			split(line, f, " ");
+			base_wall[f[1]] = f[3];
+			base_eps[f[1]]  = rate(f[6], f[4]);
+		  }
+	    }
+	    printf "%-10s %9s %9s %9s %11s %12s %12s %12s", "bench", \
+		   "compile", "wall", "cpu", "steps/s", "events/s", \
+		   "instr/s", "peak-rss(KB)";
+	    if (baseline != "")
+		  printf " %9s %9s", "wall-x", "events-x";
+	    printf "\n";
+      }
+      {
+	    eps = rate($6, $4);
+	    printf "%-10s %9.3f %9.3f %9.3f %11.0f %12.0f %12.0f %12.0f", \
+		   $1, $2, $3, $4, rate($5, $4), eps, rate($7, $4), $8;
+	    if (baseline != "") {
+		  if (($1 in base_wall) && $3 > 0 && base_eps[$1] > 0)
+			printf " %9.2f %9.2f", base_wall[$1] / $3, \
+			       eps / base_eps[$1];
+		  else
+			printf " %9s %9s", "-", "-";
+	    }
+	    printf "\n";
+      }' "$results"
+
+if test -n "$save" ; then
+      cp "$results" "$save" || status=1
+fi
+
+exit $status
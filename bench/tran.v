@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * Benchmark: tran/switch networks.
+ *
+ * Each slice is a bus segment of 8 nodes joined by tranif1 switches,
+ * with bufif1 drivers and a weak pullup, plus a chain of CMOS
+ * inverters built from pmos/nmos switches. The switch controls and
+ * driver enables come from an LFSR, so the islands of connected
+ * nodes change every cycle. This exercises the tran island solver
+ * and strength resolution.
+ */
+
+module cmos_inv(output wire y, input wire a);
+      supply1 vdd;
+      supply0 gnd;
+      pmos p (y, vdd, a);
+      nmos n (y, gnd, a);
+endmodule
+
+module slice(input wire [15:0] ctl, input wire [3:0] din, inout wire [7:0] node,
+	     output wire chain_out);
+
+	/* The bus segment. Node 0 and 7 have drivers, and the
+	   switches between the nodes are controlled by ctl. */
+      pullup (weak1) pu (node[3]);
+      bufif1 d0 (node[0], din[0], ctl[8]);
+      bufif1 d1 (node[7], din[1], ctl[9]);
+      bufif1 d2 (node[4], din[2], ctl[10]);
+
+      genvar idx;
+      generate for (idx = 0 ; idx < 7 ; idx = idx + 1) begin : sw
+	 tranif1 t (node[idx], node[idx+1], ctl[idx]);
+      end endgenerate
+
+	/* A chain of CMOS inverters. */
+      wire [8:0] chain;
+      assign chain[0] = din[3] ^ node[5];
+      generate for (idx = 0 ; idx < 8 ; idx = idx + 1) begin : inv
+	 cmos_inv i (chain[idx+1], chain[idx]);
+      end endgenerate
+      assign chain_out = chain[8];
+
+endmodule
+
+module main;
+
+      reg clk;
+      reg [31:0] lfsr;
+      reg [31:0] check;
+      integer cycles;
+
+      wire [7:0]  node0, node1, node2, node3;
+      wire [3:0]  chain;
+
+      slice s0 (.ctl(lfsr[15:0]),  .din(lfsr[19:16]), .node(node0), .chain_out(chain[0]));
+      slice s1 (.ctl(lfsr[31:16]), .din(lfsr[3:0]),   .node(node1), .chain_out(chain[1]));
+      slice s2 (.ctl(~lfsr[15:0]), .din(lfsr[27:24]), .node(node2), .chain_out(chain[2]));
+      slice s3 (.ctl(lfsr[23:8]),  .din(lfsr[11:8]),  .node(node3), .chain_out(chain[3]));
+
+      always #5 clk = ~clk;
+
+      always @(posedge clk)
+	lfsr <= {lfsr[30:0], lfsr[31] ^ lfsr[21] ^ lfsr[1] ^ lfsr[0]};
+
+	/* Fold the node values into a check value. Nodes can be X or
+	   Z, so only use case equality results. */
+      always @(negedge clk)
+	check <= {check[30:0], check[31]}
+		 ^ {node0 === 8'hff, node1 === 8'h00, node2 === 8'hff, node3 === 8'h00,
+		    chain[0] === 1'b1, chain[1] === 1'b1,
+		    chain[2] === 1'b1, chain[3] === 1'b1, 24'h0};
+
+      initial begin
+	 if (! $value$plusargs("cycles=%d", cycles))
+	   cycles = 100000;
+
+	 clk = 0;
+	 lfsr = 32'h1234_5679;
+	 check = 0;
+	 repeat (cycles) @(posedge clk) ;
+
+	 $display("tran: %0d cycles, check=%h", cycles, check);
+	 $finish;
+      end
+
+endmodule
@@ -121,6 +121,10 @@ extern bool disable_virtual_pins;
  * LPM objects so this flag is used to block them from being generated. */
 extern bool disable_concatz_generation;
 
+/* Skip releasing the design and other global data at exit. The
+ * operating system reclaims it faster then we can. */
+extern bool skip_teardown;
+
 /* Limit to size of devirtualized arrays */
 extern unsigned long array_size_limit;
 
@@ -38,7 +38,7 @@ const char NOTICE[] =
 ;
 
 const char HELP[] =
-"Usage: iverilog [-ESvV] [-B base] [-c cmdfile|-f cmdfile]\n"
+"Usage: iverilog [-EiSuvV] [-B base] [-c cmdfile|-f cmdfile]\n"
 "                [-g1995|-g2001|-g2005|-g2005-sv|-g2009|-g2012] [-g<feature>]\n"
 "                [-D macro[=defn]] [-I includedir]\n"
 "                [-M [mode=]depfile] [-m module]\n"
@@ -159,11 +159,24 @@ FILE*iconfig_file = 0;
 
 char*compiled_defines_path = 0;
 
+/* Boolean: true if there are library directories (-y) that the
+   compiler may search. The contents of these are not known until
+   elaboration, so the compile cache cannot be used with them. */
+int library_dir_flag = 0;
+
 static char iconfig_common_path[4096] = "";
 
 int synth_flag = 0;
 int verbose_flag = 0;
 
+/* Boolean: true means run the preprocessor inside the ivl program
+   instead of piping the ivlpp program into it. */
+int inprocess_pp_flag = 0;
+
+/* Boolean: true means that each source file is a compilation unit
+   of its own, so the files may be preprocessed in parallel. */
+int separate_units_flag = 0;
+
 FILE *fp;
 
 char line[MAXSIZE];
@@ -395,6 +408,546 @@ static int t_preprocess_only(void)
       return 0;
 }
 
+/*
+ * The compile cache is enabled by setting the IVERILOG_CACHE
+ * environment variable to the path of a directory. The output of a
+ * compile is saved there, keyed by a hash of everything that goes
+ * into the ivl program: the preprocessed source (which already has
+ * the defines and include files expanded), the configuration that
+ * the driver generates, the target configuration file, the system
+ * function (.sft) files named by the configuration, and the ivl and
+ * target binaries themselves. If a later compile hashes to the same
+ * key, the saved output is copied instead of parsing and elaborating
+ * the design again. The diagnostics that ivl printed are saved next
+ * to the output and printed again on a hit.
+ */
+typedef unsigned long long cache_hash_t;
+
+static void cache_hash_bytes(cache_hash_t*hash, const char*buf, size_t nbuf)
+{
+      size_t idx;
+      for (idx = 0 ; idx < nbuf ; idx += 1) {
+	    *hash ^= (unsigned char)buf[idx];
+	    *hash *= 0x100000001b3ULL;
+      }
+}
+
+static int cache_hash_file(cache_hash_t*hash, const char*path)
+{
+      char buf[8192];
+      size_t nbuf;
+      FILE*fd = fopen(path, "rb");
+      if (fd == 0)
+	    return -1;
+
+      while ((nbuf = fread(buf, 1, sizeof buf, fd)) > 0)
+	    cache_hash_bytes(hash, buf, nbuf);
+
+      fclose(fd);
+      return 0;
+}
+
+/*
+ * Hash a program or target in the base directory. On Windows the
+ * file may have an extension that the command does not mention.
+ */
+static int cache_hash_tool(cache_hash_t*hash, const char*name)
+{
+      int rc;
+      size_t nfile = strlen(base) + strlen(name) + 8;
+      char*path = malloc(nfile);
+
+      if (name[0] == '/' || name[0] == sep)
+	    snprintf(path, nfile, "%s", name);
+      else
+	    snprintf(path, nfile, "%s%c%s", base, sep, name);
+
+      rc = cache_hash_file(hash, path);
+#ifdef __MINGW32__
+      if (rc < 0) {
+	    strcat(path, ".exe");
+	    rc = cache_hash_file(hash, path);
+      }
+#endif
+      free(path);
+      return rc;
+}
+
+/*
+ * The iconfig file contains the output path and the paths of some
+ * temporary files. Those do not change the generated code, so leave
+ * them out of the key. The system function files and the target
+ * module are named by path, so hash their contents as well so that
+ * a rebuilt target or a changed .sft file is a miss. VPI modules are
+ * only named in the output; what the compiler reads of them is their
+ * .sft file.
+ */
+static int cache_hash_config(cache_hash_t*hash, const char*path)
+{
+      int rc = 0;
+      FILE*fd = fopen(path, "r");
+      if (fd == 0)
+	    return -1;
+
+      while (rc == 0 && fgets(line, sizeof line, fd)) {
+	    char*cp;
+	    if (strncmp(line, "out:", 4) == 0)
+		  continue;
+	    if (strncmp(line, "ivlpp:", 6) == 0)
+		  continue;
+	    cache_hash_bytes(hash, line, strlen(line));
+
+	    cp = line + strcspn(line, "\r\n");
+	    *cp = 0;
+	    if (strncmp(line, "sys_func:", 9) == 0)
+		  rc = cache_hash_file(hash, line+9);
+	    else if (strncmp(line, "flag:DLL=", 9) == 0)
+		  rc = cache_hash_tool(hash, line+9);
+      }
+
+      fclose(fd);
+      return rc;
+}
+
+static int cache_copy_stream(FILE*ofd, FILE*ifd)
+{
+      char buf[8192];
+      size_t nbuf;
+
+      while ((nbuf = fread(buf, 1, sizeof buf, ifd)) > 0) {
+	    if (fwrite(buf, 1, nbuf, ofd) != nbuf)
+		  return -1;
+      }
+
+      return 0;
+}
+
+static int cache_copy_file(const char*dst, const char*src)
+{
+      FILE*ifd, *ofd;
+
+      ifd = fopen(src, "rb");
+      if (ifd == 0)
+	    return -1;
+
+      ofd = fopen(dst, "wb");
+      if (ofd == 0) {
+	    fclose(ifd);
+	    return -1;
+      }
+
+      if (cache_copy_stream(ofd, ifd) < 0) {
+	    fclose(ifd);
+	    fclose(ofd);
+	    remove(dst);
+	    return -1;
+      }
+
+      fclose(ifd);
+      if (fclose(ofd) != 0) {
+	    remove(dst);
+	    return -1;
+      }
+
+      return 0;
+}
+
+/*
+ * Save a file into the cache. Write to a temporary name and rename
+ * so that a concurrent compile never sees a partial file. A failure
+ * here only costs a future cache miss.
+ */
+static int cache_save_file(const char*cache_path, const char*src)
+{
+      int rc = -1;
+      size_t npart = strlen(cache_path) + 16;
+      char*part_path = malloc(npart);
+
+      snprintf(part_path, npart, "%s.%d", cache_path, (int)getpid());
+      if (cache_copy_file(part_path, src) == 0) {
+#ifdef __MINGW32__
+	    remove(cache_path);
+#endif
+	    if (rename(part_path, cache_path) != 0)
+		  remove(part_path);
+	    else
+		  rc = 0;
+      }
+
+      free(part_path);
+      return rc;
+}
+
+/* Print the saved diagnostics of a compile. */
+static void cache_replay_diag(FILE*diag)
+{
+      fflush(stdout);
+      cache_copy_stream(stderr, diag);
+      fflush(stderr);
+}
+
+static void remove_compile_temps(void)
+{
+      if ( ! getenv("IVERILOG_ICONFIG")) {
+	    remove(source_path);
+	    free(source_path);
+	    remove(iconfig_path);
+	    free(iconfig_path);
+	    remove(defines_path);
+	    free(defines_path);
+	    remove(compiled_defines_path);
+	    free(compiled_defines_path);
+      }
+}
+
+static int t_compile_cached(const char*cache_dir)
+{
+      int rc;
+      size_t ncmd;
+      char*cmd;
+      FILE*pp_file;
+      FILE*diag_file;
+      const char*tmp_name;
+      char*pp_path;
+      char*diag_path;
+      char*cache_path;
+      char*diag_cache_path;
+      cache_hash_t hash = 0xcbf29ce484222325ULL;
+
+	/* Preprocess the source into a temporary file. */
+      tmp_name = my_tempfile("ivrlp", &pp_file);
+      if (pp_file == 0) {
+	    fprintf(stderr, "Unable to create temporary file for "
+		    "preprocessed source.\n");
+	    return 1;
+      }
+      fclose(pp_file);
+      pp_path = strdup(tmp_name);
+
+      build_preprocess_command(0);
+      ncmd = strlen(tmp) + strlen(pp_path) + 8;
+      cmd = malloc(ncmd);
+      snprintf(cmd, ncmd, "%s > \"%s\"", tmp, pp_path);
+
+      if (verbose_flag)
+	    printf("preprocess: %s\n", cmd);
+
+      rc = system(cmd);
+      free(cmd);
+      if (rc != 0) {
+	    remove(pp_path);
+	    free(pp_path);
+	    remove_compile_temps();
+	    if (WIFEXITED(rc))
+		  return WEXITSTATUS(rc);
+	    return 1;
+      }
+
+	/* Calculate the cache key. */
+      cache_hash_bytes(&hash, VERSION, strlen(VERSION));
+      cache_hash_bytes(&hash, VERSION_TAG, strlen(VERSION_TAG));
+      cache_hash_bytes(&hash, targ, strlen(targ));
+      if (cache_hash_file(&hash, pp_path) < 0
+	  || cache_hash_tool(&hash, "ivl") < 0
+	  || cache_hash_config(&hash, iconfig_path) < 0
+	  || cache_hash_config(&hash, iconfig_common_path) < 0) {
+	    fprintf(stderr, "warning: Unable to read the compile "
+		    "configuration, not using IVERILOG_CACHE.\n");
+	    hash = 0;
+      }
+
+      ncmd = strlen(cache_dir) + strlen(targ) + 32;
+      cache_path = malloc(ncmd);
+      snprintf(cache_path, ncmd, "%s%c%016llx.%s", cache_dir, sep,
+	       hash, targ);
+      diag_cache_path = malloc(ncmd + 4);
+      snprintf(diag_cache_path, ncmd + 4, "%s.log", cache_path);
+
+	/* An entry is only complete if it has its diagnostics too. */
+      if (hash != 0) {
+	    FILE*diag = fopen(diag_cache_path, "rb");
+	    if (diag && cache_copy_file(opath, cache_path) == 0) {
+		  if (verbose_flag)
+			printf("cache: reusing %s\n", cache_path);
+		  cache_replay_diag(diag);
+		  fclose(diag);
+		  free(cache_path);
+		  free(diag_cache_path);
+		  remove(pp_path);
+		  free(pp_path);
+		  remove_compile_temps();
+		  return 0;
+	    }
+	    if (diag)
+		  fclose(diag);
+      }
+
+	/* Cache miss, so run the compiler on the preprocessed file,
+	   capturing its diagnostics so that they can be saved. */
+      tmp_name = my_tempfile("ivrld", &diag_file);
+      if (diag_file == 0) {
+	    fprintf(stderr, "Unable to create temporary file for "
+		    "compiler messages.\n");
+	    free(cache_path);
+	    free(diag_cache_path);
+	    remove(pp_path);
+	    free(pp_path);
+	    remove_compile_temps();
+	    return 1;
+      }
+      fclose(diag_file);
+      diag_path = strdup(tmp_name);
+
+      ncmd = strlen(base) + strlen(iconfig_path) + strlen(iconfig_common_path)
+	    + strlen(pp_path) + strlen(diag_path) + 64;
+      cmd = malloc(ncmd);
+      snprintf(cmd, ncmd, "%s%civl%s -C\"%s\" -C\"%s\" -- \"%s\" 2>\"%s\"",
+	       base, sep, verbose_flag? " -v" : "", iconfig_path,
+	       iconfig_common_path, pp_path, diag_path);
+
+      if (verbose_flag)
+	    printf("translate: %s\n", cmd);
+
+      rc = system(cmd);
+      remove(pp_path);
+      free(pp_path);
+      remove_compile_temps();
+
+      diag_file = fopen(diag_path, "rb");
+      if (diag_file) {
+	    cache_replay_diag(diag_file);
+	    fclose(diag_file);
+      }
+
+      if (rc != 0) {
+	    remove(diag_path);
+	    free(diag_path);
+	    free(cache_path);
+	    free(diag_cache_path);
+	    if (rc == 127) {
+		  fprintf(stderr, "Failed to execute: %s\n", cmd);
+		  free(cmd);
+		  return 1;
+	    }
+	    free(cmd);
+	    if (WIFEXITED(rc))
+		  return WEXITSTATUS(rc);
+	    return 1;
+      }
+      free(cmd);
+
+	/* Save the diagnostics first, so that an output in the cache
+	   always has its diagnostics next to it. */
+      if (hash != 0 && diag_file
+	  && cache_save_file(diag_cache_path, diag_path) == 0
+	  && cache_save_file(cache_path, opath) == 0
+	  && verbose_flag)
+	    printf("cache: saved %s\n", cache_path);
+
+      remove(diag_path);
+      free(diag_path);
+      free(cache_path);
+      free(diag_cache_path);
+      return 0;
+}
+
+/*
+ * Use the compile cache if the user asked for it, and if all the
+ * outputs of the compile are in the one output file. Separately
+ * preprocessed compilation units are not cached.
+ */
+static const char* compile_cache_dir(void)
+{
+      const char*cache_dir = getenv("IVERILOG_CACHE");
+      if (cache_dir && *cache_dir && !library_dir_flag && !separate_units_flag
+	  && npath == 0 && depfile == 0 && strcmp(opath, "-") != 0)
+	    return cache_dir;
+      return 0;
+}
+
+/*
+ * Run a list of shell commands, as many at a time as there are
+ * processors. The return value is 0 if all the commands succeed.
+ */
+static int run_commands_parallel(char**cmds, unsigned ncmds)
+{
+      unsigned idx;
+      int rtn = 0;
+#ifdef __MINGW32__
+      for (idx = 0 ; idx < ncmds ; idx += 1) {
+	    if (system(cmds[idx]) != 0)
+		  rtn = 1;
+      }
+#else
+      long njobs = sysconf(_SC_NPROCESSORS_ONLN);
+      long running = 0;
+      if (njobs < 1)
+	    njobs = 1;
+
+      idx = 0;
+      while (idx < ncmds || running > 0) {
+	    int status;
+	    while (running < njobs && idx < ncmds) {
+		  pid_t pid = fork();
+		  if (pid == 0) {
+			execl("/bin/sh", "sh", "-c", cmds[idx], (char*)0);
+			_exit(127);
+		  }
+		  if (pid < 0) {
+			perror("fork");
+			rtn = 1;
+			idx = ncmds;
+			break;
+		  }
+		  running += 1;
+		  idx += 1;
+	    }
+
+	    if (running == 0)
+		  break;
+	    if (wait(&status) < 0) {
+		  perror("wait");
+		  return 1;
+	    }
+	    running -= 1;
+	    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+		  rtn = 1;
+      }
+#endif
+      return rtn;
+}
+
+/*
+ * With -u each source file is a compilation unit of its own, and no
+ * macro definitions pass from one file to the next, so the files can
+ * be preprocessed independently of each other. Run an ivlpp for each
+ * file, in parallel, then pass the outputs to ivl in the order of the
+ * source files as unit: lines in the iconfig file.
+ */
+static int t_compile_units(void)
+{
+      char**names = 0;
+      char**units = 0;
+      char**cmds = 0;
+      unsigned nunits = 0;
+      unsigned idx;
+      size_t ncmd;
+      char*cmd;
+      char*unit_base;
+      FILE*unit_file;
+      int rc;
+      int rtn = 0;
+      FILE*fd;
+
+      fd = fopen(source_path, "r");
+      if (fd == 0) {
+	    perror(source_path);
+	    remove_compile_temps();
+	    return 1;
+      }
+      while (fgets(line, sizeof line, fd)) {
+	    line[strcspn(line, "\r\n")] = 0;
+	    if (line[0] == 0)
+		  continue;
+	    names = realloc(names, (nunits+1) * sizeof(char*));
+	    names[nunits] = strdup(line);
+	    nunits += 1;
+      }
+      fclose(fd);
+
+	/* The preprocessed units are named after one temporary
+	   file, with the unit number added. */
+      unit_base = strdup(my_tempfile("ivrlu", &unit_file));
+      if (unit_file == 0) {
+	    fprintf(stderr, "Unable to create temporary file for "
+		    "preprocessed source.\n");
+	    rtn = 1;
+      } else {
+	    fclose(unit_file);
+      }
+
+      units = calloc(nunits, sizeof(char*));
+      cmds = calloc(nunits, sizeof(char*));
+      for (idx = 0 ; rtn == 0 && idx < nunits ; idx += 1) {
+	    ncmd = strlen(unit_base) + 16;
+	    units[idx] = malloc(ncmd);
+	    snprintf(units[idx], ncmd, "%s.%u", unit_base, idx);
+
+	    ncmd = strlen(ivlpp_dir) + strlen(defines_path)
+		  + strlen(units[idx]) + strlen(names[idx]) + 64;
+	    cmds[idx] = malloc(ncmd);
+	    snprintf(cmds[idx], ncmd, "%s%civlpp%s -L -F\"%s\" -o\"%s\" \"%s\"",
+		     ivlpp_dir, sep, verbose_flag? " -v" : "", defines_path,
+		     units[idx], names[idx]);
+	    if (verbose_flag)
+		  printf("preprocess: %s\n", cmds[idx]);
+      }
+
+      if (rtn == 0) {
+	    fflush(0);
+	    if (run_commands_parallel(cmds, nunits) != 0) {
+		  fprintf(stderr, "errors preprocessing Verilog program.\n");
+		  rtn = 1;
+	    }
+      }
+
+	/* Tell ivl where the compilation units are. */
+      if (rtn == 0) {
+	    fd = fopen(iconfig_path, "a");
+	    if (fd == 0) {
+		  perror(iconfig_path);
+		  rtn = 1;
+	    } else {
+		  for (idx = 0 ; idx < nunits ; idx += 1)
+			fprintf(fd, "unit:%s\n", units[idx]);
+		  fclose(fd);
+	    }
+      }
+
+      if (rtn == 0) {
+	    ncmd = strlen(base) + (npath? strlen(npath) : 0)
+		  + strlen(iconfig_path) + strlen(iconfig_common_path) + 64;
+	    cmd = malloc(ncmd);
+	    snprintf(cmd, ncmd, "%s%civl%s%s%s%s -C\"%s\" -C\"%s\"",
+		     base, sep, verbose_flag? " -v" : "",
+		     npath? " -N\"" : "", npath? npath : "", npath? "\"" : "",
+		     iconfig_path, iconfig_common_path);
+
+	    if (verbose_flag)
+		  printf("translate: %s\n", cmd);
+
+	    rc = system(cmd);
+	    if (rc != 0) {
+		  if (rc == 127) {
+			fprintf(stderr, "Failed to execute: %s\n", cmd);
+			rtn = 1;
+		  } else if (WIFEXITED(rc)) {
+			rtn = WEXITSTATUS(rc);
+		  } else {
+			fprintf(stderr, "Command signaled: %s\n", cmd);
+			rtn = -1;
+		  }
+	    }
+	    free(cmd);
+      }
+
+      for (idx = 0 ; idx < nunits ; idx += 1) {
+	    if (units[idx]) {
+		  remove(units[idx]);
+		  free(units[idx]);
+	    }
+	    free(cmds[idx]);
+	    free(names[idx]);
+      }
+      remove(unit_base);
+      free(unit_base);
+      free(units);
+      free(cmds);
+      free(names);
+      remove_compile_temps();
+      return rtn;
+}
+
 /*
  * This is the default target type. It looks up the bits that are
  * needed to run the command from the configuration file (which is
@@ -403,9 +956,21 @@ static int t_preprocess_only(void)
 static int t_compile()
 {
       unsigned rc;
+      const char*cache_dir;
 
-	/* Start by building the preprocess command line. */
-      build_preprocess_command(0);
+      if (separate_units_flag)
+	    return t_compile_units();
+
+      cache_dir = compile_cache_dir();
+      if (cache_dir)
+	    return t_compile_cached(cache_dir);
+
+	/* Start by building the preprocess command line, unless ivl
+	   is to run the preprocessor itself. */
+      if (inprocess_pp_flag)
+	    tmp[0] = 0;
+      else
+	    build_preprocess_command(0);
 
       size_t ncmd = strlen(tmp);
       char*cmd = malloc(ncmd + 1);
@@ -416,7 +981,8 @@ static int t_compile()
 #endif
 
 	/* Build the ivl command and pipe it to the preprocessor. */
-      snprintf(tmp, sizeof tmp, " | %s%civl", base, sep);
+      snprintf(tmp, sizeof tmp, "%s%s%civl",
+	       inprocess_pp_flag? "" : " | ", base, sep);
       rc = strlen(tmp);
       cmd = realloc(cmd, ncmd+rc+1);
       strcpy(cmd+ncmd, tmp);
@@ -456,16 +1022,7 @@ static int t_compile()
 
 
       rc = system(cmd);
-      if ( ! getenv("IVERILOG_ICONFIG")) {
-	    remove(source_path);
-	    free(source_path);
-	    remove(iconfig_path);
-	    free(iconfig_path);
-	    remove(defines_path);
-	    free(defines_path);
-	    remove(compiled_defines_path);
-	    free(compiled_defines_path);
-      }
+      remove_compile_temps();
 #ifdef __MINGW32__  /* MinGW just returns the exit status, so return it! */
       free(cmd);
       return rc;
@@ -572,11 +1129,13 @@ static void process_warning_switch(const char*name)
 void process_library_switch(const char *name)
 {
       fprintf(iconfig_file, "-y:%s\n", name);
+      library_dir_flag = 1;
 }
 
 void process_library_nocase_switch(const char *name)
 {
       fprintf(iconfig_file, "-yl:%s\n", name);
+      library_dir_flag = 1;
 }
 
 void process_library2_switch(const char *name)
@@ -905,7 +1464,7 @@ int main(int argc, char **argv)
 	}
       }
 
-      while ((opt = getopt(argc, argv, "B:c:D:d:Ef:g:hI:M:m:N::o:P:p:Ss:T:t:vVW:y:Y:")) != EOF) {
+      while ((opt = getopt(argc, argv, "B:c:D:d:Ef:g:hiI:M:m:N::o:P:p:Ss:T:t:uvVW:y:Y:")) != EOF) {
 
 	    switch (opt) {
 		case 'B':
@@ -956,6 +1515,10 @@ int main(int argc, char **argv)
 		  fprintf(stderr, "%s\n", HELP);
 		  return 1;
 
+		case 'i':
+		  inprocess_pp_flag = 1;
+		  break;
+
 		case 'I':
 		  process_include_dir(optarg);
 		  break;
@@ -1000,6 +1563,9 @@ int main(int argc, char **argv)
 		case 't':
 		  targ = optarg;
 		  break;
+		case 'u':
+		  separate_units_flag = 1;
+		  break;
 		case 'v':
 		  verbose_flag = 1;
 		  break;
@@ -1198,6 +1764,22 @@ int main(int argc, char **argv)
       fprintf(iconfig_file, "ivlpp:%s%civlpp -L -F\"%s\" -P\"%s\"\n",
 	      ivlpp_dir, sep, defines_path, compiled_defines_path);
 
+	/* The cache and separate compilation units both preprocess
+	   the source before ivl runs. Otherwise, if the user asked for
+	   it, write the arguments that ivl passes to its preprocessor
+	   library. These are the arguments of the ivlpp command that
+	   would otherwise be piped into ivl. */
+      if (separate_units_flag || compile_cache_dir())
+	    inprocess_pp_flag = 0;
+      if (inprocess_pp_flag) {
+	    if (verbose_flag)
+		  fprintf(iconfig_file, "ivlpp_arg:-v\n");
+	    fprintf(iconfig_file, "ivlpp_arg:-L\n");
+	    fprintf(iconfig_file, "ivlpp_arg:-F%s\n", defines_path);
+	    fprintf(iconfig_file, "ivlpp_arg:-f%s\n", source_path);
+	    fprintf(iconfig_file, "ivlpp_arg:-p%s\n", compiled_defines_path);
+      }
+
 	/* Done writing to the iconfig file. Close it now. */
       fclose(iconfig_file);
 
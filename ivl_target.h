@@ -1134,6 +1134,14 @@ extern unsigned    ivl_lpm_lineno(ivl_lpm_t net);
  *
  * These are the functions that apply to all LPM devices:
  *
+ * ivl_lpm_attr_cnt
+ * ivl_lpm_attr_val
+ *    These support iterating over the attributes of the device. The
+ *    synthesizer marks a flip-flop (IVL_LPM_FF) that is clocked on the
+ *    negative edge with the "Clock:LPM_Polarity" attribute set to the
+ *    string "INVERT". Devices that are not synthesized flip-flops
+ *    have no attributes.
+ *
  * ivl_lpm_name (Obsolete)
  * ivl_lpm_basename
  *    Return the name of the device. The name is the name of the
@@ -1384,6 +1392,8 @@ extern unsigned    ivl_lpm_lineno(ivl_lpm_t net);
  * re-evaluated when a change is detected on its input ports.
  */
 
+extern unsigned        ivl_lpm_attr_cnt(ivl_lpm_t net);
+extern ivl_attribute_t ivl_lpm_attr_val(ivl_lpm_t net, unsigned idx);
 extern const char*    ivl_lpm_name(ivl_lpm_t net); /* (Obsolete) */
 extern const char*    ivl_lpm_basename(ivl_lpm_t net);
 extern ivl_expr_t     ivl_lpm_delay(ivl_lpm_t net, unsigned transition);
@@ -21,6 +21,33 @@
 
 # include  <stdio.h>
 
+/*
+ * The preprocessor is also linked into the ivl program as a library
+ * (see ivlpp.h), so give the global symbols that the preprocessor
+ * files share names that cannot clash with those of the compiler.
+ */
+# define add_source_file           ivlpp_add_source_file
+# define define_macro              ivlpp_define_macro
+# define dep_mode                  ivlpp_dep_mode
+# define dep_path                  ivlpp_dep_path
+# define depend_file               ivlpp_depend_file
+# define destroy_lexor             ivlpp_destroy_lexor
+# define dump_precompiled_defines  ivlpp_dump_precompiled_defines
+# define error_count               ivlpp_error_count
+# define fatal_error               ivlpp_fatal_error
+# define free_macros               ivlpp_free_macros
+# define include_cnt               ivlpp_include_cnt
+# define include_dir               ivlpp_include_dir
+# define line_direct_flag          ivlpp_line_direct_flag
+# define load_precompiled_defines  ivlpp_load_precompiled_defines
+# define relative_include          ivlpp_relative_include
+# define reset_lexor               ivlpp_reset_lexor
+# define verbose_flag              ivlpp_verbose_flag
+# define vhdlpp_libdir             ivlpp_vhdlpp_libdir
+# define vhdlpp_libdir_cnt         ivlpp_vhdlpp_libdir_cnt
+# define vhdlpp_path               ivlpp_vhdlpp_path
+# define vhdlpp_work               ivlpp_vhdlpp_work
+
 extern void reset_lexor(FILE*out, char*paths[]);
 extern void destroy_lexor();
 extern void load_precompiled_defines(FILE*src);
@@ -53,7 +80,18 @@ extern char dep_mode;
 
 extern int verbose_flag;
 
-/* This is the entry to the lexer. */
-extern int yylex();
+/* The lexor calls this for an error that it cannot continue from.
+   It does not return, but unwinds to ivlpp_main, which returns an
+   error status. The preprocessor may be running inside the ivl
+   program, so it must not exit. */
+extern void fatal_error(void)
+#ifdef __GNUC__
+      __attribute__((noreturn))
+#endif
+      ;
+
+/* This is the entry to the lexer. The scanner uses the "pp" prefix
+   instead of "yy" for the same reason. */
+extern int pplex();
 
 #endif
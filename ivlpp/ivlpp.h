@@ -0,0 +1,47 @@
+#ifndef __ivlpp_H
+#define __ivlpp_H
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * This is the interface to the preprocessor library, libivlpp.a,
+ * that the ivl program links so that it can preprocess the source
+ * without running the ivlpp program.
+ *
+ * The ivlpp_main function takes the same arguments as the ivlpp
+ * program, and returns the exit status that the program would. It
+ * never exits the process, even for an error that stops it in the
+ * middle of the source, since it may be running in a thread of ivl.
+ * The output goes to the def_out stream unless the arguments include an
+ * -o flag. The stream is not closed. The preprocessor keeps its
+ * state in globals, so it may only be run once in a process.
+ */
+extern int ivlpp_main(int argc, char*argv[], FILE*def_out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
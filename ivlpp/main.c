@@ -42,10 +42,12 @@ const char NOTICE[] =
 # include  <unistd.h>
 # include  <string.h>
 # include  <ctype.h>
+# include  <setjmp.h>
 #if defined(HAVE_GETOPT_H)
 # include  <getopt.h>
 #endif
 # include  "globals.h"
+# include  "ivlpp.h"
 # include  "ivl_alloc.h"
 
 #if defined(__MINGW32__) && !defined(HAVE_GETOPT_H)
@@ -235,7 +237,20 @@ static int flist_read_names(const char*path)
       return 0;
 }
 
-int main(int argc, char*argv[])
+/*
+ * A fatal error in the lexor jumps back to ivlpp_main, which closes
+ * the files that this run opened and returns an error status.
+ */
+static jmp_buf fatal_env;
+static FILE*fatal_out = 0;
+static FILE*fatal_precomp_out = 0;
+
+void fatal_error(void)
+{
+      longjmp(fatal_env, 1);
+}
+
+static int ivlpp_run(int argc, char*argv[], FILE*def_out)
 {
       int opt, idx;
       unsigned lp;
@@ -282,6 +297,9 @@ int main(int argc, char*argv[])
       include_dir[0] = 0;  /* 0 is reserved for the current files path. */
       include_dir[1] = strdup(".");
 
+	/* The ivl program calls this after it has used getopt on its
+	   own command line, so start the scan over. */
+      optind = 1;
       while ((opt=getopt(argc, argv, "F:f:K:Lo:p:P:vV")) != EOF) switch (opt) {
 
 	  case 'F':
@@ -329,7 +347,7 @@ int main(int argc, char*argv[])
 		FILE*src = fopen(optarg, "rb");
 		if (src == 0) {
 		      perror(optarg);
-		      exit(1);
+		      return 1;
 		}
 		load_precompiled_defines(src);
 		fclose(src);
@@ -384,25 +402,31 @@ int main(int argc, char*argv[])
 		  return rc;
       }
 
-	/* Figure out what to use for an output file. Write to stdout
-	   if no path is specified. */
+	/* Figure out what to use for an output file. Write to the
+	   caller's stream if no path is specified. */
       if (out_path) {
 	    out = fopen(out_path, "w");
 	    if (out == 0) {
 		  perror(out_path);
-		  exit(1);
+		  return 1;
 	    }
+	    fatal_out = out;
       } else {
-	    out = stdout;
+	    out = def_out;
       }
 
+	/* The output is normally a pipe into the compiler, so write it
+	   in large blocks instead of the default stdio buffer size. */
+      setvbuf(out, 0, _IOFBF, 64*1024);
+
       if (precomp_out_path) {
 	    precomp_out = fopen(precomp_out_path, "wb");
 	    if (precomp_out == 0) {
 		  if (out_path) fclose(out);
 		  perror(precomp_out_path);
-		  exit(1);
+		  return 1;
 	    }
+	    fatal_precomp_out = precomp_out;
       }
 
       if (dep_path) {
@@ -411,7 +435,7 @@ int main(int argc, char*argv[])
 		  if (out_path) fclose(out);
 		  if (precomp_out) fclose(precomp_out);
 		  perror(dep_path);
-		  exit(1);
+		  return 1;
 	      }
       }
 
@@ -430,7 +454,7 @@ int main(int argc, char*argv[])
 	/* Pass to the lexical analyzer the list of input file, and
 	   start scanning. */
       reset_lexor(out, source_list);
-      if (yylex()) {
+      if (pplex()) {
 	    if (out_path) fclose(out);
 	    if (depend_file) fclose(depend_file);
 	    if (precomp_out) fclose(precomp_out);
@@ -469,3 +493,18 @@ int main(int argc, char*argv[])
 
       return error_count;
 }
+
+int ivlpp_main(int argc, char*argv[], FILE*def_out)
+{
+      fatal_out = 0;
+      fatal_precomp_out = 0;
+      if (setjmp(fatal_env)) {
+	    if (fatal_out) fclose(fatal_out);
+	    if (fatal_precomp_out) fclose(fatal_precomp_out);
+	    if (depend_file) fclose(depend_file);
+	    depend_file = 0;
+	    return 1;
+      }
+
+      return ivlpp_run(argc, argv, def_out);
+}
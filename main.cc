@@ -45,8 +45,10 @@ const char NOTICE[] =
 # include  <cstring>
 # include  <list>
 # include  <map>
+# include  <vector>
 # include  <unistd.h>
 # include  <cstdlib>
+# include  <cassert>
 #if defined(HAVE_TIMES)
 # include  <sys/times.h>
 #endif
@@ -61,6 +63,14 @@ const char NOTICE[] =
 # include  "compiler.h"
 # include  "discipline.h"
 # include  "t-dll.h"
+# include  "pool_alloc.h"
+# include  "netmisc.h"
+# include  "ivlpp/ivlpp.h"
+
+#if defined(HAVE_LIBPTHREAD) && !defined(__MINGW32__)
+# define USE_PP_THREAD
+# include  <pthread.h>
+#endif
 
 #if defined(__MINGW32__) && !defined(HAVE_GETOPT_H)
 extern "C" int getopt(int argc, char*argv[], const char*fmt);
@@ -145,6 +155,12 @@ list<perm_string> roots;
 
 char*ivlpp_string = 0;
 
+/* The command line arguments of the in-process preprocessor. */
+static vector<char*> ivlpp_args;
+
+/* Separately preprocessed compilation units to parse. */
+static vector<char*> unit_paths;
+
 char depfile_mode = 'a';
 char* depfile_name = NULL;
 FILE *depend_file = NULL;
@@ -183,6 +199,7 @@ bool disable_virtual_pins = false;
 unsigned long array_size_limit = 16777216;  // Minimum required by IEEE-1364?
 unsigned recursive_mod_limit = 10;
 bool disable_concatz_generation = false;
+bool skip_teardown = false;
 
 /*
  * Verbose messages enabled.
@@ -531,6 +548,11 @@ static bool set_default_timescale(const char*ts_string)
  *        This specifies the ivlpp command line used to process
  *        library modules as I read them in.
  *
+ *    ivlpp_arg:<argument>
+ *        An argument for the preprocessor library. If there are any
+ *        of these, the input file is preprocessed in this process
+ *        with these arguments instead of read as is.
+ *
  *    iwidth:<bits>
  *        This specifies the width of integer variables. (that is,
  *        variables declared using the "integer" keyword.)
@@ -549,6 +571,10 @@ static bool set_default_timescale(const char*ts_string)
  *    sys_func:<path>
  *        Path to a system functions descriptor table
  *
+ *    unit:<path>
+ *        A preprocessed compilation unit. If there are any of these,
+ *        they are the input, in order, instead of the input file.
+ *
  *    root:<name>
  *        Specify a root module. There may be multiple of this.
  *
@@ -644,6 +670,9 @@ static void read_iconfig_file(const char*ipath)
 	    } else if (strcmp(buf, "ivlpp") == 0) {
 		  ivlpp_string = strdup(cp);
 
+	    } else if (strcmp(buf, "ivlpp_arg") == 0) {
+		  ivlpp_args.push_back(strdup(cp));
+
 	    } else if (strcmp(buf, "iwidth") == 0) {
 		  integer_width = strtoul(cp,0,10);
 
@@ -664,6 +693,9 @@ static void read_iconfig_file(const char*ipath)
 	    } else if (strcmp(buf, "root") == 0) {
 		  roots.push_back(lex_strings.make(cp));
 
+	    } else if (strcmp(buf, "unit") == 0) {
+		  unit_paths.push_back(strdup(cp));
+
 	    } else if (strcmp(buf,"warnings") == 0) {
 		    /* Scan the warnings enable string for warning flags. */
 		  for ( ;  *cp ;  cp += 1) switch (*cp) {
@@ -778,6 +810,13 @@ static void EOC_cleanup(void)
       free(ivlpp_string);
       free(depfile_name);
 
+      for (size_t idx = 0 ; idx < ivlpp_args.size() ; idx += 1)
+	    free(ivlpp_args[idx]);
+      ivlpp_args.clear();
+      for (size_t idx = 0 ; idx < unit_paths.size() ; idx += 1)
+	    free(unit_paths[idx]);
+      unit_paths.clear();
+
       for (map<string, const char*>::iterator flg = flags.begin() ;
            flg != flags.end() ; ++ flg ) {
 	    free((void *)flg->second);
@@ -789,6 +828,110 @@ static void EOC_cleanup(void)
       filename_strings.cleanup();
 }
 
+/*
+ * The preprocessor library runs in this process when the driver
+ * passes its arguments with ivlpp_arg lines. It writes into a pipe
+ * from a thread of its own while the parser reads the other end, so
+ * the two still overlap as they do when the driver pipes the ivlpp
+ * program into ivl, but there is no fork/exec and the text does not
+ * pass through another program. Without threads, the preprocessor
+ * writes an anonymous temporary file that the parser then reads.
+ */
+#ifdef USE_PP_THREAD
+struct ivlpp_thread_s {
+      vector<char*>*argv;
+      FILE*out;
+      int rc;
+};
+
+static void* ivlpp_thread(void*arg)
+{
+      ivlpp_thread_s*info = static_cast<ivlpp_thread_s*>(arg);
+      info->rc = ivlpp_main(info->argv->size()-1, &(*info->argv)[0],
+			    info->out);
+      fclose(info->out);
+      return 0;
+}
+#endif
+
+static int pform_parse_in_process(const char*path)
+{
+	/* Make an argv with a program name and a trailing nil. */
+      vector<char*> pp_argv;
+      char prog_name[] = "ivlpp";
+      pp_argv.push_back(prog_name);
+      pp_argv.insert(pp_argv.end(), ivlpp_args.begin(), ivlpp_args.end());
+      pp_argv.push_back(0);
+
+      int pp_rc;
+      int rc;
+#ifdef USE_PP_THREAD
+      int fds[2];
+      if (pipe(fds) != 0) {
+	    perror("pipe");
+	    return 1;
+      }
+
+      ivlpp_thread_s info;
+      info.argv = &pp_argv;
+      info.out = fdopen(fds[1], "w");
+      info.rc = 0;
+      FILE*in = fdopen(fds[0], "r");
+      assert(info.out && in);
+
+      pthread_t thread;
+      if (pthread_create(&thread, 0, ivlpp_thread, &info) != 0) {
+	    cerr << "error: Unable to start the preprocessor thread." << endl;
+	    fclose(info.out);
+	    fclose(in);
+	    return 1;
+      }
+
+      rc = pform_parse(path, in);
+
+	/* The parser may give up before the end of the input, so
+	   drain the pipe to let the preprocessor finish. */
+      char buf[4096];
+      while (fread(buf, 1, sizeof buf, in) > 0)
+	    ;
+      fclose(in);
+      pthread_join(thread, 0);
+      pp_rc = info.rc;
+#else
+      FILE*tmp = tmpfile();
+      if (tmp == 0) {
+	    perror("tmpfile");
+	    return 1;
+      }
+
+      pp_rc = ivlpp_main(pp_argv.size()-1, &pp_argv[0], tmp);
+      fflush(tmp);
+      rewind(tmp);
+      rc = pform_parse(path, tmp);
+      fclose(tmp);
+#endif
+
+      if (pp_rc != 0 && rc == 0)
+	    rc = pp_rc;
+      return rc;
+}
+
+/*
+ * Parse the compilation units that the driver preprocessed one by
+ * one. A compilation unit does not inherit the `timescale of the
+ * units before it, so each starts with the default.
+ */
+static int pform_parse_units(void)
+{
+      int rc = 0;
+      for (size_t idx = 0 ; idx < unit_paths.size() ; idx += 1) {
+	    if (idx > 0)
+		  pform_set_timescale(def_ts_units, def_ts_prec, 0, 0);
+	    rc += pform_parse(unit_paths[idx]);
+      }
+      return rc;
+}
+
 int main(int argc, char*argv[])
 {
       bool help_flag = false;
@@ -897,7 +1040,7 @@ int main(int argc, char*argv[])
 	    return 0;
       }
 
-      if (optind == argc) {
+      if (optind == argc && unit_paths.empty()) {
 	    cerr << "No input files." << endl;
 	    return 1;
       }
@@ -995,9 +1138,18 @@ int main(int argc, char*argv[])
       flag_tmp = flags["DISABLE_CONCATZ_GENERATION"];
       if (flag_tmp) disable_concatz_generation = strcmp(flag_tmp,"true")==0;
 
+      flag_tmp = flags["SKIP_TEARDOWN"];
+      if (flag_tmp) skip_teardown = strcmp(flag_tmp,"true")==0;
+
 	/* Parse the input. Make the pform. */
       pform_set_timescale(def_ts_units, def_ts_prec, 0, 0);
-      int rc = pform_parse(argv[optind]);
+      int rc;
+      if (! unit_paths.empty())
+	    rc = pform_parse_units();
+      else if (! ivlpp_args.empty())
+	    rc = pform_parse_in_process(argv[optind]);
+      else
+	    rc = pform_parse(argv[optind]);
 
       if (pf_path) {
 	    ofstream out (pf_path);
@@ -1213,10 +1365,22 @@ int main(int argc, char*argv[])
 		 << " add_count=" << lex_strings.add_count()
 		 << " hit_count=" << lex_strings.add_hit_count()
 		 << endl;
+	    cout << "symbol_search:"
+		 << " count=" << symbol_search_count
+		 << " scope_steps=" << symbol_search_steps
+		 << endl;
+	    pool_alloc_stats(cout);
       }
 
-      delete des;
-      EOC_cleanup();
+	/* The target is done with the design, so there is nothing left
+	   to do but release memory. For really large designs that can
+	   take a noticeable amount of time, so the user may choose to
+	   leave it to the operating system. The normal exit still runs,
+	   so the streams are flushed and the exit handlers called. */
+      if (! skip_teardown) {
+	    delete des;
+	    EOC_cleanup();
+      }
       return 0;
 
  errors_summary:
@@ -24,6 +24,7 @@
 # include  "netdarray.h"
 # include  "compiler.h"
 # include  "netmisc.h"
+# include  "pool_alloc.h"
 # include  <iostream>
 # include  "ivl_assert.h"
 
@@ -41,6 +42,16 @@ NetExpr::~NetExpr()
 {
 }
 
+void* NetExpr::operator new(size_t size)
+{
+      return pool_alloc(size);
+}
+
+void NetExpr::operator delete(void*ptr, size_t size)
+{
+      pool_free(ptr, size);
+}
+
 ivl_type_t NetExpr::net_type() const
 {
       return net_type_;
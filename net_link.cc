@@ -27,6 +27,7 @@
 # include  <string>
 # include  <typeinfo>
 # include  <cstdlib>
+# include  "pool_alloc.h"
 # include  "ivl_alloc.h"
 
 void Nexus::connect(Link&r)
@@ -267,6 +268,16 @@ Nexus::~Nexus()
       delete[] name_;
 }
 
+void* Nexus::operator new(size_t size)
+{
+      return pool_alloc(size);
+}
+
+void Nexus::operator delete(void*ptr, size_t size)
+{
+      pool_free(ptr, size);
+}
+
 bool Nexus::assign_lval() const
 {
       for (const Link*cur = first_nlink() ; cur ; cur = cur->next_nlink()) {
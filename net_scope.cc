@@ -109,6 +109,7 @@ NetScope::NetScope(NetScope*up, const hname_t&n, NetScope::TYPE t, bool nest, bo
 : type_(t), name_(n), nested_module_(nest), program_block_(prog), up_(up)
 {
       events_ = 0;
+      symbol_index_count_ = 0;
       lcounter_ = 0;
       is_auto_ = false;
       is_cell_ = false;
@@ -196,6 +197,7 @@ void NetScope::set_parameter(perm_string key, bool is_annotatable,
 			     NetScope::range_t*range_list,
 			     const LineInfo&file_line)
 {
+      symbol_index_set_(key, SYMBOL_PARAMETER);
       param_expr_t&ref = parameters[key];
       ref.is_annotatable = is_annotatable;
       ref.msb_expr = msb;
@@ -221,6 +223,7 @@ void NetScope::set_parameter(perm_string key, bool is_annotatable,
 void NetScope::set_parameter(perm_string key, NetExpr*val,
 			     const LineInfo&file_line)
 {
+      symbol_index_set_(key, SYMBOL_PARAMETER);
       param_expr_t&ref = parameters[key];
       ref.is_annotatable = false;
       ref.msb_expr = 0;
@@ -547,6 +550,7 @@ void NetScope::add_event(NetEvent*ev)
       ev->scope_ = this;
       ev->snext_ = events_;
       events_ = ev;
+      symbol_index_set_(ev->name(), SYMBOL_EVENT);
 }
 
 void NetScope::rem_event(NetEvent*ev)
@@ -566,6 +570,8 @@ void NetScope::rem_event(NetEvent*ev)
       }
 
       ev->snext_ = 0;
+      if (find_event(ev->name()) == 0)
+	    symbol_index_clr_(ev->name(), SYMBOL_EVENT);
 }
 
 
@@ -586,8 +592,9 @@ void NetScope::add_genvar(perm_string name, LineInfo *li)
 
 LineInfo* NetScope::find_genvar(perm_string name)
 {
-      if (genvars_.find(name) != genvars_.end())
-	    return genvars_[name];
+      map<perm_string,LineInfo*>::const_iterator cur = genvars_.find(name);
+      if (cur != genvars_.end())
+	    return cur->second;
       else
             return 0;
 }
@@ -595,12 +602,14 @@ LineInfo* NetScope::find_genvar(perm_string name)
 void NetScope::add_signal(NetNet*net)
 {
       signals_map_[net->name()]=net;
+      symbol_index_set_(net->name(), SYMBOL_SIGNAL);
 }
 
 void NetScope::rem_signal(NetNet*net)
 {
       assert(net->scope() == this);
       signals_map_.erase(net->name());
+      symbol_index_clr_(net->name(), SYMBOL_SIGNAL);
 }
 
 /*
@@ -610,12 +619,100 @@ void NetScope::rem_signal(NetNet*net)
  */
 NetNet* NetScope::find_signal(perm_string key)
 {
-      if (signals_map_.find(key)!=signals_map_.end())
-	    return signals_map_[key];
+      map<perm_string,NetNet*>::const_iterator cur = signals_map_.find(key);
+      if (cur != signals_map_.end())
+	    return cur->second;
       else
 	    return 0;
 }
 
+/*
+ * This is the same hash that the lexical string heap uses.
+ */
+unsigned NetScope::symbol_hash(perm_string name)
+{
+      unsigned h = 0;
+
+      for (const char*text = name.str() ; text && *text ; text += 1)
+	    h = (h << 4) ^ (h >> 28) ^ *text;
+
+      return h;
+}
+
+unsigned NetScope::symbol_kinds(perm_string name, unsigned hash) const
+{
+      if (symbol_index_.empty())
+	    return 0;
+
+      unsigned mask = symbol_index_.size() - 1;
+      for (unsigned idx = hash & mask ; ! symbol_index_[idx].name.nil()
+		 ; idx = (idx + 1) & mask) {
+	    if (symbol_index_[idx].hash == hash && symbol_index_[idx].name == name)
+		  return symbol_index_[idx].kinds;
+      }
+
+      return 0;
+}
+
+/*
+ * Locate the index entry for the name, or the empty slot where it
+ * belongs. The table is kept at most half full, so there is always
+ * an empty slot to stop the probe.
+ */
+NetScope::symbol_index_t* NetScope::symbol_index_entry_(perm_string name,
+							 unsigned hash)
+{
+      unsigned mask = symbol_index_.size() - 1;
+      unsigned idx = hash & mask;
+      while (! symbol_index_[idx].name.nil()) {
+	    if (symbol_index_[idx].hash == hash && symbol_index_[idx].name == name)
+		  break;
+	    idx = (idx + 1) & mask;
+      }
+
+      return &symbol_index_[idx];
+}
+
+void NetScope::symbol_index_set_(perm_string name, unsigned kind)
+{
+      if (name.nil())
+	    return;
+
+      if (2 * (symbol_index_count_ + 1) > symbol_index_.size()) {
+	    std::vector<symbol_index_t> old;
+	    old.swap(symbol_index_);
+
+	    symbol_index_t empty;
+	    empty.hash = 0;
+	    empty.kinds = 0;
+	    symbol_index_.resize(old.empty()? 16 : 2 * old.size(), empty);
+
+	    for (unsigned idx = 0 ; idx < old.size() ; idx += 1) {
+		  if (old[idx].name.nil())
+			continue;
+		  *symbol_index_entry_(old[idx].name, old[idx].hash) = old[idx];
+	    }
+      }
+
+      unsigned hash = symbol_hash(name);
+      symbol_index_t*ent = symbol_index_entry_(name, hash);
+      if (ent->name.nil()) {
+	    ent->name = name;
+	    ent->hash = hash;
+	    symbol_index_count_ += 1;
+      }
+      ent->kinds |= kind;
+}
+
+void NetScope::symbol_index_clr_(perm_string name, unsigned kind)
+{
+      if (name.nil() || symbol_index_.empty())
+	    return;
+
+      symbol_index_t*ent = symbol_index_entry_(name, symbol_hash(name));
+      ent->kinds &= ~kind;
+}
+
 void NetScope::add_class(netclass_t*net_class)
 {
       classes_[net_class->get_name()] = net_class;
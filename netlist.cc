@@ -24,6 +24,7 @@
 # include  <typeinfo>
 # include  <cstdlib>
 # include  <climits>
+# include  <new>
 # include  "compiler.h"
 # include  "netlist.h"
 # include  "netmisc.h"
@@ -33,6 +34,7 @@
 # include  "netparray.h"
 # include  "netstruct.h"
 # include  "netvector.h"
+# include  "pool_alloc.h"
 # include  "ivl_assert.h"
 
 
@@ -154,7 +156,12 @@ void NetPins::devirtualize_pins(void)
       }
       if (debug_optimizer && npins_ > 1000) cerr << "debug: devirtualizing " << npins_ << " pins." << endl;
 
-      pins_ = new Link[npins_];
+	// Link arrays are allocated from the pool. Most objects have
+	// only a handful of pins, so these recycle nicely.
+      pins_ = static_cast<Link*>(pool_alloc(npins_ * sizeof(Link)));
+      for (unsigned idx = 0 ;  idx < npins_ ;  idx += 1)
+	    new (pins_+idx) Link;
+
       pins_[0].pin_zero_ = true;
       pins_[0].node_ = this;
       pins_[0].dir_  = default_dir_;
@@ -180,7 +187,11 @@ NetPins::NetPins(unsigned npins)
 
 NetPins::~NetPins()
 {
-      delete[] pins_;
+      if (pins_ == 0) return;
+
+      for (unsigned idx = 0 ;  idx < npins_ ;  idx += 1)
+	    pins_[idx].~Link();
+      pool_free(pins_, npins_ * sizeof(Link));
 }
 
 Link& NetPins::pin(unsigned idx)
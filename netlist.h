@@ -342,6 +342,11 @@ class Nexus {
       explicit Nexus(Link&r);
       ~Nexus();
 
+	// There is a Nexus for nearly every connected pin, so they
+	// are allocated from the pool heap (see pool_alloc.h).
+      static void* operator new(size_t size);
+      static void  operator delete(void*ptr, size_t size);
+
     public:
 
       void connect(Link&r);
@@ -953,6 +958,17 @@ class NetScope : public Definitions, public Attrib {
       void rem_signal(NetNet*);
       NetNet* find_signal(perm_string name);
 
+	/* The symbol index is a hash table of the names of the
+	   signals, events and parameters of this scope, so that a
+	   symbol search can test each scope it passes through with a
+	   single probe. The symbol_kinds method returns the SYMBOL_*
+	   flags of the items that have the given name, or 0 if there
+	   are none. The hash is from symbol_hash, so that a search
+	   computes it only once for all the scopes it visits. */
+      enum { SYMBOL_SIGNAL = 1, SYMBOL_EVENT = 2, SYMBOL_PARAMETER = 4 };
+      static unsigned symbol_hash(perm_string name);
+      unsigned symbol_kinds(perm_string name, unsigned hash) const;
+
       void add_class(netclass_t*class_type);
       netclass_t* find_class(perm_string name);
 
@@ -1191,6 +1207,19 @@ class NetScope : public Definitions, public Attrib {
 
       typedef std::map<perm_string,NetNet*>::const_iterator signals_map_iter_t;
       std::map <perm_string,NetNet*> signals_map_;
+
+	// The symbol index is an open hash table with a power of 2
+	// size. Entries are never removed, only their kinds cleared.
+      struct symbol_index_t {
+	    perm_string name;
+	    unsigned hash;
+	    unsigned kinds;
+      };
+      std::vector<symbol_index_t> symbol_index_;
+      unsigned symbol_index_count_;
+      symbol_index_t* symbol_index_entry_(perm_string name, unsigned hash);
+      void symbol_index_set_(perm_string name, unsigned kind);
+      void symbol_index_clr_(perm_string name, unsigned kind);
       perm_string module_name_;
       vector<NetNet*> port_nets;
 
@@ -1873,6 +1902,11 @@ class NetExpr  : public LineInfo {
       explicit NetExpr(ivl_type_t t);
       virtual ~NetExpr() =0;
 
+	// Expression nodes are small and numerous, so allocate them
+	// from the pool heap (see pool_alloc.h).
+      static void* operator new(size_t size);
+      static void  operator delete(void*ptr, size_t size);
+
       virtual void expr_scan(struct expr_scan_t*) const =0;
       virtual void dump(ostream&) const;
 
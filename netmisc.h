@@ -39,7 +39,7 @@
 extern NetScope* symbol_search(const LineInfo*li,
                                Design*des,
 			       NetScope*start,
-                               pform_name_t path,
+                               const pform_name_t&path,
 			       NetNet*&net,       /* net/reg */
 			       const NetExpr*&par,/* parameter/expr */
 			       NetEvent*&eve,     /* named event */
@@ -57,6 +57,13 @@ inline NetScope* symbol_search(const LineInfo*li,
       return symbol_search(li, des, start, path, net, par, eve, ex1, ex2);
 }
 
+/*
+ * Counters for the number of symbol searches, and the number of
+ * scopes visited by those searches.
+ */
+extern unsigned long symbol_search_count;
+extern unsigned long symbol_search_steps;
+
 /*
  * This function transforms an expression by padding the high bits
  * with V0 until the expression has the desired width. This may mean
@@ -2005,7 +2005,7 @@ variable_dimension /* IEEE1800-2005: A.2.5 */
 	list<pform_range_t> *tmp = new list<pform_range_t>;
 	pform_range_t index (0,0);
 	if (gn_system_verilog()) {
-	      yyerror("sorry: Dynamic array ranges not supported.");
+	      yyerror("sorry: Queue declarations are not supported.");
 	} else {
 	      yyerror("error: Queue declarations require System Verilog.");
 	}
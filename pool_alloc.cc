@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "pool_alloc.h"
+# include  <new>
+
+using namespace std;
+
+/*
+ * Items are allocated in multiples of POOL_GRAIN bytes, which also
+ * gives them the alignment of a pointer or a double. Items larger
+ * then POOL_LIMIT bytes go directly to the global heap.
+ */
+static const size_t POOL_GRAIN = 8;
+static const size_t POOL_LIMIT = 256;
+static const size_t POOL_CHUNK = 256*1024;
+
+struct pool_cell_s {
+      struct pool_cell_s*next;
+};
+
+static pool_cell_s*pool_free_list[POOL_LIMIT/POOL_GRAIN + 1];
+
+static char*  pool_chunk_ptr = 0;
+static size_t pool_chunk_rem = 0;
+
+static unsigned long pool_chunk_count = 0;
+static unsigned long pool_alloc_count = 0;
+static unsigned long pool_reuse_count = 0;
+static unsigned long pool_large_count = 0;
+
+static inline size_t pool_class(size_t size)
+{
+      return (size + POOL_GRAIN - 1) / POOL_GRAIN;
+}
+
+void* pool_alloc(size_t size)
+{
+      if (size == 0) size = 1;
+      if (size > POOL_LIMIT) {
+	    pool_large_count += 1;
+	    return ::operator new(size);
+      }
+
+      pool_alloc_count += 1;
+
+      size_t cls = pool_class(size);
+      if (pool_cell_s*cur = pool_free_list[cls]) {
+	    pool_free_list[cls] = cur->next;
+	    pool_reuse_count += 1;
+	    return cur;
+      }
+
+      size_t bytes = cls * POOL_GRAIN;
+      if (pool_chunk_rem < bytes) {
+	      // Don't waste the tail of the current chunk. Put it on
+	      // the free list of the size class that it fits.
+	    if (pool_chunk_rem >= POOL_GRAIN) {
+		  size_t tail = pool_chunk_rem / POOL_GRAIN;
+		  pool_cell_s*cell = reinterpret_cast<pool_cell_s*>(pool_chunk_ptr);
+		  cell->next = pool_free_list[tail];
+		  pool_free_list[tail] = cell;
+	    }
+	    pool_chunk_ptr = static_cast<char*>(::operator new(POOL_CHUNK));
+	    pool_chunk_rem = POOL_CHUNK;
+	    pool_chunk_count += 1;
+      }
+
+      void*res = pool_chunk_ptr;
+      pool_chunk_ptr += bytes;
+      pool_chunk_rem -= bytes;
+      return res;
+}
+
+void pool_free(void*ptr, size_t size)
+{
+      if (ptr == 0) return;
+      if (size == 0) size = 1;
+      if (size > POOL_LIMIT) {
+	    ::operator delete(ptr);
+	    return;
+      }
+
+      size_t cls = pool_class(size);
+      pool_cell_s*cell = static_cast<pool_cell_s*>(ptr);
+      cell->next = pool_free_list[cls];
+      pool_free_list[cls] = cell;
+}
+
+void pool_alloc_stats(ostream&out)
+{
+      out << "pool_alloc:"
+	  << " chunks=" << pool_chunk_count
+	  << " (" << (pool_chunk_count*POOL_CHUNK/1024) << "K)"
+	  << " alloc_count=" << pool_alloc_count
+	  << " reuse_count=" << pool_reuse_count
+	  << " large_count=" << pool_large_count
+	  << endl;
+}
@@ -0,0 +1,45 @@
+#ifndef __pool_alloc_H
+#define __pool_alloc_H
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  <cstddef>
+# include  <iostream>
+
+/*
+ * The compiler creates and destroys huge numbers of small objects
+ * (Link arrays, Nexus objects, PExpr and NetExpr nodes) that are
+ * never more then a few hundred bytes. The pool allocator carves
+ * these out of large chunks and keeps freed items on per-size free
+ * lists so that they can be recycled by any other object of the same
+ * size class. Large requests are passed through to the global heap.
+ *
+ * The size passed to pool_free() must be the size that was passed to
+ * pool_alloc() for that item. The sized operator delete of a class
+ * with a virtual destructor gets exactly that.
+ */
+extern void* pool_alloc(size_t size);
+extern void  pool_free(void*ptr, size_t size);
+
+/*
+ * Print allocation statistics for the pool.
+ */
+extern void pool_alloc_stats(std::ostream&out);
+
+#endif
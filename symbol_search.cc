@@ -58,17 +58,32 @@ struct symbol_search_results {
       NetEvent*eve;
 };
 
+/*
+ * These count the symbol searches and the number of scopes that the
+ * searches visit. They are reported with the compiler statistics.
+ */
+unsigned long symbol_search_count = 0;
+unsigned long symbol_search_steps = 0;
+
+/*
+ * Search for the name component at "tail" in the path. The
+ * components before "tail" are the prefix, and are searched for
+ * recursively. Working with an iterator into the caller's path
+ * instead of a shortened copy avoids copying the path (and the
+ * index expression lists of all its components) at each level.
+ */
 static bool symbol_search(const LineInfo*li, Design*des, NetScope*scope,
-			  pform_name_t path, struct symbol_search_results*res,
+			  const pform_name_t&path,
+			  pform_name_t::const_iterator tail,
+			  struct symbol_search_results*res,
 			  NetScope*start_scope = 0)
 {
       assert(scope);
       bool prefix_scope = false;
       bool recurse_flag = false;
 
-      ivl_assert(*li, ! path.empty());
-      name_component_t path_tail = path.back();
-      path.pop_back();
+      ivl_assert(*li, tail != path.end());
+      const name_component_t&path_tail = *tail;
 
 	// If this is a recursive call, then we need to know that so
 	// that we can enable the search for scopes. Set the
@@ -81,9 +96,13 @@ static bool symbol_search(const LineInfo*li, Design*des, NetScope*scope,
 	// If there are components ahead of the tail, symbol_search
 	// recursively. Ideally, the result is a scope that we search
 	// for the tail key, but there are other special cases as well.
-      if (! path.empty()) {
+      if (tail != path.begin()) {
+	    pform_name_t::const_iterator prefix_tail = tail;
+	    -- prefix_tail;
+
 	    symbol_search_results recurse;
-	    bool flag = symbol_search(li, des, scope, path, &recurse, start_scope);
+	    bool flag = symbol_search(li, des, scope, path, prefix_tail,
+				      &recurse, start_scope);
 	    if (! flag)
 		  return false;
 
@@ -95,9 +114,10 @@ static bool symbol_search(const LineInfo*li, Design*des, NetScope*scope,
 		  prefix_scope = true;
 
 		  if (scope->is_auto() && li) {
+			pform_name_t prefix (path.begin(), tail);
 			cerr << li->get_fileline() << ": error: Hierarchical "
 			      "reference to automatically allocated item "
-			      "`" << path_tail.name << "' in path `" << path << "'" << endl;
+			      "`" << path_tail.name << "' in path `" << prefix << "'" << endl;
 			des->errors += 1;
 		  }
 	    } else {
@@ -106,26 +126,52 @@ static bool symbol_search(const LineInfo*li, Design*des, NetScope*scope,
 	    }
       }
 
+      if (path_tail.name == "#") {
+	    cerr << li->get_fileline() << ": sorry: "
+		 << "Implicit class handle \"super\" not supported." << endl;
+	    return false;
+      }
+
+      symbol_search_count += 1;
+      unsigned name_hash = NetScope::symbol_hash(path_tail.name);
+
       while (scope) {
-	    if (path_tail.name == "#") {
-		  cerr << li->get_fileline() << ": sorry: "
-		       << "Implicit class handle \"super\" not supported." << endl;
-		  return false;
-	    }
+	    symbol_search_steps += 1;
 
-	    if (NetNet*net = scope->find_signal(path_tail.name)) {
-		  res->scope = scope;
-		  res->net = net;
-		  return true;
+	      // The symbol index tells which (if any) of the signal,
+	      // event and parameter tables have this name, so only
+	      // those need be searched.
+	    unsigned kinds = scope->symbol_kinds(path_tail.name, name_hash);
+
+	    if (kinds & NetScope::SYMBOL_SIGNAL) {
+		  if (NetNet*net = scope->find_signal(path_tail.name)) {
+			res->scope = scope;
+			res->net = net;
+			return true;
+		  }
 	    }
 
-	    if (NetEvent*eve = scope->find_event(path_tail.name)) {
-		  res->scope = scope;
-		  res->eve = eve;
-		  return true;
+	    if (kinds & NetScope::SYMBOL_EVENT) {
+		  if (NetEvent*eve = scope->find_event(path_tail.name)) {
+			res->scope = scope;
+			res->eve = eve;
+			return true;
+		  }
 	    }
 
-	    if (const NetExpr*par = scope->get_parameter(des, path_tail.name, res->par_msb, res->par_lsb)) {
+	      // Enumeration literals are not in the index, so if the
+	      // name is not a parameter, look for those directly.
+	    const NetExpr*par = 0;
+	    if (kinds & NetScope::SYMBOL_PARAMETER) {
+		  par = scope->get_parameter(des, path_tail.name, res->par_msb, res->par_lsb);
+	    } else {
+		  res->par_msb = 0;
+		  res->par_lsb = 0;
+		  par = scope->enumeration_expr(path_tail.name);
+		  if (par == 0)
+			par = des->enumeration_expr(path_tail.name);
+	    }
+	    if (par) {
 		  res->scope = scope;
 		  res->par_val = par;
 		  return true;
@@ -171,14 +217,18 @@ static bool symbol_search(const LineInfo*li, Design*des, NetScope*scope,
  * Compatibility version. Remove me!
  */
 NetScope*symbol_search(const LineInfo*li, Design*des, NetScope*scope,
-                       pform_name_t path,
+                       const pform_name_t&path,
 		       NetNet*&net,
 		       const NetExpr*&par,
 		       NetEvent*&eve,
 		       const NetExpr*&ex1, const NetExpr*&ex2)
 {
+      ivl_assert(*li, ! path.empty());
+      pform_name_t::const_iterator tail = path.end();
+      -- tail;
+
       symbol_search_results recurse;
-      bool flag = symbol_search(li, des, scope, path, &recurse);
+      bool flag = symbol_search(li, des, scope, path, tail, &recurse);
       net = recurse.net;
       par = recurse.par_val;
       ex1 = recurse.par_msb;
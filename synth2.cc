@@ -943,6 +943,12 @@ bool NetProcTop::synth_sync(Design*des)
 
 	    connect(clock->pin(0),  ff2->pin_Clock());
 	    connect(ce->pin(0),     ff2->pin_Enable());
+
+	      /* The clock net goes away, so pass its polarity on to
+		 the device. */
+	    perm_string polarity = perm_string::literal("Clock:LPM_Polarity");
+	    if (clock->attribute(polarity).is_string())
+		  ff2->attribute(polarity, clock->attribute(polarity));
 #if 0
 	    if (ff->pin_Aset().is_linked())
 		  connect(ff->pin_Aset(), ff2->pin_Aset());
@@ -1855,6 +1855,8 @@ void dll_target::lpm_ff(const NetFF*net)
       FILE_NAME(obj, net);
 
       obj->width = net->width();
+      obj->nattr = net->attr_cnt();
+      obj->attr  = fill_in_attributes(net);
 
       scope_add_lpm(obj->scope, obj);
 
@@ -356,6 +356,8 @@ struct ivl_expr_s {
  */
 
 struct ivl_lpm_s {
+      ivl_lpm_s() : nattr(0), attr(0) { }
+
       ivl_lpm_type_t type;
       ivl_scope_t scope;
       perm_string name;
@@ -365,6 +367,9 @@ struct ivl_lpm_s {
       unsigned width;
       ivl_expr_t delay[3];
 
+      unsigned nattr;
+      struct ivl_attribute_s*attr;
+
       union {
 	    struct ivl_lpm_ff_s {
 		  ivl_nexus_t clk;
@@ -0,0 +1,639 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "version_base.h"
+# include  "version_tag.h"
+# include  "priv.h"
+# include  "ivl_target.h"
+# include  "nex_data.h"
+# include  <map>
+# include  <string>
+# include  <vector>
+# include  <cstdio>
+# include  <cstring>
+# include  <cassert>
+
+using namespace std;
+
+/*
+ * This is a C++ target module. It writes the synthesized design as a
+ * C++ class that evaluates the netlist natively. The class can be
+ * bound to a shell module in a vvp simulation through the VPI glue
+ * that is also written into the output file.
+ */
+
+static const char*version_string =
+"Icarus Verilog C++ Code Generator " VERSION " (" VERSION_TAG ")\n\n"
+"Copyright (c) 2026 Stephen Williams (steve@icarus.com)\n\n"
+"  This program is free software; you can redistribute it and/or modify\n"
+"  it under the terms of the GNU General Public License as published by\n"
+"  the Free Software Foundation; either version 2 of the License, or\n"
+"  (at your option) any later version.\n"
+"\n"
+"  This program is distributed in the hope that it will be useful,\n"
+"  but WITHOUT ANY WARRANTY; without even the implied warranty of\n"
+"  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the\n"
+"  GNU General Public License for more details.\n"
+"\n"
+"  You should have received a copy of the GNU General Public License along\n"
+"  with this program; if not, write to the Free Software Foundation, Inc.,\n"
+"  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.\n"
+;
+
+int cxx_errors = 0;
+
+/*
+ * A combinational node of the model is either a logic gate or an LPM
+ * device. Flip-flops are kept separately since they are evaluated
+ * only at clock edges.
+ */
+struct cxx_node_t {
+      ivl_net_logic_t log;
+      ivl_lpm_t lpm;
+};
+
+static vector<cxx_node_t> comb_nodes;
+static vector<ivl_lpm_t> ff_nodes;
+
+static void emit_cxx(const char*cxx_path, ivl_design_t des, ivl_scope_t model);
+
+static int process_scan_fun(ivl_process_t net, void* /*raw*/)
+{
+      fprintf(stderr, "%s:%u: sorry: CXX: Processes that cannot be "
+	      "synthesized are not supported.\n",
+	      ivl_process_file(net), ivl_process_lineno(net));
+      cxx_errors += 1;
+      return 0;
+}
+
+int target_design(ivl_design_t des)
+{
+      const char*cxx_path = ivl_design_flag(des, "-o");
+
+	// Locate the root scope for the design. The root module is
+	// the model that is compiled.
+      ivl_scope_t*roots;
+      unsigned nroots;
+      ivl_design_roots(des, &roots, &nroots);
+      if (nroots != 1) {
+	    fprintf(stderr, "CXX: The C++ code generator requires that there be only one root scope.\n");
+	    return 1;
+      }
+
+      assert(roots[0]);
+
+      if (ivl_scope_type(roots[0]) != IVL_SCT_MODULE) {
+	    fprintf(stderr, "CXX: The root scope %s must be a module.\n", ivl_scope_basename(roots[0]));
+	    return 1;
+      }
+
+	// Processes that the synthesizer left behind cannot be
+	// compiled into the model.
+      ivl_design_process(des, &process_scan_fun, 0);
+
+	// Emit to the destination file.
+      assert(cxx_path);
+      emit_cxx(cxx_path, des, roots[0]);
+
+      return cxx_errors;
+}
+
+
+const char* target_query(const char*key)
+{
+      if (strcmp(key,"version") == 0)
+	    return version_string;
+
+      return 0;
+}
+
+uint64_t mask_value(unsigned wid)
+{
+      if (wid >= 64)
+	    return ~(uint64_t)0;
+      return ((uint64_t)1 << wid) - 1;
+}
+
+string hex_string(uint64_t val)
+{
+      char buf[64];
+      snprintf(buf, sizeof buf, "0x%llxULL", (unsigned long long)val);
+      return buf;
+}
+
+string mask_string(unsigned wid)
+{
+      return hex_string(mask_value(wid));
+}
+
+string sext_string(const string&expr, unsigned wid)
+{
+      char buf[32];
+      snprintf(buf, sizeof buf, ", %u)", wid);
+      return "cxx_sext(" + expr + buf;
+}
+
+string value_string(const char*bits, unsigned wid)
+{
+      uint64_t val = 0;
+      for (unsigned idx = 0 ; idx < wid && idx < 64 ; idx += 1) {
+	    if (bits[idx] == '1')
+		  val |= (uint64_t)1 << idx;
+      }
+
+      return hex_string(val);
+}
+
+/*
+ * Collect the nodes of the model. The signals of the model are also
+ * checked here, as the model only supports vectors that fit in a
+ * uint64_t.
+ */
+static void collect_scope(ivl_scope_t scope)
+{
+      for (unsigned idx = 0 ; idx < ivl_scope_sigs(scope) ; idx += 1) {
+	    ivl_signal_t sig = ivl_scope_sig(scope, idx);
+	    switch (ivl_signal_data_type(sig)) {
+		case IVL_VT_BOOL:
+		case IVL_VT_LOGIC:
+		  break;
+		default:
+		  fprintf(stderr, "%s:%u: sorry: CXX: Signal %s is not a "
+			  "vector.\n", ivl_signal_file(sig),
+			  ivl_signal_lineno(sig), ivl_signal_basename(sig));
+		  cxx_errors += 1;
+		  continue;
+	    }
+	    if (ivl_signal_array_count(sig) != 1) {
+		  fprintf(stderr, "%s:%u: sorry: CXX: Array %s is not "
+			  "supported.\n", ivl_signal_file(sig),
+			  ivl_signal_lineno(sig), ivl_signal_basename(sig));
+		  cxx_errors += 1;
+	    }
+	    if (ivl_signal_width(sig) > CXX_MAX_WIDTH) {
+		  fprintf(stderr, "%s:%u: sorry: CXX: Signal %s is wider "
+			  "than %u bits.\n", ivl_signal_file(sig),
+			  ivl_signal_lineno(sig), ivl_signal_basename(sig),
+			  CXX_MAX_WIDTH);
+		  cxx_errors += 1;
+	    }
+      }
+
+      for (unsigned idx = 0 ; idx < ivl_scope_logs(scope) ; idx += 1) {
+	    cxx_node_t node;
+	    node.log = ivl_scope_log(scope, idx);
+	    node.lpm = 0;
+	    assert(node.log);
+	    comb_nodes.push_back(node);
+
+	    ivl_nexus_t nex = ivl_logic_pin(node.log, 0);
+	    cxx_nex_data_t::get_nex_data(nex)->set_width(ivl_logic_width(node.log));
+      }
+
+      for (unsigned idx = 0 ; idx < ivl_scope_lpms(scope) ; idx += 1) {
+	    ivl_lpm_t net = ivl_scope_lpm(scope, idx);
+	    if (ivl_lpm_type(net) == IVL_LPM_FF) {
+		  ff_nodes.push_back(net);
+		  continue;
+	    }
+
+	    cxx_node_t node;
+	    node.log = 0;
+	    node.lpm = net;
+	    comb_nodes.push_back(node);
+
+	      // The output of a part-to-vector is wider than the
+	      // device, so its width can only come from the signal.
+	    if (ivl_lpm_type(net) != IVL_LPM_PART_PV) {
+		  ivl_nexus_t nex = ivl_lpm_q(net);
+		  unsigned wid = ivl_lpm_width(net);
+		  switch (ivl_lpm_type(net)) {
+		      case IVL_LPM_CMP_EEQ:
+		      case IVL_LPM_CMP_EQ:
+		      case IVL_LPM_CMP_GE:
+		      case IVL_LPM_CMP_GT:
+		      case IVL_LPM_CMP_NE:
+		      case IVL_LPM_CMP_NEE:
+		      case IVL_LPM_RE_AND:
+		      case IVL_LPM_RE_NAND:
+		      case IVL_LPM_RE_NOR:
+		      case IVL_LPM_RE_OR:
+		      case IVL_LPM_RE_XNOR:
+		      case IVL_LPM_RE_XOR:
+			wid = 1;
+			break;
+		      default:
+			break;
+		  }
+		  cxx_nex_data_t::get_nex_data(nex)->set_width(wid);
+	    }
+      }
+
+      for (size_t idx = 0 ; idx < ivl_scope_childs(scope) ; idx += 1) {
+	    ivl_scope_t child = ivl_scope_child(scope, idx);
+	    collect_scope(child);
+      }
+}
+
+static ivl_nexus_t node_output(const cxx_node_t&node)
+{
+      if (node.log)
+	    return ivl_logic_pin(node.log, 0);
+      else
+	    return ivl_lpm_q(node.lpm);
+}
+
+static void node_inputs(const cxx_node_t&node, vector<ivl_nexus_t>&inputs)
+{
+      if (node.log)
+	    logic_gate_inputs(node.log, inputs);
+      else
+	    lpm_inputs(node.lpm, inputs);
+}
+
+static void print_node_loop(const cxx_node_t&node)
+{
+      if (node.log)
+	    fprintf(stderr, "%s:%u: error: CXX: Combinational loop "
+		    "through this gate.\n", ivl_logic_file(node.log),
+		    ivl_logic_lineno(node.log));
+      else
+	    fprintf(stderr, "%s:%u: error: CXX: Combinational loop "
+		    "through this device.\n", ivl_lpm_file(node.lpm),
+		    ivl_lpm_lineno(node.lpm));
+}
+
+/*
+ * Sort the combinational nodes so that every node is evaluated after
+ * all the nodes that drive its inputs. A node is ready when all the
+ * drivers of all its inputs are done. Nodes that never become ready
+ * are part of a combinational loop, which the model cannot evaluate
+ * in a single pass.
+ */
+static void schedule_comb_nodes(vector<size_t>&order)
+{
+      vector<vector<ivl_nexus_t> > inputs (comb_nodes.size());
+
+      for (size_t idx = 0 ; idx < comb_nodes.size() ; idx += 1) {
+	    ivl_nexus_t out = node_output(comb_nodes[idx]);
+	    cxx_nex_data_t::get_nex_data(out)->drivers_ += 1;
+
+	    node_inputs(comb_nodes[idx], inputs[idx]);
+	    for (size_t pdx = 0 ; pdx < inputs[idx].size() ; pdx += 1) {
+		  cxx_nex_data_t*ned = cxx_nex_data_t::get_nex_data(inputs[idx][pdx]);
+		  ned->readers_.push_back(idx);
+	    }
+      }
+
+      vector<unsigned> pending (comb_nodes.size());
+      for (size_t idx = 0 ; idx < comb_nodes.size() ; idx += 1) {
+	    pending[idx] = 0;
+	    for (size_t pdx = 0 ; pdx < inputs[idx].size() ; pdx += 1) {
+		  cxx_nex_data_t*ned = cxx_nex_data_t::get_nex_data(inputs[idx][pdx]);
+		  pending[idx] += ned->drivers_;
+	    }
+	    if (pending[idx] == 0)
+		  order.push_back(idx);
+      }
+
+      for (size_t cur = 0 ; cur < order.size() ; cur += 1) {
+	    ivl_nexus_t out = node_output(comb_nodes[order[cur]]);
+	    cxx_nex_data_t*ned = cxx_nex_data_t::get_nex_data(out);
+	    for (size_t rdx = 0 ; rdx < ned->readers_.size() ; rdx += 1) {
+		  size_t reader = ned->readers_[rdx];
+		  assert(pending[reader] > 0);
+		  pending[reader] -= 1;
+		  if (pending[reader] == 0)
+			order.push_back(reader);
+	    }
+      }
+
+      if (order.size() == comb_nodes.size())
+	    return;
+
+      for (size_t idx = 0 ; idx < comb_nodes.size() ; idx += 1) {
+	    if (pending[idx] == 0)
+		  continue;
+	    print_node_loop(comb_nodes[idx]);
+	    cxx_errors += 1;
+      }
+}
+
+static string model_class_name(ivl_scope_t model)
+{
+      string tmp;
+      for (const char*cp = ivl_scope_basename(model) ; *cp ; cp += 1) {
+	    char ch = *cp;
+	    if ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z')
+		|| (ch >= '0' && ch <= '9') || ch == '_')
+		  tmp += ch;
+	    else
+		  tmp += '_';
+      }
+
+      return tmp + "_model";
+}
+
+/*
+ * These are the helper functions that the generated expressions
+ * use. They are guarded so that several models can be compiled into
+ * the same translation unit.
+ */
+static const char*model_helpers =
+"#ifndef CXX_MODEL_HELPERS\n"
+"#define CXX_MODEL_HELPERS\n"
+"# include  <stdint.h>\n"
+"\n"
+"#ifndef CXX_MODEL_PASSES\n"
+"#define CXX_MODEL_PASSES 64\n"
+"#endif\n"
+"\n"
+"static inline int64_t cxx_sext(uint64_t val, unsigned wid)\n"
+"{\n"
+"      if (wid >= 64) return (int64_t)val;\n"
+"      uint64_t sign = (uint64_t)1 << (wid-1);\n"
+"      return (int64_t)((val ^ sign) - sign);\n"
+"}\n"
+"\n"
+"static inline uint64_t cxx_div(uint64_t a, uint64_t b)\n"
+"{\n"
+"      return b? a / b : 0;\n"
+"}\n"
+"\n"
+"static inline uint64_t cxx_mod(uint64_t a, uint64_t b)\n"
+"{\n"
+"      return b? a % b : 0;\n"
+"}\n"
+"\n"
+"static inline uint64_t cxx_sdiv(int64_t a, int64_t b)\n"
+"{\n"
+"      if (b == 0) return 0;\n"
+"      if (b == -1) return (uint64_t)0 - (uint64_t)a;\n"
+"      return (uint64_t)(a / b);\n"
+"}\n"
+"\n"
+"static inline uint64_t cxx_smod(int64_t a, int64_t b)\n"
+"{\n"
+"      if (b == 0 || b == -1) return 0;\n"
+"      return (uint64_t)(a % b);\n"
+"}\n"
+"\n"
+"static inline uint64_t cxx_pow(uint64_t a, uint64_t b)\n"
+"{\n"
+"      uint64_t res = 1;\n"
+"      while (b) {\n"
+"\t    if (b & 1) res *= a;\n"
+"\t    a *= a;\n"
+"\t    b >>= 1;\n"
+"      }\n"
+"      return res;\n"
+"}\n"
+"\n"
+"static inline uint64_t cxx_abs(int64_t a)\n"
+"{\n"
+"      return a < 0? (uint64_t)0 - (uint64_t)a : (uint64_t)a;\n"
+"}\n"
+"\n"
+"static inline uint64_t cxx_parity(uint64_t val)\n"
+"{\n"
+"      val ^= val >> 32;\n"
+"      val ^= val >> 16;\n"
+"      val ^= val >> 8;\n"
+"      val ^= val >> 4;\n"
+"      val ^= val >> 2;\n"
+"      val ^= val >> 1;\n"
+"      return val & 1;\n"
+"}\n"
+"\n"
+"static inline uint64_t cxx_part(uint64_t val, int64_t off, unsigned wid)\n"
+"{\n"
+"      if (off >= (int64_t)wid || off <= -64) return 0;\n"
+"      return off >= 0? val >> off : val << -off;\n"
+"}\n"
+"#endif\n"
+"\n";
+
+static void emit_cxx(const char*cxx_path, ivl_design_t des, ivl_scope_t model)
+{
+      FILE*fd = fopen(cxx_path, "wt");
+      if (fd == 0) {
+	    perror(cxx_path);
+	    cxx_errors += 1;
+	    return;
+      }
+
+	// The port signals of the root scope become the public
+	// members of the model. Name them first so that they get
+	// their own names.
+      vector<ivl_signal_t> ports_in;
+      vector<ivl_signal_t> ports_out;
+      for (unsigned idx = 0 ; idx < ivl_scope_sigs(model) ; idx += 1) {
+	    ivl_signal_t prt = ivl_scope_sig(model, idx);
+	    ivl_signal_port_t dir = ivl_signal_port(prt);
+
+	    switch (dir) {
+		case IVL_SIP_NONE:
+		  continue;
+		case IVL_SIP_INPUT:
+		  ports_in.push_back(prt);
+		  break;
+		case IVL_SIP_OUTPUT:
+		  ports_out.push_back(prt);
+		  break;
+		case IVL_SIP_INOUT:
+		  fprintf(stderr, "CXX: error: "
+			  "Model port %s is bi-directional.\n",
+			  ivl_signal_basename(prt));
+		  cxx_errors += 1;
+		  continue;
+	    }
+
+	    cxx_nex_data_t::get_nex_data(ivl_signal_nex(prt,0))->set_name(prt);
+      }
+
+      collect_scope(model);
+
+	// The constants are the initial values of their nexa, so make
+	// sure they are declared as well.
+      for (unsigned idx = 0 ; idx < ivl_design_consts(des) ; idx += 1) {
+	    ivl_net_const_t net = ivl_design_const(des, idx);
+	    if (! scope_is_in_model(model, ivl_const_scope(net)))
+		  continue;
+	    ivl_nexus_t nex = ivl_const_nex(net);
+	    cxx_nex_data_t::get_nex_data(nex)->set_width(ivl_const_width(net));
+      }
+
+      vector<size_t> order;
+      schedule_comb_nodes(order);
+
+	// Each distinct clock gets a variable that holds its previous
+	// value, so that the flip-flops can detect the clock edge. Note
+	// which edges of each clock are used, so that only those edge
+	// variables are written.
+      map<ivl_nexus_t,unsigned> clocks;
+      vector<ivl_nexus_t> clock_list;
+      vector<bool> clock_pos, clock_neg;
+      for (size_t idx = 0 ; idx < ff_nodes.size() ; idx += 1) {
+	    ivl_nexus_t clk = ivl_lpm_clk(ff_nodes[idx]);
+	    if (clocks.find(clk) == clocks.end()) {
+		  clocks[clk] = clock_list.size();
+		  clock_list.push_back(clk);
+		  clock_pos.push_back(false);
+		  clock_neg.push_back(false);
+	    }
+	    if (lpm_ff_is_negedge(ff_nodes[idx]))
+		  clock_neg[clocks[clk]] = true;
+	    else
+		  clock_pos[clocks[clk]] = true;
+      }
+
+      const vector<cxx_nex_data_t*>&nets = cxx_nex_data_t::all();
+      for (size_t idx = 0 ; idx < nets.size() ; idx += 1) {
+	    unsigned wid = nets[idx]->get_width();
+	    if (wid > CXX_MAX_WIDTH) {
+		  fprintf(stderr, "CXX: sorry: Net %s is wider than %u bits.\n",
+			  nets[idx]->get_name(), CXX_MAX_WIDTH);
+		  cxx_errors += 1;
+	    }
+      }
+
+      string name = model_class_name(model);
+
+      fprintf(fd, "/*\n * Model of module %s, generated by the Icarus "
+	      "Verilog C++ code generator.\n */\n\n", ivl_scope_basename(model));
+      fputs(model_helpers, fd);
+
+	// The class declaration. The ports are first, then the rest
+	// of the nets of the model.
+      fprintf(fd, "struct %s {\n", name.c_str());
+      fprintf(fd, "\t// Ports\n");
+      for (size_t idx = 0 ; idx < ports_in.size() ; idx += 1) {
+	    cxx_nex_data_t*ned = cxx_nex_data_t::get_nex_data(ivl_signal_nex(ports_in[idx],0));
+	    fprintf(fd, "      uint64_t %s; // input [%u]\n", ned->get_name(), ned->get_width());
+      }
+      for (size_t idx = 0 ; idx < ports_out.size() ; idx += 1) {
+	    cxx_nex_data_t*ned = cxx_nex_data_t::get_nex_data(ivl_signal_nex(ports_out[idx],0));
+	    fprintf(fd, "      uint64_t %s; // output [%u]\n", ned->get_name(), ned->get_width());
+      }
+
+      fprintf(fd, "\t// Nets\n");
+      for (size_t idx = 0 ; idx < nets.size() ; idx += 1) {
+	    ivl_nexus_t nex = nets[idx]->nex_;
+	    bool is_port = false;
+	    for (unsigned pdx = 0 ; pdx < ivl_nexus_ptrs(nex) && !is_port ; pdx += 1) {
+		  ivl_signal_t sig = ivl_nexus_ptr_sig(ivl_nexus_ptr(nex,pdx));
+		  if (sig && ivl_signal_scope(sig) == model
+		      && ivl_signal_port(sig) != IVL_SIP_NONE)
+			is_port = true;
+	    }
+	    if (is_port)
+		  continue;
+	    fprintf(fd, "      uint64_t %s; // [%u]\n", nets[idx]->get_name(),
+		    nets[idx]->get_width());
+      }
+      for (size_t idx = 0 ; idx < clock_list.size() ; idx += 1) {
+	    fprintf(fd, "      uint64_t cxx_prev%zu; // %s\n", idx,
+		    cxx_nex_data_t::get_nex_data(clock_list[idx])->get_name());
+      }
+      fprintf(fd, "\n");
+      fprintf(fd, "      %s();\n", name.c_str());
+      fprintf(fd, "\t// Evaluate the model after the inputs change. This returns\n");
+      fprintf(fd, "\t// false if the flip-flops do not settle.\n");
+      fprintf(fd, "      bool eval();\n");
+      fprintf(fd, "\n");
+      fprintf(fd, "    private:\n");
+      fprintf(fd, "      void comb_();\n");
+      fprintf(fd, "      bool ff_();\n");
+      fprintf(fd, "};\n\n");
+
+	// The constructor clears everything, then loads the
+	// constants. The model is 2-state, so x and z bits start out 0.
+      fprintf(fd, "%s::%s()\n{\n", name.c_str(), name.c_str());
+      for (size_t idx = 0 ; idx < nets.size() ; idx += 1)
+	    fprintf(fd, "      %s = 0;\n", nets[idx]->get_name());
+      for (size_t idx = 0 ; idx < clock_list.size() ; idx += 1)
+	    fprintf(fd, "      cxx_prev%zu = 0;\n", idx);
+      emit_constants(fd, des, model);
+      fprintf(fd, "}\n\n");
+
+	// The combinational logic, in dependency order.
+      fprintf(fd, "void %s::comb_()\n{\n", name.c_str());
+      for (size_t idx = 0 ; idx < order.size() ; idx += 1) {
+	    const cxx_node_t&node = comb_nodes[order[idx]];
+	    if (node.log)
+		  cxx_errors += print_logic_gate(fd, node.log);
+	    else
+		  cxx_errors += print_lpm(fd, node.lpm);
+      }
+      fprintf(fd, "}\n\n");
+
+	// The flip-flops. All the next values are calculated before
+	// any Q changes, so that the FFs all see the same inputs.
+      fprintf(fd, "bool %s::ff_()\n{\n", name.c_str());
+      for (size_t idx = 0 ; idx < clock_list.size() ; idx += 1) {
+	    const char*clk = cxx_nex_data_t::get_nex_data(clock_list[idx])->get_name();
+	    if (clock_pos[idx])
+		  fprintf(fd, "      bool cxx_posedge%zu = %s && !cxx_prev%zu;\n", idx, clk, idx);
+	    if (clock_neg[idx])
+		  fprintf(fd, "      bool cxx_negedge%zu = !%s && cxx_prev%zu;\n", idx, clk, idx);
+	    fprintf(fd, "      cxx_prev%zu = %s;\n", idx, clk);
+      }
+      for (size_t idx = 0 ; idx < ff_nodes.size() ; idx += 1) {
+	    char edge[64];
+	    snprintf(edge, sizeof edge, "cxx_%sedge%u",
+		     lpm_ff_is_negedge(ff_nodes[idx])? "neg" : "pos",
+		     clocks[ivl_lpm_clk(ff_nodes[idx])]);
+	    cxx_errors += print_lpm_ff_next(fd, ff_nodes[idx], idx, edge);
+      }
+      fprintf(fd, "      bool cxx_changed = false;\n");
+      for (size_t idx = 0 ; idx < ff_nodes.size() ; idx += 1)
+	    print_lpm_ff_update(fd, ff_nodes[idx], idx);
+      fprintf(fd, "      return cxx_changed;\n");
+      fprintf(fd, "}\n\n");
+
+	// Evaluate the combinational logic, then clock the FFs until
+	// the model settles. The FF outputs can feed clocks and
+	// asynchronous inputs, so it may take more than one pass. A
+	// model that is still changing after CXX_MODEL_PASSES passes
+	// is oscillating, and that is reported to the caller.
+      fprintf(fd, "bool %s::eval()\n{\n", name.c_str());
+      fprintf(fd, "      comb_();\n");
+      fprintf(fd, "      for (unsigned cxx_idx = 0 ; cxx_idx < CXX_MODEL_PASSES ; cxx_idx += 1) {\n");
+      fprintf(fd, "\t    if (! ff_()) return true;\n");
+      fprintf(fd, "\t    comb_();\n");
+      fprintf(fd, "      }\n");
+      fprintf(fd, "      return false;\n");
+      fprintf(fd, "}\n\n");
+
+      emit_vpi_glue(fd, name.c_str(), ports_in, ports_out);
+
+      fclose(fd);
+}
+
+bool scope_is_in_model(ivl_scope_t model, ivl_scope_t scope)
+{
+      while (scope) {
+	    if (scope==model)
+		  return true;
+
+	    scope = ivl_scope_parent(scope);
+      }
+
+      return false;
+}
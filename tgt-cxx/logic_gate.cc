@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "priv.h"
+# include  "nex_data.h"
+# include  <string>
+# include  <cassert>
+
+using namespace std;
+
+void logic_gate_inputs(ivl_net_logic_t net, vector<ivl_nexus_t>&inputs)
+{
+      for (unsigned idx = 1 ; idx < ivl_logic_pins(net) ; idx += 1)
+	    inputs.push_back(ivl_logic_pin(net,idx));
+}
+
+/*
+ * Logic gates are vector wide, so all the gates map to the C++
+ * bitwise operators. The result is masked to the width of the output
+ * so that inverting gates do not leave junk in the unused bits.
+ */
+int print_logic_gate(FILE*fd, ivl_net_logic_t net)
+{
+      ivl_nexus_t nex_out = ivl_logic_pin(net,0);
+      cxx_nex_data_t*ned_out = cxx_nex_data_t::get_nex_data(nex_out);
+
+      const char*op = 0;
+      bool invert = false;
+      switch (ivl_logic_type(net)) {
+	  case IVL_LO_AND:
+	    op = " & ";
+	    break;
+	  case IVL_LO_OR:
+	    op = " | ";
+	    break;
+	  case IVL_LO_XOR:
+	    op = " ^ ";
+	    break;
+	  case IVL_LO_NAND:
+	    op = " & ";
+	    invert = true;
+	    break;
+	  case IVL_LO_NOR:
+	    op = " | ";
+	    invert = true;
+	    break;
+	  case IVL_LO_XNOR:
+	    op = " ^ ";
+	    invert = true;
+	    break;
+	  case IVL_LO_BUF:
+	  case IVL_LO_BUFZ:
+	  case IVL_LO_BUFT:
+	    assert(ivl_logic_pins(net)==2);
+	    op = "";
+	    break;
+	  case IVL_LO_NOT:
+	    assert(ivl_logic_pins(net)==2);
+	    op = "";
+	    invert = true;
+	    break;
+
+	  default:
+	    fprintf(stderr, "%s:%u: sorry: CXX: Logic type %d not supported.\n",
+		    ivl_logic_file(net), ivl_logic_lineno(net),
+		    ivl_logic_type(net));
+	    return 1;
+      }
+
+      string expr;
+      for (unsigned idx = 1 ; idx < ivl_logic_pins(net) ; idx += 1) {
+	    cxx_nex_data_t*ned = cxx_nex_data_t::get_nex_data(ivl_logic_pin(net,idx));
+	    if (idx > 1) expr += op;
+	    expr += ned->get_name();
+      }
+
+      if (invert)
+	    expr = "~(" + expr + ")";
+
+      fprintf(fd, "      %s = (%s) & %s;\n", ned_out->get_name(), expr.c_str(),
+	      mask_string(ned_out->get_width()).c_str());
+      return 0;
+}
@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "priv.h"
+# include  "nex_data.h"
+# include  <string>
+# include  <cstdio>
+# include  <cassert>
+
+using namespace std;
+
+static const char* nex_name(ivl_nexus_t nex)
+{
+      return cxx_nex_data_t::get_nex_data(nex)->get_name();
+}
+
+static unsigned nex_width(ivl_nexus_t nex)
+{
+      return cxx_nex_data_t::get_nex_data(nex)->get_width();
+}
+
+static string num_string(unsigned val)
+{
+      char buf[32];
+      snprintf(buf, sizeof buf, "%u", val);
+      return buf;
+}
+
+void lpm_inputs(ivl_lpm_t net, vector<ivl_nexus_t>&inputs)
+{
+      switch (ivl_lpm_type(net)) {
+	  case IVL_LPM_CONCAT:
+	  case IVL_LPM_CONCATZ:
+	    for (unsigned idx = 0 ; idx < ivl_lpm_size(net) ; idx += 1)
+		  inputs.push_back(ivl_lpm_data(net,idx));
+	    break;
+
+	  case IVL_LPM_MUX:
+	    for (unsigned idx = 0 ; idx < ivl_lpm_size(net) ; idx += 1)
+		  inputs.push_back(ivl_lpm_data(net,idx));
+	    inputs.push_back(ivl_lpm_select(net));
+	    break;
+
+	  case IVL_LPM_PART_VP:
+	  case IVL_LPM_PART_PV:
+	    inputs.push_back(ivl_lpm_data(net,0));
+	    if (ivl_lpm_data(net,1))
+		  inputs.push_back(ivl_lpm_data(net,1));
+	    break;
+
+	  case IVL_LPM_ABS:
+	  case IVL_LPM_CAST_INT2:
+	  case IVL_LPM_RE_AND:
+	  case IVL_LPM_RE_NAND:
+	  case IVL_LPM_RE_NOR:
+	  case IVL_LPM_RE_OR:
+	  case IVL_LPM_RE_XNOR:
+	  case IVL_LPM_RE_XOR:
+	  case IVL_LPM_REPEAT:
+	  case IVL_LPM_SIGN_EXT:
+	    inputs.push_back(ivl_lpm_data(net,0));
+	    break;
+
+	  case IVL_LPM_ADD:
+	  case IVL_LPM_CMP_EEQ:
+	  case IVL_LPM_CMP_EQ:
+	  case IVL_LPM_CMP_GE:
+	  case IVL_LPM_CMP_GT:
+	  case IVL_LPM_CMP_NE:
+	  case IVL_LPM_CMP_NEE:
+	  case IVL_LPM_DIVIDE:
+	  case IVL_LPM_MOD:
+	  case IVL_LPM_MULT:
+	  case IVL_LPM_POW:
+	  case IVL_LPM_SHIFTL:
+	  case IVL_LPM_SHIFTR:
+	  case IVL_LPM_SUB:
+	    inputs.push_back(ivl_lpm_data(net,0));
+	    inputs.push_back(ivl_lpm_data(net,1));
+	    break;
+
+	  default:
+	      // Unsupported devices are reported by print_lpm.
+	    break;
+      }
+}
+
+/*
+ * A part-to-vector device writes only its part of the output
+ * vector. There may be several of these driving different parts of
+ * the same nexus, so each only replaces its own bits.
+ */
+static int print_lpm_part_pv(FILE*fd, ivl_lpm_t net)
+{
+      if (ivl_lpm_data(net,1)) {
+	    fprintf(stderr, "%s:%u: sorry: CXX: Non-constant base of "
+		    "l-value part select not supported.\n",
+		    ivl_lpm_file(net), ivl_lpm_lineno(net));
+	    return 1;
+      }
+
+      ivl_nexus_t nex_q = ivl_lpm_q(net);
+      unsigned qwid = nex_width(nex_q);
+      unsigned wid = ivl_lpm_width(net);
+      unsigned base = ivl_lpm_base(net);
+      assert(base + wid <= qwid);
+
+      string part_mask = mask_string(wid);
+      string mask = hex_string(mask_value(wid) << base);
+      fprintf(fd, "      %s = (%s & ~%s) | ((%s & %s) << %u);\n",
+	      nex_name(nex_q), nex_name(nex_q), mask.c_str(),
+	      nex_name(ivl_lpm_data(net,0)), part_mask.c_str(), base);
+      return 0;
+}
+
+int print_lpm(FILE*fd, ivl_lpm_t net)
+{
+      ivl_lpm_type_t type = ivl_lpm_type(net);
+      if (type == IVL_LPM_PART_PV)
+	    return print_lpm_part_pv(fd, net);
+
+      ivl_nexus_t nex_q = ivl_lpm_q(net);
+      unsigned wid = ivl_lpm_width(net);
+      unsigned qwid = nex_width(nex_q);
+      bool sign_flag = ivl_lpm_signed(net) != 0;
+
+      string a, b;
+      unsigned awid = 0, bwid = 0;
+      if (type != IVL_LPM_MUX && type != IVL_LPM_CONCAT && type != IVL_LPM_CONCATZ) {
+	    ivl_nexus_t nex_a = ivl_lpm_data(net,0);
+	    if (nex_a) {
+		  a = nex_name(nex_a);
+		  awid = nex_width(nex_a);
+	    }
+      }
+      switch (type) {
+	  case IVL_LPM_ADD:
+	  case IVL_LPM_CMP_EEQ:
+	  case IVL_LPM_CMP_EQ:
+	  case IVL_LPM_CMP_GE:
+	  case IVL_LPM_CMP_GT:
+	  case IVL_LPM_CMP_NE:
+	  case IVL_LPM_CMP_NEE:
+	  case IVL_LPM_DIVIDE:
+	  case IVL_LPM_MOD:
+	  case IVL_LPM_MULT:
+	  case IVL_LPM_POW:
+	  case IVL_LPM_SHIFTL:
+	  case IVL_LPM_SHIFTR:
+	  case IVL_LPM_SUB:
+	    b = nex_name(ivl_lpm_data(net,1));
+	    bwid = nex_width(ivl_lpm_data(net,1));
+	    break;
+	  case IVL_LPM_PART_VP:
+	    if (ivl_lpm_data(net,1)) {
+		  b = nex_name(ivl_lpm_data(net,1));
+		  bwid = nex_width(ivl_lpm_data(net,1));
+	    }
+	    break;
+	  default:
+	    break;
+      }
+
+      string expr;
+      switch (type) {
+	  case IVL_LPM_ADD:
+	    expr = a + " + " + b;
+	    break;
+	  case IVL_LPM_SUB:
+	    expr = a + " - " + b;
+	    break;
+	  case IVL_LPM_MULT:
+	    expr = a + " * " + b;
+	    break;
+
+	      // Division by zero has an undefined (x) result in
+	      // Verilog. The 2-state model makes that 0.
+	  case IVL_LPM_DIVIDE:
+	    if (sign_flag)
+		  expr = "cxx_sdiv(" + sext_string(a,awid) + ", " + sext_string(b,bwid) + ")";
+	    else
+		  expr = "cxx_div(" + a + ", " + b + ")";
+	    break;
+	  case IVL_LPM_MOD:
+	    if (sign_flag)
+		  expr = "cxx_smod(" + sext_string(a,awid) + ", " + sext_string(b,bwid) + ")";
+	    else
+		  expr = "cxx_mod(" + a + ", " + b + ")";
+	    break;
+	  case IVL_LPM_POW:
+	    if (sign_flag) {
+		  fprintf(stderr, "%s:%u: sorry: CXX: Signed power not supported.\n",
+			  ivl_lpm_file(net), ivl_lpm_lineno(net));
+		  return 1;
+	    }
+	    expr = "cxx_pow(" + a + ", " + b + ")";
+	    break;
+
+	  case IVL_LPM_ABS:
+	    expr = "cxx_abs(" + sext_string(a,awid) + ")";
+	    break;
+
+	  case IVL_LPM_CMP_EEQ:
+	  case IVL_LPM_CMP_EQ:
+	    expr = a + " == " + b;
+	    break;
+	  case IVL_LPM_CMP_NEE:
+	  case IVL_LPM_CMP_NE:
+	    expr = a + " != " + b;
+	    break;
+	  case IVL_LPM_CMP_GE:
+	    if (sign_flag)
+		  expr = sext_string(a,wid) + " >= " + sext_string(b,wid);
+	    else
+		  expr = a + " >= " + b;
+	    break;
+	  case IVL_LPM_CMP_GT:
+	    if (sign_flag)
+		  expr = sext_string(a,wid) + " > " + sext_string(b,wid);
+	    else
+		  expr = a + " > " + b;
+	    break;
+
+	    // Select values past the last input have an undefined (x)
+	    // result in Verilog. The 2-state model makes that 0.
+	  case IVL_LPM_MUX: {
+		string sel = nex_name(ivl_lpm_select(net));
+		unsigned size = ivl_lpm_size(net);
+		if (size == 2) {
+		      expr = sel + "? " + nex_name(ivl_lpm_data(net,1))
+			    + " : " + nex_name(ivl_lpm_data(net,0));
+		      break;
+		}
+		for (unsigned idx = 0 ; idx < size ; idx += 1) {
+		      expr += sel + " == " + num_string(idx) + "? "
+			    + nex_name(ivl_lpm_data(net,idx)) + " : ";
+		}
+		expr += "0";
+		break;
+	  }
+
+	  case IVL_LPM_PART_VP:
+	    if (b.empty()) {
+		  expr = a + " >> " + num_string(ivl_lpm_base(net));
+	    } else if (sign_flag) {
+		  expr = "cxx_part(" + a + ", " + sext_string(b,bwid)
+			+ ", " + num_string(awid) + ")";
+	    } else {
+		  expr = b + " >= " + num_string(awid) + "? 0 : " + a + " >> " + b;
+	    }
+	    break;
+
+	  case IVL_LPM_CONCAT:
+	  case IVL_LPM_CONCATZ: {
+		unsigned off = 0;
+		for (unsigned idx = 0 ; idx < ivl_lpm_size(net) ; idx += 1) {
+		      ivl_nexus_t nex = ivl_lpm_data(net,idx);
+		      if (idx > 0) expr += " | ";
+		      if (off == 0)
+			    expr += nex_name(nex);
+		      else
+			    expr += string("(") + nex_name(nex) + " << " + num_string(off) + ")";
+		      off += nex_width(nex);
+		}
+		break;
+	  }
+
+	  case IVL_LPM_REPEAT: {
+		unsigned size = ivl_lpm_size(net);
+		unsigned iwid = wid / size;
+		for (unsigned idx = 0 ; idx < size ; idx += 1) {
+		      if (idx > 0)
+			    expr += " | (" + a + " << " + num_string(idx*iwid) + ")";
+		      else
+			    expr += a;
+		}
+		break;
+	  }
+
+	  case IVL_LPM_SIGN_EXT:
+	    expr = "(uint64_t)" + sext_string(a,awid);
+	    break;
+
+	  case IVL_LPM_SHIFTL:
+	    expr = b + " >= " + num_string(wid) + "? 0 : " + a + " << " + b;
+	    break;
+	  case IVL_LPM_SHIFTR:
+	    if (sign_flag)
+		  expr = "(uint64_t)(" + sext_string(a,wid) + " >> (" + b + " >= "
+			+ num_string(wid) + "? " + num_string(wid-1) + " : " + b + "))";
+	    else
+		  expr = b + " >= " + num_string(wid) + "? 0 : " + a + " >> " + b;
+	    break;
+
+	    // For the reduction devices, the width is the input width.
+	  case IVL_LPM_RE_AND:
+	    expr = a + " == " + mask_string(awid);
+	    break;
+	  case IVL_LPM_RE_NAND:
+	    expr = a + " != " + mask_string(awid);
+	    break;
+	  case IVL_LPM_RE_OR:
+	    expr = a + " != 0";
+	    break;
+	  case IVL_LPM_RE_NOR:
+	    expr = a + " == 0";
+	    break;
+	  case IVL_LPM_RE_XOR:
+	    expr = "cxx_parity(" + a + ")";
+	    break;
+	  case IVL_LPM_RE_XNOR:
+	    expr = "cxx_parity(" + a + ") ^ 1";
+	    break;
+
+	    // The model is already 2-state, so this is a plain copy.
+	  case IVL_LPM_CAST_INT2:
+	    expr = a;
+	    break;
+
+	  default:
+	    fprintf(stderr, "%s:%u: sorry: CXX: LPM device type %d not supported.\n",
+		    ivl_lpm_file(net), ivl_lpm_lineno(net), type);
+	    return 1;
+      }
+
+      fprintf(fd, "      %s = (uint64_t)(%s) & %s;\n", nex_name(nex_q),
+	      expr.c_str(), mask_string(qwid).c_str());
+      return 0;
+}
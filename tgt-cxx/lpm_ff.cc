@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "priv.h"
+# include  "nex_data.h"
+# include  <string>
+# include  <cstring>
+# include  <cassert>
+
+using namespace std;
+
+/*
+ * Get the value that a set input of the FF loads. The synthesizer
+ * only attaches a value if it is not all 1s.
+ */
+static string set_value_string(ivl_expr_t val, unsigned wid)
+{
+      if (val == 0)
+	    return mask_string(wid);
+
+      assert(ivl_expr_type(val) == IVL_EX_NUMBER);
+      return value_string(ivl_expr_bits(val), ivl_expr_width(val));
+}
+
+/*
+ * The synthesizer marks a FF that is clocked on the negative edge
+ * with the Clock:LPM_Polarity attribute.
+ */
+bool lpm_ff_is_negedge(ivl_lpm_t net)
+{
+      for (unsigned idx = 0 ; idx < ivl_lpm_attr_cnt(net) ; idx += 1) {
+	    ivl_attribute_t attr = ivl_lpm_attr_val(net, idx);
+	    if (strcmp(attr->key, "Clock:LPM_Polarity") != 0)
+		  continue;
+	    if (attr->type == IVL_ATT_STR && strcmp(attr->val.str, "INVERT") == 0)
+		  return true;
+      }
+
+      return false;
+}
+
+/*
+ * The asynchronous inputs take precedence over the clock, and the
+ * synchronous inputs take precedence over the clock enable. This
+ * matches the priority that synth2 uses when it infers the device.
+ */
+int print_lpm_ff_next(FILE*fd, ivl_lpm_t net, unsigned idx, const char*edge)
+{
+      unsigned wid = ivl_lpm_width(net);
+      cxx_nex_data_t*ned_q = cxx_nex_data_t::get_nex_data(ivl_lpm_q(net));
+      cxx_nex_data_t*ned_d = cxx_nex_data_t::get_nex_data(ivl_lpm_data(net,0));
+
+      ivl_nexus_t nex_ce = ivl_lpm_enable(net);
+      ivl_nexus_t nex_aclr = ivl_lpm_async_clr(net);
+      ivl_nexus_t nex_aset = ivl_lpm_async_set(net);
+      ivl_nexus_t nex_sclr = ivl_lpm_sync_clr(net);
+      ivl_nexus_t nex_sset = ivl_lpm_sync_set(net);
+
+      fprintf(fd, "      uint64_t cxx_ff%u = %s;\n", idx, ned_q->get_name());
+
+      const char*else_str = "";
+      if (nex_aclr) {
+	    fprintf(fd, "      if (%s) cxx_ff%u = 0;\n",
+		    cxx_nex_data_t::get_nex_data(nex_aclr)->get_name(), idx);
+	    else_str = "else ";
+      }
+      if (nex_aset) {
+	    fprintf(fd, "      %sif (%s) cxx_ff%u = %s;\n", else_str,
+		    cxx_nex_data_t::get_nex_data(nex_aset)->get_name(), idx,
+		    set_value_string(ivl_lpm_aset_value(net), wid).c_str());
+	    else_str = "else ";
+      }
+
+      fprintf(fd, "      %sif (%s) {\n", else_str, edge);
+      else_str = "";
+      if (nex_sclr) {
+	    fprintf(fd, "\t    if (%s) cxx_ff%u = 0;\n",
+		    cxx_nex_data_t::get_nex_data(nex_sclr)->get_name(), idx);
+	    else_str = "else ";
+      }
+      if (nex_sset) {
+	    fprintf(fd, "\t    %sif (%s) cxx_ff%u = %s;\n", else_str,
+		    cxx_nex_data_t::get_nex_data(nex_sset)->get_name(), idx,
+		    set_value_string(ivl_lpm_sset_value(net), wid).c_str());
+	    else_str = "else ";
+      }
+      if (nex_ce) {
+	    fprintf(fd, "\t    %sif (%s) cxx_ff%u = %s & %s;\n", else_str,
+		    cxx_nex_data_t::get_nex_data(nex_ce)->get_name(), idx,
+		    ned_d->get_name(), mask_string(wid).c_str());
+      } else if (*else_str) {
+	    fprintf(fd, "\t    else cxx_ff%u = %s & %s;\n", idx,
+		    ned_d->get_name(), mask_string(wid).c_str());
+      } else {
+	    fprintf(fd, "\t    cxx_ff%u = %s & %s;\n", idx,
+		    ned_d->get_name(), mask_string(wid).c_str());
+      }
+      fprintf(fd, "      }\n");
+
+      return 0;
+}
+
+void print_lpm_ff_update(FILE*fd, ivl_lpm_t net, unsigned idx)
+{
+      cxx_nex_data_t*ned_q = cxx_nex_data_t::get_nex_data(ivl_lpm_q(net));
+      fprintf(fd, "      if (cxx_ff%u != %s) {\n", idx, ned_q->get_name());
+      fprintf(fd, "\t    %s = cxx_ff%u;\n", ned_q->get_name(), idx);
+      fprintf(fd, "\t    cxx_changed = true;\n");
+      fprintf(fd, "      }\n");
+}
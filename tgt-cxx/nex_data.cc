@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "nex_data.h"
+# include  <set>
+# include  <string>
+# include  <cstdlib>
+# include  <cstdio>
+# include  <cstring>
+# include  <cassert>
+
+using namespace std;
+
+static vector<cxx_nex_data_t*> nex_data_list;
+
+  // All the identifiers that are already taken in the model class.
+static set<string> names_used;
+
+/*
+ * These are words that can be Verilog identifiers, but are reserved
+ * in C++ or name members of the generated model class.
+ */
+static const char*reserved_words[] = {
+      "auto", "bool", "break", "catch", "char", "class", "const",
+      "continue", "delete", "do", "double", "else", "enum", "explicit",
+      "extern", "false", "float", "friend", "goto", "if", "inline", "int",
+      "long", "mutable", "namespace", "new", "operator", "private",
+      "protected", "public", "register", "return", "short", "signed",
+      "sizeof", "static", "struct", "switch", "template", "this", "throw",
+      "true", "try", "typedef", "typename", "union", "unsigned", "using",
+      "virtual", "void", "volatile", "while",
+      "eval", "comb_", "ff_", "uint64_t", "int64_t",
+      0
+};
+
+inline cxx_nex_data_t::cxx_nex_data_t(ivl_nexus_t nex)
+: nex_(nex), name_(0), width_(0), drivers_(0)
+{
+}
+
+cxx_nex_data_t::~cxx_nex_data_t()
+{
+      if (name_) free(name_);
+}
+
+cxx_nex_data_t* cxx_nex_data_t::get_nex_data(ivl_nexus_t nex)
+{
+      void*tmp = ivl_nexus_get_private(nex);
+      if (tmp != 0) return reinterpret_cast<cxx_nex_data_t*> (tmp);
+
+      cxx_nex_data_t*data = new cxx_nex_data_t(nex);
+      ivl_nexus_set_private(nex, data);
+      nex_data_list.push_back(data);
+      return data;
+}
+
+const vector<cxx_nex_data_t*>& cxx_nex_data_t::all(void)
+{
+      return nex_data_list;
+}
+
+/*
+ * Turn the base string into a C++ identifier that is not yet used in
+ * the model. Characters that cannot be in an identifier (escaped
+ * Verilog names can have almost anything) become '_', and names that
+ * collide with C++ keywords or with other names get a suffix.
+ */
+void cxx_nex_data_t::make_name_(const char*base)
+{
+      assert(name_ == 0);
+
+      string tmp;
+      for (const char*cp = base ; *cp ; cp += 1) {
+	    char ch = *cp;
+	    if ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z')
+		|| (ch >= '0' && ch <= '9') || ch == '_')
+		  tmp += ch;
+	    else
+		  tmp += '_';
+      }
+
+	// Names that start with a digit are not C++ identifiers, and
+	// names that start with cxx_ are reserved for the generator.
+      if (tmp.empty() || (tmp[0] >= '0' && tmp[0] <= '9')
+	  || tmp.compare(0, 4, "cxx_") == 0)
+	    tmp = "n_" + tmp;
+
+      for (const char**wp = reserved_words ; *wp ; wp += 1) {
+	    if (tmp == *wp) {
+		  tmp += "_";
+		  break;
+	    }
+      }
+
+      string use = tmp;
+      for (unsigned idx = 1 ; names_used.count(use) ; idx += 1) {
+	    char buf[32];
+	    snprintf(buf, sizeof buf, "_%u", idx);
+	    use = tmp + buf;
+      }
+
+      names_used.insert(use);
+      name_ = strdup(use.c_str());
+}
+
+void cxx_nex_data_t::make_name_from_sig_(ivl_signal_t sig)
+{
+      string tmp = ivl_signal_basename(sig);
+      for (ivl_scope_t sscope = ivl_signal_scope(sig) ; ivl_scope_parent(sscope) ; sscope = ivl_scope_parent(sscope)) {
+	    tmp = ivl_scope_basename(sscope) + string("__") + tmp;
+      }
+
+      make_name_(tmp.c_str());
+      width_ = ivl_signal_width(sig);
+}
+
+/*
+ * Given that there is not an explicit binding to a signal for naming,
+ * search for a signal and use that signal to derive the name of this
+ * nexus. The synthesizer normally leaves a signal on every nexus, but
+ * if there is none, then make up a name from the nexus itself.
+ */
+void cxx_nex_data_t::select_name_(void)
+{
+      for (unsigned idx = 0 ; idx < ivl_nexus_ptrs(nex_) ; idx += 1) {
+	    ivl_nexus_ptr_t ptr = ivl_nexus_ptr(nex_, idx);
+	    ivl_signal_t sig = ivl_nexus_ptr_sig(ptr);
+	    if (sig == 0)
+		  continue;
+
+	    make_name_from_sig_(sig);
+	    return;
+      }
+
+      char buf[64];
+      snprintf(buf, sizeof buf, "nex_%zu", nex_data_list.size());
+      make_name_(buf);
+}
+
+void cxx_nex_data_t::set_name(ivl_signal_t sig)
+{
+      assert(name_ == 0);
+      assert(ivl_signal_nex(sig,0) == nex_);
+
+      make_name_from_sig_(sig);
+}
+
+const char* cxx_nex_data_t::get_name(void)
+{
+      if (name_==0) select_name_();
+      return name_;
+}
+
+unsigned cxx_nex_data_t::get_width(void)
+{
+      if (name_==0) select_name_();
+      return width_;
+}
+
+void cxx_nex_data_t::set_width(unsigned wid)
+{
+      if (name_==0) select_name_();
+      if (width_ == 0)
+	    width_ = wid;
+}
@@ -0,0 +1,87 @@
+#ifndef __nex_data_H
+#define __nex_data_H
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "ivl_target.h"
+# include  <vector>
+# include  <cstddef>
+
+/*
+ * The ivl_target.h API allows for binding data to a nexus. This class
+ * represents the data that we want to attach to a nexus. Every nexus
+ * of the model becomes a uint64_t member of the generated class, and
+ * the name_ is the C++ identifier of that member.
+ */
+class cxx_nex_data_t {
+
+    private:
+	// The constructors are private. Only the get_nex_data()
+	// function can create these objects.
+      cxx_nex_data_t(ivl_nexus_t nex);
+      ~cxx_nex_data_t();
+
+    public:
+	// Return the cxx_nex_data_t object that is associated with
+	// the given nexus. If the nexus does not have a nex_data_t
+	// object, then create it and bind it to the nexus. Thus, this
+	// function will always return the same nex_data instance for
+	// the same nexus.
+      static cxx_nex_data_t* get_nex_data(ivl_nexus_t nex);
+
+	// Get all the nex_data objects that were created, in the
+	// order they were created. The model declares a member for
+	// each of these.
+      static const std::vector<cxx_nex_data_t*>& all(void);
+
+	// In certain situations, we know a priori what we want the
+	// nexus name to be. In those cases, the context can use this
+	// method to set the name (by the signal from which the name
+	// is derived). Note that this must be called before the name
+	// is otherwise queried.
+      void set_name(ivl_signal_t sig);
+
+	// Get the C++ identifier chosen for this nexus.
+      const char*get_name(void);
+
+	// Get the vector width for this nexus. If there is no signal
+	// attached to the nexus, then the width is whatever the
+	// driver said with set_width.
+      unsigned get_width(void);
+      void set_width(unsigned wid);
+
+    public:
+      ivl_nexus_t nex_;
+      char*name_;
+      unsigned width_;
+
+	// The scheduler uses these to sort the combinational nodes
+	// of the model. The drivers_ is the count of combinational
+	// nodes that drive this nexus, and the readers_ are the
+	// indices of the nodes that read it.
+      unsigned drivers_;
+      std::vector<size_t> readers_;
+
+    private:
+      void select_name_(void);
+      void make_name_from_sig_(ivl_signal_t sig);
+      void make_name_(const char*base);
+};
+
+#endif
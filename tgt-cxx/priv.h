@@ -0,0 +1,111 @@
+#ifndef __priv_H
+#define __priv_H
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "ivl_target.h"
+# include  <cstdio>
+# include  <string>
+# include  <stdint.h>
+# include  <vector>
+
+/*
+ * Errors are counted here. When the cxx processing is done, this
+ * value is returned to ivl so that it can report error counts.
+ */
+extern int cxx_errors;
+
+/*
+ * The generated model carries every vector in a single 64bit word,
+ * so this is the widest vector that the code generator can handle.
+ */
+# define CXX_MAX_WIDTH 64
+
+/*
+ * Collect the input nexa of a combinational logic gate or LPM
+ * device. The scheduler uses these to put the nodes of the model in
+ * evaluation order.
+ */
+extern void logic_gate_inputs(ivl_net_logic_t net, std::vector<ivl_nexus_t>&inputs);
+extern void lpm_inputs(ivl_lpm_t net, std::vector<ivl_nexus_t>&inputs);
+
+/*
+ * Print the C++ statement that evaluates a combinational logic gate
+ * or LPM device into the variable for its output nexus. These return
+ * the number of errors encountered.
+ */
+extern int print_logic_gate(FILE*fd, ivl_net_logic_t net);
+extern int print_lpm(FILE*fd, ivl_lpm_t net);
+
+/*
+ * The flip-flops are handled in two steps. The print_lpm_ff_next
+ * function prints the code that calculates the next value of the FF
+ * into a temporary, and print_lpm_ff_update writes the temporary
+ * to the Q output. The edge argument is the name of the variable that
+ * is true if there is an active edge on the clock of the FF. The
+ * lpm_ff_is_negedge function tells which edge that is.
+ */
+extern int print_lpm_ff_next(FILE*fd, ivl_lpm_t net, unsigned idx,
+			     const char*edge);
+extern void print_lpm_ff_update(FILE*fd, ivl_lpm_t net, unsigned idx);
+extern bool lpm_ff_is_negedge(ivl_lpm_t net);
+
+/*
+ * Emit the constructor initializers for all the constants of a
+ * model. This works by scanning the design for all constants, testing
+ * that they are part of the model, and writing out the assignment of
+ * the constant value to the nexus variable.
+ */
+extern void emit_constants(FILE*fd, ivl_design_t des, ivl_scope_t model);
+
+/*
+ * Emit the VPI glue that binds the model to a shell module in a vvp
+ * simulation. The glue is compiled only if CXX_MODEL_VPI is defined.
+ */
+extern void emit_vpi_glue(FILE*fd, const char*model,
+			  const std::vector<ivl_signal_t>&ports_in,
+			  const std::vector<ivl_signal_t>&ports_out);
+
+/*
+ * Return true if the passed scope is under the model scope, at any
+ * depth. The scope may be an immediate child, or a child several
+ * levels removed.
+ */
+extern bool scope_is_in_model(ivl_scope_t model, ivl_scope_t scope);
+
+/*
+ * Helpers for formatting C++ expressions.
+ *
+ * mask_value returns the mask for a vector of the given width, and
+ * mask_string/hex_string return the C++ hex literal for a mask or
+ * value.
+ *
+ * sext_string returns an expression that sign extends the given
+ * expression of the given width to an int64_t.
+ *
+ * value_string returns the literal for a constant vector, with x and
+ * z bits replaced by 0.
+ */
+extern uint64_t mask_value(unsigned wid);
+extern std::string hex_string(uint64_t val);
+extern std::string mask_string(unsigned wid);
+extern std::string sext_string(const std::string&expr, unsigned wid);
+extern std::string value_string(const char*bits, unsigned wid);
+
+#endif
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "priv.h"
+# include  "nex_data.h"
+# include  <cstring>
+
+using namespace std;
+
+/*
+ * The VPI glue binds the model to an instance of a shell module in a
+ * vvp simulation. The shell has the same ports as the model, and the
+ * instance is named on the command line by a plusarg, for example:
+ *
+ *    vvp -M. -mmodel sim.vvp +top_model=tb.dut
+ *
+ * At the start of simulation the glue looks up the ports of the
+ * instance and puts a value change callback on every input. Whenever
+ * an input changes, the model reads all the inputs, evaluates, and
+ * writes the outputs back to the shell. Output nets are forced,
+ * output variables are assigned.
+ */
+static const char*vpi_helpers =
+"#ifndef CXX_MODEL_VPI_HELPERS\n"
+"#define CXX_MODEL_VPI_HELPERS\n"
+"# include  <vpi_user.h>\n"
+"# include  <cstring>\n"
+"# include  <string>\n"
+"\n"
+"static vpiHandle cxx_vpi_port(const char*path, const char*name)\n"
+"{\n"
+"      std::string tmp = std::string(path) + \".\" + name;\n"
+"      vpiHandle res = vpi_handle_by_name(const_cast<char*>(tmp.c_str()), 0);\n"
+"      if (res == 0)\n"
+"\t    vpi_printf(\"ERROR: Model port %s not found.\\n\", tmp.c_str());\n"
+"      return res;\n"
+"}\n"
+"\n"
+"static uint64_t cxx_vpi_get(vpiHandle obj)\n"
+"{\n"
+"      s_vpi_value val;\n"
+"      val.format = vpiVectorVal;\n"
+"      vpi_get_value(obj, &val);\n"
+"      uint64_t res = (uint32_t)(val.value.vector[0].aval & ~val.value.vector[0].bval);\n"
+"      if (vpi_get(vpiSize, obj) > 32)\n"
+"\t    res |= (uint64_t)(uint32_t)(val.value.vector[1].aval & ~val.value.vector[1].bval) << 32;\n"
+"      return res;\n"
+"}\n"
+"\n"
+"static void cxx_vpi_put(vpiHandle obj, uint64_t bits)\n"
+"{\n"
+"      s_vpi_vecval vec[2];\n"
+"      vec[0].aval = (PLI_INT32)(uint32_t)bits;\n"
+"      vec[0].bval = 0;\n"
+"      vec[1].aval = (PLI_INT32)(uint32_t)(bits >> 32);\n"
+"      vec[1].bval = 0;\n"
+"      s_vpi_value val;\n"
+"      val.format = vpiVectorVal;\n"
+"      val.value.vector = vec;\n"
+"      int flag = vpi_get(vpiType, obj) == vpiNet? vpiForceFlag : vpiNoDelay;\n"
+"      vpi_put_value(obj, &val, 0, flag);\n"
+"}\n"
+"#endif\n"
+"\n";
+
+void emit_vpi_glue(FILE*fd, const char*model,
+		   const vector<ivl_signal_t>&ports_in,
+		   const vector<ivl_signal_t>&ports_out)
+{
+      fprintf(fd, "#ifdef CXX_MODEL_VPI\n");
+      fputs(vpi_helpers, fd);
+
+      fprintf(fd, "static %s*%s_vpi = 0;\n", model, model);
+      fprintf(fd, "static vpiHandle %s_vpi_in[%zu];\n", model, ports_in.size()+1);
+      fprintf(fd, "static vpiHandle %s_vpi_out[%zu];\n\n", model, ports_out.size()+1);
+
+      fprintf(fd, "static void %s_vpi_eval(void)\n{\n", model);
+      for (size_t idx = 0 ; idx < ports_in.size() ; idx += 1) {
+	    cxx_nex_data_t*ned = cxx_nex_data_t::get_nex_data(ivl_signal_nex(ports_in[idx],0));
+	    fprintf(fd, "      %s_vpi->%s = cxx_vpi_get(%s_vpi_in[%zu]) & %s;\n",
+		    model, ned->get_name(), model, idx,
+		    mask_string(ned->get_width()).c_str());
+      }
+      fprintf(fd, "      if (! %s_vpi->eval()) {\n", model);
+      fprintf(fd, "\t    vpi_printf(\"ERROR: Model %s did not settle after %%d \"\n", model);
+      fprintf(fd, "\t               \"passes, the flip-flops oscillate.\\n\", CXX_MODEL_PASSES);\n");
+      fprintf(fd, "\t    vpi_control(vpiFinish, 1);\n");
+      fprintf(fd, "      }\n");
+      for (size_t idx = 0 ; idx < ports_out.size() ; idx += 1) {
+	    cxx_nex_data_t*ned = cxx_nex_data_t::get_nex_data(ivl_signal_nex(ports_out[idx],0));
+	    fprintf(fd, "      cxx_vpi_put(%s_vpi_out[%zu], %s_vpi->%s);\n",
+		    model, idx, model, ned->get_name());
+      }
+      fprintf(fd, "}\n\n");
+
+      fprintf(fd, "static PLI_INT32 %s_vpi_change(p_cb_data)\n{\n", model);
+      fprintf(fd, "      %s_vpi_eval();\n", model);
+      fprintf(fd, "      return 0;\n");
+      fprintf(fd, "}\n\n");
+
+	// Bind the model at the start of simulation, when the
+	// instance path can be looked up.
+      size_t arg_len = strlen(model) + 2;
+      fprintf(fd, "static PLI_INT32 %s_vpi_start(p_cb_data)\n{\n", model);
+      fprintf(fd, "      s_vpi_vlog_info info;\n");
+      fprintf(fd, "      const char*path = 0;\n");
+      fprintf(fd, "      if (vpi_get_vlog_info(&info)) {\n");
+      fprintf(fd, "\t    for (int idx = 0 ; idx < info.argc ; idx += 1) {\n");
+      fprintf(fd, "\t\t  if (strncmp(info.argv[idx], \"+%s=\", %zu) == 0)\n", model, arg_len);
+      fprintf(fd, "\t\t\tpath = info.argv[idx] + %zu;\n", arg_len);
+      fprintf(fd, "\t    }\n");
+      fprintf(fd, "      }\n");
+      fprintf(fd, "      if (path == 0) {\n");
+      fprintf(fd, "\t    vpi_printf(\"WARNING: No +%s=<instance> argument, \"\n", model);
+      fprintf(fd, "\t               \"the compiled model is not bound.\\n\");\n");
+      fprintf(fd, "\t    return 0;\n");
+      fprintf(fd, "      }\n\n");
+
+      fprintf(fd, "      bool ok = true;\n");
+      for (size_t idx = 0 ; idx < ports_in.size() ; idx += 1) {
+	    fprintf(fd, "      ok = (%s_vpi_in[%zu] = cxx_vpi_port(path, \"%s\")) && ok;\n",
+		    model, idx, ivl_signal_basename(ports_in[idx]));
+      }
+      for (size_t idx = 0 ; idx < ports_out.size() ; idx += 1) {
+	    fprintf(fd, "      ok = (%s_vpi_out[%zu] = cxx_vpi_port(path, \"%s\")) && ok;\n",
+		    model, idx, ivl_signal_basename(ports_out[idx]));
+      }
+      fprintf(fd, "      if (! ok) return 0;\n\n");
+
+      fprintf(fd, "      %s_vpi = new %s;\n\n", model, model);
+
+      fprintf(fd, "      s_vpi_time tm;\n");
+      fprintf(fd, "      tm.type = vpiSuppressTime;\n");
+      fprintf(fd, "      s_vpi_value val;\n");
+      fprintf(fd, "      val.format = vpiSuppressVal;\n");
+      fprintf(fd, "      s_cb_data cb;\n");
+      fprintf(fd, "      memset(&cb, 0, sizeof cb);\n");
+      fprintf(fd, "      cb.reason = cbValueChange;\n");
+      fprintf(fd, "      cb.cb_rtn = %s_vpi_change;\n", model);
+      fprintf(fd, "      cb.time = &tm;\n");
+      fprintf(fd, "      cb.value = &val;\n");
+      fprintf(fd, "      for (unsigned idx = 0 ; idx < %zu ; idx += 1) {\n", ports_in.size());
+      fprintf(fd, "\t    cb.obj = %s_vpi_in[idx];\n", model);
+      fprintf(fd, "\t    vpi_free_object(vpi_register_cb(&cb));\n");
+      fprintf(fd, "      }\n\n");
+
+      fprintf(fd, "      %s_vpi_eval();\n", model);
+      fprintf(fd, "      return 0;\n");
+      fprintf(fd, "}\n\n");
+
+      fprintf(fd, "void %s_vpi_register(void)\n{\n", model);
+      fprintf(fd, "      s_cb_data cb;\n");
+      fprintf(fd, "      memset(&cb, 0, sizeof cb);\n");
+      fprintf(fd, "      cb.reason = cbStartOfSimulation;\n");
+      fprintf(fd, "      cb.cb_rtn = %s_vpi_start;\n", model);
+      fprintf(fd, "      vpi_free_object(vpi_register_cb(&cb));\n");
+      fprintf(fd, "}\n\n");
+
+	// Several models can be linked into one VPI module, in which
+	// case the user supplies the startup table.
+      fprintf(fd, "# ifndef CXX_MODEL_NO_STARTUP\n");
+      fprintf(fd, "void (*vlog_startup_routines[])() = {\n");
+      fprintf(fd, "      %s_vpi_register,\n", model);
+      fprintf(fd, "      0\n");
+      fprintf(fd, "};\n");
+      fprintf(fd, "# endif\n");
+      fprintf(fd, "#endif\n");
+}
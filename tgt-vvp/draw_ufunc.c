@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2005-2011 Stephen Williams (steve@icarus.com)
+ * Copyright (c) 2005-2014 Stephen Williams (steve@icarus.com)
  *
  *    This source code is free software; you can redistribute it
  *    and/or modify it in source code form under the terms of the GNU
@@ -106,6 +106,74 @@ static void draw_function_argument(ivl_signal_t port, ivl_expr_t expr)
       }
 }
 
+/*
+ * A function can be invoked with %call (in the caller's thread) if it
+ * has no need for a thread of its own. That means it must not be
+ * automatic (the %alloc/%fork/%join context handling needs the child
+ * thread) and its body must not disable any scope, since a %disable
+ * works by finding the threads of the target scope. Forking threads
+ * is also ruled out to keep the detached child bookkeeping of the
+ * caller simple. Named blocks are fine; they fork and join their own
+ * thread as usual.
+ */
+static int stmt_is_callable(ivl_statement_t net)
+{
+      unsigned idx;
+
+      if (net == 0)
+	    return 1;
+
+      switch (ivl_statement_type(net)) {
+	  case IVL_ST_ALLOC:
+	  case IVL_ST_DELAY:
+	  case IVL_ST_DELAYX:
+	  case IVL_ST_DISABLE:
+	  case IVL_ST_FORK:
+	  case IVL_ST_FORK_JOIN_ANY:
+	  case IVL_ST_FORK_JOIN_NONE:
+	  case IVL_ST_FREE:
+	  case IVL_ST_UTASK:
+	  case IVL_ST_WAIT:
+	    return 0;
+
+	  case IVL_ST_BLOCK:
+	    for (idx = 0 ;  idx < ivl_stmt_block_count(net) ;  idx += 1)
+		  if (! stmt_is_callable(ivl_stmt_block_stmt(net, idx)))
+			return 0;
+	    return 1;
+
+	  case IVL_ST_CASE:
+	  case IVL_ST_CASER:
+	  case IVL_ST_CASEX:
+	  case IVL_ST_CASEZ:
+	    for (idx = 0 ;  idx < ivl_stmt_case_count(net) ;  idx += 1)
+		  if (! stmt_is_callable(ivl_stmt_case_stmt(net, idx)))
+			return 0;
+	    return 1;
+
+	  case IVL_ST_CONDIT:
+	    return stmt_is_callable(ivl_stmt_cond_true(net))
+		  && stmt_is_callable(ivl_stmt_cond_false(net));
+
+	  case IVL_ST_DO_WHILE:
+	  case IVL_ST_FOREVER:
+	  case IVL_ST_REPEAT:
+	  case IVL_ST_WHILE:
+	    return stmt_is_callable(ivl_stmt_sub_stmt(net));
+
+	  default:
+	    return 1;
+      }
+}
+
+static int function_is_callable(ivl_scope_t def)
+{
+      if (ivl_scope_is_auto(def))
+	    return 0;
+
+      return stmt_is_callable(ivl_scope_def(def));
+}
+
 static void draw_ufunc_preamble(ivl_expr_t expr)
 {
       ivl_scope_t def = ivl_expr_def(expr);
@@ -126,9 +194,15 @@ static void draw_ufunc_preamble(ivl_expr_t expr)
       }
 
 	/* Call the function */
-      fprintf(vvp_out, "    %%fork TD_%s", vvp_mangle_id(ivl_scope_name(def)));
-      fprintf(vvp_out, ", S_%p;\n", def);
-      fprintf(vvp_out, "    %%join;\n");
+      if (function_is_callable(def)) {
+	    fprintf(vvp_out, "    %%call TD_%s;\n",
+		    vvp_mangle_id(ivl_scope_name(def)));
+      } else {
+	    fprintf(vvp_out, "    %%fork TD_%s",
+		    vvp_mangle_id(ivl_scope_name(def)));
+	    fprintf(vvp_out, ", S_%p;\n", def);
+	    fprintf(vvp_out, "    %%join;\n");
+      }
 
 }
 
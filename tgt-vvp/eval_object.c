@@ -60,6 +60,12 @@ static int eval_darray_new(ivl_expr_t ex)
 
 	    fprintf(vvp_out, "    %%new/darray %u, \"sb%d\";\n", size_reg, wid);
 	    break;
+	  case IVL_VT_LOGIC:
+	      // logic objects are stored packed in the runtime, so any
+	      // number of packed dimensions is fine.
+	    fprintf(vvp_out, "    %%new/darray %u, \"v%u\";\n", size_reg,
+		    width_of_packed_type(element_type));
+	    break;
 
 	  default:
 	    assert(0);
@@ -72,6 +78,7 @@ static int eval_darray_new(ivl_expr_t ex)
 	    unsigned wid;
 	    switch (ivl_type_base(element_type)) {
 		case IVL_VT_BOOL:
+		case IVL_VT_LOGIC:
 		  wid = width_of_packed_type(element_type);
 		  for (idx = 0 ; idx < ivl_expr_parms(init_expr) ; idx += 1) {
 			rvec = draw_eval_expr_wid(ivl_expr_parm(init_expr,idx),
@@ -114,6 +121,7 @@ static int eval_darray_new(ivl_expr_t ex)
 	    unsigned wid;
 	    switch (ivl_type_base(element_type)) {
 		case IVL_VT_BOOL:
+		case IVL_VT_LOGIC:
 		  wid = width_of_packed_type(element_type);
 		  rvec = draw_eval_expr_wid(init_expr, wid, STUFF_OK_XZ);
 		  for (idx = 0 ; idx < cnt ; idx += 1) {
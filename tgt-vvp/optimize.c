@@ -0,0 +1,1268 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * This is a peephole optimizer for the generated thread code. The
+ * code generators write the instructions for a thread (a process or
+ * a task/function definition) into a temporary file, and when the
+ * thread is complete the text is read back, split into lines and
+ * cleaned up before it is written to the real output file. Working
+ * on the text keeps the optimizer out of the way of the code
+ * generators, which already know nothing about each other.
+ *
+ * Each line is one of:
+ *
+ *    <label> ;               A code label (with an optional comment)
+ *    <label> %<op> ...;      A label attached to an instruction
+ *        %<op> ...;          An instruction
+ *    <anything else>         Directives, comments, etc.
+ *
+ * Anything else is a barrier: the optimizer never moves or removes
+ * code across it. Labels are the boundaries of the basic blocks.
+ *
+ * The passes are:
+ *
+ *   Jump threading. A jump to a label that is followed by an
+ *   unconditional %jmp is retargeted to the final destination.
+ *
+ *   Jumps to the next instruction. A jump (conditional or not) to a
+ *   label that immediately follows it is removed.
+ *
+ *   Unreachable code. Instructions after a %jmp or %end up to the
+ *   next label are removed.
+ *
+ *   Repeated loads. A forward scan of each block keeps track of
+ *   which variable values are in which thread bits, from %load/v and
+ *   %set/v instructions, and removes a %load/v of a value that is
+ *   already in the same bits. This catches the reload of a variable
+ *   that was assigned or loaded earlier in the block, which the
+ *   expression lookaside cannot see. A repeated %ix/load of a value
+ *   that is already in the index register is also removed.
+ *
+ *   Dead stores. A backward scan of each block keeps track of the
+ *   thread bits that may still be read, and removes instructions
+ *   that only write bits that are overwritten before they are read.
+ *
+ * The dataflow is within basic blocks only. All the bits are taken
+ * to be live at the end of a block, and nothing is known about the
+ * thread bits at the start of one.
+ *
+ * The optimizer is off unless it is turned on with the -poptimize=1
+ * flag.
+ */
+
+# include  "vvp_priv.h"
+# include  <string.h>
+# include  <stdlib.h>
+# include  <assert.h>
+
+enum line_kind_e { LINE_OTHER, LINE_LABEL, LINE_INSTR };
+
+struct opt_line {
+      enum line_kind_e kind;
+      char*text;
+	/* For labels, the label text. The label is not nul
+	   terminated in the text, so it is copied. */
+      char*label;
+	/* For instructions, the opcode and the operands. The operands
+	   are the text between the opcode and the ';'. */
+      const char*op;
+      unsigned op_len;
+      const char*args;
+      unsigned args_len;
+	/* The instruction part of this line was removed. */
+      int deleted;
+	/* The jump target was replaced with this label. */
+      const char*new_target;
+};
+
+struct label_map_s {
+      const char*label;
+      unsigned line;
+};
+
+static int opt_enabled = 1;
+static FILE*opt_real_out = 0;
+static FILE*opt_tmp_out = 0;
+
+static unsigned long opt_instr_total = 0;
+static unsigned long opt_instr_removed = 0;
+
+  /* The variables that may not be treated as ordinary storage by the
+     redundant load removal. These are the signals that appear as the
+     target of a force or a procedural continuous assign. */
+static ivl_signal_t*opt_unsafe = 0;
+static unsigned opt_unsafe_cnt = 0;
+  /* All the signals of the design, so that a v<ptr>_<word> label can
+     be mapped back to the signal that it names. */
+static ivl_signal_t*opt_sigs = 0;
+static unsigned opt_sigs_cnt = 0;
+
+struct bit_range_s {
+      unsigned long base, wid;
+};
+
+/*
+ * A value that is known to be in the thread bits: the bits base to
+ * base+wid-1 hold what a %load/v of var with that width would get.
+ */
+struct vec_fact_s {
+      char var[64];
+      struct bit_range_s bits;
+};
+
+static struct vec_fact_s*facts = 0;
+static unsigned nfacts = 0, max_facts = 0;
+
+/*
+ * The live thread bits during the backward scan of a basic block.
+ * The bits past the end of the array are all live.
+ */
+static unsigned char*live_bits = 0;
+static unsigned long live_cnt = 0, live_max = 0;
+
+static int compare_ptr(const void*a, const void*b)
+{
+      const char*pa = *(const char*const*)a;
+      const char*pb = *(const char*const*)b;
+      if (pa < pb) return -1;
+      if (pa > pb) return 1;
+      return 0;
+}
+
+static void add_signal(ivl_signal_t**list, unsigned*cnt, ivl_signal_t sig)
+{
+      *list = realloc(*list, (*cnt+1) * sizeof(ivl_signal_t));
+      (*list)[*cnt] = sig;
+      *cnt += 1;
+}
+
+static int find_signal(ivl_signal_t*list, unsigned cnt, ivl_signal_t sig)
+{
+      if (cnt == 0) return 0;
+      return bsearch(&sig, list, cnt, sizeof(ivl_signal_t), compare_ptr) != 0;
+}
+
+static void scan_statement(ivl_statement_t net)
+{
+      unsigned idx;
+
+      if (net == 0)
+	    return;
+
+      switch (ivl_statement_type(net)) {
+	  case IVL_ST_FORCE:
+	  case IVL_ST_CASSIGN:
+	    for (idx = 0 ; idx < ivl_stmt_lvals(net) ; idx += 1) {
+		  ivl_signal_t sig = ivl_lval_sig(ivl_stmt_lval(net, idx));
+		  if (sig) add_signal(&opt_unsafe, &opt_unsafe_cnt, sig);
+	    }
+	    break;
+
+	  case IVL_ST_BLOCK:
+	  case IVL_ST_FORK:
+	  case IVL_ST_FORK_JOIN_ANY:
+	  case IVL_ST_FORK_JOIN_NONE:
+	    for (idx = 0 ; idx < ivl_stmt_block_count(net) ; idx += 1)
+		  scan_statement(ivl_stmt_block_stmt(net, idx));
+	    break;
+
+	  case IVL_ST_CONDIT:
+	    scan_statement(ivl_stmt_cond_true(net));
+	    scan_statement(ivl_stmt_cond_false(net));
+	    break;
+
+	  case IVL_ST_CASE:
+	  case IVL_ST_CASER:
+	  case IVL_ST_CASEX:
+	  case IVL_ST_CASEZ:
+	    for (idx = 0 ; idx < ivl_stmt_case_count(net) ; idx += 1)
+		  scan_statement(ivl_stmt_case_stmt(net, idx));
+	    break;
+
+	  case IVL_ST_DELAY:
+	  case IVL_ST_DELAYX:
+	  case IVL_ST_DO_WHILE:
+	  case IVL_ST_FOREVER:
+	  case IVL_ST_REPEAT:
+	  case IVL_ST_WAIT:
+	  case IVL_ST_WHILE:
+	    scan_statement(ivl_stmt_sub_stmt(net));
+	    break;
+
+	  default:
+	    break;
+      }
+}
+
+static int scan_scope(ivl_scope_t net, void*x)
+{
+      unsigned idx;
+      (void)x;
+
+      for (idx = 0 ; idx < ivl_scope_sigs(net) ; idx += 1)
+	    add_signal(&opt_sigs, &opt_sigs_cnt, ivl_scope_sig(net, idx));
+
+      switch (ivl_scope_type(net)) {
+	  case IVL_SCT_TASK:
+	  case IVL_SCT_FUNCTION:
+	    scan_statement(ivl_scope_def(net));
+	    break;
+	  default:
+	    break;
+      }
+
+      return ivl_scope_children(net, scan_scope, 0);
+}
+
+static int scan_process(ivl_process_t net, void*x)
+{
+      (void)x;
+      scan_statement(ivl_process_stmt(net));
+      return 0;
+}
+
+void thread_code_opt_init(ivl_design_t des)
+{
+      ivl_scope_t*roots;
+      unsigned nroots, idx;
+      const char*flag = ivl_design_flag(des, "optimize");
+
+      if (strcmp(flag, "") == 0 || strtol(flag, 0, 0) == 0) {
+	    opt_enabled = 0;
+	    return;
+      }
+
+      ivl_design_roots(des, &roots, &nroots);
+      for (idx = 0 ; idx < nroots ; idx += 1)
+	    scan_scope(roots[idx], 0);
+      ivl_design_process(des, scan_process, 0);
+
+      if (opt_sigs_cnt > 0)
+	    qsort(opt_sigs, opt_sigs_cnt, sizeof(ivl_signal_t), compare_ptr);
+      if (opt_unsafe_cnt > 0)
+	    qsort(opt_unsafe, opt_unsafe_cnt, sizeof(ivl_signal_t), compare_ptr);
+
+      opt_tmp_out = tmpfile();
+      if (opt_tmp_out == 0)
+	    opt_enabled = 0;
+}
+
+/*
+ * Write the statistics as a comment at the end of the output, and
+ * release the optimizer tables.
+ */
+void thread_code_opt_done(void)
+{
+      if (opt_enabled) {
+	    fprintf(vvp_out, "# Thread code optimizer removed %lu of %lu "
+		    "instructions.\n", opt_instr_removed, opt_instr_total);
+      }
+
+      if (opt_tmp_out) fclose(opt_tmp_out);
+      opt_tmp_out = 0;
+      free(opt_sigs);
+      opt_sigs = 0;
+      opt_sigs_cnt = 0;
+      free(opt_unsafe);
+      opt_unsafe = 0;
+      opt_unsafe_cnt = 0;
+      free(facts);
+      facts = 0;
+      nfacts = max_facts = 0;
+      free(live_bits);
+      live_bits = 0;
+      live_cnt = live_max = 0;
+}
+
+/*
+ * Redirect the output to the temporary file. The code generators all
+ * write to vvp_out, so they don't need to know.
+ */
+void thread_code_begin(void)
+{
+      if (! opt_enabled)
+	    return;
+
+      assert(opt_real_out == 0);
+      opt_real_out = vvp_out;
+      vvp_out = opt_tmp_out;
+      rewind(vvp_out);
+}
+
+static void parse_line(struct opt_line*line, char*text)
+{
+      char*cp = text;
+
+      memset(line, 0, sizeof *line);
+      line->kind = LINE_OTHER;
+      line->text = text;
+
+      switch (*cp) {
+	  case 0:
+	  case '#':
+	  case ':':
+	  case '.':
+	    return;
+	  case ' ':
+	  case '\t':
+	    break;
+	  default:
+	    cp += strcspn(cp, " \t");
+	    line->label = malloc(cp - text + 1);
+	    memcpy(line->label, text, cp - text);
+	    line->label[cp - text] = 0;
+	    break;
+      }
+
+      cp += strspn(cp, " \t");
+
+      if (*cp != '%') {
+	      /* A label with only a comment (or nothing) after it is
+		 a code label. Anything else (a functor for example)
+		 is not thread code. */
+	    if (line->label && (*cp == ';' || *cp == 0)) {
+		  line->kind = LINE_LABEL;
+	    } else {
+		  free(line->label);
+		  line->label = 0;
+	    }
+	    return;
+      }
+
+      line->kind = LINE_INSTR;
+      line->op = cp;
+      line->op_len = strcspn(cp, " \t;");
+      cp += line->op_len;
+      cp += strspn(cp, " \t");
+      line->args = cp;
+      line->args_len = strcspn(cp, ";");
+      opt_instr_total += 1;
+}
+
+static int op_is(const struct opt_line*line, const char*op)
+{
+      return strlen(op) == line->op_len
+	    && strncmp(line->op, op, line->op_len) == 0;
+}
+
+static int is_live_instr(const struct opt_line*line)
+{
+      return line->kind == LINE_INSTR && ! line->deleted;
+}
+
+static int is_jump(const struct opt_line*line)
+{
+      return line->op_len >= 4 && strncmp(line->op, "%jmp", 4) == 0
+	    && (line->op_len == 4 || line->op[4] == '/');
+}
+
+static void delete_instr(struct opt_line*line)
+{
+      assert(is_live_instr(line));
+      line->deleted = 1;
+      opt_instr_removed += 1;
+}
+
+/*
+ * Get the nth operand of an instruction into the buffer. Operands
+ * are separated by commas and/or white space.
+ */
+static int get_arg(const struct opt_line*line, unsigned nth,
+		   char*buf, size_t size)
+{
+      const char*cp = line->args;
+      const char*end = line->args + line->args_len;
+
+      for (;;) {
+	    const char*tok;
+	    size_t len;
+
+	    while (cp < end && strchr(", \t", *cp)) cp += 1;
+	    if (cp == end)
+		  return 0;
+
+	    tok = cp;
+	    while (cp < end && ! strchr(", \t", *cp)) cp += 1;
+
+	    if (nth > 0) {
+		  nth -= 1;
+		  continue;
+	    }
+
+	    len = cp - tok;
+	    if (len >= size)
+		  return 0;
+	    memcpy(buf, tok, len);
+	    buf[len] = 0;
+	    return 1;
+      }
+}
+
+static int get_uarg(const struct opt_line*line, unsigned nth, unsigned long*val)
+{
+      char buf[64], *eptr;
+
+      if (! get_arg(line, nth, buf, sizeof buf))
+	    return 0;
+
+      *val = strtoul(buf, &eptr, 10);
+      return *eptr == 0;
+}
+
+static int compare_label(const void*a, const void*b)
+{
+      const struct label_map_s*la = (const struct label_map_s*)a;
+      const struct label_map_s*lb = (const struct label_map_s*)b;
+      return strcmp(la->label, lb->label);
+}
+
+static const struct label_map_s*label_map = 0;
+static unsigned label_map_cnt = 0;
+
+static const struct label_map_s* find_label(const char*label)
+{
+      struct label_map_s key;
+
+      if (label_map_cnt == 0)
+	    return 0;
+
+      key.label = label;
+      key.line = 0;
+      return bsearch(&key, label_map, label_map_cnt, sizeof key, compare_label);
+}
+
+/*
+ * Return the line of the first live instruction at or after the
+ * label on line idx, skipping other labels. Return -1 if there is no
+ * instruction before a barrier.
+ */
+static int first_instr_at(struct opt_line*lines, unsigned nlines, unsigned idx)
+{
+      for ( ; idx < nlines ; idx += 1) {
+	    if (is_live_instr(lines+idx))
+		  return idx;
+	    if (lines[idx].kind == LINE_OTHER)
+		  return -1;
+      }
+      return -1;
+}
+
+static const char*jump_target(const struct opt_line*line, char*buf, size_t size)
+{
+      if (line->new_target)
+	    return line->new_target;
+      if (! get_arg(line, 0, buf, size))
+	    return 0;
+      return buf;
+}
+
+static int thread_jumps(struct opt_line*lines, unsigned nlines)
+{
+      unsigned idx;
+      int changed = 0;
+
+      for (idx = 0 ; idx < nlines ; idx += 1) {
+	    struct opt_line*line = lines + idx;
+	    char buf[128];
+	    const char*target;
+	    const char*final = 0;
+	    unsigned hop;
+
+	    if (! is_live_instr(line) || ! is_jump(line))
+		  continue;
+
+	    target = jump_target(line, buf, sizeof buf);
+	    if (target == 0)
+		  continue;
+
+	      /* Follow the chain of unconditional jumps. Limit the
+		 number of hops so that loops don't hang us up. */
+	    for (hop = 0 ; hop < 16 ; hop += 1) {
+		  const struct label_map_s*lab = find_label(target);
+		  const struct label_map_s*next;
+		  int nxt;
+		  char tbuf[128];
+		  const char*next_target;
+
+		  if (lab == 0)
+			break;
+		  nxt = first_instr_at(lines, nlines, lab->line);
+		  if (nxt < 0 || ! op_is(lines+nxt, "%jmp"))
+			break;
+		  if (lines+nxt == line)
+			break;
+		  next_target = jump_target(lines+nxt, tbuf, sizeof tbuf);
+		  if (next_target == 0)
+			break;
+		  next = find_label(next_target);
+		  if (next == 0)
+			break;
+		    /* Use the label string saved in the map, since the
+		       buffer is reused. */
+		  target = lines[next->line].label;
+		  final = target;
+	    }
+
+	    if (final && final != line->new_target) {
+		  line->new_target = final;
+		  changed = 1;
+	    }
+      }
+
+      return changed;
+}
+
+static int remove_jumps_to_next(struct opt_line*lines, unsigned nlines)
+{
+      unsigned idx;
+      int changed = 0;
+
+      for (idx = 0 ; idx < nlines ; idx += 1) {
+	    struct opt_line*line = lines + idx;
+	    char buf[128];
+	    const char*target;
+	    unsigned scan;
+
+	    if (! is_live_instr(line) || ! is_jump(line))
+		  continue;
+
+	    target = jump_target(line, buf, sizeof buf);
+	    if (target == 0)
+		  continue;
+
+	    for (scan = idx+1 ; scan < nlines ; scan += 1) {
+		  struct opt_line*cur = lines + scan;
+		  if (cur->kind == LINE_OTHER)
+			break;
+		  if (cur->label && strcmp(cur->label, target) == 0) {
+			delete_instr(line);
+			changed = 1;
+			break;
+		  }
+		  if (is_live_instr(cur))
+			break;
+	    }
+      }
+
+      return changed;
+}
+
+static int remove_unreachable(struct opt_line*lines, unsigned nlines)
+{
+      unsigned idx;
+      int changed = 0;
+
+      for (idx = 0 ; idx < nlines ; idx += 1) {
+	    struct opt_line*line = lines + idx;
+	    unsigned scan;
+
+	    if (! is_live_instr(line))
+		  continue;
+	    if (! op_is(line, "%jmp") && ! op_is(line, "%end"))
+		  continue;
+
+	    for (scan = idx+1 ; scan < nlines ; scan += 1) {
+		  struct opt_line*cur = lines + scan;
+		  if (cur->kind != LINE_INSTR || cur->label)
+			break;
+		  if (! cur->deleted) {
+			delete_instr(cur);
+			changed = 1;
+		  }
+	    }
+      }
+
+      return changed;
+}
+
+/*
+ * Map a v<ptr>_<word> variable label back to the signal that it
+ * names. Return nil if the label is not one of those.
+ */
+static ivl_signal_t var_signal(const char*var, unsigned long*word)
+{
+      void*ptr;
+      char tail;
+      ivl_signal_t sig;
+
+      if (sscanf(var, "v%p_%lu%c", &ptr, word, &tail) != 2)
+	    return 0;
+
+      sig = (ivl_signal_t)ptr;
+      if (! find_signal(opt_sigs, opt_sigs_cnt, sig))
+	    return 0;
+      if (*word >= ivl_signal_array_count(sig))
+	    return 0;
+
+      return sig;
+}
+
+/*
+ * Return true if the variable named by the label only changes when
+ * a thread writes it. Nets and the targets of force and procedural
+ * continuous assign statements can change as a side effect of a
+ * write to some other variable.
+ */
+static int var_is_stable(const char*var)
+{
+      unsigned long word;
+      ivl_signal_t sig = var_signal(var, &word);
+
+      if (sig == 0)
+	    return 0;
+      if (ivl_signal_type(sig) != IVL_SIT_REG)
+	    return 0;
+      if (find_signal(opt_unsafe, opt_unsafe_cnt, sig))
+	    return 0;
+
+      return 1;
+}
+
+/*
+ * Return true if the %load/v of the variable named by the label can
+ * be replaced with the bits that were just written to it by a %set/v
+ * of the given width. The variable must be a plain static 4-state
+ * variable of exactly that width.
+ */
+static int load_after_set_ok(const char*var, unsigned long wid)
+{
+      unsigned long word;
+      ivl_signal_t sig = var_signal(var, &word);
+
+      if (sig == 0 || ! var_is_stable(var))
+	    return 0;
+      if (ivl_scope_is_auto(ivl_signal_scope(sig)))
+	    return 0;
+      if (wid != ivl_signal_width(sig))
+	    return 0;
+
+	/* A two-state variable changes X/Z bits to 0. */
+      if (ivl_signal_data_type(sig) != IVL_VT_LOGIC)
+	    return 0;
+
+      return 1;
+}
+
+/*
+ * These are instructions that are known to not write the index
+ * registers, so the %ix/load values survive them.
+ */
+static const char*const ix_safe_ops[] = {
+      "%add", "%addi", "%and", "%assign/av", "%assign/v0",
+      "%assign/v0/x1", "%cast2", "%cmp/s", "%cmp/u", "%cmp/x",
+      "%cmp/z", "%cmpi/s", "%cmpi/u", "%delay", "%inv", "%jmp",
+      "%jmp/0", "%jmp/0xz", "%jmp/1", "%load/av", "%load/v",
+      "%load/vp0", "%load/x1p", "%mov", "%movi", "%mul", "%muli",
+      "%nand", "%nor", "%or", "%pad", "%set/av", "%set/v", "%set/x0",
+      "%sub", "%subi", "%xnor", "%xor", 0
+};
+
+static int op_is_ix_safe(const struct opt_line*line)
+{
+      unsigned idx;
+      for (idx = 0 ; ix_safe_ops[idx] ; idx += 1) {
+	    if (op_is(line, ix_safe_ops[idx]))
+		  return 1;
+      }
+      return 0;
+}
+
+/*
+ * The dataflow passes need to know which thread bits an instruction
+ * reads and writes. The operand forms of the instructions that they
+ * understand are:
+ *
+ *   BINARY   <dst>, <src>, <wid>   dst = dst <op> src
+ *   IMM      <dst>, <imm>, <wid>   dst = dst <op> imm
+ *   MOVE     <dst>, <src>, <wid>   dst = src
+ *   MOVI     <dst>, <imm>, <wid>   dst = imm
+ *   INV      <bit>, <wid>          bit = ~bit
+ *   PAD      <dst>, <src>, <wid>   dst = {wid{src}}
+ *   REDUCE   <dst>, <src>, <wid>   dst = <op> src (one bit)
+ *   CMP3     <a>, <b>, <wid>       bits 4-6 = compare(a, b)
+ *   CMP1     <a>, <b>, <wid>       bit 4 = compare(a, b)
+ *   CMPI     <a>, <imm>, <wid>     bits 4-6 = compare(a, imm)
+ *   LOAD     <bit>, <obj>, <wid>   bit = value of obj
+ *   STORE    <obj>, <bit>, <wid>   obj = bit
+ *   IXGET    <idx>, <bit>, <wid>   index register = bit, bit 4 = xz
+ *   BRANCH   <label>, <bit>        jump if bit
+ *   NONE     ...                   no thread bits at all
+ *
+ * Operand bits 0-3 are the constants, so reading them is not a read.
+ * Anything else is unknown, and may read or write any bit.
+ */
+enum bit_form_e { FORM_BINARY, FORM_IMM, FORM_MOVE, FORM_MOVI, FORM_INV,
+		  FORM_PAD, FORM_REDUCE, FORM_CMP3, FORM_CMP1, FORM_CMPI,
+		  FORM_LOAD, FORM_STORE, FORM_IXGET, FORM_BRANCH, FORM_NONE };
+
+static const struct bit_form_s {
+      const char*op;
+      enum bit_form_e form;
+} bit_forms[] = {
+      { "%add",      FORM_BINARY },
+      { "%addi",     FORM_IMM },
+      { "%and",      FORM_BINARY },
+      { "%and/r",    FORM_REDUCE },
+      { "%andi",     FORM_IMM },
+      { "%blend",    FORM_BINARY },
+      { "%cast2",    FORM_MOVE },
+      { "%cmp/s",    FORM_CMP3 },
+      { "%cmp/u",    FORM_CMP3 },
+      { "%cmp/x",    FORM_CMP1 },
+      { "%cmp/z",    FORM_CMP1 },
+      { "%cmpi/s",   FORM_CMPI },
+      { "%cmpi/u",   FORM_CMPI },
+      { "%div",      FORM_BINARY },
+      { "%div/s",    FORM_BINARY },
+      { "%inv",      FORM_INV },
+      { "%ix/add",   FORM_NONE },
+      { "%ix/get",   FORM_IXGET },
+      { "%ix/get/s", FORM_IXGET },
+      { "%ix/load",  FORM_NONE },
+      { "%ix/mov",   FORM_NONE },
+      { "%ix/mul",   FORM_NONE },
+      { "%ix/sub",   FORM_NONE },
+      { "%jmp/0",    FORM_BRANCH },
+      { "%jmp/0xz",  FORM_BRANCH },
+      { "%jmp/1",    FORM_BRANCH },
+      { "%load/av",  FORM_LOAD },
+      { "%load/v",   FORM_LOAD },
+      { "%load/vp0", FORM_LOAD },
+      { "%load/vp0/s", FORM_LOAD },
+      { "%load/x1p", FORM_LOAD },
+      { "%mod",      FORM_BINARY },
+      { "%mod/s",    FORM_BINARY },
+      { "%mov",      FORM_MOVE },
+      { "%movi",     FORM_MOVI },
+      { "%mul",      FORM_BINARY },
+      { "%muli",     FORM_IMM },
+      { "%nand",     FORM_BINARY },
+      { "%nand/r",   FORM_REDUCE },
+      { "%nor",      FORM_BINARY },
+      { "%nor/r",    FORM_REDUCE },
+      { "%or",       FORM_BINARY },
+      { "%or/r",     FORM_REDUCE },
+      { "%pad",      FORM_PAD },
+      { "%set/av",   FORM_STORE },
+      { "%set/v",    FORM_STORE },
+      { "%set/x0",   FORM_STORE },
+      { "%sub",      FORM_BINARY },
+      { "%subi",     FORM_IMM },
+      { "%xnor",     FORM_BINARY },
+      { "%xnor/r",   FORM_REDUCE },
+      { "%xor",      FORM_BINARY },
+      { "%xor/r",    FORM_REDUCE },
+      { 0,           FORM_NONE }
+};
+
+struct bit_use_s {
+	/* The bits that the instruction reads and writes are known. */
+      int known;
+	/* Writing the write range is the only effect. */
+      int pure;
+	/* The instruction may jump somewhere else. */
+      int branch;
+      unsigned nread;
+      struct bit_range_s read[2];
+      int has_write;
+      struct bit_range_s write;
+};
+
+  /* Larger bit addresses than this are not tracked. */
+static const unsigned long BIT_LIMIT = 1UL << 20;
+
+static void add_read(struct bit_use_s*use, unsigned long base, unsigned long wid)
+{
+      if (base < 4)
+	    return;
+      assert(use->nread < 2);
+      use->read[use->nread].base = base;
+      use->read[use->nread].wid = wid;
+      use->nread += 1;
+}
+
+static void set_write(struct bit_use_s*use, unsigned long base, unsigned long wid)
+{
+      use->has_write = 1;
+      use->write.base = base;
+      use->write.wid = wid;
+}
+
+static void get_bit_use(const struct opt_line*line, struct bit_use_s*use)
+{
+      const struct bit_form_s*form;
+      unsigned long arg0, arg1, wid;
+
+      memset(use, 0, sizeof *use);
+
+      for (form = bit_forms ; form->op ; form += 1) {
+	    if (op_is(line, form->op))
+		  break;
+      }
+      if (form->op == 0)
+	    return;
+
+      switch (form->form) {
+	  case FORM_NONE:
+	    use->known = 1;
+	    return;
+
+	  case FORM_BRANCH:
+	    if (! get_uarg(line, 1, &arg1))
+		  return;
+	    add_read(use, arg1, 1);
+	    use->branch = 1;
+	    use->known = 1;
+	    return;
+
+	  case FORM_INV:
+	    if (! get_uarg(line, 0, &arg0) || ! get_uarg(line, 1, &wid))
+		  return;
+	    add_read(use, arg0, wid);
+	    set_write(use, arg0, wid);
+	    break;
+
+	  case FORM_LOAD:
+	    if (! get_uarg(line, 0, &arg0) || ! get_uarg(line, 2, &wid))
+		  return;
+	    set_write(use, arg0, wid);
+	    break;
+
+	  case FORM_STORE:
+	  case FORM_IXGET:
+	    if (! get_uarg(line, 1, &arg1) || ! get_uarg(line, 2, &wid))
+		  return;
+	    add_read(use, arg1, wid);
+	      /* %ix/get sets bit 4 if the value has x or z bits. */
+	    if (form->form == FORM_IXGET)
+		  set_write(use, 4, 1);
+	    break;
+
+	  case FORM_IMM:
+	  case FORM_MOVI:
+	  case FORM_CMPI:
+	    if (! get_uarg(line, 0, &arg0) || ! get_uarg(line, 2, &wid))
+		  return;
+	    if (form->form == FORM_CMPI) {
+		  add_read(use, arg0, wid);
+		  set_write(use, 4, 3);
+	    } else {
+		  if (form->form == FORM_IMM)
+			add_read(use, arg0, wid);
+		  set_write(use, arg0, wid);
+	    }
+	    break;
+
+	  default:
+	    if (! get_uarg(line, 0, &arg0) || ! get_uarg(line, 1, &arg1)
+		|| ! get_uarg(line, 2, &wid))
+		  return;
+	    switch (form->form) {
+		case FORM_BINARY:
+		  add_read(use, arg0, wid);
+		  add_read(use, arg1, wid);
+		  set_write(use, arg0, wid);
+		  break;
+		case FORM_MOVE:
+		  add_read(use, arg1, wid);
+		  set_write(use, arg0, wid);
+		  break;
+		case FORM_PAD:
+		  add_read(use, arg1, 1);
+		  set_write(use, arg0, wid);
+		  break;
+		case FORM_REDUCE:
+		  add_read(use, arg1, wid);
+		  set_write(use, arg0, 1);
+		  break;
+		case FORM_CMP3:
+		case FORM_CMP1:
+		  add_read(use, arg0, wid);
+		  add_read(use, arg1, wid);
+		  set_write(use, 4, form->form == FORM_CMP3? 3 : 1);
+		  break;
+		default:
+		  assert(0);
+		  break;
+	    }
+	    break;
+      }
+
+	/* The constant bits are never written, and very large
+	   addresses are not worth tracking. */
+      if (use->has_write && (use->write.base < 4
+			     || use->write.base + use->write.wid > BIT_LIMIT))
+	    return;
+      if (use->nread > 0 && use->read[0].base + use->read[0].wid > BIT_LIMIT)
+	    return;
+      if (use->nread > 1 && use->read[1].base + use->read[1].wid > BIT_LIMIT)
+	    return;
+
+      use->known = 1;
+      use->pure = use->has_write && form->form != FORM_STORE
+	    && form->form != FORM_IXGET;
+}
+
+static int ranges_overlap(const struct bit_range_s*a, unsigned long base,
+			  unsigned long wid)
+{
+      return a->base < base + wid && base < a->base + a->wid;
+}
+
+
+static int find_fact(const char*var, unsigned long base, unsigned long wid)
+{
+      unsigned idx;
+      for (idx = 0 ; idx < nfacts ; idx += 1) {
+	    if (facts[idx].bits.base == base && facts[idx].bits.wid == wid
+		&& strcmp(facts[idx].var, var) == 0)
+		  return 1;
+      }
+      return 0;
+}
+
+static void add_fact(const char*var, unsigned long base, unsigned long wid)
+{
+      if (nfacts == max_facts) {
+	    max_facts = max_facts? 2*max_facts : 16;
+	    facts = realloc(facts, max_facts * sizeof(struct vec_fact_s));
+      }
+      strcpy(facts[nfacts].var, var);
+      facts[nfacts].bits.base = base;
+      facts[nfacts].bits.wid = wid;
+      nfacts += 1;
+}
+
+  /* Forget the facts about values in the bits that were written. */
+static void kill_facts_bits(const struct bit_range_s*bits)
+{
+      unsigned idx = 0;
+      while (idx < nfacts) {
+	    if (ranges_overlap(&facts[idx].bits, bits->base, bits->wid))
+		  facts[idx] = facts[--nfacts];
+	    else
+		  idx += 1;
+      }
+}
+
+  /* Forget the facts about variables that a write to var (or to an
+     array, if var is nil) may change. */
+static void kill_facts_var(const char*var)
+{
+      unsigned idx = 0;
+      while (idx < nfacts) {
+	    if ((var && strcmp(facts[idx].var, var) == 0)
+		|| ! var_is_stable(facts[idx].var))
+		  facts[idx] = facts[--nfacts];
+	    else
+		  idx += 1;
+      }
+}
+
+/*
+ * Remove repeated loads. Going forward through each basic block,
+ * keep the list of the variable values that are in the thread bits,
+ * from %load/v and %set/v instructions. A %load/v of a value that is
+ * already in the same bits is removed. The bits are forgotten when
+ * they are written, and the variables when they (or a net that may
+ * depend on them) are written. An instruction that the optimizer
+ * does not understand may do anything, including give other threads
+ * a chance to run, so it forgets everything.
+ *
+ * This also removes a repeated %ix/load of the value that is already
+ * in the index register.
+ */
+static int remove_repeated_loads(struct opt_line*lines, unsigned nlines)
+{
+      unsigned idx;
+      int changed = 0;
+      char ix[4][64];
+      int ix_valid[4] = { 0, 0, 0, 0 };
+
+      nfacts = 0;
+
+      for (idx = 0 ; idx < nlines ; idx += 1) {
+	    struct opt_line*line = lines + idx;
+	    struct bit_use_s use;
+	    char var[64];
+
+	      /* Labels and barriers start a new block. */
+	    if (line->kind != LINE_INSTR || line->label) {
+		  nfacts = 0;
+		  memset(ix_valid, 0, sizeof ix_valid);
+	    }
+	    if (! is_live_instr(line))
+		  continue;
+
+	    if (op_is(line, "%ix/load")) {
+		  unsigned long reg;
+		  char val[64], tmp[64];
+		  if (get_uarg(line, 0, &reg) && reg < 4
+		      && get_arg(line, 1, val, sizeof val)
+		      && get_arg(line, 2, tmp, sizeof tmp)
+		      && strlen(val) + strlen(tmp) + 2 < sizeof val) {
+			strcat(val, ",");
+			strcat(val, tmp);
+			if (ix_valid[reg] && strcmp(ix[reg], val) == 0) {
+			      delete_instr(line);
+			      changed = 1;
+			      continue;
+			}
+			strcpy(ix[reg], val);
+			ix_valid[reg] = 1;
+		  } else {
+			memset(ix_valid, 0, sizeof ix_valid);
+		  }
+
+	    } else if (! op_is_ix_safe(line)) {
+		  memset(ix_valid, 0, sizeof ix_valid);
+	    }
+
+	    get_bit_use(line, &use);
+	    if (! use.known) {
+		  nfacts = 0;
+		  continue;
+	    }
+
+	    if (op_is(line, "%load/v")) {
+		  if (! get_arg(line, 1, var, sizeof var)) {
+			nfacts = 0;
+			continue;
+		  }
+		  if (find_fact(var, use.write.base, use.write.wid)) {
+			delete_instr(line);
+			changed = 1;
+			continue;
+		  }
+		  kill_facts_bits(&use.write);
+		  add_fact(var, use.write.base, use.write.wid);
+		  continue;
+	    }
+
+	    if (op_is(line, "%set/v") || op_is(line, "%set/x0")) {
+		  if (! get_arg(line, 0, var, sizeof var)) {
+			nfacts = 0;
+			continue;
+		  }
+		  kill_facts_var(var);
+		    /* A set from the constant bits has no read. */
+		  if (op_is(line, "%set/v") && use.nread == 1
+		      && load_after_set_ok(var, use.read[0].wid))
+			add_fact(var, use.read[0].base, use.read[0].wid);
+		  continue;
+	    }
+
+	    if (op_is(line, "%set/av")) {
+		  kill_facts_var(0);
+		  continue;
+	    }
+
+	    if (use.has_write)
+		  kill_facts_bits(&use.write);
+      }
+
+      return changed;
+}
+
+
+static void live_all(void)
+{
+      memset(live_bits, 1, live_cnt);
+}
+
+static void live_set(unsigned long base, unsigned long wid, unsigned char flag)
+{
+      unsigned long idx;
+
+      if (base + wid > live_cnt) {
+	    if (base + wid > live_max) {
+		  live_max = base + wid + 256;
+		  live_bits = realloc(live_bits, live_max);
+	    }
+	    memset(live_bits + live_cnt, 1, base + wid - live_cnt);
+	    live_cnt = base + wid;
+      }
+
+      for (idx = base ; idx < base + wid ; idx += 1)
+	    live_bits[idx] = flag;
+}
+
+static int live_any(const struct bit_range_s*bits)
+{
+      unsigned long idx;
+      if (bits->base + bits->wid > live_cnt)
+	    return 1;
+      for (idx = bits->base ; idx < bits->base + bits->wid ; idx += 1) {
+	    if (live_bits[idx])
+		  return 1;
+      }
+      return 0;
+}
+
+/*
+ * Remove dead stores. Going backward through each basic block, keep
+ * the set of thread bits that may still be read. All the bits are
+ * live at the end of a block and at a jump, since the code that
+ * follows may read them. An instruction whose only effect is to
+ * write bits that are not live is removed. Otherwise, the bits that
+ * it writes are dead before it and the bits that it reads are live.
+ * An instruction that the optimizer does not understand may read
+ * any bit, so it makes them all live.
+ */
+static int remove_dead_stores(struct opt_line*lines, unsigned nlines)
+{
+      unsigned idx;
+      int changed = 0;
+
+      live_all();
+
+      for (idx = nlines ; idx > 0 ; idx -= 1) {
+	    struct opt_line*line = lines + idx - 1;
+	    struct bit_use_s use;
+	    unsigned rdx;
+
+	    if (is_live_instr(line)) {
+		  get_bit_use(line, &use);
+		  if (! use.known || use.branch) {
+			live_all();
+		  } else if (use.pure && ! live_any(&use.write)) {
+			delete_instr(line);
+			changed = 1;
+		  } else {
+			if (use.has_write)
+			      live_set(use.write.base, use.write.wid, 0);
+			for (rdx = 0 ; rdx < use.nread ; rdx += 1)
+			      live_set(use.read[rdx].base, use.read[rdx].wid, 1);
+		  }
+	    }
+
+	      /* Going backward, a label or barrier is the start of
+		 the block, so the end of the block before it. */
+	    if (line->kind != LINE_INSTR || line->label)
+		  live_all();
+      }
+
+      return changed;
+}
+
+static void print_line(FILE*fd, const struct opt_line*line)
+{
+      if (line->kind != LINE_INSTR) {
+	    fprintf(fd, "%s\n", line->text);
+	    return;
+      }
+
+      if (line->deleted) {
+	    if (line->label)
+		  fprintf(fd, "%s ;\n", line->label);
+	    return;
+      }
+
+      if (line->new_target) {
+	    const char*rest = line->args + strcspn(line->args, ", \t;");
+	    fprintf(fd, "%.*s%s%s\n", (int)(line->args - line->text),
+		    line->text, line->new_target, rest);
+	    return;
+      }
+
+      fprintf(fd, "%s\n", line->text);
+}
+
+/*
+ * The thread is complete. Read it back from the temporary file,
+ * optimize it, and write it to the real output.
+ */
+void thread_code_end(void)
+{
+      long len;
+      char*buf, *cp;
+      struct opt_line*lines;
+      struct label_map_s*map;
+      unsigned nlines, nlabels, idx, pass;
+
+      if (! opt_enabled)
+	    return;
+
+      assert(opt_real_out);
+      len = ftell(vvp_out);
+      vvp_out = opt_real_out;
+      opt_real_out = 0;
+
+      buf = malloc(len + 1);
+      rewind(opt_tmp_out);
+      if (fread(buf, 1, len, opt_tmp_out) != (size_t)len) {
+	    fprintf(stderr, "tgt-vvp error: Unable to read back thread code.\n");
+	    vvp_errors += 1;
+	    free(buf);
+	    return;
+      }
+      buf[len] = 0;
+
+	/* Split the text into lines. */
+      nlines = 0;
+      for (cp = buf ; *cp ; cp += 1)
+	    if (*cp == '\n') nlines += 1;
+      if (len > 0 && buf[len-1] != '\n')
+	    nlines += 1;
+
+      lines = calloc(nlines ? nlines : 1, sizeof(struct opt_line));
+      map = calloc(nlines ? nlines : 1, sizeof(struct label_map_s));
+      nlabels = 0;
+      cp = buf;
+      for (idx = 0 ; idx < nlines ; idx += 1) {
+	    char*eol = strchr(cp, '\n');
+	    if (eol) *eol = 0;
+	    parse_line(lines+idx, cp);
+	    if (lines[idx].label) {
+		  map[nlabels].label = lines[idx].label;
+		  map[nlabels].line = idx;
+		  nlabels += 1;
+	    }
+	    cp = eol ? eol+1 : cp + strlen(cp);
+      }
+
+      qsort(map, nlabels, sizeof(struct label_map_s), compare_label);
+      label_map = map;
+      label_map_cnt = nlabels;
+
+	/* Each pass can expose more work for the others, so run them
+	   until nothing changes (with a limit to be safe). */
+      for (pass = 0 ; pass < 8 ; pass += 1) {
+	    int changed = 0;
+	    changed |= thread_jumps(lines, nlines);
+	    changed |= remove_jumps_to_next(lines, nlines);
+	    changed |= remove_unreachable(lines, nlines);
+	    changed |= remove_repeated_loads(lines, nlines);
+	    changed |= remove_dead_stores(lines, nlines);
+	    if (! changed)
+		  break;
+      }
+
+      for (idx = 0 ; idx < nlines ; idx += 1) {
+	    print_line(vvp_out, lines+idx);
+	    free(lines[idx].label);
+      }
+
+      label_map = 0;
+      label_map_cnt = 0;
+      free(map);
+      free(lines);
+      free(buf);
+}
@@ -156,6 +156,10 @@ int target_design(ivl_design_t des)
 
       draw_module_declarations(des);
 
+	/* Collect what the thread code optimizer needs to know about
+	   the design before any code is drawn. */
+      thread_code_opt_init(des);
+
         /* This causes all structural records to be drawn. */
       ivl_design_roots(des, &roots, &nroots);
       for (i = 0; i < nroots; i++)
@@ -165,6 +169,7 @@ int target_design(ivl_design_t des)
       cleanup_modpath();
 
       rc = ivl_design_process(des, draw_process, 0);
+      thread_code_opt_done();
 
         /* Dump the file name table. */
       size = ivl_file_table_size();
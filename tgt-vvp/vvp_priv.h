@@ -100,6 +100,18 @@ extern int draw_process(ivl_process_t net, void*x);
 extern int draw_task_definition(ivl_scope_t scope);
 extern int draw_func_definition(ivl_scope_t scope);
 
+/*
+ * The thread code optimizer (optimize.c). The code for a thread is
+ * drawn between a thread_code_begin and a thread_code_end, which
+ * buffer the code and optimize it on its way to the output file. The
+ * thread_code_opt_init function scans the design first and reads
+ * the -poptimize flag, and thread_code_opt_done reports the results.
+ */
+extern void thread_code_opt_init(ivl_design_t des);
+extern void thread_code_opt_done(void);
+extern void thread_code_begin(void);
+extern void thread_code_end(void);
+
 extern int draw_scope(ivl_scope_t scope, ivl_scope_t parent);
 
 extern void draw_lpm_mux(ivl_lpm_t net);
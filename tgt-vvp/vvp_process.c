@@ -2367,6 +2367,7 @@ int draw_process(ivl_process_t net, void*x)
 
       local_count = 0;
       fprintf(vvp_out, "    .scope S_%p;\n", scope);
+      thread_code_begin();
 
 	/* Generate the entry label. Just give the thread a number so
 	   that we ar certain the label is unique. */
@@ -2391,6 +2392,7 @@ int draw_process(ivl_process_t net, void*x)
 	    fprintf(vvp_out, "    %%jmp T_%u;\n", thread_count);
 	    break;
       }
+      thread_code_end();
 
 	/* Now write out the directive that tells vvp where the thread
 	   starts. */
@@ -2419,6 +2421,7 @@ int draw_task_definition(ivl_scope_t scope)
       int rc = 0;
       ivl_statement_t def = ivl_scope_def(scope);
 
+      thread_code_begin();
       fprintf(vvp_out, "TD_%s ;\n", vvp_mangle_id(ivl_scope_name(scope)));
       clear_expression_lookaside();
 
@@ -2426,6 +2429,7 @@ int draw_task_definition(ivl_scope_t scope)
       rc += show_statement(def, scope);
 
       fprintf(vvp_out, "    %%end;\n");
+      thread_code_end();
 
       thread_count += 1;
       return rc;
@@ -2436,6 +2440,7 @@ int draw_func_definition(ivl_scope_t scope)
       int rc = 0;
       ivl_statement_t def = ivl_scope_def(scope);
 
+      thread_code_begin();
       fprintf(vvp_out, "TD_%s ;\n", vvp_mangle_id(ivl_scope_name(scope)));
       clear_expression_lookaside();
 
@@ -2443,6 +2448,7 @@ int draw_func_definition(ivl_scope_t scope)
       rc += show_statement(def, scope);
 
       fprintf(vvp_out, "    %%end;\n");
+      thread_code_end();
 
       thread_count += 1;
       return rc;
@@ -1104,6 +1104,34 @@ static void draw_logic_in_scope(ivl_net_logic_t lptr)
       if (need_delay_flag) draw_delay(lptr);
 }
 
+/*
+ * Draw all the "any" inputs of the event as a single wide .event edge
+ * statement. The runtime turns this into one any change functor with
+ * N/4 input functors, instead of an event/or of N/4 anyedge functors
+ * that each propagate their input value.
+ */
+static void draw_event_wide_any(ivl_event_t obj, const char*suffix)
+{
+      unsigned nany = ivl_event_nany(obj);
+      char (*tmp)[32] = calloc(nany, sizeof(*tmp));
+      unsigned idx;
+
+	/* Collect the input labels first, since drawing an input
+	   may need to draw some net statements of its own. */
+      for (idx = 0 ;  idx < nany ;  idx += 1) {
+	    ivl_nexus_t nex = ivl_event_any(obj, idx);
+	    strncpy(tmp[idx], draw_input_from_net(nex), sizeof(tmp[0]));
+      }
+
+      fprintf(vvp_out, "E_%p%s .event edge", obj, suffix);
+      for (idx = 0 ;  idx < nany ;  idx += 1)
+	    fprintf(vvp_out, ", %s", tmp[idx]);
+
+      fprintf(vvp_out, ";\n");
+
+      free(tmp);
+}
+
 static void draw_event_in_scope(ivl_event_t obj)
 {
       char tmp[4][32];
@@ -1114,10 +1142,18 @@ static void draw_event_in_scope(ivl_event_t obj)
       unsigned nneg = ivl_event_nneg(obj);
       unsigned npos = ivl_event_npos(obj);
 
+	/* Wide "any" lists in static scopes are drawn as a single
+	   any change event. Automatic scopes still use the chunked
+	   form, since the any change functor has no per-context
+	   state. */
+      int wide_any = nany > ntmp && !ivl_scope_is_auto(ivl_event_scope(obj));
+
       unsigned cnt = 0;
 
 	/* Figure out how many probe functors are needed. */
-      if (nany > 0)
+      if (wide_any)
+	    cnt += 1;
+      else if (nany > 0)
 	    cnt += (nany+ntmp-1) / ntmp;
 
       if (nneg > 0)
@@ -1138,6 +1174,14 @@ static void draw_event_in_scope(ivl_event_t obj)
 	    unsigned idx;
 	    unsigned ecnt = 0;
 
+	    if (wide_any) {
+		  char suffix[16];
+		  snprintf(suffix, sizeof suffix, "/%u", ecnt);
+		  draw_event_wide_any(obj, suffix);
+		  ecnt += 1;
+		  nany = 0;
+	    }
+
 	    for (idx = 0 ;  idx < nany ;  idx += ntmp, ecnt += 1) {
 		  unsigned sub, top;
 
@@ -1202,6 +1246,10 @@ static void draw_event_in_scope(ivl_event_t obj)
 
 	    fprintf(vvp_out, ";\n");
 
+      } else if (wide_any) {
+	    assert((nneg + npos) == 0);
+	    draw_event_wide_any(obj, "");
+
       } else {
 	    unsigned num_input_strings = nany + nneg + npos;
 	    unsigned idx;
@@ -43,18 +43,161 @@ extern "C" long int lround(double x)
 
 static verinum::V add_with_carry(verinum::V l, verinum::V r, verinum::V&c);
 
+static const unsigned WORD_BITS = 64;
+
+static inline unsigned word_count(unsigned nbits)
+{
+      return (nbits + WORD_BITS - 1) / WORD_BITS;
+}
+
+/*
+ * Return the mask of the bits of the last word of a value with the
+ * given width that are part of the value.
+ */
+static inline uint64_t tail_mask(unsigned nbits)
+{
+      unsigned tail = nbits % WORD_BITS;
+      return tail? (((uint64_t)1 << tail) - 1) : ~(uint64_t)0;
+}
+
+/*
+ * Get the 64 bits of the plane that start at bit offset "off". Bits
+ * past the end of the plane read as zero.
+ */
+static inline uint64_t get_bits64(const uint64_t*plane, unsigned nbits,
+				  unsigned off)
+{
+      unsigned wdx = off / WORD_BITS;
+      unsigned sft = off % WORD_BITS;
+      unsigned nwords = word_count(nbits);
+
+      if (wdx >= nwords) return 0;
+      uint64_t val = plane[wdx] >> sft;
+      if (sft && (wdx+1) < nwords)
+	    val |= plane[wdx+1] << (WORD_BITS - sft);
+      return val;
+}
+
+/*
+ * Find the highest set bit in a word, which must not be zero.
+ */
+static inline unsigned top_bit(uint64_t val)
+{
+      unsigned res = 0;
+      if (val >> 32) { val >>= 32; res += 32; }
+      if (val >> 16) { val >>= 16; res += 16; }
+      if (val >>  8) { val >>=  8; res +=  8; }
+      if (val >>  4) { val >>=  4; res +=  4; }
+      if (val >>  2) { val >>=  2; res +=  2; }
+      if (val >>  1) { res += 1; }
+      return res;
+}
+
+void verinum::alloc_(unsigned nbits)
+{
+      nbits_ = nbits;
+      unsigned nwords = word_count(nbits);
+      if (nwords == 0) {
+	    abits_ = 0;
+	    bbits_ = 0;
+	    return;
+      }
+
+      abits_ = new uint64_t[2*nwords];
+      bbits_ = abits_ + nwords;
+}
+
+void verinum::truncate_(unsigned nbits)
+{
+      assert(nbits <= nbits_);
+      if (nbits == nbits_) return;
+
+      unsigned nwords = word_count(nbits);
+      uint64_t*tmp = nwords? new uint64_t[2*nwords] : 0;
+      for (unsigned idx = 0 ;  idx < nwords ;  idx += 1) {
+	    tmp[idx] = abits_[idx];
+	    tmp[nwords+idx] = bbits_[idx];
+      }
+      if (nwords) {
+	    tmp[nwords-1] &= tail_mask(nbits);
+	    tmp[2*nwords-1] &= tail_mask(nbits);
+      }
+
+      delete[]abits_;
+      abits_ = tmp;
+      bbits_ = tmp? tmp + nwords : 0;
+      nbits_ = nbits;
+}
+
+void verinum::copy_bits_(unsigned doff, const verinum&src,
+			 unsigned soff, unsigned cnt)
+{
+      assert(doff + cnt <= nbits_);
+      assert(soff + cnt <= src.nbits_);
+
+      while (cnt > 0) {
+	    unsigned wdx = doff / WORD_BITS;
+	    unsigned sft = doff % WORD_BITS;
+	    unsigned trans = WORD_BITS - sft;
+	    if (trans > cnt) trans = cnt;
+
+	    uint64_t mask = (trans == WORD_BITS)? ~(uint64_t)0
+		  : (((uint64_t)1 << trans) - 1);
+	    uint64_t aval = get_bits64(src.abits_, src.nbits_, soff) & mask;
+	    uint64_t bval = get_bits64(src.bbits_, src.nbits_, soff) & mask;
+
+	    abits_[wdx] = (abits_[wdx] & ~(mask << sft)) | (aval << sft);
+	    bbits_[wdx] = (bbits_[wdx] & ~(mask << sft)) | (bval << sft);
+
+	    doff += trans;
+	    soff += trans;
+	    cnt -= trans;
+      }
+}
+
+uint64_t verinum::aword_(unsigned wdx, V pad) const
+{
+      uint64_t fill = (pad & 1)? ~(uint64_t)0 : 0;
+      unsigned nwords = word_count(nbits_);
+      if (wdx >= nwords) return fill;
+      if (wdx+1 < nwords) return abits_[wdx];
+
+      uint64_t mask = tail_mask(nbits_);
+      return abits_[wdx] | (fill & ~mask);
+}
+
+uint64_t verinum::bword_(unsigned wdx, V pad) const
+{
+      uint64_t fill = (pad & 2)? ~(uint64_t)0 : 0;
+      unsigned nwords = word_count(nbits_);
+      if (wdx >= nwords) return fill;
+      if (wdx+1 < nwords) return bbits_[wdx];
+
+      uint64_t mask = tail_mask(nbits_);
+      return bbits_[wdx] | (fill & ~mask);
+}
+
 verinum::verinum()
-: bits_(0), nbits_(0), has_len_(false), has_sign_(false), is_single_(false), string_flag_(false)
+: abits_(0), bbits_(0), nbits_(0), has_len_(false), has_sign_(false), is_single_(false), string_flag_(false)
 {
 }
 
 verinum::verinum(const V*bits, unsigned nbits, bool has_len__)
 : has_len_(has_len__), has_sign_(false), is_single_(false), string_flag_(false)
 {
-      nbits_ = nbits;
-      bits_ = new V [nbits];
-      for (unsigned idx = 0 ;  idx < nbits ;  idx += 1) {
-	    bits_[idx] = bits[idx];
+      alloc_(nbits);
+      unsigned nwords = word_count(nbits);
+      for (unsigned wdx = 0 ;  wdx < nwords ;  wdx += 1) {
+	    uint64_t aval = 0, bval = 0;
+	    unsigned base = wdx * WORD_BITS;
+	    unsigned cnt = nbits - base;
+	    if (cnt > WORD_BITS) cnt = WORD_BITS;
+	    for (unsigned idx = 0 ;  idx < cnt ;  idx += 1) {
+		  aval |= (uint64_t)(bits[base+idx] & 1) << idx;
+		  bval |= (uint64_t)((bits[base+idx] >> 1) & 1) << idx;
+	    }
+	    abits_[wdx] = aval;
+	    bbits_[wdx] = bval;
       }
 }
 
@@ -115,58 +258,59 @@ verinum::verinum(const string&s)
 : has_len_(true), has_sign_(false), is_single_(false), string_flag_(true)
 {
       string str = process_verilog_string_quotes(s);
-      nbits_ = str.length() * 8;
 
 	// Special case: The string "" is 8 bits of 0.
-      if (nbits_ == 0) {
-	    nbits_ = 8;
-	    bits_ = new V [nbits_];
-	    bits_[0] = V0;
-	    bits_[1] = V0;
-	    bits_[2] = V0;
-	    bits_[3] = V0;
-	    bits_[4] = V0;
-	    bits_[5] = V0;
-	    bits_[6] = V0;
-	    bits_[7] = V0;
+      if (str.length() == 0) {
+	    alloc_(8);
+	    abits_[0] = 0;
+	    bbits_[0] = 0;
 	    return;
       }
 
-      bits_ = new V [nbits_];
+      alloc_(str.length() * 8);
+      for (unsigned idx = 0 ;  idx < word_count(nbits_) ;  idx += 1) {
+	    abits_[idx] = 0;
+	    bbits_[idx] = 0;
+      }
 
-      unsigned idx, cp;
-      V*bp = bits_+nbits_;
-      for (idx = nbits_, cp = 0 ;  idx > 0 ;  idx -= 8, cp += 1) {
-	    char ch = str[cp];
-	    *(--bp) = (ch&0x80) ? V1 : V0;
-	    *(--bp) = (ch&0x40) ? V1 : V0;
-	    *(--bp) = (ch&0x20) ? V1 : V0;
-	    *(--bp) = (ch&0x10) ? V1 : V0;
-	    *(--bp) = (ch&0x08) ? V1 : V0;
-	    *(--bp) = (ch&0x04) ? V1 : V0;
-	    *(--bp) = (ch&0x02) ? V1 : V0;
-	    *(--bp) = (ch&0x01) ? V1 : V0;
+	// The first character of the string is the most significant
+	// byte of the value.
+      unsigned nchars = str.length();
+      for (unsigned cp = 0 ;  cp < nchars ;  cp += 1) {
+	    unsigned bit = (nchars - cp - 1) * 8;
+	    uint64_t ch = (unsigned char)str[cp];
+	    abits_[bit/WORD_BITS] |= ch << (bit%WORD_BITS);
       }
 }
 
 verinum::verinum(verinum::V val, unsigned n, bool h)
 : has_len_(h), has_sign_(false), is_single_(false), string_flag_(false)
 {
-      nbits_ = n;
-      bits_ = new V[nbits_];
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1)
-	    bits_[idx] = val;
+      alloc_(n);
+      unsigned nwords = word_count(n);
+      uint64_t aval = (val & 1)? ~(uint64_t)0 : 0;
+      uint64_t bval = (val & 2)? ~(uint64_t)0 : 0;
+      for (unsigned idx = 0 ;  idx < nwords ;  idx += 1) {
+	    abits_[idx] = aval;
+	    bbits_[idx] = bval;
+      }
+      if (nwords) {
+	    abits_[nwords-1] &= tail_mask(n);
+	    bbits_[nwords-1] &= tail_mask(n);
+      }
 }
 
 verinum::verinum(uint64_t val, unsigned n)
 : has_len_(true), has_sign_(false), is_single_(false), string_flag_(false)
 {
-      nbits_ = n;
-      bits_ = new V[nbits_];
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1) {
-	    bits_[idx] = (val&1) ? V1 : V0;
-	    val >>= (uint64_t)1;
-      }
+      alloc_(n);
+      unsigned nwords = word_count(n);
+      for (unsigned idx = 0 ;  idx < nwords ;  idx += 1) {
+	    abits_[idx] = 0;
+	    bbits_[idx] = 0;
+      }
+      if (nwords)
+	    abits_[0] = val & (nwords == 1? tail_mask(n) : ~(uint64_t)0);
 }
 
 /* The second argument is not used! It is there to make this
@@ -181,9 +325,9 @@ verinum::verinum(double val, bool)
 
 	/* We return `bx for a NaN or +/- infinity. */
       if (val != val || (val && (val == 0.5*val))) {
-	    nbits_ = 1;
-	    bits_ = new V[nbits_];
-	    bits_[0] = Vx;
+	    alloc_(1);
+	    abits_[0] = 0;
+	    bbits_[0] = 1;
 	    return;
       }
 
@@ -199,17 +343,17 @@ verinum::verinum(double val, bool)
 
 	/* Get the exponent and fractional part of the number. */
       fraction = frexp(val, &exponent);
-      nbits_ = exponent+1;
-      bits_ = new V[nbits_];
+      alloc_(exponent+1);
+      for (unsigned idx = 0 ;  idx < word_count(nbits_) ;  idx += 1) {
+	    abits_[idx] = 0;
+	    bbits_[idx] = 0;
+      }
 
 	/* If the value is small enough just use lround(). */
       if (nbits_ <= BITS_IN_LONG) {
 	    long sval = lround(val);
 	    if (is_neg) sval = -sval;
-	    for (unsigned idx = 0; idx < nbits_; idx += 1) {
-		  bits_[idx] = (sval&1) ? V1 : V0;
-		  sval >>= 1;
-	    }
+	    abits_[0] = (uint64_t)(int64_t)sval & tail_mask(nbits_);
 	      /* Trim the result. */
 	    signed_trim();
 	    return;
@@ -223,7 +367,7 @@ verinum::verinum(double val, bool)
 	    unsigned long bits = (unsigned long) fraction;
 	    fraction = fraction - (double) bits;
 	    for (unsigned idx = 0; idx < nbits_; idx += 1) {
-		  bits_[idx] = (bits&1) ? V1 : V0;
+		  set(idx, (bits&1) ? V1 : V0);
 		  bits >>= 1;
 	    }
       } else {
@@ -233,7 +377,7 @@ verinum::verinum(double val, bool)
 		  unsigned max_idx = (wd+1)*BITS_IN_LONG;
 		  if (max_idx > nbits_) max_idx = nbits_;
 		  for (unsigned idx = wd*BITS_IN_LONG; idx < max_idx; idx += 1) {
-			bits_[idx] = (bits&1) ? V1 : V0;
+			set(idx, (bits&1) ? V1 : V0);
 			bits >>= 1;
 		  }
 		  fraction = ldexp(fraction, BITS_IN_LONG);
@@ -256,43 +400,35 @@ void verinum::signed_trim()
 {
 	/* Do we have any extra digits? */
       unsigned tlen = nbits_-1;
-      verinum::V sign = bits_[tlen];
-      while ((tlen > 0) && (bits_[tlen] == sign)) tlen -= 1;
+      verinum::V sign = get(tlen);
+      while ((tlen > 0) && (get(tlen) == sign)) tlen -= 1;
 
 	/* tlen now points to the first digit that is not the sign.
 	 * or bit 0. Set the length to include this bit and one proper
 	 * sign bit if needed. */
-      if (bits_[tlen] != sign) tlen += 1;
+      if (get(tlen) != sign) tlen += 1;
       tlen += 1;
 
 	/* Trim the bits if needed. */
-      if (tlen < nbits_) {
-	    V* tbits = new V[tlen];
-	    for (unsigned idx = 0; idx < tlen; idx += 1)
-		  tbits[idx] = bits_[idx];
-	    delete[] bits_;
-	    bits_ = tbits;
-	    nbits_ = tlen;
-      }
+      if (tlen < nbits_)
+	    truncate_(tlen);
 }
 
 verinum::verinum(const verinum&that)
 {
       string_flag_ = that.string_flag_;
-      nbits_ = that.nbits_;
-      bits_ = new V[nbits_];
       has_len_ = that.has_len_;
       has_sign_ = that.has_sign_;
       is_single_ = that.is_single_;
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1)
-	    bits_[idx] = that.bits_[idx];
+      alloc_(that.nbits_);
+      unsigned nwords = word_count(nbits_);
+      for (unsigned idx = 0 ;  idx < 2*nwords ;  idx += 1)
+	    abits_[idx] = that.abits_[idx];
 }
 
 verinum::verinum(const verinum&that, unsigned nbits)
 {
       string_flag_ = that.string_flag_ && (that.nbits_ == nbits);
-      nbits_ = nbits;
-      bits_ = new V[nbits_];
       has_len_ = true;
       has_sign_ = that.has_sign_;
       is_single_ = false;
@@ -300,17 +436,22 @@ verinum::verinum(const verinum&that, unsigned nbits)
       unsigned copy = nbits;
       if (copy > that.nbits_)
 	    copy = that.nbits_;
-      for (unsigned idx = 0 ;  idx < copy ;  idx += 1)
-	    bits_[idx] = that.bits_[idx];
 
-      if (copy < nbits_) {
-	    if (has_sign_ || that.is_single_) {
-		  for (unsigned idx = copy ;  idx < nbits_ ;  idx += 1)
-			bits_[idx] = bits_[idx-1];
-	    } else {
-		  for (unsigned idx = copy ;  idx < nbits_ ;  idx += 1)
-			bits_[idx] = verinum::V0;
-	    }
+	// Bits past the end of the source are padded with the sign
+	// bit (which may be x or z) if the source is signed.
+      V pad = V0;
+      if (copy > 0 && copy < nbits && (has_sign_ || that.is_single_))
+	    pad = that.get(copy-1);
+
+      alloc_(nbits);
+      unsigned nwords = word_count(nbits);
+      for (unsigned idx = 0 ;  idx < nwords ;  idx += 1) {
+	    abits_[idx] = that.aword_(idx, pad);
+	    bbits_[idx] = that.bword_(idx, pad);
+      }
+      if (nwords) {
+	    abits_[nwords-1] &= tail_mask(nbits);
+	    bbits_[nwords-1] &= tail_mask(nbits);
       }
 }
 
@@ -321,36 +462,43 @@ verinum::verinum(int64_t that)
 
       if (that < 0) tmp = (that+1)/2;
       else tmp = that/2;
-      nbits_ = 1;
+      unsigned nbits = 1;
       while (tmp != 0) {
-	    nbits_ += 1;
+	    nbits += 1;
 	    tmp /= 2;
       }
 
-      nbits_ += 1;
+      nbits += 1;
 
-      bits_ = new V[nbits_];
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1) {
-	    bits_[idx] = (that & 1)? V1 : V0;
-	    that >>= 1;
+      alloc_(nbits);
+      unsigned nwords = word_count(nbits);
+      abits_[0] = (uint64_t)that;
+      bbits_[0] = 0;
+      for (unsigned idx = 1 ;  idx < nwords ;  idx += 1) {
+	    abits_[idx] = (that < 0)? ~(uint64_t)0 : 0;
+	    bbits_[idx] = 0;
       }
+      abits_[nwords-1] &= tail_mask(nbits);
 }
 
 verinum::~verinum()
 {
-      delete[]bits_;
+      delete[]abits_;
 }
 
 verinum& verinum::operator= (const verinum&that)
 {
       if (this == &that) return *this;
-      if (nbits_ != that.nbits_) {
-            delete[]bits_;
-            nbits_ = that.nbits_;
-            bits_ = new V[that.nbits_];
+      if (word_count(nbits_) != word_count(that.nbits_)) {
+	    delete[]abits_;
+	    alloc_(that.nbits_);
+      }
+      nbits_ = that.nbits_;
+      unsigned nwords = word_count(nbits_);
+      for (unsigned idx = 0 ;  idx < nwords ;  idx += 1) {
+	    abits_[idx] = that.abits_[idx];
+	    bbits_[idx] = that.bbits_[idx];
       }
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1)
-	    bits_[idx] = that.bits_[idx];
 
       has_len_ = that.has_len_;
       has_sign_ = that.has_sign_;
@@ -362,20 +510,28 @@ verinum& verinum::operator= (const verinum&that)
 verinum::V verinum::get(unsigned idx) const
 {
       assert(idx < nbits_);
-      return bits_[idx];
+      unsigned wdx = idx / WORD_BITS;
+      unsigned sft = idx % WORD_BITS;
+      unsigned val = ((abits_[wdx] >> sft) & 1) | (((bbits_[wdx] >> sft) & 1) << 1);
+      return (V) val;
 }
 
 verinum::V verinum::set(unsigned idx, verinum::V val)
 {
       assert(idx < nbits_);
-      return bits_[idx] = val;
+      unsigned wdx = idx / WORD_BITS;
+      uint64_t mask = (uint64_t)1 << (idx % WORD_BITS);
+      if (val & 1) abits_[wdx] |= mask;
+      else abits_[wdx] &= ~mask;
+      if (val & 2) bbits_[wdx] |= mask;
+      else bbits_[wdx] &= ~mask;
+      return val;
 }
 
 void verinum::set(unsigned off, const verinum&val)
 {
       assert(off + val.len() <= nbits_);
-      for (unsigned idx = 0 ; idx < val.len() ; idx += 1)
-	    bits_[off+idx] = val[idx];
+      copy_bits_(off, val, 0, val.len());
 }
 
 unsigned long verinum::as_ulong() const
@@ -386,17 +542,9 @@ unsigned long verinum::as_ulong() const
       if (!is_defined())
 	    return 0;
 
-      unsigned top = nbits_;
-      if (top >= (8 * sizeof(unsigned long)))
-	  top = 8 * sizeof(unsigned long);
-
-      unsigned long val = 0;
-      unsigned long mask = 1;
-      for (unsigned idx = 0 ;  idx < top ;  idx += 1, mask <<= 1)
-	    if (bits_[idx] == V1)
-		  val |= mask;
-
-      return val;
+	// Bits past the end of the value are always zero, so the low
+	// word is the value, truncated if needed.
+      return (unsigned long) abits_[0];
 }
 
 uint64_t verinum::as_ulong64() const
@@ -407,17 +555,7 @@ uint64_t verinum::as_ulong64() const
       if (!is_defined())
 	    return 0;
 
-      unsigned top = nbits_;
-      if (top >= (8 * sizeof(uint64_t)))
-	  top = 8 * sizeof(uint64_t);
-
-      uint64_t val = 0;
-      uint64_t mask = 1;
-      for (unsigned idx = 0 ;  idx < top ;  idx += 1, mask <<= 1)
-	    if (bits_[idx] == V1)
-		  val |= mask;
-
-      return val;
+      return abits_[0];
 }
 
 /*
@@ -450,26 +588,26 @@ signed long verinum::as_long() const
       }
       int lost_bits=0;
 
-      if (has_sign_ && (bits_[nbits_-1] == V1)) {
+      if (has_sign_ && (get(nbits_-1) == V1)) {
 	    val = -1;
 	    signed long mask = ~1L;
 	    for (unsigned idx = 0 ;  idx < top ;  idx += 1) {
-		  if (bits_[idx] == V0) val &= mask;
+		  if (get(idx) == V0) val &= mask;
 		  mask = (mask << 1) | 1L;
 	    }
 	    if (diag_top) {
 		  for (unsigned idx = top; idx < diag_top; idx += 1) {
-			if (bits_[idx] == V0) lost_bits=1;
+			if (get(idx) == V0) lost_bits=1;
 		  }
 	    }
       } else {
 	    signed long mask = 1;
 	    for (unsigned idx = 0 ;  idx < top ;  idx += 1, mask <<= 1) {
-		  if (bits_[idx] == V1) val |= mask;
+		  if (get(idx) == V1) val |= mask;
 	    }
 	    if (diag_top) {
 		  for (unsigned idx = top; idx < diag_top; idx += 1) {
-			if (bits_[idx] == V1) lost_bits=1;
+			if (get(idx) == V1) lost_bits=1;
 		  }
 	    }
       }
@@ -486,17 +624,17 @@ double verinum::as_double() const
 
       double val = 0.0;
         /* Do we have/want a signed value? */
-      if (has_sign_ && bits_[nbits_-1] == V1) {
+      if (has_sign_ && get(nbits_-1) == V1) {
 	    V carry = V1;
 	    for (unsigned idx = 0; idx < nbits_; idx += 1) {
-		  V sum = add_with_carry(~bits_[idx], V0, carry);
+		  V sum = add_with_carry(~get(idx), V0, carry);
 		  if (sum == V1)
 			val += pow(2.0, (double)idx);
 	    }
 	    val *= -1.0;
       } else {
 	    for (unsigned idx = 0; idx < nbits_; idx += 1) {
-		  if (bits_[idx] == V1)
+		  if (get(idx) == V1)
 			val += pow(2.0, (double)idx);
 	    }
       }
@@ -511,17 +649,11 @@ string verinum::as_string() const
 
       string res;
       for (unsigned idx = nbits_ ;  idx > 0 ;  idx -= 8) {
-	    char char_val = 0;
-	    V*bp = bits_+idx;
-
-	    if (*(--bp) == V1) char_val |= 0x80;
-	    if (*(--bp) == V1) char_val |= 0x40;
-	    if (*(--bp) == V1) char_val |= 0x20;
-	    if (*(--bp) == V1) char_val |= 0x10;
-	    if (*(--bp) == V1) char_val |= 0x08;
-	    if (*(--bp) == V1) char_val |= 0x04;
-	    if (*(--bp) == V1) char_val |= 0x02;
-	    if (*(--bp) == V1) char_val |= 0x01;
+	    unsigned bit = idx - 8;
+	    uint64_t aval = abits_[bit/WORD_BITS] >> (bit%WORD_BITS);
+	    uint64_t bval = bbits_[bit/WORD_BITS] >> (bit%WORD_BITS);
+	      // Only bits that are 1 (not x or z) count.
+	    char char_val = (char) (aval & ~bval & 0xff);
 
 	    if (char_val == '"' || char_val == '\\') {
 		  char tmp[5];
@@ -543,40 +675,45 @@ bool verinum::is_before(const verinum&that) const
       if (that.nbits_ > nbits_) return true;
       if (that.nbits_ < nbits_) return false;
 
-      for (unsigned idx = nbits_  ;  idx > 0 ;  idx -= 1) {
-	    if (bits_[idx-1] < that.bits_[idx-1]) return true;
-	    if (bits_[idx-1] > that.bits_[idx-1]) return false;
+	// Find the most significant bit where the values differ, and
+	// compare the V encoding of the bits there.
+      for (unsigned wdx = word_count(nbits_) ;  wdx > 0 ;  wdx -= 1) {
+	    uint64_t diff = (abits_[wdx-1] ^ that.abits_[wdx-1])
+		  | (bbits_[wdx-1] ^ that.bbits_[wdx-1]);
+	    if (diff == 0) continue;
+
+	    unsigned bit = (wdx-1)*WORD_BITS + top_bit(diff);
+	    return get(bit) < that.get(bit);
       }
       return false;
 }
 
 bool verinum::is_defined() const
 {
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1) {
-	    if (bits_[idx] == Vx) return false;
-	    if (bits_[idx] == Vz) return false;
+      for (unsigned idx = 0 ;  idx < word_count(nbits_) ;  idx += 1) {
+	    if (bbits_[idx]) return false;
       }
       return true;
 }
 
 bool verinum::is_zero() const
 {
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1)
-	    if (bits_[idx] != V0) return false;
+      for (unsigned idx = 0 ;  idx < word_count(nbits_) ;  idx += 1)
+	    if (abits_[idx] || bbits_[idx]) return false;
 
       return true;
 }
 
 bool verinum::is_negative() const
 {
-      return (bits_[nbits_-1] == V1) && has_sign();
+      return (get(nbits_-1) == V1) && has_sign();
 }
 
 void verinum::cast_to_int2()
 {
-      for (unsigned idx = 0 ;  idx < nbits_ ;  idx += 1) {
-	    if (bits_[idx] == Vx || bits_[idx] == Vz)
-		  bits_[idx] = V0;
+      for (unsigned idx = 0 ;  idx < word_count(nbits_) ;  idx += 1) {
+	    abits_[idx] &= ~bbits_[idx];
+	    bbits_[idx] = 0;
       }
 }
 
@@ -602,9 +739,7 @@ verinum pad_to_width(const verinum&that, unsigned width)
       }
 
       verinum val(pad, width, that.has_len());
-
-      for (unsigned idx = 0 ;  idx < that.len() ;  idx += 1)
-	    val.set(idx, that[idx]);
+      val.set(0, that);
 
       val.has_sign(that.has_sign());
       if (that.is_string() && (width % 8) == 0) {
@@ -638,9 +773,7 @@ verinum cast_to_width(const verinum&that, unsigned width)
       }
 
       verinum val(pad, width, true);
-
-      for (unsigned idx = 0 ;  idx < that.len() ;  idx += 1)
-	    val.set(idx, that[idx]);
+      val.set(0, that);
 
       val.has_sign(that.has_sign());
       return val;
@@ -668,15 +801,27 @@ verinum trim_vnum(const verinum&that)
 	    unsigned top = that.len()-1;
 	    verinum::V sign = that.get(top);
 
-	    while ((top > 0) && (that.get(top) == sign))
-		  top -= 1;
+	      /* Find the highest bit that is not the same as the sign
+		 bit, a word at a time. */
+	    uint64_t afill = (sign & 1)? ~(uint64_t)0 : 0;
+	    uint64_t bfill = (sign & 2)? ~(uint64_t)0 : 0;
+	    unsigned nwords = word_count(that.len());
+	    unsigned wdx = nwords;
+	    uint64_t diff = 0;
+	    while (wdx > 0) {
+		  wdx -= 1;
+		  uint64_t mask = (wdx+1 == nwords)? tail_mask(that.len()) : ~(uint64_t)0;
+		  diff = ((that.abits_[wdx] ^ afill) | (that.bbits_[wdx] ^ bfill)) & mask;
+		  if (diff) break;
+	    }
 
 	      /* top points to the first digit that is not the
 		 sign. Set the length to include this and one proper
 		 sign bit. */
-
-	    if (that.get(top) != sign)
-		  top += 1;
+	    if (diff)
+		  top = wdx*WORD_BITS + top_bit(diff) + 1;
+	    else
+		  top = 0;
 
 	    tlen = top+1;
 
@@ -684,9 +829,15 @@ verinum trim_vnum(const verinum&that)
 
 	      /* If the result is unsigned and has an indefinite
 		 length, then trim off all but one leading zero. */
-	    unsigned top = that.len()-1;
-	    while ((top > 0) && (that.get(top) == verinum::V0))
-		  top -= 1;
+	    unsigned top = 0;
+	    bool nonzero = false;
+	    for (unsigned wdx = word_count(that.len()) ;  wdx > 0 ;  wdx -= 1) {
+		  uint64_t val = that.abits_[wdx-1] | that.bbits_[wdx-1];
+		  if (val == 0) continue;
+		  top = (wdx-1)*WORD_BITS + top_bit(val);
+		  nonzero = true;
+		  break;
+	    }
 
 	      /* Now top is the index of the highest non-zero bit. If
 		 that turns out to the highest bit in the vector, then
@@ -700,14 +851,13 @@ verinum trim_vnum(const verinum&that)
 
 	      /* This can only happen when the verinum is all zeros,
 		 so make it a single bit wide. */
-	    if (that.get(top) == verinum::V0) tlen -= 1;
+	    if (!nonzero) tlen -= 1;
       }
 
-      verinum tmp (verinum::V0, tlen, false);
+      verinum tmp (that, tlen);
+      tmp.has_len(false);
       tmp.has_sign(that.has_sign());
-      for (unsigned idx = 0 ;  idx < tmp.len() ;  idx += 1)
-	    tmp.set(idx, that.get(idx));
-
+      tmp.string_flag_ = false;
       return tmp;
 }
 
@@ -809,16 +959,67 @@ verinum::V operator == (const verinum&left, const verinum&right)
       if (right.len() > max_len)
 	    max_len = right.len();
 
-      for (unsigned idx = 0 ;  idx < max_len ;  idx += 1) {
-	    verinum::V left_bit  = idx < left.len() ? left[idx]  : left_pad;
-	    verinum::V right_bit = idx < right.len()? right[idx] : right_pad;
-	    if (left_bit != right_bit)
+      unsigned nwords = word_count(max_len);
+      for (unsigned wdx = 0 ;  wdx < nwords ;  wdx += 1) {
+	    uint64_t mask = (wdx+1 == nwords)? tail_mask(max_len) : ~(uint64_t)0;
+	    uint64_t diff = (left.aword_(wdx, left_pad) ^ right.aword_(wdx, right_pad))
+		  | (left.bword_(wdx, left_pad) ^ right.bword_(wdx, right_pad));
+	    if (diff & mask)
 		  return verinum::V0;
       }
 
       return verinum::V1;
 }
 
+/*
+ * Return true if any of the bits [from, to) of the value are not the
+ * same (in the 4-value sense) as the pad bit.
+ */
+static bool bits_differ_from_pad(const uint64_t*abits, const uint64_t*bbits,
+				 unsigned from, unsigned to, verinum::V pad)
+{
+      uint64_t afill = (pad & 1)? ~(uint64_t)0 : 0;
+      uint64_t bfill = (pad & 2)? ~(uint64_t)0 : 0;
+      while (from < to) {
+	    unsigned wdx = from / WORD_BITS;
+	    unsigned sft = from % WORD_BITS;
+	    unsigned cnt = WORD_BITS - sft;
+	    if (cnt > to - from) cnt = to - from;
+	    uint64_t mask = (cnt == WORD_BITS)? ~(uint64_t)0 : (((uint64_t)1 << cnt) - 1);
+	    mask <<= sft;
+	    if (((abits[wdx] ^ afill) | (bbits[wdx] ^ bfill)) & mask)
+		  return true;
+	    from += cnt;
+      }
+      return false;
+}
+
+/*
+ * Compare the low "len" bits of the left and right values, from the
+ * most significant bit down. The result is Vx if an x or z bit is
+ * found before a bit that is different, V1 if left<right, V0 if
+ * left>right and Vz if the bits are all the same.
+ */
+static verinum::V compare_bits(const uint64_t*la, const uint64_t*lb,
+			       const uint64_t*ra, const uint64_t*rb,
+			       unsigned len)
+{
+      for (unsigned wdx = word_count(len) ;  wdx > 0 ;  wdx -= 1) {
+	    uint64_t mask = (wdx == word_count(len))? tail_mask(len) : ~(uint64_t)0;
+	    uint64_t xz = (lb[wdx-1] | rb[wdx-1]) & mask;
+	    uint64_t diff = (la[wdx-1] ^ ra[wdx-1]) & mask;
+	    uint64_t stop = xz | diff;
+	    if (stop == 0) continue;
+
+	    uint64_t bit = (uint64_t)1 << top_bit(stop);
+	    if (xz & bit) return verinum::Vx;
+	    if (la[wdx-1] & bit) return verinum::V0;
+	    return verinum::V1;
+      }
+
+      return verinum::Vz;
+}
+
 verinum::V operator <= (const verinum&left, const verinum&right)
 {
       verinum::V left_pad = verinum::V0;
@@ -834,41 +1035,33 @@ verinum::V operator <= (const verinum&left, const verinum&right)
 		  return verinum::V0;
       }
 
-      unsigned idx;
-      for (idx = left.len() ; idx > right.len() ;  idx -= 1) {
-	    if (left[idx-1] != right_pad) {
-		      // A change of padding for a negative left argument
-		      // denotes the left value is less than the right.
-		   return (signed_calc &&
-		           (left_pad == verinum::V1)) ? verinum::V1 :
-		                                        verinum::V0;
-	    }
+      if (left.len() > right.len()
+	  && bits_differ_from_pad(left.abits_, left.bbits_,
+				  right.len(), left.len(), right_pad)) {
+	      // A change of padding for a negative left argument
+	      // denotes the left value is less than the right.
+	    return (signed_calc &&
+		    (left_pad == verinum::V1)) ? verinum::V1 :
+						 verinum::V0;
       }
 
-      for (idx = right.len() ; idx > left.len() ;  idx -= 1) {
-	    if (right[idx-1] != left_pad) {
-		      // A change of padding for a negative right argument
-		      // denotes the left value is not less than the right.
-		   return (signed_calc &&
-		           (right_pad == verinum::V1)) ? verinum::V0 :
-		                                         verinum::V1;
-	    }
+      if (right.len() > left.len()
+	  && bits_differ_from_pad(right.abits_, right.bbits_,
+				  left.len(), right.len(), left_pad)) {
+	      // A change of padding for a negative right argument
+	      // denotes the left value is not less than the right.
+	    return (signed_calc &&
+		    (right_pad == verinum::V1)) ? verinum::V0 :
+						  verinum::V1;
       }
 
-      idx = right.len();
-      if (left.len() < idx) idx = left.len();
-
-      while (idx > 0) {
-	    if (left[idx-1] == verinum::Vx) return verinum::Vx;
-	    if (left[idx-1] == verinum::Vz) return verinum::Vx;
-	    if (right[idx-1] == verinum::Vx) return verinum::Vx;
-	    if (right[idx-1] == verinum::Vz) return verinum::Vx;
-	    if (left[idx-1] > right[idx-1]) return verinum::V0;
-	    if (left[idx-1] < right[idx-1]) return verinum::V1;
-	    idx -= 1;
-      }
+      unsigned len = min(left.len(), right.len());
+      verinum::V res = compare_bits(left.abits_, left.bbits_,
+				    right.abits_, right.bbits_, len);
+      if (res == verinum::Vz)
+	    return verinum::V1;
 
-      return verinum::V1;
+      return res;
 }
 
 verinum::V operator < (const verinum&left, const verinum&right)
@@ -886,38 +1079,33 @@ verinum::V operator < (const verinum&left, const verinum&right)
 		  return verinum::V0;
       }
 
-      unsigned idx;
-      for (idx = left.len() ; idx > right.len() ;  idx -= 1) {
-	    if (left[idx-1] != right_pad) {
-		      // A change of padding for a negative left argument
-		      // denotes the left value is less than the right.
-		   return (signed_calc &&
-		           (left_pad == verinum::V1)) ? verinum::V1 :
-		                                        verinum::V0;
-	    }
+      if (left.len() > right.len()
+	  && bits_differ_from_pad(left.abits_, left.bbits_,
+				  right.len(), left.len(), right_pad)) {
+	      // A change of padding for a negative left argument
+	      // denotes the left value is less than the right.
+	    return (signed_calc &&
+		    (left_pad == verinum::V1)) ? verinum::V1 :
+						 verinum::V0;
       }
 
-      for (idx = right.len() ; idx > left.len() ;  idx -= 1) {
-	    if (right[idx-1] != left_pad) {
-		      // A change of padding for a negative right argument
-		      // denotes the left value is not less than the right.
-		   return (signed_calc &&
-		           (right_pad == verinum::V1)) ? verinum::V0 :
-		                                         verinum::V1;
-	    }
+      if (right.len() > left.len()
+	  && bits_differ_from_pad(right.abits_, right.bbits_,
+				  left.len(), right.len(), left_pad)) {
+	      // A change of padding for a negative right argument
+	      // denotes the left value is not less than the right.
+	    return (signed_calc &&
+		    (right_pad == verinum::V1)) ? verinum::V0 :
+						  verinum::V1;
       }
 
-      while (idx > 0) {
-	    if (left[idx-1] == verinum::Vx) return verinum::Vx;
-	    if (left[idx-1] == verinum::Vz) return verinum::Vx;
-	    if (right[idx-1] == verinum::Vx) return verinum::Vx;
-	    if (right[idx-1] == verinum::Vz) return verinum::Vx;
-	    if (left[idx-1] > right[idx-1]) return verinum::V0;
-	    if (left[idx-1] < right[idx-1]) return verinum::V1;
-	    idx -= 1;
-      }
+      unsigned len = min(left.len(), right.len());
+      verinum::V res = compare_bits(left.abits_, left.bbits_,
+				    right.abits_, right.bbits_, len);
+      if (res == verinum::Vz)
+	    return verinum::V0;
 
-      return verinum::V0;
+      return res;
 }
 
 static verinum::V add_with_carry(verinum::V l, verinum::V r, verinum::V&c)
@@ -971,35 +1159,42 @@ static verinum::V add_with_carry(verinum::V l, verinum::V r, verinum::V&c)
 verinum operator ~ (const verinum&left)
 {
       verinum val = left;
-      for (unsigned idx = 0 ;  idx < val.len() ;  idx += 1)
-	    switch (val[idx]) {
-		case verinum::V0:
-		  val.set(idx, verinum::V1);
-		  break;
-		case verinum::V1:
-		  val.set(idx, verinum::V0);
-		  break;
-		default:
-		  val.set(idx, verinum::Vx);
-		  break;
-	    }
+	// 0 becomes 1, 1 becomes 0, and x or z become x.
+      for (unsigned idx = 0 ;  idx < word_count(val.len()) ;  idx += 1)
+	    val.abits_[idx] = ~val.abits_[idx] & ~val.bbits_[idx];
+
+      unsigned nwords = word_count(val.len());
+      if (nwords)
+	    val.abits_[nwords-1] &= tail_mask(val.len());
 
       return val;
 }
 
 /*
- * Addition and subtraction works a bit at a time, from the least
+ * Addition and subtraction works a word at a time, from the least
  * significant up to the most significant. The result is signed only
  * if both of the operands are signed. If either operand is unsized,
  * the result is expanded as needed to prevent overflow.
+ *
+ * The operands are both defined, and are extended with their sign
+ * bit (or zero) to the width of the result. The carry out of each
+ * word is carried into the next.
  */
+static inline uint64_t add_word(uint64_t l, uint64_t r, uint64_t&carry)
+{
+      uint64_t sum = l + r;
+      uint64_t c1 = sum < l;
+      uint64_t res = sum + carry;
+      uint64_t c2 = res < sum;
+      carry = c1 | c2;
+      return res;
+}
 
 verinum operator + (const verinum&left, const verinum&right)
 {
       const bool has_len_flag = left.has_len() && right.has_len();
       const bool signed_flag = left.has_sign() && right.has_sign();
 
-      unsigned min_len = min(left.len(), right.len());
       unsigned max_len = max(left.len(), right.len());
 
 	// If either the left or right values are undefined, the
@@ -1011,40 +1206,29 @@ verinum operator + (const verinum&left, const verinum&right)
 	    return result;
       }
 
-      verinum::V*val_bits = new verinum::V[max_len+1];
-
-      verinum::V carry = verinum::V0;
-      for (unsigned idx = 0 ;  idx < min_len ;  idx += 1)
-	    val_bits[idx] = add_with_carry(left[idx], right[idx], carry);
-
       verinum::V rpad = sign_bit(right);
       verinum::V lpad = sign_bit(left);
 
-      if (left.len() > right.len()) {
-
-	    for (unsigned idx = min_len ;  idx < max_len ;  idx += 1)
-		  val_bits[idx] = add_with_carry(left[idx], rpad, carry);
-
-      } else {
-
-	    for (unsigned idx = min_len ;  idx < max_len ;  idx += 1)
-		  val_bits[idx] = add_with_carry(lpad, right[idx], carry);
-      }
+	// Calculate one extra bit, in case the result needs to grow.
+      verinum result (verinum::V0, max_len+1, has_len_flag);
+      uint64_t carry = 0;
+      for (unsigned idx = 0 ;  idx < word_count(max_len+1) ;  idx += 1)
+	    result.abits_[idx] = add_word(left.aword_(idx, lpad),
+					  right.aword_(idx, rpad), carry);
+      result.abits_[word_count(max_len+1)-1] &= tail_mask(max_len+1);
 
       unsigned len = max_len;
       if (!has_len_flag) {
-	    val_bits[max_len] = add_with_carry(lpad, rpad, carry);
+	    verinum::V top = result.get(max_len);
 	    if (signed_flag) {
-		  if (val_bits[max_len] != val_bits[max_len-1]) len += 1;
+		  if (top != result.get(max_len-1)) len += 1;
 	    } else {
-		  if (val_bits[max_len] != verinum::V0) len += 1;
+		  if (top != verinum::V0) len += 1;
 	    }
       }
-      verinum result (val_bits, len, has_len_flag);
+      result.truncate_(len);
       result.has_sign(signed_flag);
 
-      delete[]val_bits;
-
       return result;
 }
 
@@ -1053,7 +1237,6 @@ verinum operator - (const verinum&left, const verinum&right)
       const bool has_len_flag = left.has_len() && right.has_len();
       const bool signed_flag = left.has_sign() && right.has_sign();
 
-      unsigned min_len = min(left.len(), right.len());
       unsigned max_len = max(left.len(), right.len());
 
 	// If either the left or right values are undefined, the
@@ -1065,36 +1248,24 @@ verinum operator - (const verinum&left, const verinum&right)
 	    return result;
       }
 
-      verinum::V*val_bits = new verinum::V[max_len+1];
-
-      verinum::V carry = verinum::V1;
-      for (unsigned idx = 0 ;  idx < min_len ;  idx += 1)
-	    val_bits[idx] = add_with_carry(left[idx], ~right[idx], carry);
-
       verinum::V rpad = sign_bit(right);
       verinum::V lpad = sign_bit(left);
 
-      if (left.len() > right.len()) {
-
-	    for (unsigned idx = min_len ;  idx < max_len ;  idx += 1)
-		  val_bits[idx] = add_with_carry(left[idx], ~rpad, carry);
-
-      } else {
-
-	    for (unsigned idx = min_len ;  idx < max_len ;  idx += 1)
-		  val_bits[idx] = add_with_carry(lpad, ~right[idx], carry);
-      }
+	// Calculate one extra bit, in case the result needs to grow.
+      verinum result (verinum::V0, max_len+1, has_len_flag);
+      uint64_t carry = 1;
+      for (unsigned idx = 0 ;  idx < word_count(max_len+1) ;  idx += 1)
+	    result.abits_[idx] = add_word(left.aword_(idx, lpad),
+					  ~right.aword_(idx, rpad), carry);
+      result.abits_[word_count(max_len+1)-1] &= tail_mask(max_len+1);
 
       unsigned len = max_len;
       if (signed_flag && !has_len_flag) {
-	    val_bits[max_len] = add_with_carry(lpad, ~rpad, carry);
-	    if (val_bits[max_len] != val_bits[max_len-1]) len += 1;
+	    if (result.get(max_len) != result.get(max_len-1)) len += 1;
       }
-      verinum result (val_bits, len, has_len_flag);
+      result.truncate_(len);
       result.has_sign(signed_flag);
 
-      delete[]val_bits;
-
       return result;
 }
 
@@ -1113,21 +1284,22 @@ verinum operator - (const verinum&right)
 	    return result;
       }
 
-      verinum::V*val_bits = new verinum::V[len+1];
+      verinum::V rpad = sign_bit(right);
 
-      verinum::V carry = verinum::V1;
-      for (unsigned idx = 0 ;  idx < len ;  idx += 1)
-	    val_bits[idx] = add_with_carry(verinum::V0, ~right[idx], carry);
+	// Calculate one extra bit, in case the result needs to grow.
+      verinum result (verinum::V0, len+1, has_len_flag);
+      uint64_t carry = 1;
+      for (unsigned idx = 0 ;  idx < word_count(len+1) ;  idx += 1)
+	    result.abits_[idx] = add_word(0, ~right.aword_(idx, rpad), carry);
+      result.abits_[word_count(len+1)-1] &= tail_mask(len+1);
 
+      unsigned res_len = len;
       if (signed_flag && !has_len_flag) {
-	    val_bits[len] = add_with_carry(verinum::V0, ~sign_bit(right), carry);
-	    if (val_bits[len] != val_bits[len-1]) len += 1;
+	    if (result.get(len) != result.get(len-1)) res_len += 1;
       }
-      verinum result (val_bits, len, has_len_flag);
+      result.truncate_(res_len);
       result.has_sign(signed_flag);
 
-      delete[]val_bits;
-
       return result;
 }
 
@@ -1137,8 +1309,9 @@ verinum operator - (const verinum&right)
  * operand is unsized, the resulting number is as large as the sum of
  * the sizes of the operands.
  *
- * The algorithm used is successive shift and add operations,
- * implemented as the nested loops.
+ * The operands are extended (with their own sign bit) to the width
+ * of the result, and then multiplied with the schoolbook algorithm
+ * using 32bit digits. The product is truncated to the result width.
  */
 verinum operator * (const verinum&left, const verinum&right)
 {
@@ -1160,24 +1333,48 @@ verinum operator * (const verinum&left, const verinum&right)
 
       verinum result(verinum::V0, len, has_len_flag);
       result.has_sign(signed_flag);
+      if (len == 0)
+	    return result;
 
+      verinum::V l_sign = sign_bit(left);
       verinum::V r_sign = sign_bit(right);
-      for (unsigned rdx = 0 ;  rdx < len ;  rdx += 1) {
 
-	    verinum::V r_bit = rdx < r_len ? right.get(rdx) : r_sign;
-	    if (r_bit == verinum::V0)
+      unsigned ndig = (len + 31) / 32;
+      uint32_t*ldig = new uint32_t[3*ndig];
+      uint32_t*rdig = ldig + ndig;
+      uint32_t*pdig = rdig + ndig;
+      for (unsigned idx = 0 ;  idx < ndig ;  idx += 1) {
+	    uint64_t lw = left.aword_(idx/2, l_sign);
+	    uint64_t rw = right.aword_(idx/2, r_sign);
+	    ldig[idx] = (uint32_t) (idx%2? lw >> 32 : lw);
+	    rdig[idx] = (uint32_t) (idx%2? rw >> 32 : rw);
+	    pdig[idx] = 0;
+      }
+
+      for (unsigned rdx = 0 ;  rdx < ndig ;  rdx += 1) {
+	    if (rdig[rdx] == 0)
 		  continue;
 
-	    verinum::V l_sign = sign_bit(left);
-	    verinum::V carry = verinum::V0;
-	    for (unsigned ldx = 0 ;  ldx < (len - rdx) ;  ldx += 1) {
-		  verinum::V l_bit = ldx < l_len ? left[ldx] : l_sign;
-		  result.set(ldx+rdx, add_with_carry(l_bit,
-						     result[rdx+ldx],
-						     carry));
+	    uint64_t carry = 0;
+	    for (unsigned ldx = 0 ;  ldx < (ndig - rdx) ;  ldx += 1) {
+		  uint64_t tmp = (uint64_t)ldig[ldx] * rdig[rdx]
+			+ pdig[ldx+rdx] + carry;
+		  pdig[ldx+rdx] = (uint32_t) tmp;
+		  carry = tmp >> 32;
 	    }
       }
 
+      unsigned nwords = word_count(len);
+      for (unsigned idx = 0 ;  idx < nwords ;  idx += 1) {
+	    uint64_t val = pdig[2*idx];
+	    if (2*idx+1 < ndig)
+		  val |= (uint64_t)pdig[2*idx+1] << 32;
+	    result.abits_[idx] = val;
+      }
+      result.abits_[nwords-1] &= tail_mask(len);
+
+      delete[]ldig;
+
       return trim_vnum(result);
 }
 
@@ -1281,8 +1478,8 @@ verinum operator << (const verinum&that, unsigned shift)
       verinum result(verinum::V0, len, has_len_flag);
       result.has_sign(that.has_sign());
 
-      for (unsigned idx = shift ;  idx < len ;  idx += 1)
-	    result.set(idx, that.get(idx - shift));
+      if (shift < len)
+	    result.copy_bits_(shift, that, 0, len - shift);
 
       return trim_vnum(result);
 }
@@ -1306,8 +1503,7 @@ verinum operator >> (const verinum&that, unsigned shift)
       verinum result(sign_bit, len, has_len_flag);
       result.has_sign(that.has_sign());
 
-      for (unsigned idx = shift ;  idx < that.len() ;  idx += 1)
-	    result.set(idx-shift, that.get(idx));
+      result.copy_bits_(0, that, shift, that.len() - shift);
 
       return trim_vnum(result);
 }
@@ -1541,11 +1737,8 @@ verinum concat(const verinum&left, const verinum&right)
       }
 
       verinum res (verinum::V0, left.len() + right.len());
-      for (unsigned idx = 0 ;  idx < right.len() ;  idx += 1)
-	    res.set(idx, right.get(idx));
-
-      for (unsigned idx = 0 ;  idx < left.len() ;  idx += 1)
-	    res.set(idx+right.len(), left.get(idx));
+      res.copy_bits_(0, right, 0, right.len());
+      res.copy_bits_(right.len(), left, 0, left.len());
 
       return res;
 }
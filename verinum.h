@@ -35,6 +35,13 @@ using namespace std;
  * possible values: 0, 1, x or z. The verinum number is store in
  * little-endian format. This means that if the long value is 2b'10,
  * get(0) is 0 and get(1) is 1.
+ *
+ * Internally, the bits are packed into two planes of 64bit words. The
+ * "a" plane holds the low bit of the V encoding and the "b" plane
+ * holds the high bit, so a defined value has a zero b plane and the
+ * a plane is the binary value. This lets the arithmetic operators
+ * work a word at a time. Bits past the end of the value in the last
+ * word are always kept zero.
  */
 class verinum {
 
@@ -106,8 +113,33 @@ class verinum {
     private:
       void signed_trim();
 
+	// Allocate (uninitialized) planes for the given width.
+      void alloc_(unsigned nbits);
+	// Truncate the value to the given (smaller) width.
+      void truncate_(unsigned nbits);
+	// Copy bits [soff, soff+cnt) of src to bits starting at doff.
+      void copy_bits_(unsigned doff, const verinum&src,
+		      unsigned soff, unsigned cnt);
+	// Get a word of a plane, extended with the bits of pad.
+      uint64_t aword_(unsigned wdx, V pad) const;
+      uint64_t bword_(unsigned wdx, V pad) const;
+
+      friend verinum operator - (const verinum&);
+      friend verinum operator + (const verinum&, const verinum&);
+      friend verinum operator - (const verinum&, const verinum&);
+      friend verinum operator * (const verinum&, const verinum&);
+      friend verinum operator<< (const verinum&, unsigned);
+      friend verinum operator>> (const verinum&, unsigned);
+      friend verinum operator ~ (const verinum&);
+      friend verinum concat(const verinum&, const verinum&);
+      friend verinum trim_vnum(const verinum&);
+      friend V operator == (const verinum&, const verinum&);
+      friend V operator <= (const verinum&, const verinum&);
+      friend V operator <  (const verinum&, const verinum&);
+
     private:
-      V* bits_;
+      uint64_t*abits_;
+      uint64_t*bbits_;
       unsigned nbits_;
       bool has_len_;
       bool has_sign_;
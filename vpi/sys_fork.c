@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "sys_priv.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * $ivl_fork_tests(<count> [, <plusargs file>])
+ *
+ * This function forks the simulation into <count> tests that each
+ * continue from the point of the call, so that a long warm up is
+ * only simulated once. It returns the index of the test (from 1) in
+ * each test, and 0 in the original simulation once all the tests
+ * have exited, after which the original simulation finishes. The run
+ * time (vpip_fork_tests) does the work of making the tests
+ * independent. This module moves the waveform dump.
+ */
+PLI_INT32 (*sys_dump_fork_hook)(unsigned index) = 0;
+
+/*
+ * A dump that is opened in a test goes to the test's own file. This
+ * takes and returns a malloc'ed path.
+ */
+char *sys_dump_fork_path(char *path)
+{
+      char *res;
+
+      if (vpip_fork_index() == 0) return path;
+
+      res = vpip_fork_path(path);
+      free(path);
+      return res;
+}
+
+static PLI_INT32 sys_fork_tests_compiletf(ICARUS_VPI_CONST PLI_BYTE8*name)
+{
+      vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, callh);
+      vpiHandle arg;
+
+      if (argv == 0) {
+	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s requires a numeric argument.\n", name);
+	    vpi_control(vpiFinish, 1);
+	    return 0;
+      }
+
+      if (! is_numeric_obj(vpi_scan(argv))) {
+	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s's first argument must be numeric.\n", name);
+	    vpi_control(vpiFinish, 1);
+      }
+
+      arg = vpi_scan(argv);
+      if (arg == 0) return 0;
+
+      if (! is_string_obj(arg)) {
+	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s's second argument must be a file name.\n", name);
+	    vpi_control(vpiFinish, 1);
+      }
+
+      check_for_extra_args(argv, callh, name, "two arguments", 1);
+
+      return 0;
+}
+
+/*
+ * The -fork-jobs=<n> extended argument limits the number of tests
+ * that run at the same time. The default is one per processor.
+ */
+static PLI_INT32 get_fork_jobs(void)
+{
+      struct t_vpi_vlog_info vlog_info;
+      int idx;
+
+      vpi_get_vlog_info(&vlog_info);
+      for (idx = 0 ;  idx < vlog_info.argc ;  idx += 1) {
+	    if (strncmp(vlog_info.argv[idx], "-fork-jobs=", 11) == 0)
+		  return atoi(vlog_info.argv[idx]+11);
+      }
+      return 0;
+}
+
+static PLI_INT32 sys_fork_tests_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
+{
+      vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, callh);
+      vpiHandle arg;
+      s_vpi_value val;
+      char *path = 0;
+      PLI_INT32 count, index;
+
+      val.format = vpiIntVal;
+      vpi_get_value(vpi_scan(argv), &val);
+      count = val.value.integer;
+
+      arg = vpi_scan(argv);
+      if (arg) {
+	    vpi_free_object(argv);
+	    path = get_filename(callh, name, arg);
+	    if (path == 0) count = 0;
+      }
+
+      if (count <= 0) {
+	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s needs a positive number of tests.\n", name);
+	    index = -1;
+
+      } else if (sys_dump_fork_hook && sys_dump_fork_hook(0)) {
+	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s cannot split an open LXT, LXT2 or FST dump. "
+	               "Start the dump after the fork, or use VCD.\n", name);
+	    index = -1;
+
+      } else {
+	    index = vpip_fork_tests(count, get_fork_jobs(), path);
+	    if (index > 0 && sys_dump_fork_hook)
+		  sys_dump_fork_hook(index);
+      }
+
+      free(path);
+
+	/* The original simulation is done once its tests are. */
+      if (index <= 0)
+	    vpi_control(vpiFinish, 1);
+
+      val.format = vpiIntVal;
+      val.value.integer = index;
+      vpi_put_value(callh, &val, 0, vpiNoDelay);
+
+      return 0;
+}
+
+void sys_fork_register(void)
+{
+      s_vpi_systf_data tf_data;
+      vpiHandle res;
+
+      tf_data.type        = vpiSysFunc;
+      tf_data.sysfunctype = vpiIntFunc;
+      tf_data.tfname      = "$ivl_fork_tests";
+      tf_data.calltf      = sys_fork_tests_calltf;
+      tf_data.compiletf   = sys_fork_tests_compiletf;
+      tf_data.sizetf      = 0;
+      tf_data.user_data   = "$ivl_fork_tests";
+      res = vpi_register_systf(&tf_data);
+      vpip_make_systf_system_defined(res);
+}
@@ -230,6 +230,7 @@ static PLI_INT32 finish_cb(p_cb_data cause)
       }
 
       fstWriterClose(dump_file);
+      sys_dump_count_bytes(dump_path);
 
       for (cur = vcd_list ;  cur ;  cur = next) {
 	    next = cur->next;
@@ -358,6 +359,7 @@ static PLI_INT32 sys_dumpall_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 static void open_dumpfile(vpiHandle callh)
 {
       if (dump_path == 0) dump_path = strdup("dump.fst");
+      dump_path = sys_dump_fork_path(dump_path);
 
       dump_file = fstWriterCreate(dump_path, 1);
 
@@ -879,6 +881,15 @@ static PLI_INT32 sys_dumpvars_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       return 0;
 }
 
+/*
+ * The writer of an open FST dump cannot be split between the tests
+ * of $ivl_fork_tests.
+ */
+static PLI_INT32 fst_fork(unsigned index)
+{
+      return index == 0 && dump_file != 0;
+}
+
 void sys_fst_register()
 {
       int idx;
@@ -886,6 +897,8 @@ void sys_fst_register()
       s_vpi_systf_data tf_data;
       vpiHandle res;
 
+      sys_dump_fork_hook = fst_fork;
+
 	/* Scan the extended arguments, looking for fst optimization flags. */
       vpi_get_vlog_info(&vlog_info);
 
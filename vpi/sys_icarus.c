@@ -18,6 +18,7 @@
 
 #include "sys_priv.h"
 #include <assert.h>
+#include <stdlib.h>
 
 static PLI_INT32 finish_and_return_calltf(ICARUS_VPI_CONST PLI_BYTE8* name)
 {
@@ -67,6 +68,29 @@ static PLI_INT32 missing_optional_compiletf(ICARUS_VPI_CONST PLI_BYTE8* name)
       return 0;
 }
 
+/*
+ * $save(<file>) asks the run time to write a checkpoint of the
+ * simulation at the end of the current time step. "vvp -r <file>"
+ * resumes the simulation from that checkpoint. $restart and
+ * $incsave are not provided.
+ */
+static PLI_INT32 sys_save_calltf(ICARUS_VPI_CONST PLI_BYTE8* name)
+{
+      vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, callh);
+      vpiHandle arg = vpi_scan(argv);
+      char *path;
+
+      vpi_free_object(argv);
+
+      path = get_filename(callh, name, arg);
+      if (path == 0) return 0;
+
+      vpip_save_checkpoint(path);
+      free(path);
+      return 0;
+}
+
 /*
  * Register the function with Verilog.
  */
@@ -218,6 +242,15 @@ void sys_special_register(void)
       tf_data.tfname      = "$dumpportsflush";
       tf_data.user_data   = "$dumpportsflush";
       res = vpi_register_systf(&tf_data);
+      vpip_make_systf_system_defined(res);
+
+      tf_data.type        = vpiSysTask;
+      tf_data.calltf      = sys_save_calltf;
+      tf_data.compiletf   = sys_one_string_arg_compiletf;
+      tf_data.sizetf      = 0;
+      tf_data.tfname      = "$save";
+      tf_data.user_data   = "$save";
+      res = vpi_register_systf(&tf_data);
       vpip_make_systf_system_defined(res);
 
 	/* The following optional system tasks/functions are not implemented
@@ -257,11 +290,6 @@ void sys_special_register(void)
       res = vpi_register_systf(&tf_data);
       vpip_make_systf_system_defined(res);
 
-      tf_data.tfname      = "$save";
-      tf_data.user_data   = "$save";
-      res = vpi_register_systf(&tf_data);
-      vpip_make_systf_system_defined(res);
-
       tf_data.tfname      = "$restart";
       tf_data.user_data   = "$restart";
       res = vpi_register_systf(&tf_data);
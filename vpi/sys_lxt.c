@@ -436,6 +436,7 @@ static void *close_dumpfile(void)
 static void open_dumpfile(vpiHandle callh)
 {
       if (dump_path == 0) dump_path = strdup("dump.lxt");
+      dump_path = sys_dump_fork_path(dump_path);
 
       dump_file = lt_init(dump_path);
 
@@ -774,6 +775,15 @@ static PLI_INT32 sys_dumpvars_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       return 0;
 }
 
+/*
+ * The writer of an open LXT dump cannot be split between the tests
+ * of $ivl_fork_tests.
+ */
+static PLI_INT32 lxt_fork(unsigned index)
+{
+      return index == 0 && dump_file != 0;
+}
+
 void sys_lxt_register()
 {
       int idx;
@@ -781,6 +791,8 @@ void sys_lxt_register()
       s_vpi_systf_data tf_data;
       vpiHandle res;
 
+      sys_dump_fork_hook = lxt_fork;
+
 
 	/* Scan the extended arguments, looking for lxt optimization flags. */
       vpi_get_vlog_info(&vlog_info);
@@ -476,6 +476,7 @@ static void open_dumpfile(vpiHandle callh)
 {
       off_t use_file_size_limit = lxt2_file_size_limit;
       if (dump_path == 0) dump_path = strdup("dump.lx2");
+      dump_path = sys_dump_fork_path(dump_path);
 
       dump_file = lxt2_wr_init(dump_path);
 
@@ -873,6 +874,15 @@ static void* lxt2_thread(void*arg)
       return 0;
 }
 
+/*
+ * The writer of an open LXT2 dump cannot be split between the tests
+ * of $ivl_fork_tests.
+ */
+static PLI_INT32 lxt2_fork(unsigned index)
+{
+      return index == 0 && dump_file != 0;
+}
+
 void sys_lxt2_register()
 {
       int idx;
@@ -880,6 +890,8 @@ void sys_lxt2_register()
       s_vpi_systf_data tf_data;
       vpiHandle res;
 
+      sys_dump_fork_hook = lxt2_fork;
+
 	/* Scan the extended arguments, looking for lxt2 optimization flags. */
       vpi_get_vlog_info(&vlog_info);
 
@@ -22,6 +22,8 @@
 #include <ctype.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
 #include "ivl_alloc.h"
 
 PLI_UINT64 timerec_to_time64(const struct t_vpi_time*timerec)
@@ -396,3 +398,11 @@ PLI_INT32 sys_one_string_arg_compiletf(ICARUS_VPI_CONST PLI_BYTE8 *name)
 
       return 0;
 }
+
+void sys_dump_count_bytes(const char *path)
+{
+      struct stat sb;
+
+      if (path && stat(path, &sb) == 0)
+	    vpip_count_dump_bytes(sb.st_size);
+}
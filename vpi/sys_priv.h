@@ -56,6 +56,21 @@ extern unsigned is_string_obj(vpiHandle obj);
 
 extern vpiHandle sys_func_module(vpiHandle obj);
 
+/*
+ * The dump module that is in use sets this to prepare its dump for
+ * $ivl_fork_tests. It is called with index 0 before the fork, and
+ * returns non-zero if the dump cannot be split, and then with the
+ * index of the test in each test.
+ */
+extern PLI_INT32 (*sys_dump_fork_hook)(unsigned index);
+extern char *sys_dump_fork_path(char *path);
+
+/*
+ * A dump module calls this with the path of a dump file once it has
+ * closed the file, to add its size to the simulation statistics.
+ */
+extern void sys_dump_count_bytes(const char *path);
+
 /*
  * The standard compiletf routines.
  */
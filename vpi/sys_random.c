@@ -22,347 +22,13 @@
 
 # include  <assert.h>
 # include  <stdlib.h>
-# include  <math.h>
 # include  <limits.h>
 
-#if ULONG_MAX > 4294967295UL
-# define UNIFORM_MAX INT_MAX
-# define UNIFORM_MIN INT_MIN
-#else
-# define UNIFORM_MAX LONG_MAX
-# define UNIFORM_MIN LONG_MIN
-#endif
-
-static double uniform(long *seed, long start, long end);
-static double normal(long *seed, long mean, long deviation);
-static double exponential(long *seed, long mean);
-static long poisson(long *seed, long mean);
-static double chi_square(long *seed, long deg_of_free);
-static double t(long *seed, long deg_of_free);
-static double erlangian(long *seed, long k, long mean);
-
-long rtl_dist_chi_square(long *seed, long df)
-{
-      double r;
-      long i;
-
-      if (df > 0) {
-            r = chi_square(seed, df);
-            if (r >= 0) {
-                  i = (long) (r + 0.5);
-            } else {
-                  r = -r;
-                  i = (long) (r + 0.5);
-                  i = -i;
-            }
-      } else {
-            vpi_printf("WARNING: Chi_square distribution must have "
-                       "a positive degree of freedom\n");
-            i = 0;
-      }
-
-      return i;
-}
-
-long rtl_dist_erlang(long *seed, long k, long mean)
-{
-      double r;
-      long i;
-
-      if (k > 0) {
-            r = erlangian(seed, k, mean);
-            if (r >= 0) {
-                  i = (long) (r + 0.5);
-            } else {
-                  r = -r;
-                  i = (long) (r + 0.5);
-                  i = -i;
-            }
-      } else {
-            vpi_printf("WARNING: K-stage erlangian distribution must have "
-                       "a positive k\n");
-            i = 0;
-      }
-
-      return i;
-}
-
-long rtl_dist_exponential(long *seed, long mean)
-{
-      double r;
-      long i;
-
-      if (mean > 0) {
-            r = exponential(seed, mean);
-            if (r >= 0) {
-                  i = (long) (r + 0.5);
-            } else {
-                  r = -r;
-                  i = (long) (r + 0.5);
-                  i = -i;
-            }
-      } else {
-            vpi_printf("WARNING: Exponential distribution must have "
-                       "a positive mean\n");
-            i = 0;
-      }
-
-      return i;
-}
-
-long rtl_dist_normal(long *seed, long mean, long sd)
-{
-      double r;
-      long i;
-
-      r = normal(seed, mean, sd);
-      if (r >= 0) {
-            i = (long) (r + 0.5);
-      } else {
-            r = -r;
-            i = (long) (r + 0.5);
-            i = -i;
-      }
-
-      return i;
-}
-
-long rtl_dist_poisson(long *seed, long mean)
-{
-      long i;
-
-      if (mean > 0) {
-            i = poisson(seed, mean);
-      } else {
-            vpi_printf("WARNING: Poisson distribution must have "
-                       "a positive mean\n");
-            i = 0;
-      }
-
-      return i;
-}
-
-long rtl_dist_t(long *seed, long df)
-{
-      double r;
-      long i;
-
-      if (df > 0) {
-            r = t(seed, df);
-            if (r >= 0) {
-                  i = (long) (r + 0.5);
-            } else {
-                  r = -r;
-                  i = (long) (r + 0.5);
-                  i = -i;
-            }
-      } else {
-            vpi_printf("WARNING: t distribution must have "
-                       "a positive degree of freedom\n");
-            i = 0;
-      }
-
-      return i;
-}
-
-/* copied from IEEE1364-2001, with slight modifications for 64bit machines. */
-long rtl_dist_uniform(long *seed, long start, long end)
-{
-      double r;
-      long i;
-
-      if (start >= end) return(start);
-
-      /* NOTE: The cast of r to i can overflow and generate strange
-         values, so cast to unsigned long first. This eliminates
-         the underflow and gets the twos complement value. That in
-         turn can be cast to the long value that is expected. */
-
-      if (end != UNIFORM_MAX) {
-            end++;
-            r = uniform(seed, start, end);
-            if (r >= 0) {
-                  i = (unsigned long) r;
-            } else {
-	          i = - ( (unsigned long) (-(r - 1)) );
-            }
-            if (i < start) i = start;
-            if (i >= end) i = end - 1;
-      } else if (start != UNIFORM_MIN) {
-            start--;
-            r = uniform( seed, start, end) + 1.0;
-            if (r >= 0) {
-                  i = (unsigned long) r;
-            } else {
-	          i = - ( (unsigned long) (-(r - 1)) );
-            }
-            if (i <= start) i = start + 1;
-            if (i > end) i = end;
-      } else {
-            r = (uniform(seed, start, end) + 2147483648.0) / 4294967295.0;
-            r = r * 4294967296.0 - 2147483648.0;
-
-            if (r >= 0) {
-                  i = (unsigned long) r;
-            } else {
-	            /* At least some compilers will notice that (r-1)
-		       is <0 when castling to unsigned long and
-		       replace the result with a zero. This causes
-		       much wrongness, so do the casting to the
-		       positive version and invert it back. */
-	          i = - ( (unsigned long) (-(r - 1)) );
-            }
-      }
-
-      return i;
-}
-
-static double uniform(long *seed, long start, long end )
-{
-      double d = 0.00000011920928955078125;
-      double a, b, c;
-      unsigned long oldseed, newseed;
-
-      oldseed = *seed;
-      if (oldseed == 0)
-            oldseed = 259341593;
-
-      if (start >= end) {
-            a = 0.0;
-            b = 2147483647.0;
-      } else {
-            a = (double)start;
-            b = (double)end;
-      }
-
-      /* Original routine used signed arithmetic, and the (frequent)
-       * overflows trigger "Undefined Behavior" according to the
-       * C standard (both c89 and c99).  Using unsigned arithmetic
-       * forces a conforming C implementation to get the result
-       * that the IEEE-1364-2001 committee wants.
-       */
-      newseed = 69069 * oldseed + 1;
-
-      /* Emulate a 32-bit unsigned long, even if the native machine
-       * uses wider words.
-       */
-#if ULONG_MAX > 4294967295UL
-      newseed = newseed & 4294967295UL;
-#endif
-      *seed = newseed;
-
-
-#if 0
-      /* Cadence-donated conversion from unsigned int to double */
-      {
-            union { float s; unsigned stemp; } u;
-            u.stemp = (newseed >> 9) | 0x3f800000;
-            c = (double) u.s;
-      }
-#else
-      /* Equivalent conversion without assuming IEEE 32-bit float */
-      /* constant is 2^(-23) */
-      c = 1.0 + (newseed >> 9) * 0.00000011920928955078125;
-#endif
-
-
-      c = c + (c*d);
-      c = ((b - a) * (c - 1.0)) + a;
-
-      return c;
-}
-
-static double normal(long *seed, long mean, long deviation)
-{
-      double v1, v2, s;
-
-      s = 1.0;
-      while ((s >= 1.0) || (s == 0.0)) {
-            v1 = uniform(seed, -1, 1);
-            v2 = uniform(seed, -1, 1);
-            s = v1 * v1 + v2 * v2;
-      }
-      s = v1 * sqrt(-2.0 * log(s) / s);
-      v1 = (double) deviation;
-      v2 = (double) mean;
-
-      return s * v1 + v2;
-}
-
-static double exponential(long *seed, long mean)
-{
-      double n;
-
-      n = uniform(seed, 0, 1);
-      if (n != 0.0) {
-            n = -log(n) * mean;
-      }
-
-      return n;
-}
-
-static long poisson(long *seed, long mean)
-{
-      long n;
-      double p, q;
-
-      n = 0;
-      q = -(double) mean;
-      p = exp(q);
-      q = uniform(seed, 0, 1);
-      while (p < q) {
-            n++;
-            q = uniform(seed, 0, 1) * q;
-      }
-
-      return n;
-}
-
-static double chi_square(long *seed, long deg_of_free)
-{
-      double x;
-      long k;
-
-      if (deg_of_free % 2) {
-            x = normal(seed, 0, 1);
-            x = x * x;
-      } else {
-            x = 0.0;
-      }
-      for (k = 2; k <= deg_of_free; k = k + 2) {
-            x = x + 2 * exponential(seed, 1);
-      }
-
-      return x;
-}
-
-static double t( long *seed, long deg_of_free)
-{
-      double x, chi2, dv, root;
-
-      chi2 = chi_square(seed, deg_of_free);
-      dv = chi2 / (double) deg_of_free;
-      root = sqrt(dv);
-      x = normal(seed, 0, 1) / root;
-
-      return x;
-}
-
-static double erlangian(long *seed, long k, long mean)
-{
-      double x, a, b;
-      long i;
-
-      x = 1.0;
-      for (i = 1; i <= k; i++) {
-            x = x * uniform(seed, 0, 1);
-      }
-      a = (double) mean;
-      b = (double) k;
-      x = -a * log(x) / b;
-
-      return x;
-}
+/*
+ * The generators themselves are in the simulator (the vpip_dist_*
+ * functions), so that this module and the native implementations of
+ * these functions in vvp produce the same sequences.
+ */
 
 /* A seed can only be an integer/time variable or a register. */
 static unsigned is_seed_obj(vpiHandle obj, vpiHandle callh, const char *name)
@@ -524,8 +190,7 @@ static PLI_INT32 sys_random_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
 {
       vpiHandle callh, argv, seed = 0;
       s_vpi_value val;
-      static long i_seed = 0;
-      long a_seed;
+      long a_seed = 0;
 
       /* Get the argument list and look for a seed. If it is there,
          get the value and reseed the random number generator. */
@@ -537,17 +202,17 @@ static PLI_INT32 sys_random_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
             vpi_free_object(argv);
             vpi_get_value(seed, &val);
             a_seed = val.value.integer;
-      } else a_seed = i_seed;
+      }
 
       /* Calculate and return the result. */
-      val.value.integer = rtl_dist_uniform(&a_seed, INT_MIN, INT_MAX);
+      val.value.integer = vpip_random(seed ? &a_seed : 0);
       vpi_put_value(callh, &val, 0, vpiNoDelay);
 
       /* If it exists send the updated seed back to seed parameter. */
       if (seed) {
             val.value.integer = a_seed;
             vpi_put_value(seed, &val, 0, vpiNoDelay);
-      } else i_seed = a_seed;
+      }
 
       return 0;
 }
@@ -588,21 +253,6 @@ static PLI_INT32 sys_urandom_range_compiletf(ICARUS_VPI_CONST PLI_BYTE8 *name)
       return 0;
 }
 
-/* From System Verilog 3.1a. */
-static unsigned long urandom(long *seed, unsigned long max, unsigned long min)
-{
-      static long i_seed = 0;
-      unsigned long result;
-      long max_i, min_i;
-
-      max_i =  max + INT_MIN;
-      min_i =  min + INT_MIN;
-      if (seed != 0) i_seed = *seed;
-      result = rtl_dist_uniform(&i_seed, min_i, max_i) - INT_MIN;
-      if (seed != 0) *seed = i_seed;
-      return result;
-}
-
 /* From System Verilog 3.1a. */
 static PLI_INT32 sys_urandom_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
 {
@@ -624,9 +274,9 @@ static PLI_INT32 sys_urandom_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
 
       /* Calculate and return the result. */
       if (seed) {
-            val.value.integer = urandom(&i_seed, UINT_MAX, 0);
+            val.value.integer = vpip_urandom(&i_seed, UINT_MAX, 0);
       } else {
-            val.value.integer = urandom(0, UINT_MAX, 0);
+            val.value.integer = vpip_urandom(0, UINT_MAX, 0);
       }
       vpi_put_value(callh, &val, 0, vpiNoDelay);
 
@@ -667,7 +317,7 @@ static PLI_INT32 sys_urandom_range_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
       }
 
       /* Calculate and return the result. */
-      val.value.integer = urandom(0, i_maxval, i_minval);
+      val.value.integer = vpip_urandom(0, i_maxval, i_minval);
       vpi_put_value(callh, &val, 0, vpiNoDelay);
       vpi_free_object(argv);
       return 0;
@@ -697,7 +347,7 @@ static PLI_INT32 sys_dist_uniform_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
       i_end = val.value.integer;
 
       /* Calculate and return the result. */
-      val.value.integer = rtl_dist_uniform(&i_seed, i_start, i_end);
+      val.value.integer = vpip_dist_uniform(&i_seed, i_start, i_end);
       vpi_put_value(callh, &val, 0, vpiNoDelay);
 
       /* Return the seed. */
@@ -732,7 +382,7 @@ static PLI_INT32 sys_dist_normal_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
       i_sd = val.value.integer;
 
       /* Calculate and return the result. */
-      val.value.integer = rtl_dist_normal(&i_seed, i_mean, i_sd);
+      val.value.integer = vpip_dist_normal(&i_seed, i_mean, i_sd);
       vpi_put_value(callh, &val, 0, vpiNoDelay);
 
       /* Return the seed. */
@@ -763,7 +413,7 @@ static PLI_INT32 sys_dist_exponential_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
       i_mean = val.value.integer;
 
       /* Calculate and return the result. */
-      val.value.integer = rtl_dist_exponential(&i_seed, i_mean);
+      val.value.integer = vpip_dist_exponential(&i_seed, i_mean);
       vpi_put_value(callh, &val, 0, vpiNoDelay);
 
       /* Return the seed. */
@@ -794,7 +444,7 @@ static PLI_INT32 sys_dist_poisson_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
       i_mean = val.value.integer;
 
       /* Calculate and return the result. */
-      val.value.integer = rtl_dist_poisson(&i_seed, i_mean);
+      val.value.integer = vpip_dist_poisson(&i_seed, i_mean);
       vpi_put_value(callh, &val, 0, vpiNoDelay);
 
       /* Return the seed. */
@@ -825,7 +475,7 @@ static PLI_INT32 sys_dist_chi_square_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
       i_df = val.value.integer;
 
       /* Calculate and return the result. */
-      val.value.integer = rtl_dist_chi_square(&i_seed, i_df);
+      val.value.integer = vpip_dist_chi_square(&i_seed, i_df);
       vpi_put_value(callh, &val, 0, vpiNoDelay);
 
       /* Return the seed. */
@@ -856,7 +506,7 @@ static PLI_INT32 sys_dist_t_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
       i_df = val.value.integer;
 
       /* Calculate and return the result. */
-      val.value.integer = rtl_dist_t(&i_seed, i_df);
+      val.value.integer = vpip_dist_t(&i_seed, i_df);
       vpi_put_value(callh, &val, 0, vpiNoDelay);
 
       /* Return the seed. */
@@ -891,7 +541,7 @@ static PLI_INT32 sys_dist_erlang_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
       i_mean = val.value.integer;
 
       /* Calculate and return the result. */
-      val.value.integer = rtl_dist_erlang(&i_seed, i_k, i_mean);
+      val.value.integer = vpip_dist_erlang(&i_seed, i_k, i_mean);
       vpi_put_value(callh, &val, 0, vpiNoDelay);
 
       /* Return the seed. */
@@ -902,6 +552,83 @@ static PLI_INT32 sys_dist_erlang_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
       return 0;
 }
 
+/*
+ * $ivl_random_fill(mem [, seed]) fills every word of an array with the
+ * next value of $random (or $random(seed)), from the first word to
+ * the last. It gives the same values as a loop that assigns $random to
+ * each word, with one call for the whole array.
+ */
+static PLI_INT32 sys_random_fill_compiletf(ICARUS_VPI_CONST PLI_BYTE8 *name)
+{
+      vpiHandle callh = vpi_handle(vpiSysTfCall, 0);
+      vpiHandle argv = vpi_iterate(vpiArgument, callh);
+      vpiHandle mem, seed;
+
+      /* Check that there is an argument. */
+      if (argv == 0) {
+	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s requires an array argument.\n", name);
+	    vpi_control(vpiFinish, 1);
+	    return 0;
+      }
+
+      /* The first argument must be an array. */
+      mem = vpi_scan(argv);  /* This should never be zero. */
+      if (vpi_get(vpiType, mem) != vpiMemory) {
+	    vpi_printf("ERROR: %s:%d: ", vpi_get_str(vpiFile, callh),
+	               (int)vpi_get(vpiLineNo, callh));
+	    vpi_printf("%s's first argument must be an array.\n", name);
+	    vpi_control(vpiFinish, 1);
+	    return 0;
+      }
+
+      /* The seed is optional. */
+      seed = vpi_scan(argv);
+      if (seed == 0) return 0;
+
+      /* The seed must be a time/integer variable or a register. */
+      if (! is_seed_obj(seed, callh, name)) return 0;
+
+      /* Check that there is at most two arguments. */
+      check_for_extra_args(argv, callh, name, "two arguments", 1);
+
+      return 0;
+}
+
+static PLI_INT32 sys_random_fill_calltf(ICARUS_VPI_CONST PLI_BYTE8 *name)
+{
+      vpiHandle callh, argv, mem, seed, words, word;
+      s_vpi_value val;
+      long a_seed = 0;
+
+      callh = vpi_handle(vpiSysTfCall, 0);
+      argv = vpi_iterate(vpiArgument, callh);
+      mem = vpi_scan(argv);
+      seed = vpi_scan(argv);
+      if (seed) vpi_free_object(argv);
+
+      val.format = vpiIntVal;
+      if (seed) {
+            vpi_get_value(seed, &val);
+            a_seed = val.value.integer;
+      }
+
+      words = vpi_iterate(vpiMemoryWord, mem);
+      if (words) while ((word = vpi_scan(words))) {
+            val.value.integer = vpip_random(seed ? &a_seed : 0);
+            vpi_put_value(word, &val, 0, vpiNoDelay);
+      }
+
+      /* If it exists send the updated seed back to seed parameter. */
+      if (seed) {
+            val.value.integer = a_seed;
+            vpi_put_value(seed, &val, 0, vpiNoDelay);
+      }
+
+      return 0;
+}
+
 static PLI_INT32 sys_rand_func_sizetf(PLI_BYTE8 *x)
 {
       return 32;
@@ -1013,4 +740,13 @@ void sys_random_register()
       tf_data.user_data = "$dist_erlang";
       res = vpi_register_systf(&tf_data);
       vpip_make_systf_system_defined(res);
+
+      tf_data.type = vpiSysTask;
+      tf_data.tfname = "$ivl_random_fill";
+      tf_data.calltf = sys_random_fill_calltf;
+      tf_data.compiletf = sys_random_fill_compiletf;
+      tf_data.sizetf = 0;
+      tf_data.user_data = "$ivl_random_fill";
+      res = vpi_register_systf(&tf_data);
+      vpip_make_systf_system_defined(res);
 }
@@ -28,6 +28,7 @@ extern void sys_countdrivers_register();
 extern void sys_darray_register();
 extern void sys_fileio_register();
 extern void sys_finish_register();
+extern void sys_fork_register();
 extern void sys_deposit_register();
 extern void sys_display_register();
 extern void sys_plusargs_register();
@@ -201,6 +202,7 @@ void (*vlog_startup_routines[])() = {
       sys_darray_register,
       sys_fileio_register,
       sys_finish_register,
+      sys_fork_register,
       sys_deposit_register,
       sys_display_register,
       sys_plusargs_register,
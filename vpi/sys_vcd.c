@@ -264,6 +264,7 @@ static PLI_INT32 finish_cb(p_cb_data cause)
       }
 
       fclose(dump_file);
+      sys_dump_count_bytes(dump_path);
 
       for (cur = vcd_list ;  cur ;  cur = next) {
 	    next = cur->next;
@@ -396,6 +397,7 @@ static PLI_INT32 sys_dumpall_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
 static void open_dumpfile(vpiHandle callh)
 {
       if (dump_path == 0) dump_path = strdup("dump.vcd");
+      dump_path = sys_dump_fork_path(dump_path);
 
       dump_file = fopen(dump_path, "w");
 
@@ -855,11 +857,34 @@ static PLI_INT32 sys_dumpvars_calltf(ICARUS_VPI_CONST PLI_BYTE8*name)
       return 0;
 }
 
+/*
+ * A test of $ivl_fork_tests continues the dump in its own copy of
+ * the file.
+ */
+static PLI_INT32 vcd_fork(unsigned index)
+{
+      char *path;
+
+      if (index == 0 || dump_file == 0) return 0;
+
+      path = vpip_fork_file(dump_file, dump_path, "w");
+      if (path == 0) {
+	    vpi_printf("VCD Error: Unable to copy %s for test %u.\n",
+	               dump_path, index);
+	    exit(1);
+      }
+      free(dump_path);
+      dump_path = path;
+      return 0;
+}
+
 void sys_vcd_register()
 {
       s_vpi_systf_data tf_data;
       vpiHandle res;
 
+      sys_dump_fork_hook = vcd_fork;
+
       /* All the compiletf routines are located in vcd_priv.c. */
 
       tf_data.type      = vpiSysTask;
@@ -623,6 +623,43 @@ extern void vpip_set_return_value(int value);
 extern s_vpi_vecval vpip_calc_clog2(vpiHandle arg);
 extern void vpip_make_systf_system_defined(vpiHandle ref);
 
+  /* The IEEE 1364 $random and $dist_* generators, and the $urandom
+     generator of SystemVerilog. The seed is updated in place. For
+     vpip_random and vpip_urandom, a nil seed selects the internal
+     seed of the seedless $random or $urandom. */
+extern long vpip_dist_chi_square(long*seed, long df);
+extern long vpip_dist_erlang(long*seed, long k, long mean);
+extern long vpip_dist_exponential(long*seed, long mean);
+extern long vpip_dist_normal(long*seed, long mean, long sd);
+extern long vpip_dist_poisson(long*seed, long mean);
+extern long vpip_dist_t(long*seed, long df);
+extern long vpip_dist_uniform(long*seed, long start, long end);
+extern long vpip_random(long*seed);
+extern unsigned long vpip_urandom(long*seed, unsigned long max,
+                                  unsigned long min);
+
+  /* Ask the simulator to save its state in the named checkpoint file
+     at the end of the current time step. The $save system task uses
+     this, and "vvp -r <file>" resumes from the checkpoint. */
+extern void vpip_save_checkpoint(const char*path);
+
+  /* Fork the simulation into count tests, at most jobs at a time, or
+     one per processor if jobs is 0 (see $ivl_fork_tests). This returns the index (from 1) of the test in
+     each child, and 0 in the parent once all the tests have exited.
+     vpip_fork_index returns the index of the current test, or 0 in
+     the parent. In a test, vpip_fork_path returns the path of the
+     test's own copy of a file, and vpip_fork_file moves an open file
+     to it. Both return a string that the caller must free. */
+extern PLI_INT32 vpip_fork_tests(PLI_INT32 count, PLI_INT32 jobs,
+                                 const char*plusargs_path);
+extern PLI_INT32 vpip_fork_index(void);
+extern char* vpip_fork_path(const char*path);
+extern char* vpip_fork_file(FILE*fp, const char*path, const char*mode);
+
+  /* The waveform dumpers report the size of each dump file that
+     they write, for the +vvp-stats statistics. */
+extern void vpip_count_dump_bytes(PLI_UINT64 bytes);
+
   /* Return driver information for a net bit. The information is returned
      in the 'counts' array as follows:
        counts[0] - number of drivers driving '0' onto the net
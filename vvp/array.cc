@@ -23,6 +23,7 @@
 # include  "vpi_priv.h"
 # include  "vvp_net_sig.h"
 # include  "vvp_darray.h"
+# include  "checkpoint.h"
 # include  "config.h"
 #ifdef CHECK_WITH_VALGRIND
 #include  "vvp_cleanup.h"
@@ -241,6 +242,16 @@ unsigned get_array_word_size(vvp_array_t array)
       return width;
 }
 
+bool array_is_vec4_var(vvp_array_t array)
+{
+      return array->vals4 != 0 && array->array_count > 0;
+}
+
+vvp_array_t array_from_handle(vpiHandle obj)
+{
+      return dynamic_cast<__vpiArray*> (obj);
+}
+
 bool is_net_array(vpiHandle obj)
 {
       struct __vpiArray*rfp = dynamic_cast<__vpiArray*> (obj);
@@ -1150,6 +1161,103 @@ string array_get_word_str(vvp_array_t arr, unsigned address)
       return "";
 }
 
+/*
+ * A checkpoint holds the words of variable arrays. The words of an
+ * array of nets are separate signals, some of which may be
+ * variables, so those are saved one by one like the signals of a
+ * scope.
+ */
+enum array_checkpoint_e { ACK_VEC4 = 1, ACK_REAL, ACK_STR, ACK_ATOM, ACK_WORDS };
+
+static unsigned array_checkpoint_kind(vvp_array_t arr, unsigned long&count)
+{
+      if (arr->vals4) {
+	    count = arr->array_count;
+	    return ACK_VEC4;
+      }
+      if (arr->vals) {
+	    count = arr->vals->get_size();
+	    if (dynamic_cast<vvp_darray_real*>(arr->vals))
+		  return ACK_REAL;
+	    if (dynamic_cast<vvp_darray_string*>(arr->vals))
+		  return ACK_STR;
+	    return ACK_ATOM;
+      }
+      count = arr->nets? arr->array_count : 0;
+      return ACK_WORDS;
+}
+
+void array_checkpoint_save(vvp_array_t arr, checkpoint_out&out)
+{
+      unsigned long count;
+      unsigned kind = array_checkpoint_kind(arr, count);
+      out.put_uint(kind);
+      out.put_uint(count);
+
+      for (unsigned idx = 0 ; idx < count ; idx += 1) {
+	    switch (kind) {
+		case ACK_VEC4:
+		  out.put_vec4(arr->vals4->get_word(idx));
+		  break;
+		case ACK_REAL: {
+		      double val;
+		      arr->vals->get_word(idx, val);
+		      out.put_real(val);
+		      break;
+		}
+		case ACK_STR: {
+		      string val;
+		      arr->vals->get_word(idx, val);
+		      out.put_str(val);
+		      break;
+		}
+		case ACK_ATOM: {
+		      vvp_vector4_t val;
+		      arr->vals->get_word(idx, val);
+		      out.put_vec4(val);
+		      break;
+		}
+		case ACK_WORDS:
+		  checkpoint_save_var(out, arr->nets[idx]);
+		  break;
+	    }
+      }
+}
+
+void array_checkpoint_restore(vvp_array_t arr, checkpoint_in&in)
+{
+      unsigned long count;
+      unsigned kind = array_checkpoint_kind(arr, count);
+      if (in.get_uint() != kind || in.get_uint() != count) {
+	    in.corrupt("an array does not match the design");
+	    return;
+      }
+
+      for (unsigned idx = 0 ; idx < count && in.ok() ; idx += 1) {
+	    switch (kind) {
+		case ACK_VEC4:
+		case ACK_ATOM: {
+		      vvp_vector4_t val = in.get_vec4();
+		      if (val.size() != arr->vals_width) {
+			    in.corrupt("an array does not match the design");
+			    break;
+		      }
+		      array_set_word(arr, idx, 0, val);
+		      break;
+		}
+		case ACK_REAL:
+		  array_set_word(arr, idx, in.get_real());
+		  break;
+		case ACK_STR:
+		  array_set_word(arr, idx, in.get_str());
+		  break;
+		case ACK_WORDS:
+		  checkpoint_restore_var(in, arr->nets[idx]);
+		  break;
+	    }
+      }
+}
+
 static vpiHandle vpip_make_array(char*label, const char*name,
 				 int first_addr, int last_addr,
 				 bool signed_flag)
@@ -1482,6 +1590,10 @@ class vvp_fun_arrayport_aa  : public vvp_fun_arrayport, public automatic_hooks_s
 #ifdef CHECK_WITH_VALGRIND
       void free_instance(vvp_context_t context);
 #endif
+      size_t image_size() const;
+      void init_image(void*img) const;
+      void checkpoint_save(vvp_context_t context, checkpoint_out&out) const;
+      void checkpoint_restore(vvp_context_t context, checkpoint_in&in);
 
       void check_word_change(unsigned long addr);
 
@@ -1538,6 +1650,34 @@ void vvp_fun_arrayport_aa::free_instance(vvp_context_t context)
 }
 #endif
 
+size_t vvp_fun_arrayport_aa::image_size() const
+{
+      return sizeof(unsigned long);
+}
+
+void vvp_fun_arrayport_aa::init_image(void*img) const
+{
+      *static_cast<unsigned long*>(img) = addr_;
+}
+
+void vvp_fun_arrayport_aa::checkpoint_save(vvp_context_t context,
+					   checkpoint_out&out) const
+{
+      unsigned long*addr = static_cast<unsigned long*>
+            (vvp_get_context_item(context, context_idx_));
+
+      out.put_uint(*addr);
+}
+
+void vvp_fun_arrayport_aa::checkpoint_restore(vvp_context_t context,
+					      checkpoint_in&in)
+{
+      unsigned long*addr = static_cast<unsigned long*>
+            (vvp_get_context_item(context, context_idx_));
+
+      *addr = in.get_uint();
+}
+
 void vvp_fun_arrayport_aa::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
                                      vvp_context_t context)
 {
@@ -31,7 +31,12 @@ class value_callback;
  */
 extern vvp_array_t array_find(const char*label);
 extern unsigned get_array_word_size(vvp_array_t array);
+  /* True if the words are 4-state vector variables, which
+     array_set_word can write a whole word at a time. */
+extern bool array_is_vec4_var(vvp_array_t array);
 extern vpiHandle array_index_iterate(int code, vpiHandle ref);
+  /* Return the array that the handle is, or nil. */
+extern vvp_array_t array_from_handle(vpiHandle obj);
 
 extern void array_word_change(vvp_array_t array, unsigned long addr);
 
@@ -0,0 +1,779 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "checkpoint.h"
+# include  "compile.h"
+# include  "delay.h"
+# include  "dff.h"
+# include  "event.h"
+# include  "schedule.h"
+# include  "udp.h"
+# include  "vpi_priv.h"
+# include  "vvp_net_sig.h"
+# include  "config.h"
+# include  <cassert>
+# include  <cstdarg>
+# include  <cstdlib>
+# include  <cstring>
+# include  <map>
+
+using namespace std;
+
+/*
+ * The file starts with this magic string and a version number,
+ * followed by the path and hash of the design, and the simulation
+ * time. Then come the sections that the modules write: the values
+ * of the variables, the state of the functors, the outputs of the
+ * delays, the random seeds, the open files, the threads and finally
+ * the event queue. The version number is written again at the end,
+ * to catch a truncated file.
+ */
+static const char checkpoint_magic[8] = "VVPCKPT";
+static const uint64_t checkpoint_version = 3;
+
+/* These are the kinds of value records. */
+enum checkpoint_value_e { VAL_NET = 0, VAL_VEC4, VAL_REAL, VAL_STR, VAL_ARRAY };
+
+checkpoint_out::checkpoint_out(FILE*fd)
+: fd_(fd)
+{
+}
+
+void checkpoint_out::put_uint(uint64_t val)
+{
+      while (val >= 0x80) {
+	    fputc((int)(val & 0x7f) | 0x80, fd_);
+	    val >>= 7;
+      }
+      fputc((int)val, fd_);
+}
+
+void checkpoint_out::put_int(int64_t val)
+{
+	// Fold the sign into bit 0, so that small negative numbers
+	// are short too.
+      put_uint(((uint64_t)val << 1) ^ (uint64_t)(val >> 63));
+}
+
+void checkpoint_out::put_real(double val)
+{
+      uint64_t bits;
+      memcpy(&bits, &val, sizeof bits);
+      for (unsigned idx = 0 ; idx < 8 ; idx += 1)
+	    fputc((int)(bits >> 8*idx) & 0xff, fd_);
+}
+
+void checkpoint_out::put_str(const string&val)
+{
+      put_uint(val.size());
+      fwrite(val.data(), 1, val.size(), fd_);
+}
+
+void checkpoint_out::put_vec4(const vvp_vector4_t&val)
+{
+      unsigned wid = val.size();
+      put_uint(wid);
+      for (unsigned idx = 0 ; idx < wid ; idx += 4) {
+	    int byte = 0;
+	    for (unsigned bit = 0 ; bit < 4 && idx+bit < wid ; bit += 1)
+		  byte |= (int)val.value(idx+bit) << 2*bit;
+	    fputc(byte, fd_);
+      }
+}
+
+void checkpoint_out::put_vec8(const vvp_vector8_t&val)
+{
+      unsigned wid = val.size();
+      put_uint(wid);
+      for (unsigned idx = 0 ; idx < wid ; idx += 1)
+	    fputc(val.value(idx).raw(), fd_);
+}
+
+void checkpoint_out::refuse(const char*fmt, ...)
+{
+      if (! reason_.empty())
+	    return;
+
+      char buf[1024];
+      va_list ap;
+      va_start(ap, fmt);
+      vsnprintf(buf, sizeof buf, fmt, ap);
+      va_end(ap);
+      reason_ = buf;
+}
+
+checkpoint_in::checkpoint_in(FILE*fd)
+: fd_(fd)
+{
+}
+
+uint64_t checkpoint_in::get_uint()
+{
+      uint64_t res = 0;
+      for (unsigned shift = 0 ; shift < 64 ; shift += 7) {
+	    int byte = fgetc(fd_);
+	    if (byte == EOF) {
+		  corrupt("the file is truncated");
+		  return 0;
+	    }
+	    res |= (uint64_t)(byte & 0x7f) << shift;
+	    if ((byte & 0x80) == 0)
+		  return res;
+      }
+      corrupt("a number is malformed");
+      return 0;
+}
+
+int64_t checkpoint_in::get_int()
+{
+      uint64_t val = get_uint();
+      return (int64_t)(val >> 1) ^ -(int64_t)(val & 1);
+}
+
+double checkpoint_in::get_real()
+{
+      uint64_t bits = 0;
+      for (unsigned idx = 0 ; idx < 8 ; idx += 1) {
+	    int byte = fgetc(fd_);
+	    if (byte == EOF) {
+		  corrupt("the file is truncated");
+		  return 0.0;
+	    }
+	    bits |= (uint64_t)byte << 8*idx;
+      }
+
+      double res;
+      memcpy(&res, &bits, sizeof res);
+      return res;
+}
+
+string checkpoint_in::get_str()
+{
+      uint64_t len = get_uint();
+      if (len > 0x10000000) {
+	    corrupt("a string is too long");
+	    return string();
+      }
+
+      string res (len, 0);
+      if (len > 0 && fread(&res[0], 1, len, fd_) != len) {
+	    corrupt("the file is truncated");
+	    return string();
+      }
+      return res;
+}
+
+vvp_vector4_t checkpoint_in::get_vec4()
+{
+      uint64_t wid = get_uint();
+      if (wid > 0x10000000) {
+	    corrupt("a vector is too wide");
+	    return vvp_vector4_t();
+      }
+
+      vvp_vector4_t res (wid);
+      for (unsigned idx = 0 ; idx < wid ; idx += 4) {
+	    int byte = fgetc(fd_);
+	    if (byte == EOF) {
+		  corrupt("the file is truncated");
+		  return vvp_vector4_t();
+	    }
+	    for (unsigned bit = 0 ; bit < 4 && idx+bit < wid ; bit += 1)
+		  res.set_bit(idx+bit, (vvp_bit4_t) ((byte >> 2*bit) & 3));
+      }
+      return res;
+}
+
+vvp_vector8_t checkpoint_in::get_vec8()
+{
+      uint64_t wid = get_uint();
+      if (wid > 0x10000000) {
+	    corrupt("a vector is too wide");
+	    return vvp_vector8_t();
+      }
+
+      vvp_vector8_t res (wid);
+      for (unsigned idx = 0 ; idx < wid ; idx += 1) {
+	    int byte = fgetc(fd_);
+	    if (byte == EOF) {
+		  corrupt("the file is truncated");
+		  return vvp_vector8_t();
+	    }
+	    res.set_bit(idx, vvp_scalar_t((unsigned char)byte));
+      }
+      return res;
+}
+
+void checkpoint_in::corrupt(const char*what)
+{
+      if (reason_.empty())
+	    reason_ = what;
+}
+
+const char*checkpoint_design_path = 0;
+bool checkpoint_pending = false;
+
+/* This is the file that $save asked for. */
+static string checkpoint_save_path;
+
+/* These describe the checkpoint that -r is restoring. */
+static FILE*restore_fd = 0;
+static string restore_path;
+static uint64_t restore_hash = 0;
+static vvp_time64_t restore_time = 0;
+
+/*
+ * The scopes and the items of the scopes, in the order of a walk of
+ * the scope tree. The walk is the same in every run of a design, so
+ * the position of an object in these lists identifies it in the
+ * checkpoint file.
+ */
+static vector<struct __vpiScope*> scope_list;
+static vector<vpiHandle> item_list;
+static map<vvp_net_t*,unsigned long> net_index_map;
+static map<vvp_array_t,unsigned long> array_index_map;
+
+/* The functors with state of their own, in the order of compilation. */
+static vector<vvp_net_t*> functor_list;
+/* The delay functors, in the order of compilation. */
+static vector<vvp_net_t*> delay_list;
+
+class index_walker : public vpip_scope_walker {
+    public:
+      void visit_scope(struct __vpiScope*scope);
+      void visit_item(vpiHandle item);
+};
+
+void index_walker::visit_scope(struct __vpiScope*scope)
+{
+      scope_list.push_back(scope);
+}
+
+void index_walker::visit_item(vpiHandle item)
+{
+      item_list.push_back(item);
+      if (vvp_net_t*net = vpip_item_net(item))
+	    net_index_map[net] = item_list.size();
+      else if (vvp_array_t array = array_from_handle(item))
+	    array_index_map[array] = item_list.size();
+}
+
+static void build_index(void)
+{
+      scope_list.clear();
+      item_list.clear();
+      net_index_map.clear();
+      array_index_map.clear();
+
+      index_walker walker;
+      vpip_walk_scopes(walker);
+}
+
+unsigned long checkpoint_net_index(vvp_net_t*net)
+{
+      map<vvp_net_t*,unsigned long>::const_iterator cur = net_index_map.find(net);
+      if (cur == net_index_map.end())
+	    return 0;
+      return cur->second;
+}
+
+vvp_net_t* checkpoint_net(unsigned long idx)
+{
+      if (idx == 0 || idx > item_list.size())
+	    return 0;
+      return vpip_item_net(item_list[idx-1]);
+}
+
+unsigned long checkpoint_array_index(vvp_array_t array)
+{
+      map<vvp_array_t,unsigned long>::const_iterator cur = array_index_map.find(array);
+      if (cur == array_index_map.end())
+	    return 0;
+      return cur->second;
+}
+
+vvp_array_t checkpoint_array(unsigned long idx)
+{
+      if (idx == 0 || idx > item_list.size())
+	    return 0;
+      return array_from_handle(item_list[idx-1]);
+}
+
+struct __vpiScope* checkpoint_scope(unsigned long idx)
+{
+      if (idx == 0 || idx > scope_list.size())
+	    return 0;
+      return scope_list[idx-1];
+}
+
+void checkpoint_add_functor(vvp_net_t*net)
+{
+      functor_list.push_back(net);
+}
+
+void checkpoint_add_delay(vvp_net_t*net)
+{
+      delay_list.push_back(net);
+}
+
+/*
+ * Variables are saved by value. Nets are not: their drivers are
+ * (eventually) variables, so the restored variables drive the nets
+ * to their values again. A forced or continuously assigned signal
+ * cannot be saved this way, so refuse the checkpoint for those.
+ */
+void checkpoint_save_var(checkpoint_out&out, vpiHandle item)
+{
+      vvp_net_t*net = vpip_item_net(item);
+      if (net == 0) {
+	    out.put_uint(VAL_NET);
+	    return;
+      }
+
+      vvp_fun_signal_base*sig = dynamic_cast<vvp_fun_signal_base*>(net->fun);
+      if ((net->fil && net->fil->force_active())
+	  || (sig && sig->cassign_active())) {
+	    out.refuse("%s is forced or continuously assigned",
+		       vpi_get_str(vpiFullName, item));
+	    return;
+      }
+
+      if (vvp_fun_signal4_sa*fun4 = dynamic_cast<vvp_fun_signal4_sa*>(net->fun)) {
+	    out.put_uint(VAL_VEC4);
+	    out.put_vec4(fun4->vec4_unfiltered_value());
+
+      } else if (vvp_fun_signal_real_sa*funr = dynamic_cast<vvp_fun_signal_real_sa*>(net->fun)) {
+	    out.put_uint(VAL_REAL);
+	    out.put_real(funr->real_unfiltered_value());
+
+      } else if (vvp_fun_signal_string_sa*funs = dynamic_cast<vvp_fun_signal_string_sa*>(net->fun)) {
+	    out.put_uint(VAL_STR);
+	    out.put_str(funs->get_string());
+
+      } else if (vvp_fun_signal_object_sa*funo = dynamic_cast<vvp_fun_signal_object_sa*>(net->fun)) {
+	    if (! funo->get_object().test_nil()) {
+		  out.refuse("%s holds a class object or dynamic array",
+			     vpi_get_str(vpiFullName, item));
+		  return;
+	    }
+	    out.put_uint(VAL_NET);
+
+      } else {
+	    out.put_uint(VAL_NET);
+      }
+}
+
+void checkpoint_restore_var(checkpoint_in&in, vpiHandle item)
+{
+      vvp_net_t*net = vpip_item_net(item);
+      vvp_net_ptr_t ptr (net, 0);
+
+      switch (in.get_uint()) {
+	  case VAL_NET:
+	    break;
+
+	  case VAL_VEC4: {
+		vvp_vector4_t val = in.get_vec4();
+		vvp_fun_signal4_sa*fun = net? dynamic_cast<vvp_fun_signal4_sa*>(net->fun) : 0;
+		if (fun == 0 || fun->vec4_unfiltered_value().size() != val.size()) {
+		      in.corrupt("a vector variable does not match the design");
+		      break;
+		}
+		vvp_send_vec4(ptr, val, 0);
+		break;
+	  }
+
+	  case VAL_REAL: {
+		double val = in.get_real();
+		if (net == 0 || dynamic_cast<vvp_fun_signal_real_sa*>(net->fun) == 0) {
+		      in.corrupt("a real variable does not match the design");
+		      break;
+		}
+		vvp_send_real(ptr, val, 0);
+		break;
+	  }
+
+	  case VAL_STR: {
+		string val = in.get_str();
+		if (net == 0 || dynamic_cast<vvp_fun_signal_string_sa*>(net->fun) == 0) {
+		      in.corrupt("a string variable does not match the design");
+		      break;
+		}
+		vvp_send_string(ptr, val, 0);
+		break;
+	  }
+
+	  default:
+	    in.corrupt("a variable record is malformed");
+	    break;
+      }
+}
+
+static void save_values(checkpoint_out&out)
+{
+      for (unsigned long idx = 0 ; idx < item_list.size() && out.ok() ; idx += 1) {
+	    vpiHandle item = item_list[idx];
+	    if (vvp_array_t array = array_from_handle(item)) {
+		  out.put_uint(idx+1);
+		  out.put_uint(VAL_ARRAY);
+		  array_checkpoint_save(array, out);
+		  continue;
+	    }
+
+	    if (vpip_item_net(item) == 0)
+		  continue;
+
+	    out.put_uint(idx+1);
+	    checkpoint_save_var(out, item);
+      }
+      out.put_uint(0);
+}
+
+static void restore_values(checkpoint_in&in)
+{
+      while (in.ok()) {
+	    unsigned long idx = in.get_uint();
+	    if (idx == 0)
+		  break;
+	    if (idx > item_list.size()) {
+		  in.corrupt("a variable is not in the design");
+		  break;
+	    }
+
+	    vpiHandle item = item_list[idx-1];
+	    if (vvp_array_t array = array_from_handle(item)) {
+		  if (in.get_uint() != VAL_ARRAY) {
+			in.corrupt("an array does not match the design");
+			break;
+		  }
+		  array_checkpoint_restore(array, in);
+		  continue;
+	    }
+
+	    checkpoint_restore_var(in, item);
+      }
+}
+
+/*
+ * The flip-flops and sequential UDPs remember their output (and the
+ * flip-flops their clock) so that is saved after the values. The
+ * restored values may clock them, so their state is restored after
+ * the values, and only then are the outputs sent, in case one of
+ * these functors feeds another.
+ */
+static void save_functors(checkpoint_out&out)
+{
+      out.put_uint(functor_list.size());
+      for (size_t idx = 0 ; idx < functor_list.size() ; idx += 1) {
+	    vvp_net_fun_t*fun = functor_list[idx]->fun;
+	    if (vvp_dff*dff = dynamic_cast<vvp_dff*>(fun))
+		  dff->checkpoint_save(out);
+	    else if (vvp_udp_fun_core*udp = dynamic_cast<vvp_udp_fun_core*>(fun))
+		  udp->checkpoint_save(out);
+	    else
+		  assert(0);
+      }
+}
+
+static void restore_functors(checkpoint_in&in)
+{
+      if (in.get_uint() != functor_list.size()) {
+	    in.corrupt("the flip-flops and UDPs do not match the design");
+	    return;
+      }
+
+      for (size_t idx = 0 ; idx < functor_list.size() && in.ok() ; idx += 1) {
+	    vvp_net_fun_t*fun = functor_list[idx]->fun;
+	    if (vvp_dff*dff = dynamic_cast<vvp_dff*>(fun))
+		  dff->checkpoint_restore(in);
+	    else if (vvp_udp_fun_core*udp = dynamic_cast<vvp_udp_fun_core*>(fun))
+		  udp->checkpoint_restore(in);
+	    else
+		  assert(0);
+      }
+      if (! in.ok())
+	    return;
+
+      for (size_t idx = 0 ; idx < functor_list.size() ; idx += 1) {
+	    vvp_net_fun_t*fun = functor_list[idx]->fun;
+	    if (vvp_dff*dff = dynamic_cast<vvp_dff*>(fun))
+		  dff->checkpoint_send(functor_list[idx]);
+	    else if (vvp_udp_fun_core*udp = dynamic_cast<vvp_udp_fun_core*>(fun))
+		  udp->checkpoint_send();
+      }
+}
+
+/*
+ * The restored values drive the inputs of the delays, and the
+ * delays schedule the change of their outputs for later, as if the
+ * inputs had just changed. So the delays are restored after the
+ * values have settled: they drop those changes and drive their saved
+ * outputs at once. That way a net behind a delay has the same value
+ * as when it was saved, and threads that wait on it do not see a
+ * change that did not happen in the saved run.
+ */
+static void save_delays(checkpoint_out&out)
+{
+      out.put_uint(delay_list.size());
+      for (size_t idx = 0 ; idx < delay_list.size() ; idx += 1) {
+	    vvp_net_fun_t*fun = delay_list[idx]->fun;
+	    if (vvp_fun_delay*del = dynamic_cast<vvp_fun_delay*>(fun))
+		  del->checkpoint_save(out);
+	    else if (vvp_fun_modpath*path = dynamic_cast<vvp_fun_modpath*>(fun))
+		  path->checkpoint_save(out);
+	    else
+		  assert(0);
+      }
+}
+
+static void restore_delays(checkpoint_in&in)
+{
+      if (in.get_uint() != delay_list.size()) {
+	    in.corrupt("the delays do not match the design");
+	    return;
+      }
+
+      for (size_t idx = 0 ; idx < delay_list.size() && in.ok() ; idx += 1) {
+	    vvp_net_fun_t*fun = delay_list[idx]->fun;
+	    if (vvp_fun_delay*del = dynamic_cast<vvp_fun_delay*>(fun))
+		  del->checkpoint_restore(in);
+	    else if (vvp_fun_modpath*path = dynamic_cast<vvp_fun_modpath*>(fun))
+		  path->checkpoint_restore(in);
+	    else
+		  assert(0);
+      }
+      if (! in.ok())
+	    return;
+
+      for (size_t idx = 0 ; idx < delay_list.size() ; idx += 1) {
+	    vvp_net_fun_t*fun = delay_list[idx]->fun;
+	    if (vvp_fun_delay*del = dynamic_cast<vvp_fun_delay*>(fun))
+		  del->checkpoint_send();
+	    else if (vvp_fun_modpath*path = dynamic_cast<vvp_fun_modpath*>(fun))
+		  path->checkpoint_send();
+      }
+}
+
+/*
+ * The checkpoint is only good for the design that made it, so the
+ * header holds a hash (64 bit FNV-1a) of the design file.
+ */
+static bool design_hash(const char*path, uint64_t&hash)
+{
+      FILE*fd = fopen(path, "rb");
+      if (fd == 0)
+	    return false;
+
+      hash = 0xcbf29ce484222325ULL;
+      unsigned char buf[8192];
+      size_t cnt;
+      while ((cnt = fread(buf, 1, sizeof buf, fd)) > 0) {
+	    for (size_t idx = 0 ; idx < cnt ; idx += 1) {
+		  hash ^= buf[idx];
+		  hash *= 0x100000001b3ULL;
+	    }
+      }
+      fclose(fd);
+      return true;
+}
+
+/*
+ * The $save system task calls this to ask for a checkpoint. The
+ * state is saved by the scheduler at the end of the time step, when
+ * no thread is running and the only events left are in the future.
+ */
+extern "C" void vpip_save_checkpoint(const char*path)
+{
+      checkpoint_save_path = path;
+      checkpoint_pending = true;
+}
+
+void checkpoint_save(void)
+{
+      checkpoint_pending = false;
+
+      const char*path = checkpoint_save_path.c_str();
+      uint64_t hash;
+      if (checkpoint_design_path == 0
+	  || ! design_hash(checkpoint_design_path, hash)) {
+	    vpi_printf("ERROR: $save: Unable to read the design file, "
+		       "checkpoint %s is not written.\n", path);
+	    return;
+      }
+
+	/* Write a temporary file, and only replace the checkpoint if
+	   all of the state could be saved. */
+      string tmp_path = checkpoint_save_path + ".tmp";
+      FILE*fd = fopen(tmp_path.c_str(), "wb");
+      if (fd == 0) {
+	    vpi_printf("ERROR: $save: Unable to open %s for writing.\n",
+		       tmp_path.c_str());
+	    return;
+      }
+
+      build_index();
+
+      checkpoint_out out (fd);
+      fwrite(checkpoint_magic, 1, sizeof checkpoint_magic, fd);
+      out.put_uint(checkpoint_version);
+      out.put_str(checkpoint_design_path);
+      out.put_uint(hash);
+      out.put_uint(schedule_simtime());
+
+      if (evctl::pending_count > 0)
+	    out.refuse("an intra-assignment event control is pending");
+
+      if (out.ok()) save_values(out);
+      if (out.ok()) save_functors(out);
+      if (out.ok()) save_delays(out);
+      if (out.ok()) vpip_random_checkpoint_save(out);
+      if (out.ok()) vpip_mcd_checkpoint_save(out);
+      if (out.ok()) vthread_checkpoint_save(out, scope_list);
+      if (out.ok()) schedule_checkpoint_save(out);
+      out.put_uint(checkpoint_version);
+
+      bool write_error = ferror(fd) != 0;
+      if (fclose(fd) != 0)
+	    write_error = true;
+
+      if (! out.ok() || write_error) {
+	    remove(tmp_path.c_str());
+	    if (out.ok())
+		  vpi_printf("ERROR: $save: Error writing %s.\n", path);
+	    else
+		  vpi_printf("ERROR: $save: The state at time %" TIME_FMT_U
+			     " cannot be saved because %s.\n",
+			     schedule_simtime(), out.reason().c_str());
+	    return;
+      }
+
+      if (rename(tmp_path.c_str(), path) != 0) {
+	      // Some systems do not rename over an existing file.
+	    remove(path);
+	    if (rename(tmp_path.c_str(), path) != 0) {
+		  vpi_printf("ERROR: $save: Unable to create %s.\n", path);
+		  remove(tmp_path.c_str());
+		  return;
+	    }
+      }
+
+      if (verbose_flag)
+	    vpi_mcd_printf(1, " ... saved checkpoint %s at time %" TIME_FMT_U
+			   "\n", path, schedule_simtime());
+}
+
+bool checkpoint_open(const char*path, string&design)
+{
+      FILE*fd = fopen(path, "rb");
+      if (fd == 0) {
+	    perror(path);
+	    return false;
+      }
+
+      char magic[sizeof checkpoint_magic];
+      if (fread(magic, 1, sizeof magic, fd) != sizeof magic
+	  || memcmp(magic, checkpoint_magic, sizeof magic) != 0) {
+	    fprintf(stderr, "%s: Not a vvp checkpoint file.\n", path);
+	    fclose(fd);
+	    return false;
+      }
+
+      checkpoint_in in (fd);
+      if (in.get_uint() != checkpoint_version) {
+	    fprintf(stderr, "%s: Checkpoint is from an incompatible "
+		    "version of vvp.\n", path);
+	    fclose(fd);
+	    return false;
+      }
+
+      design = in.get_str();
+      restore_hash = in.get_uint();
+      restore_time = in.get_uint();
+      if (! in.ok()) {
+	    fprintf(stderr, "%s: Damaged checkpoint file: %s.\n", path,
+		    in.reason().c_str());
+	    fclose(fd);
+	    return false;
+      }
+
+      restore_fd = fd;
+      restore_path = path;
+      return true;
+}
+
+bool checkpoint_restoring(void)
+{
+      return restore_fd != 0;
+}
+
+/*
+ * The scheduler calls this after the initialization events, so the
+ * netlist is settled at its time 0 values. Throw away the threads
+ * that the compiler made, set the variables and the functors and let
+ * the values ripple through the netlist, then set the outputs of the
+ * delays and let those ripple too, and only then put back the
+ * threads and the events. That way the restored values do not wake
+ * any of the restored threads.
+ */
+bool checkpoint_restore(void)
+{
+      FILE*fd = restore_fd;
+      restore_fd = 0;
+
+      uint64_t hash;
+      if (! design_hash(checkpoint_design_path, hash) || hash != restore_hash) {
+	    fprintf(stderr, "%s: Checkpoint was not made from %s.\n",
+		    restore_path.c_str(), checkpoint_design_path);
+	    fclose(fd);
+	    return false;
+      }
+
+      build_index();
+
+      schedule_checkpoint_discard(restore_time);
+      vthread_checkpoint_discard(scope_list);
+
+      checkpoint_in in (fd);
+      restore_values(in);
+      if (in.ok()) restore_functors(in);
+      schedule_checkpoint_settle();
+      if (in.ok()) restore_delays(in);
+      schedule_checkpoint_settle();
+
+      if (in.ok()) vpip_random_checkpoint_restore(in);
+      if (in.ok()) vpip_mcd_checkpoint_restore(in);
+      if (in.ok()) vthread_checkpoint_restore(in);
+      if (in.ok()) schedule_checkpoint_restore(in);
+      if (in.ok() && in.get_uint() != checkpoint_version)
+	    in.corrupt("the file is damaged");
+
+      fclose(fd);
+
+      if (! in.ok()) {
+	    fprintf(stderr, "%s: Unable to restore checkpoint: %s.\n",
+		    restore_path.c_str(), in.reason().c_str());
+	    return false;
+      }
+
+      if (verbose_flag)
+	    vpi_mcd_printf(1, " ... restored checkpoint %s at time %"
+			   TIME_FMT_U "\n", restore_path.c_str(), restore_time);
+
+      return true;
+}
@@ -0,0 +1,176 @@
+#ifndef __checkpoint_H
+#define __checkpoint_H
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "vvp_net.h"
+# include  "array.h"
+# include  "vthread.h"
+# include  <cstdio>
+# include  <string>
+# include  <vector>
+
+/*
+ * A checkpoint holds the state of a simulation at the end of a time
+ * step, so that a later run of the same design can resume from that
+ * point instead of from time 0. The $save system task asks for a
+ * checkpoint, and "vvp -r <file>" restores one.
+ *
+ * The file does not hold the design. It holds the values of the
+ * variables and memories, the state of the flip-flops and sequential
+ * UDPs, the outputs of the delays, the threads and their automatic
+ * contexts, the pending events and the open files, and refers to the
+ * objects of the design by their position in the (deterministic)
+ * compiled design. The header holds
+ * a hash of the .vvp file, so that a checkpoint is only restored
+ * into the design that made it.
+ *
+ * The checkpoint_out and checkpoint_in classes are the stream
+ * formats. Integers are written as variable length (7 bits per
+ * byte) numbers and vectors are packed 4 bits per byte (strength
+ * vectors 1 byte per bit), so the file is about the size of the
+ * state it holds.
+ */
+class checkpoint_out {
+
+    public:
+      explicit checkpoint_out(FILE*fd);
+
+      void put_uint(uint64_t val);
+      void put_int(int64_t val);
+      void put_real(double val);
+      void put_str(const std::string&val);
+      void put_vec4(const vvp_vector4_t&val);
+      void put_vec8(const vvp_vector8_t&val);
+
+	// Some state cannot be saved. The module that finds such
+	// state calls refuse() with the reason, and the checkpoint
+	// is abandoned. Only the first reason is kept.
+      void refuse(const char*fmt, ...) __attribute__((format(printf,2,3)));
+      bool ok() const { return reason_.empty(); }
+      const std::string& reason() const { return reason_; }
+
+    private:
+      FILE*fd_;
+      std::string reason_;
+};
+
+class checkpoint_in {
+
+    public:
+      explicit checkpoint_in(FILE*fd);
+
+      uint64_t get_uint();
+      int64_t get_int();
+      double get_real();
+      std::string get_str();
+      vvp_vector4_t get_vec4();
+      vvp_vector8_t get_vec8();
+
+	// A reader that finds data that does not fit the design
+	// marks the stream as corrupt. Only the first reason is kept.
+      void corrupt(const char*what);
+      bool ok() const { return reason_.empty(); }
+      const std::string& reason() const { return reason_; }
+
+    private:
+      FILE*fd_;
+      std::string reason_;
+};
+
+/*
+ * The main program sets the path of the design file so that the
+ * checkpoint can record (and later check) it. The -r flag calls
+ * checkpoint_open, which reads the header and returns the design
+ * path saved in it. The scheduler then calls checkpoint_restore
+ * after the initialization events, and checkpoint_save at the end of
+ * a time step if checkpoint_pending is set by $save.
+ */
+extern const char*checkpoint_design_path;
+extern bool checkpoint_pending;
+
+extern bool checkpoint_open(const char*path, std::string&design);
+extern bool checkpoint_restoring(void);
+extern bool checkpoint_restore(void);
+extern void checkpoint_save(void);
+
+/*
+ * The variables, memories and scopes of the design are numbered (from
+ * 1) in the order of a walk of the scope tree. These map the objects
+ * that events and threads refer to, to and from those numbers. A 0
+ * index means the object is not one that the checkpoint knows.
+ */
+extern unsigned long checkpoint_net_index(vvp_net_t*net);
+extern vvp_net_t* checkpoint_net(unsigned long idx);
+extern unsigned long checkpoint_array_index(vvp_array_t array);
+extern vvp_array_t checkpoint_array(unsigned long idx);
+extern struct __vpiScope* checkpoint_scope(unsigned long idx);
+
+/*
+ * The functors that hold state of their own (flip-flops and
+ * sequential UDPs) are not in the scopes. The compiler registers
+ * them here, and they are numbered in the order of the registration.
+ */
+extern void checkpoint_add_functor(vvp_net_t*net);
+
+/*
+ * The delay functors (net and gate delays and module paths) are
+ * registered the same way. A checkpoint is only taken when none of
+ * them has a change pending, so their output is all that is saved.
+ * When the restored values have settled, each one cancels the
+ * changes that the restored values scheduled and drives its saved
+ * output with no delay.
+ */
+extern void checkpoint_add_delay(vvp_net_t*net);
+
+/*
+ * Save and restore the value of a variable, which may be an item of
+ * a scope or a word of an array. Nets are recorded as nets but their
+ * values are not saved. The restored variables drive them again.
+ */
+extern void checkpoint_save_var(checkpoint_out&out, vpiHandle item);
+extern void checkpoint_restore_var(checkpoint_in&in, vpiHandle item);
+
+/*
+ * Each module that holds simulation state saves and restores it
+ * with these functions.
+ */
+extern void array_checkpoint_save(vvp_array_t array, checkpoint_out&out);
+extern void array_checkpoint_restore(vvp_array_t array, checkpoint_in&in);
+
+extern void vthread_checkpoint_discard(const std::vector<struct __vpiScope*>&scopes);
+extern void vthread_checkpoint_save(checkpoint_out&out,
+				    const std::vector<struct __vpiScope*>&scopes);
+extern void vthread_checkpoint_restore(checkpoint_in&in);
+extern unsigned long vthread_checkpoint_id(vthread_t thr);
+extern vthread_t vthread_checkpoint_thread(unsigned long id);
+
+extern void schedule_checkpoint_discard(vvp_time64_t now);
+extern void schedule_checkpoint_settle(void);
+extern void schedule_checkpoint_cancel(struct vvp_gen_event_s*obj);
+extern void schedule_checkpoint_save(checkpoint_out&out);
+extern void schedule_checkpoint_restore(checkpoint_in&in);
+
+extern void vpip_mcd_checkpoint_save(checkpoint_out&out);
+extern void vpip_mcd_checkpoint_restore(checkpoint_in&in);
+
+extern void vpip_random_checkpoint_save(checkpoint_out&out);
+extern void vpip_random_checkpoint_restore(checkpoint_in&in);
+
+#endif
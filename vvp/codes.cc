@@ -96,6 +96,34 @@ vvp_code_t codespace_null(void)
       return first_chunk + 0;
 }
 
+unsigned long codespace_index(vvp_code_t ptr)
+{
+      unsigned long base = 0;
+      for (vvp_code_t cur = first_chunk ; cur ; cur = cur[code_chunk_size-1].cptr) {
+	    if (ptr >= cur && ptr < cur+code_chunk_size)
+		  return base + (ptr - cur);
+	    base += code_chunk_size;
+      }
+
+      assert(0);
+      return 0;
+}
+
+vvp_code_t codespace_at(unsigned long idx)
+{
+      vvp_code_t cur = first_chunk;
+      while (cur && idx >= code_chunk_size) {
+	    cur = cur[code_chunk_size-1].cptr;
+	    idx -= code_chunk_size;
+      }
+
+      if (cur == 0)
+	    return 0;
+      if (cur == current_chunk && idx >= current_within_chunk)
+	    return 0;
+      return cur + idx;
+}
+
 #ifdef CHECK_WITH_VALGRIND
 void codespace_delete(void)
 {
@@ -118,7 +146,6 @@ void codespace_delete(void)
 		  } else if ((cur+idx)->opcode == &of_FILE_LINE) {
 			delete((cur+idx)->handle);
 		  } else if (((cur+idx)->opcode == &of_CONCATI_STR) ||
-		             ((cur+idx)->opcode == &of_NEW_DARRAY) ||
 		             ((cur+idx)->opcode == &of_PUSHI_STR)) {
 			delete [] ((cur+idx)->text);
 		  }
@@ -60,6 +60,7 @@ extern bool of_ASSIGN_X0(vthread_t thr, vvp_code_t code);
 extern bool of_BLEND(vthread_t thr, vvp_code_t code);
 extern bool of_BLEND_WR(vthread_t thr, vvp_code_t code);
 extern bool of_BREAKPOINT(vthread_t thr, vvp_code_t code);
+extern bool of_CALL(vthread_t thr, vvp_code_t code);
 extern bool of_CASSIGN_LINK(vthread_t thr, vvp_code_t code);
 extern bool of_CASSIGN_V(vthread_t thr, vvp_code_t code);
 extern bool of_CASSIGN_WR(vthread_t thr, vvp_code_t code);
@@ -263,4 +264,12 @@ extern vvp_code_t codespace_allocate(void);
 extern vvp_code_t codespace_next(void);
 extern vvp_code_t codespace_null(void);
 
+/*
+ * Checkpoints refer to instructions by their index in the code
+ * space, which is the same in every run of a design. The
+ * codespace_at function returns nil for an index past the end.
+ */
+extern unsigned long codespace_index(vvp_code_t ptr);
+extern vvp_code_t codespace_at(unsigned long idx);
+
 #endif
@@ -31,6 +31,8 @@
 # include  "vpi_priv.h"
 # include  "parse_misc.h"
 # include  "statistics.h"
+# include  "vvp_darray.h"
+# include  "checkpoint.h"
 # include  "schedule.h"
 # include  <iostream>
 # include  <list>
@@ -72,7 +74,9 @@ enum operand_e {
 	/* The operand is a VPI handle */
       OA_VPI_PTR,
 	/* String */
-      OA_STRING
+      OA_STRING,
+	/* Element type string of a darray */
+      OA_DAR_TYPE
 };
 
 struct opcode_table_s {
@@ -111,6 +115,7 @@ static const struct opcode_table_s opcode_table[] = {
       { "%blend",    of_BLEND,   3,  {OA_BIT1,  OA_BIT2,     OA_NUMBER} },
       { "%blend/wr", of_BLEND_WR,0,  {OA_NONE,  OA_NONE,     OA_NONE} },
       { "%breakpoint", of_BREAKPOINT, 0,  {OA_NONE, OA_NONE, OA_NONE} },
+      { "%call",   of_CALL,   1,  {OA_CODE_PTR, OA_NONE,     OA_NONE} },
       { "%cassign/link",of_CASSIGN_LINK,2,{OA_FUNC_PTR,OA_FUNC_PTR2,OA_NONE} },
       { "%cassign/v",of_CASSIGN_V,3,{OA_FUNC_PTR,OA_BIT1,    OA_BIT2} },
       { "%cassign/wr",of_CASSIGN_WR,1,{OA_FUNC_PTR,OA_NONE,  OA_NONE} },
@@ -201,7 +206,7 @@ static const struct opcode_table_s opcode_table[] = {
       { "%nand",   of_NAND,   3,  {OA_BIT1,     OA_BIT2,     OA_NUMBER} },
       { "%nand/r", of_NANDR,  3,  {OA_BIT1,     OA_BIT2,     OA_NUMBER} },
       { "%new/cobj",  of_NEW_COBJ,  1, {OA_VPI_PTR,OA_NONE,  OA_NONE} },
-      { "%new/darray",of_NEW_DARRAY,2, {OA_BIT1,   OA_STRING,OA_NONE} },
+      { "%new/darray",of_NEW_DARRAY,2, {OA_BIT1,   OA_DAR_TYPE,OA_NONE} },
       { "%noop",   of_NOOP,   0,  {OA_NONE,     OA_NONE,     OA_NONE} },
       { "%nor",    of_NOR,    3,  {OA_BIT1,     OA_BIT2,     OA_NUMBER} },
       { "%nor/r",  of_NORR,   3,  {OA_BIT1,     OA_BIT2,     OA_NUMBER} },
@@ -749,6 +754,14 @@ void compile_cleanup(void)
       compile_island_cleanup();
       compile_array_cleanup();
 
+      if (levelize_flag) {
+	    if (verbose_flag) {
+		  fprintf(stderr, " ... Levelizing logic\n");
+		  fflush(stderr);
+	    }
+	    compile_levelize_gates();
+      }
+
       if (verbose_flag) {
 	    fprintf(stderr, " ... Compiletf functions\n");
 	    fflush(stderr);
@@ -1346,6 +1359,7 @@ void compile_delay(char*label, unsigned width,
       vvp_net_t*net = new vvp_net_t;
       vvp_fun_delay*obj = new vvp_fun_delay(net, width, *delay);
       net->fun = obj;
+      checkpoint_add_delay(net);
 
       delete delay;
 
@@ -1363,6 +1377,7 @@ void compile_delay(char*label, unsigned width,
       vvp_net_t*net = new vvp_net_t;
       vvp_fun_delay*obj = new vvp_fun_delay(net, width, stub);
       net->fun = obj;
+      checkpoint_add_delay(net);
 
       inputs_connect(net, argc, argv);
       free(argv);
@@ -1394,6 +1409,7 @@ struct __vpiModPath* compile_modpath(char*label, unsigned width,
       vvp_net_t*net = new vvp_net_t;
       vvp_fun_modpath*obj = new vvp_fun_modpath(net, width);
       net->fun = obj;
+      checkpoint_add_delay(net);
 
       input_connect(net, 0, drv.text);
 
@@ -1740,6 +1756,22 @@ void compile_code(char*label, char*mnem, comp_operands_t opa)
 
 		  code->text = opa->argv[idx].text;
 		  break;
+
+		case OA_DAR_TYPE:
+		  if (opa->argv[idx].ltype != L_STRING) {
+			yyerror("operand format");
+			break;
+		  }
+
+		    /* Resolve the element type now, so that the
+		       instruction does not parse it every time. */
+		  code->number = vvp_darray_type_code(opa->argv[idx].text);
+		  if (code->number == 0) {
+			yyerror("invalid darray element type");
+			compile_errors += 1;
+		  }
+		  delete[]opa->argv[idx].text;
+		  break;
 	    }
       }
 
@@ -19,6 +19,7 @@
 
 #include "delay.h"
 #include "schedule.h"
+#include "checkpoint.h"
 #include "vpi_priv.h"
 #include "config.h"
 #ifdef CHECK_WITH_VALGRIND
@@ -159,7 +160,12 @@ vvp_fun_delay::vvp_fun_delay(vvp_net_t*n, unsigned width, const vvp_delay_t&d)
       } else {
             schedule_init_propagate(net_, cur_real_);
       }
-      list_ = 0;
+      ring_ = 0;
+      ring_size_ = 0;
+      ring_head_ = 0;
+      ring_count_ = 0;
+      wake_time_ = 0;
+      wake_pending_ = false;
       type_ = UNKNOWN_DELAY;
       initial_ = true;
 	// Calculate the values used when converting variable delays
@@ -177,18 +183,53 @@ vvp_fun_delay::vvp_fun_delay(vvp_net_t*n, unsigned width, const vvp_delay_t&d)
 
 vvp_fun_delay::~vvp_fun_delay()
 {
-      while (struct event_*cur = dequeue_())
-	    delete cur;
+      delete[] ring_;
+}
+
+vvp_fun_delay::event_& vvp_fun_delay::enqueue_(vvp_time64_t sim_time)
+{
+      if (ring_count_ == ring_size_) {
+	    unsigned new_size = ring_size_? 2*ring_size_ : 4;
+	    struct event_*tmp = new struct event_[new_size];
+	    for (unsigned idx = 0 ;  idx < ring_count_ ;  idx += 1)
+		  tmp[idx] = ring_[(ring_head_+idx) & (ring_size_-1)];
+	    delete[] ring_;
+	    ring_ = tmp;
+	    ring_size_ = new_size;
+	    ring_head_ = 0;
+      }
+
+      struct event_&cur = ring_[(ring_head_+ring_count_) & (ring_size_-1)];
+      ring_count_ += 1;
+      cur.sim_time = sim_time;
+      return cur;
+}
+
+/*
+ * Schedule the event that will propagate a change use_delay from
+ * now. The run_run method propagates all the changes that are due,
+ * so if the latest wakeup is already for the same time, then that
+ * wakeup will take this change as well.
+ */
+void vvp_fun_delay::schedule_wakeup_(vvp_time64_t use_delay)
+{
+      vvp_time64_t use_simtime = schedule_simtime() + use_delay;
+      if (wake_pending_ && wake_time_ == use_simtime)
+	    return;
+
+      wake_time_ = use_simtime;
+      wake_pending_ = true;
+      schedule_generic(this, use_delay, false);
 }
 
 bool vvp_fun_delay::clean_pulse_events_(vvp_time64_t use_delay,
                                         const vvp_vector4_t&bit)
 {
-      if (list_ == 0) return false;
+      if (ring_count_ == 0) return false;
 
 	/* If the most recent event and the new event have the same
 	 * value then we need to skip the new event. */
-      if (list_->next->ptr_vec4.eeq(bit)) return true;
+      if (head_().ptr_vec4.eeq(bit)) return true;
 
       clean_pulse_events_(use_delay);
       return false;
@@ -197,11 +238,11 @@ bool vvp_fun_delay::clean_pulse_events_(vvp_time64_t use_delay,
 bool vvp_fun_delay::clean_pulse_events_(vvp_time64_t use_delay,
                                         const vvp_vector8_t&bit)
 {
-      if (list_ == 0) return false;
+      if (ring_count_ == 0) return false;
 
 	/* If the most recent event and the new event have the same
 	 * value then we need to skip the new event. */
-      if (list_->next->ptr_vec8.eeq(bit)) return true;
+      if (head_().ptr_vec8.eeq(bit)) return true;
 
       clean_pulse_events_(use_delay);
       return false;
@@ -210,11 +251,11 @@ bool vvp_fun_delay::clean_pulse_events_(vvp_time64_t use_delay,
 bool vvp_fun_delay::clean_pulse_events_(vvp_time64_t use_delay,
                                         double bit)
 {
-      if (list_ == 0) return false;
+      if (ring_count_ == 0) return false;
 
 	/* If the most recent event and the new event have the same
 	 * value then we need to skip the new event. */
-      if (list_->next->ptr_real == bit) return true;
+      if (head_().ptr_real == bit) return true;
 
       clean_pulse_events_(use_delay);
       return false;
@@ -222,22 +263,20 @@ bool vvp_fun_delay::clean_pulse_events_(vvp_time64_t use_delay,
 
 void vvp_fun_delay::clean_pulse_events_(vvp_time64_t use_delay)
 {
-      assert(list_ != 0);
+      assert(ring_count_ != 0);
 
       do {
-	    struct event_*cur = list_->next;
 	      /* If this event is far enough from the event I'm about
 	         to create, then that scheduled event is not a pulse
-	         to be eliminated, so we're done. */
-	    if (cur->sim_time+use_delay <= use_delay+schedule_simtime())
+	         to be eliminated, so we're done. Cancelled events
+	         just release their slot. The wakeup that was
+	         scheduled for them finds nothing due and does
+	         nothing. */
+	    if (head_().sim_time+use_delay <= use_delay+schedule_simtime())
 		  break;
 
-	    if (list_ == cur)
-		  list_ = 0;
-	    else
-		  list_->next = cur->next;
-	    delete cur;
-      } while (list_);
+	    pop_head_();
+      } while (ring_count_);
 }
 
 /*
@@ -294,7 +333,7 @@ void vvp_fun_delay::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
 	      // current value of the output. Detect and handle the
 	      // special case that the event list contains the current
 	      // value as a zero-delay-remaining event.
-	    const vvp_vector4_t&use_vec4 = (list_ && list_->next->sim_time == schedule_simtime())? list_->next->ptr_vec4 : cur_vec4_;
+	    const vvp_vector4_t&use_vec4 = (ring_count_ && head_().sim_time == schedule_simtime())? head_().ptr_vec4 : cur_vec4_;
 
 	      /* How many bits to compare? */
 	    unsigned use_wid = use_vec4.size();
@@ -319,16 +358,13 @@ void vvp_fun_delay::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
       vvp_time64_t use_simtime = schedule_simtime() + use_delay;
 
 	/* And propagate it. */
-      if (use_delay == 0 && list_ == 0) {
+      if (use_delay == 0 && ring_count_ == 0) {
 	    cur_vec4_ = bit;
 	    initial_ = false;
 	    net_->send_vec4(cur_vec4_, 0);
       } else {
-	    struct event_*cur = new struct event_(use_simtime);
-	    cur->run_run_ptr = &vvp_fun_delay::run_run_vec4_;
-	    cur->ptr_vec4 = bit;
-	    enqueue_(cur);
-	    schedule_generic(this, use_delay, false);
+	    enqueue_(use_simtime).ptr_vec4 = bit;
+	    schedule_wakeup_(use_delay);
       }
 }
 
@@ -357,7 +393,7 @@ void vvp_fun_delay::recv_vec8(vvp_net_ptr_t port, const vvp_vector8_t&bit)
 	      // current value of the output. Detect and handle the
 	      // special case that the event list contains the current
 	      // value as a zero-delay-remaining event.
-	    const vvp_vector8_t&use_vec8 = (list_ && list_->next->sim_time == schedule_simtime())? list_->next->ptr_vec8 : cur_vec8_;
+	    const vvp_vector8_t&use_vec8 = (ring_count_ && head_().sim_time == schedule_simtime())? head_().ptr_vec8 : cur_vec8_;
 
 	      /* How many bits to compare? */
 	    unsigned use_wid = use_vec8.size();
@@ -384,16 +420,13 @@ void vvp_fun_delay::recv_vec8(vvp_net_ptr_t port, const vvp_vector8_t&bit)
       vvp_time64_t use_simtime = schedule_simtime() + use_delay;
 
 	/* And propagate it. */
-      if (use_delay == 0 && list_ == 0) {
+      if (use_delay == 0 && ring_count_ == 0) {
 	    cur_vec8_ = bit;
 	    initial_ = false;
 	    net_->send_vec8(cur_vec8_);
       } else {
-	    struct event_*cur = new struct event_(use_simtime);
-	    cur->ptr_vec8 = bit;
-	    cur->run_run_ptr = &vvp_fun_delay::run_run_vec8_;
-	    enqueue_(cur);
-	    schedule_generic(this, use_delay, false);
+	    enqueue_(use_simtime).ptr_vec8 = bit;
+	    schedule_wakeup_(use_delay);
       }
 }
 
@@ -446,51 +479,111 @@ void vvp_fun_delay::recv_real(vvp_net_ptr_t port, double bit,
 
       vvp_time64_t use_simtime = schedule_simtime() + use_delay;
 
-      if (use_delay == 0 && list_ == 0) {
+      if (use_delay == 0 && ring_count_ == 0) {
 	    cur_real_ = bit;
 	    initial_ = false;
 	    net_->send_real(cur_real_, 0);
       } else {
-	    struct event_*cur = new struct event_(use_simtime);
-	    cur->run_run_ptr = &vvp_fun_delay::run_run_real_;
-	    cur->ptr_real = bit;
-	    enqueue_(cur);
-
-	    schedule_generic(this, use_delay, false);
+	    enqueue_(use_simtime).ptr_real = bit;
+	    schedule_wakeup_(use_delay);
       }
 }
 
+/*
+ * Propagate, in order, all the changes that are due. Sending a value
+ * may cause new changes to be queued, so the head is copied out of
+ * the ring before it is released.
+ */
 void vvp_fun_delay::run_run()
 {
       vvp_time64_t sim_time = schedule_simtime();
-      if (list_ == 0 || list_->next->sim_time > sim_time)
-	    return;
+      if (wake_pending_ && wake_time_ == sim_time)
+	    wake_pending_ = false;
+
+      while (ring_count_ && head_().sim_time <= sim_time) {
+	    switch (type_) {
+		case VEC4_DELAY:
+		  cur_vec4_ = head_().ptr_vec4;
+		  pop_head_();
+		  net_->send_vec4(cur_vec4_, 0);
+		  break;
+		case VEC8_DELAY:
+		  cur_vec8_ = head_().ptr_vec8;
+		  pop_head_();
+		  net_->send_vec8(cur_vec8_);
+		  break;
+		case REAL_DELAY:
+		  cur_real_ = head_().ptr_real;
+		  pop_head_();
+		  net_->send_real(cur_real_, 0);
+		  break;
+		default:
+		  assert(0);
+		  pop_head_();
+		  break;
+	    }
+	    initial_ = false;
+      }
+}
 
-      struct event_*cur = dequeue_();
-      if (cur == 0)
+void vvp_fun_delay::checkpoint_save(checkpoint_out&out) const
+{
+      if (ring_count_ > 0) {
+	    out.refuse("a delayed net value is scheduled");
 	    return;
+      }
 
-      (this->*(cur->run_run_ptr))(cur);
-      initial_ = false;
-      delete cur;
+      out.put_uint(type_);
+      out.put_uint(initial_);
+      out.put_vec4(cur_vec4_);
+      out.put_vec8(cur_vec8_);
+      out.put_real(cur_real_);
 }
 
-void vvp_fun_delay::run_run_vec4_(struct event_*cur)
+void vvp_fun_delay::checkpoint_restore(checkpoint_in&in)
 {
-      cur_vec4_ = cur->ptr_vec4;
-      net_->send_vec4(cur_vec4_, 0);
-}
+      uint64_t type = in.get_uint();
+      bool initial = in.get_uint() != 0;
+      vvp_vector4_t vec4 = in.get_vec4();
+      vvp_vector8_t vec8 = in.get_vec8();
+      double real = in.get_real();
+      if (type > REAL_DELAY) {
+	    in.corrupt("a delay does not match the design");
+	    return;
+      }
+      if (! in.ok())
+	    return;
 
-void vvp_fun_delay::run_run_vec8_(struct vvp_fun_delay::event_*cur)
-{
-      cur_vec8_ = cur->ptr_vec8;
-      net_->send_vec8(cur_vec8_);
+	/* The restored values drove the input, and the changes that
+	   this scheduled are replaced by the saved output. */
+      schedule_checkpoint_cancel(this);
+      ring_head_ = 0;
+      ring_count_ = 0;
+      wake_pending_ = false;
+
+      type_ = (delay_type_t) type;
+      initial_ = initial;
+      cur_vec4_ = vec4;
+      cur_vec8_ = vec8;
+      cur_real_ = real;
 }
 
-void vvp_fun_delay::run_run_real_(struct vvp_fun_delay::event_*cur)
+void vvp_fun_delay::checkpoint_send()
 {
-      cur_real_ = cur->ptr_real;
-      net_->send_real(cur_real_, 0);
+      switch (type_) {
+	  case VEC8_DELAY:
+	    net_->send_vec8(cur_vec8_);
+	    break;
+	  case REAL_DELAY:
+	    net_->send_real(cur_real_, 0);
+	    break;
+	  default:
+	    if (cur_vec4_.size() > 0)
+		  net_->send_vec4(cur_vec4_, 0);
+	    else
+		  net_->send_real(cur_real_, 0);
+	    break;
+      }
 }
 
 vvp_fun_modpath::vvp_fun_modpath(vvp_net_t*net, unsigned width)
@@ -659,6 +752,42 @@ void vvp_fun_modpath::run_run()
       net_->send_vec4(cur_vec4_, 0);
 }
 
+/*
+ * A checkpoint is not taken while the modpath has an output event
+ * scheduled (the scheduler refuses it), so cur_vec4_ is the output.
+ */
+void vvp_fun_modpath::checkpoint_save(checkpoint_out&out) const
+{
+      out.put_vec4(cur_vec4_);
+      for (vvp_fun_modpath_src*cur = src_list_ ;  cur ;  cur=cur->next_)
+	    out.put_uint(cur->wake_time_);
+      for (vvp_fun_modpath_src*cur = ifnone_list_ ;  cur ;  cur=cur->next_)
+	    out.put_uint(cur->wake_time_);
+}
+
+void vvp_fun_modpath::checkpoint_restore(checkpoint_in&in)
+{
+      vvp_vector4_t vec4 = in.get_vec4();
+      if (vec4.size() != cur_vec4_.size()) {
+	    in.corrupt("a module path does not match the design");
+	    return;
+      }
+      for (vvp_fun_modpath_src*cur = src_list_ ;  cur ;  cur=cur->next_)
+	    cur->wake_time_ = in.get_uint();
+      for (vvp_fun_modpath_src*cur = ifnone_list_ ;  cur ;  cur=cur->next_)
+	    cur->wake_time_ = in.get_uint();
+      if (! in.ok())
+	    return;
+
+      schedule_checkpoint_cancel(this);
+      cur_vec4_ = vec4;
+}
+
+void vvp_fun_modpath::checkpoint_send()
+{
+      net_->send_vec4(cur_vec4_, 0);
+}
+
 vvp_fun_modpath_src::vvp_fun_modpath_src(vvp_time64_t del[12])
 {
       for (unsigned idx = 0 ;  idx < 12 ;  idx += 1)
@@ -76,16 +76,11 @@ class vvp_fun_delay  : public vvp_net_fun_t, private vvp_gen_event_s {
 
       enum delay_type_t {UNKNOWN_DELAY, VEC4_DELAY, VEC8_DELAY, REAL_DELAY};
       struct event_ {
-	    event_(vvp_time64_t s) : sim_time(s) {
-		  ptr_real = 0.0;
-		  next = NULL;
-	    }
-	    void (vvp_fun_delay::*run_run_ptr)(struct vvp_fun_delay::event_*cur);
-	    const vvp_time64_t sim_time;
+	    event_() : sim_time(0), ptr_real(0.0) { }
+	    vvp_time64_t sim_time;
 	    vvp_vector4_t ptr_vec4;
 	    vvp_vector8_t ptr_vec8;
 	    double ptr_real;
-	    struct event_*next;
       };
 
     public:
@@ -99,14 +94,16 @@ class vvp_fun_delay  : public vvp_net_fun_t, private vvp_gen_event_s {
                      vvp_context_t);
 	//void recv_long(vvp_net_ptr_t port, long bit);
 
+	// Save and restore the output for a checkpoint. The restore
+	// also cancels the changes that are pending. The checkpoint
+	// calls checkpoint_send when all the delays are restored.
+      void checkpoint_save(checkpoint_out&out) const;
+      void checkpoint_restore(checkpoint_in&in);
+      void checkpoint_send();
+
     private:
       virtual void run_run();
 
-
-      void run_run_vec4_(struct vvp_fun_delay::event_*cur);
-      void run_run_vec8_(struct vvp_fun_delay::event_*cur);
-      void run_run_real_(struct vvp_fun_delay::event_*cur);
-
     private:
       vvp_net_t*net_;
       vvp_delay_t delay_;
@@ -118,29 +115,27 @@ class vvp_fun_delay  : public vvp_net_fun_t, private vvp_gen_event_s {
       double cur_real_;
       vvp_time64_t round_, scale_; // Needed to scale variable time values.
 
-      struct event_ *list_;
-      void enqueue_(struct event_*cur)
-      {
-	    if (list_) {
-		  cur->next = list_->next;
-		  list_->next = cur;
-		  list_ = cur;
-	    } else {
-		  cur->next = cur;
-		  list_ = cur;
-	    }
-      }
-      struct event_* dequeue_(void)
+	// The pending output changes are kept oldest first in a ring
+	// buffer that grows by doubling. The slots (and the storage
+	// of the values in them) are reused from change to change.
+      struct event_*ring_;
+      unsigned ring_size_, ring_head_, ring_count_;
+
+      struct event_&head_(void) { return ring_[ring_head_]; }
+      void pop_head_(void)
       {
-	    if (list_ == 0)
-		  return 0;
-	    struct event_*cur = list_->next;
-	    if (list_ == cur)
-		  list_ = 0;
-	    else
-		  list_->next = cur->next;
-	    return cur;
+	    ring_head_ = (ring_head_ + 1) & (ring_size_ - 1);
+	    ring_count_ -= 1;
       }
+      struct event_&enqueue_(vvp_time64_t sim_time);
+
+	// The time of the latest wakeup event that was scheduled
+	// and has not yet run. Changes that mature at the same time
+	// share that wakeup.
+      vvp_time64_t wake_time_;
+      bool wake_pending_;
+      void schedule_wakeup_(vvp_time64_t use_delay);
+
       bool clean_pulse_events_(vvp_time64_t use_delay, const vvp_vector4_t&bit);
       bool clean_pulse_events_(vvp_time64_t use_delay, const vvp_vector8_t&bit);
       bool clean_pulse_events_(vvp_time64_t use_delay, double bit);
@@ -170,6 +165,13 @@ class vvp_fun_modpath  : public vvp_net_fun_t, private vvp_gen_event_s {
       void recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
                      vvp_context_t);
 
+	// Save and restore the output, and the time of the last
+	// input change of each path, for a checkpoint. This works
+	// the same as for vvp_fun_delay.
+      void checkpoint_save(checkpoint_out&out) const;
+      void checkpoint_restore(checkpoint_in&in);
+      void checkpoint_send();
+
     private:
       virtual void run_run();
 
@@ -20,6 +20,7 @@
 # include  "compile.h"
 # include  "schedule.h"
 # include  "dff.h"
+# include  "checkpoint.h"
 # include  <climits>
 # include  <cstdio>
 # include  <cassert>
@@ -55,8 +56,10 @@ void vvp_dff::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
 		  break;
 	    tmp = clk_cur_;
 	    clk_cur_ = bit.value(0);
-	    if (clk_cur_ == BIT4_1 && tmp != BIT4_1)
-		  port.ptr()->send_vec4(d_, 0);
+	    if (clk_cur_ == BIT4_1 && tmp != BIT4_1) {
+		  q_ = d_;
+		  port.ptr()->send_vec4(q_, 0);
+	    }
 	    break;
 
 	  case 2: // CE
@@ -75,11 +78,34 @@ void vvp_dff::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
 		  d_ .copy_bits(bit);
 	    else
 		  d_ = bit;
-	    port.ptr()->send_vec4(d_, 0);
+	    q_ = d_;
+	    port.ptr()->send_vec4(q_, 0);
 	    break;
       }
 }
 
+void vvp_dff::checkpoint_save(checkpoint_out&out) const
+{
+      out.put_uint(clk_cur_);
+      out.put_uint(enable_);
+      out.put_vec4(d_);
+      out.put_vec4(q_);
+}
+
+void vvp_dff::checkpoint_restore(checkpoint_in&in)
+{
+      clk_cur_ = (vvp_bit4_t) (in.get_uint() & 3);
+      enable_ = (vvp_bit4_t) (in.get_uint() & 3);
+      d_ = in.get_vec4();
+      q_ = in.get_vec4();
+}
+
+void vvp_dff::checkpoint_send(vvp_net_t*net)
+{
+      if (q_.size() > 0)
+	    net->send_vec4(q_, 0);
+}
+
 void compile_dff(char*label, struct symb_s arg_d,
 		 struct symb_s arg_c,
 		 struct symb_s arg_e,
@@ -89,6 +115,7 @@ void compile_dff(char*label, struct symb_s arg_d,
       vvp_dff*fun = new vvp_dff(false, false);
 
       ptr->fun = fun;
+      checkpoint_add_functor(ptr);
       define_functor_symbol(label, ptr);
       free(label);
       input_connect(ptr, 0, arg_d.text);
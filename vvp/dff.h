@@ -42,11 +42,20 @@ class vvp_dff  : public vvp_net_fun_t {
       void recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
                      vvp_context_t);
 
+	// Save and restore the state for a checkpoint. The restore
+	// does not propagate anything. The checkpoint calls
+	// checkpoint_send when all the functors are restored.
+      void checkpoint_save(checkpoint_out&out) const;
+      void checkpoint_restore(checkpoint_in&in);
+      void checkpoint_send(vvp_net_t*net);
+
     private:
       bool iclk_, ice_;
       vvp_bit4_t clk_cur_;
       vvp_bit4_t enable_;
       vvp_vector4_t d_;
+	// The value last sent to the output.
+      vvp_vector4_t q_;
 };
 
 #endif
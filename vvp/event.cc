@@ -22,10 +22,12 @@
 # include  "vthread.h"
 # include  "schedule.h"
 # include  "vpi_priv.h"
+# include  "checkpoint.h"
 # include  "config.h"
 # include  <cstring>
 # include  <cassert>
 # include  <cstdlib>
+# include  <new>
 
 # include <iostream>
 
@@ -52,10 +54,18 @@ void waitable_hooks_s::run_waiting_threads_(vthread_t&threads)
       vthread_schedule_list(tmp);
 }
 
+unsigned long evctl::pending_count = 0;
+
 evctl::evctl(unsigned long ecount)
 {
       ecount_ = ecount;
       next = 0;
+      pending_count += 1;
+}
+
+evctl::~evctl()
+{
+      pending_count -= 1;
 }
 
 bool evctl::dec_and_run()
@@ -312,6 +322,26 @@ void vvp_fun_edge_aa::free_instance(vvp_context_t context)
 }
 #endif
 
+void vvp_fun_edge_aa::checkpoint_save(vvp_context_t context,
+				      checkpoint_out&out) const
+{
+      vvp_fun_edge_state_s*state = static_cast<vvp_fun_edge_state_s*>
+            (vvp_get_context_item(context, context_idx_));
+
+      for (unsigned idx = 0 ;  idx < 4 ;  idx += 1)
+	    out.put_uint(state->bits[idx]);
+}
+
+void vvp_fun_edge_aa::checkpoint_restore(vvp_context_t context,
+					 checkpoint_in&in)
+{
+      vvp_fun_edge_state_s*state = static_cast<vvp_fun_edge_state_s*>
+            (vvp_get_context_item(context, context_idx_));
+
+      for (unsigned idx = 0 ;  idx < 4 ;  idx += 1)
+	    state->bits[idx] = (vvp_bit4_t) (in.get_uint() & 3);
+}
+
 vthread_t vvp_fun_edge_aa::add_waiting_thread(vthread_t thread)
 {
       vvp_fun_edge_state_s*state = static_cast<vvp_fun_edge_state_s*>
@@ -365,8 +395,12 @@ vvp_fun_anyedge::~vvp_fun_anyedge()
 {
 }
 
-bool vvp_fun_anyedge::recv_vec4_(const vvp_vector4_t&bit,
-                                 vvp_vector4_t&old_bits, vthread_t&threads)
+/*
+ * Compare a new input value with the previous value, and save it if
+ * it changed. Return true if there was a change.
+ */
+static bool anyedge_test_change(const vvp_vector4_t&bit,
+				vvp_vector4_t&old_bits)
 {
       bool flag = false;
 
@@ -395,10 +429,18 @@ bool vvp_fun_anyedge::recv_vec4_(const vvp_vector4_t&bit,
 	    }
       }
 
-      if (flag) {
+      if (flag)
 	    old_bits = bit;
+
+      return flag;
+}
+
+bool vvp_fun_anyedge::recv_vec4_(const vvp_vector4_t&bit,
+                                 vvp_vector4_t&old_bits, vthread_t&threads)
+{
+      bool flag = anyedge_test_change(bit, old_bits);
+      if (flag)
 	    run_waiting_threads_(threads);
-      }
 
       return flag;
 }
@@ -504,6 +546,30 @@ void vvp_fun_anyedge_aa::free_instance(vvp_context_t context)
 }
 #endif
 
+void vvp_fun_anyedge_aa::checkpoint_save(vvp_context_t context,
+					 checkpoint_out&out) const
+{
+      vvp_fun_anyedge_state_s*state = static_cast<vvp_fun_anyedge_state_s*>
+            (vvp_get_context_item(context, context_idx_));
+
+      for (unsigned idx = 0 ;  idx < 4 ;  idx += 1) {
+	    out.put_vec4(state->bits[idx]);
+	    out.put_real(state->bitsr[idx]);
+      }
+}
+
+void vvp_fun_anyedge_aa::checkpoint_restore(vvp_context_t context,
+					    checkpoint_in&in)
+{
+      vvp_fun_anyedge_state_s*state = static_cast<vvp_fun_anyedge_state_s*>
+            (vvp_get_context_item(context, context_idx_));
+
+      for (unsigned idx = 0 ;  idx < 4 ;  idx += 1) {
+	    state->bits[idx] = in.get_vec4();
+	    state->bitsr[idx] = in.get_real();
+      }
+}
+
 vthread_t vvp_fun_anyedge_aa::add_waiting_thread(vthread_t thread)
 {
       vvp_fun_anyedge_state_s*state = static_cast<vvp_fun_anyedge_state_s*>
@@ -557,6 +623,82 @@ void vvp_fun_anyedge_aa::recv_real(vvp_net_ptr_t port, double bit,
       }
 }
 
+vvp_fun_anychange::vvp_fun_anychange(unsigned nports, vvp_net_t*net)
+: nports_(nports), net_(net), bitsr_(0), threads_(0)
+{
+      bits_ = new vvp_vector4_t[nports_];
+}
+
+vvp_fun_anychange::~vvp_fun_anychange()
+{
+      delete[] bits_;
+      delete[] bitsr_;
+}
+
+vthread_t vvp_fun_anychange::add_waiting_thread(vthread_t thread)
+{
+      vthread_t tmp = threads_;
+      threads_ = thread;
+
+      return tmp;
+}
+
+void vvp_fun_anychange::changed_()
+{
+      run_waiting_threads_(threads_);
+
+      if (! net_->fanout().nil())
+	    net_->send_vec4(vvp_vector4_t(), 0);
+}
+
+void vvp_fun_anychange::recv_vec4_(unsigned port, const vvp_vector4_t&bit)
+{
+      assert(port < nports_);
+      if (anyedge_test_change(bit, bits_[port]))
+	    changed_();
+}
+
+void vvp_fun_anychange::recv_vec4_pv_(unsigned port, const vvp_vector4_t&bit,
+				      unsigned base, unsigned wid, unsigned vwid)
+{
+      assert(port < nports_);
+      vvp_vector4_t tmp = bits_[port];
+      if (tmp.size() == 0)
+	    tmp = vvp_vector4_t(vwid, BIT4_Z);
+      assert(wid == bit.size());
+      assert(base+wid <= vwid);
+      assert(tmp.size() == vwid);
+      tmp.set_vec(base, bit);
+
+      if (anyedge_test_change(tmp, bits_[port]))
+	    changed_();
+}
+
+void vvp_fun_anychange::recv_real_(unsigned port, double bit)
+{
+      assert(port < nports_);
+      if (bitsr_ == 0) {
+	    bitsr_ = new double[nports_];
+	    for (unsigned idx = 0 ;  idx < nports_ ;  idx += 1)
+		  bitsr_[idx] = 0.0;
+      }
+
+      if (bitsr_[port] != bit) {
+	    bitsr_[port] = bit;
+	    changed_();
+      }
+}
+
+vvp_fun_anychange_in::vvp_fun_anychange_in(vvp_fun_anychange*core,
+					   unsigned port_base)
+: core_(core), port_base_(port_base)
+{
+}
+
+vvp_fun_anychange_in::~vvp_fun_anychange_in()
+{
+}
+
 vvp_fun_event_or::vvp_fun_event_or()
 {
 }
@@ -622,6 +764,28 @@ void vvp_fun_event_or_aa::free_instance(vvp_context_t context)
 }
 #endif
 
+size_t vvp_fun_event_or_aa::image_size() const
+{
+      return sizeof(waitable_state_s);
+}
+
+void vvp_fun_event_or_aa::init_image(void*img) const
+{
+      new (img) waitable_state_s;
+}
+
+/*
+ * The only state is the list of waiting threads, which the thread
+ * module saves and restores.
+ */
+void vvp_fun_event_or_aa::checkpoint_save(vvp_context_t, checkpoint_out&) const
+{
+}
+
+void vvp_fun_event_or_aa::checkpoint_restore(vvp_context_t, checkpoint_in&)
+{
+}
+
 vthread_t vvp_fun_event_or_aa::add_waiting_thread(vthread_t thread)
 {
       waitable_state_s*state = static_cast<waitable_state_s*>
@@ -722,6 +886,24 @@ void vvp_named_event_aa::free_instance(vvp_context_t context)
 }
 #endif
 
+size_t vvp_named_event_aa::image_size() const
+{
+      return sizeof(waitable_state_s);
+}
+
+void vvp_named_event_aa::init_image(void*img) const
+{
+      new (img) waitable_state_s;
+}
+
+void vvp_named_event_aa::checkpoint_save(vvp_context_t, checkpoint_out&) const
+{
+}
+
+void vvp_named_event_aa::checkpoint_restore(vvp_context_t, checkpoint_in&)
+{
+}
+
 vthread_t vvp_named_event_aa::add_waiting_thread(vthread_t thread)
 {
       waitable_state_s*state = static_cast<waitable_state_s*>
@@ -765,7 +947,36 @@ void compile_event(char*label, char*type, unsigned argc, struct symb_s*argv)
 	    return;
       }
 
-      if (strcmp(type,"edge") == 0) {
+      if (strcmp(type,"edge") == 0 && argc > 4) {
+
+	    free(type);
+
+	      /* A wide any change event. The code generator only
+		 makes these for static scopes. */
+	    assert(! vpip_peek_current_scope()->is_automatic);
+
+	    vvp_net_t*ptr = new vvp_net_t;
+	    vvp_fun_anychange*core = new vvp_fun_anychange(argc, ptr);
+	    ptr->fun = core;
+
+	    define_functor_symbol(label, ptr);
+	    free(label);
+
+	    for (unsigned base = 0 ;  base < argc ;  base += 4) {
+		  unsigned nports = argc - base;
+		  if (nports > 4)
+			nports = 4;
+
+		  if (base > 0) {
+			ptr = new vvp_net_t;
+			ptr->fun = new vvp_fun_anychange_in(core, base);
+		  }
+		  inputs_connect(ptr, nports, argv+base);
+	    }
+	    free(argv);
+	    return;
+
+      } else if (strcmp(type,"edge") == 0) {
 
 	    free(type);
 
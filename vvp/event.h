@@ -30,9 +30,13 @@ class evctl {
       explicit evctl(unsigned long ecount);
       bool dec_and_run();
       virtual void run_run() = 0;
-      virtual ~evctl() {}
+      virtual ~evctl();
       evctl*next;
 
+	// The number of event controls that are waiting for their
+	// events. A checkpoint cannot hold them.
+      static unsigned long pending_count;
+
     private:
       unsigned long ecount_;
 };
@@ -205,6 +209,8 @@ class vvp_fun_edge_aa : public vvp_fun_edge, public automatic_hooks_s {
 #ifdef CHECK_WITH_VALGRIND
       void free_instance(vvp_context_t context);
 #endif
+      void checkpoint_save(vvp_context_t context, checkpoint_out&out) const;
+      void checkpoint_restore(vvp_context_t context, checkpoint_in&in);
 
       vthread_t add_waiting_thread(vthread_t thread);
 
@@ -281,6 +287,8 @@ class vvp_fun_anyedge_aa : public vvp_fun_anyedge, public automatic_hooks_s {
 #ifdef CHECK_WITH_VALGRIND
       void free_instance(vvp_context_t context);
 #endif
+      void checkpoint_save(vvp_context_t context, checkpoint_out&out) const;
+      void checkpoint_restore(vvp_context_t context, checkpoint_in&in);
 
       vthread_t add_waiting_thread(vthread_t thread);
 
@@ -295,6 +303,76 @@ class vvp_fun_anyedge_aa : public vvp_fun_anyedge, public automatic_hooks_s {
       unsigned context_idx_;
 };
 
+/*
+ * The vvp_fun_anychange functor is a statically allocated "any
+ * change" event with any number of inputs. It replaces the event/or
+ * of a chain of vvp_fun_anyedge functors for wide sensitivity lists,
+ * such as the @* of a big mux. The core functor takes the first 4
+ * inputs and the rest arrive through vvp_fun_anychange_in functors,
+ * in the same way as resolver nodes. The core keeps the previous
+ * value of every input, and a change runs the waiting threads.
+ *
+ * The value is not propagated. If something is connected to the
+ * output (an event/or that includes this event) an empty vector is
+ * sent to trigger it.
+ */
+class vvp_fun_anychange : public vvp_net_fun_t, public waitable_hooks_s {
+
+    public:
+      explicit vvp_fun_anychange(unsigned nports, vvp_net_t*net);
+      ~vvp_fun_anychange();
+
+      vthread_t add_waiting_thread(vthread_t thread);
+
+      void recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
+                     vvp_context_t)
+            { recv_vec4_(port.port(), bit); }
+      void recv_vec4_pv(vvp_net_ptr_t port, const vvp_vector4_t&bit,
+			unsigned base, unsigned wid, unsigned vwid,
+			vvp_context_t)
+            { recv_vec4_pv_(port.port(), bit, base, wid, vwid); }
+      void recv_real(vvp_net_ptr_t port, double bit, vvp_context_t)
+            { recv_real_(port.port(), bit); }
+
+    private:
+      friend class vvp_fun_anychange_in;
+      void recv_vec4_(unsigned port, const vvp_vector4_t&bit);
+      void recv_vec4_pv_(unsigned port, const vvp_vector4_t&bit,
+			 unsigned base, unsigned wid, unsigned vwid);
+      void recv_real_(unsigned port, double bit);
+      void changed_();
+
+    private:
+      unsigned nports_;
+      vvp_net_t*net_;
+      vvp_vector4_t*bits_;
+	// In case some inputs are real-valued. Allocated on demand.
+      double*bitsr_;
+      vthread_t threads_;
+};
+
+class vvp_fun_anychange_in : public vvp_net_fun_t {
+
+    public:
+      vvp_fun_anychange_in(vvp_fun_anychange*core, unsigned port_base);
+      ~vvp_fun_anychange_in();
+
+      void recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
+                     vvp_context_t)
+            { core_->recv_vec4_(port_base_ + port.port(), bit); }
+      void recv_vec4_pv(vvp_net_ptr_t port, const vvp_vector4_t&bit,
+			unsigned base, unsigned wid, unsigned vwid,
+			vvp_context_t)
+            { core_->recv_vec4_pv_(port_base_ + port.port(), bit,
+                                   base, wid, vwid); }
+      void recv_real(vvp_net_ptr_t port, double bit, vvp_context_t)
+            { core_->recv_real_(port_base_ + port.port(), bit); }
+
+    private:
+      vvp_fun_anychange*core_;
+      unsigned port_base_;
+};
+
 /*
  * This functor triggers anytime any input is set, no matter what the
  * value. This is similar to a named event, but it has no handle.
@@ -338,6 +416,10 @@ class vvp_fun_event_or_aa : public vvp_fun_event_or, public automatic_hooks_s {
 #ifdef CHECK_WITH_VALGRIND
       void free_instance(vvp_context_t context);
 #endif
+      size_t image_size() const;
+      void init_image(void*img) const;
+      void checkpoint_save(vvp_context_t context, checkpoint_out&out) const;
+      void checkpoint_restore(vvp_context_t context, checkpoint_in&in);
 
       vthread_t add_waiting_thread(vthread_t thread);
 
@@ -396,6 +478,10 @@ class vvp_named_event_aa : public vvp_named_event, public automatic_hooks_s {
 #ifdef CHECK_WITH_VALGRIND
       void free_instance(vvp_context_t context);
 #endif
+      size_t image_size() const;
+      void init_image(void*img) const;
+      void checkpoint_save(vvp_context_t context, checkpoint_out&out) const;
+      void checkpoint_restore(vvp_context_t context, checkpoint_in&in);
 
       vthread_t add_waiting_thread(vthread_t thread);
 
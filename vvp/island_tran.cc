@@ -30,9 +30,24 @@ using namespace std;
 class vvp_island_tran : public vvp_island {
 
     public:
+      vvp_island_tran();
       void run_island();
       void count_drivers(vvp_island_port*port, unsigned bit_idx,
                          unsigned counts[3]);
+
+    private:
+      void visit_node_(vvp_branch_ptr_t end);
+
+	// This is false until the island has run once. The first run
+	// tests and resolves the entire island.
+      bool initialized_;
+	// Each run gets a new pass number. Ports are marked with the
+	// pass number when they are added to the work list.
+      unsigned long pass_;
+	// One branch end for each port to be resolved in this run,
+	// and a stack of the nodes still to be scanned.
+      std::vector<vvp_branch_ptr_t> work_nodes_;
+      std::vector<vvp_branch_ptr_t> scan_stack_;
 };
 
 enum tran_state_t {
@@ -47,10 +62,12 @@ struct vvp_island_branch_tran : public vvp_island_branch {
                              unsigned width__, unsigned part__,
                              unsigned offset__);
       bool run_test_enabled();
-      void run_resolution();
-      void run_output();
 
       vvp_net_t*en;
+	// The port for the en net (if any), and the next branch in
+	// the list of branches controlled by that port.
+      vvp_island_port*en_port;
+      vvp_island_branch*next_ctrl;
       unsigned width, part, offset;
       bool active_high;
       tran_state_t state;
@@ -61,49 +78,145 @@ vvp_island_branch_tran::vvp_island_branch_tran(vvp_net_t*en__,
                                                unsigned width__,
                                                unsigned part__,
                                                unsigned offset__)
-: en(en__), width(width__), part(part__), offset(offset__),
+: en(en__), en_port(en__? island_port(en__) : 0), next_ctrl(0),
+  width(width__), part(part__), offset(offset__),
   active_high(active_high__)
 {
       state = en__ ? tran_disabled : tran_enabled;
 }
 
+/*
+ * All the branches of a tran island are vvp_island_branch_tran
+ * objects, so there is no need for RTTI to get at them.
+ */
 static inline vvp_island_branch_tran* BRANCH_TRAN(vvp_island_branch*tmp)
 {
-      vvp_island_branch_tran*res = dynamic_cast<vvp_island_branch_tran*>(tmp);
-      assert(res);
-      return res;
+      return static_cast<vvp_island_branch_tran*>(tmp);
+}
+
+static inline vvp_net_t* branch_end_net(vvp_branch_ptr_t end)
+{
+      return end.port()? end.ptr()->b : end.ptr()->a;
+}
+
+static void push_value_through_branches(const vvp_vector8_t&val,
+					list<vvp_branch_ptr_t>&connections);
+
+vvp_island_tran::vvp_island_tran()
+: initialized_(false), pass_(0)
+{
+}
+
+/*
+ * Add the port at this branch end to the work list, unless it is
+ * already there.
+ */
+void vvp_island_tran::visit_node_(vvp_branch_ptr_t end)
+{
+      vvp_island_port*port = island_port(branch_end_net(end));
+      if (port->mark == pass_)
+	    return;
+
+      port->mark = pass_;
+      work_nodes_.push_back(end);
+      scan_stack_.push_back(end);
 }
 
 /*
  * The run_island() method is called by the scheduler to run the
- * entire island. We run the island by calling run_resolution() for
- * all the branches in the island.
+ * island. Only the parts of the island that can be affected by what
+ * changed are resolved. The changed ports are the seeds: any port
+ * with a changed input, and both ends of any branch whose enable
+ * state changed. From the seeds, the work list is extended through
+ * all the enabled (or unknown) branches, so that it holds the
+ * connected components of the currently enabled mesh that contain
+ * the changes. Only the ports of those components are resolved and
+ * output. Ports in other components can not see the change.
 */
 void vvp_island_tran::run_island()
 {
-	// Test to see if any of the branches are enabled. This loop
-	// tests the enabled inputs for all the branches and caches
-	// the results in the state for each branch.
-      bool runnable = false;
-      for (vvp_island_branch*cur = branches_ ; cur ; cur = cur->next_branch) {
-	    vvp_island_branch_tran*tmp = dynamic_cast<vvp_island_branch_tran*>(cur);
-	    assert(tmp);
-	    runnable |= tmp->run_test_enabled();
+      pass_ += 1;
+
+      if (! initialized_) {
+	      // The first time, test and resolve everything.
+	    initialized_ = true;
+	    for (vvp_island_branch*cur = branches_ ; cur ; cur = cur->next_branch) {
+		  BRANCH_TRAN(cur)->run_test_enabled();
+		  visit_node_(vvp_branch_ptr_t(cur, 0));
+		  visit_node_(vvp_branch_ptr_t(cur, 1));
+	    }
+
+      } else {
+	      // Retest the branches that are controlled by changed
+	      // ports. If the state changes, then both sides of the
+	      // branch need to be resolved again.
+	    for (size_t idx = 0 ; idx < changed_ports_.size() ; idx += 1) {
+		  vvp_island_branch*cur = changed_ports_[idx]->ctrl_branches;
+		  for ( ; cur ; cur = BRANCH_TRAN(cur)->next_ctrl) {
+			vvp_island_branch_tran*tmp = BRANCH_TRAN(cur);
+			tran_state_t old_state = tmp->state;
+			tmp->run_test_enabled();
+			if (tmp->state == old_state)
+			      continue;
+			visit_node_(vvp_branch_ptr_t(cur, 0));
+			visit_node_(vvp_branch_ptr_t(cur, 1));
+		  }
+	    }
+
+	      // And of course resolve the changed ports themselves.
+	    for (size_t idx = 0 ; idx < changed_ports_.size() ; idx += 1) {
+		  vvp_island_port*port = changed_ports_[idx];
+		  if (! port->node.nil())
+			visit_node_(port->node);
+	    }
+      }
+
+      for (size_t idx = 0 ; idx < changed_ports_.size() ; idx += 1)
+	    changed_ports_[idx]->changed = false;
+      changed_ports_.clear();
+
+	// Extend the work list through the enabled branches.
+      while (! scan_stack_.empty()) {
+	    vvp_branch_ptr_t cur = scan_stack_.back();
+	    scan_stack_.pop_back();
+
+	    vvp_branch_ptr_t idx = cur;
+	    do {
+		  vvp_island_branch_tran*tmp = BRANCH_TRAN(idx.ptr());
+		  if (tmp->state != tran_disabled)
+			visit_node_(vvp_branch_ptr_t(tmp, idx.port()^1));
+	    } while ((idx = next(idx)) != cur);
       }
 
-	// Now resolve all the branches in the island.
-      for (vvp_island_branch*cur = branches_ ; cur ; cur = cur->next_branch) {
-	    vvp_island_branch_tran*tmp = dynamic_cast<vvp_island_branch_tran*>(cur);
-	    assert(tmp);
-	    tmp->run_resolution();
+	// Now resolve the ports in the work list. If a port has not
+	// already been visited, push its input value through all the
+	// branches connected to it.
+      list<vvp_branch_ptr_t> connections;
+      for (size_t idx = 0 ; idx < work_nodes_.size() ; idx += 1) {
+	    vvp_net_t*net = branch_end_net(work_nodes_[idx]);
+	    vvp_island_port*port = island_port(net);
+	    if (port->value.size() != 0)
+		  continue;
+
+	    island_collect_node(connections, work_nodes_[idx]);
+	    port->value = island_get_value(net);
+	    if (port->value.size() != 0)
+		  push_value_through_branches(port->value, connections);
+
+	    connections.clear();
       }
 
 	// Now output the resolved values.
-      for (vvp_island_branch*cur = branches_ ; cur ; cur = cur->next_branch) {
-	    vvp_island_branch_tran*tmp = dynamic_cast<vvp_island_branch_tran*>(cur);
-	    assert(tmp);
-	    tmp->run_output();
+      for (size_t idx = 0 ; idx < work_nodes_.size() ; idx += 1) {
+	    vvp_net_t*net = branch_end_net(work_nodes_[idx]);
+	    vvp_island_port*port = island_port(net);
+	    if (port->value.size() != 0) {
+		  island_send_value(net, port->value);
+		  port->value = vvp_vector8_t::nil;
+	    }
       }
+
+      work_nodes_.clear();
 }
 
 static void count_drivers_(vvp_branch_ptr_t cur, bool other_side_visited,
@@ -111,7 +224,7 @@ static void count_drivers_(vvp_branch_ptr_t cur, bool other_side_visited,
 {
         // First count any value driven into the port associated with
         // the current endpoint.
-      vvp_net_t*net = cur.port() ? cur.ptr()->b : cur.ptr()->a;
+      vvp_net_t*net = branch_end_net(cur);
       vvp_scalar_t bit = island_get_value(net).value(bit_idx);
       update_driver_counts(bit.value(), counts);
 
@@ -161,31 +274,16 @@ static void count_drivers_(vvp_branch_ptr_t cur, bool other_side_visited,
 void vvp_island_tran::count_drivers(vvp_island_port*port, unsigned bit_idx,
                                     unsigned counts[3])
 {
-        // First we need to find a branch that is attached to the specified
-        // port. Unfortunately there's no quick way to do this.
-      vvp_island_branch*branch = branches_;
-      unsigned side = 0;
-      while (branch) {
-            if (branch->a->fun == port) {
-                  side = 0;
-                  break;
-            }
-            if (branch->b->fun == port) {
-                  side = 1;
-                  break;
-            }
-            branch = branch->next_branch;
-      }
-      assert(branch);
+        // The port knows one of the branch ends attached to it.
+      assert(! port->node.nil());
 
         // Now count the drivers, pushing through the network as necessary.
-      vvp_branch_ptr_t endpoint(branch, side);
-      count_drivers_(endpoint, false, bit_idx, counts);
+      count_drivers_(port->node, false, bit_idx, counts);
 }
 
 bool vvp_island_branch_tran::run_test_enabled()
 {
-      vvp_island_port*ep = en? dynamic_cast<vvp_island_port*> (en->fun) : 0;
+      vvp_island_port*ep = en_port;
 
 	// If there is no ep port (no "enabled" input) then this is a
 	// tran branch. Assume it is always enabled.
@@ -276,7 +374,7 @@ static void push_value_through_branch(const vvp_vector8_t&val,
       unsigned dst_ab = src_ab^1;
 
       vvp_net_t*dst_net = dst_ab? branch->b : branch->a;
-      vvp_island_port*dst_port = dynamic_cast<vvp_island_port*>(dst_net->fun);
+      vvp_island_port*dst_port = island_port(dst_net);
 
       vvp_vector8_t old_val = dst_port->value;
 
@@ -330,66 +428,6 @@ static void push_value_through_branches(const vvp_vector8_t&val,
       }
 }
 
-/*
- * This method resolves the value for a branch recursively. It uses
- * recursive descent to span the graph of branches, pushing values
- * through the network until a stable state is reached.
- */
-void vvp_island_branch_tran::run_resolution()
-{
-      list<vvp_branch_ptr_t> connections;
-      vvp_island_port*port;
-
-	// If the A side port hasn't already been visited, then push
-        // its input value through all the branches connected to it.
-      port = dynamic_cast<vvp_island_port*>(a->fun);
-      if (port->value.size() == 0) {
-	    vvp_branch_ptr_t a_side(this, 0);
-	    island_collect_node(connections, a_side);
-
-	    port->value = island_get_value(a);
-            if (port->value.size() != 0)
-	          push_value_through_branches(port->value, connections);
-
-            connections.clear();
-      }
-
-	// Do the same for the B side port. Note that if the branch
-        // is enabled, the B side port will have already been visited
-        // when we resolved the A side port.
-      port = dynamic_cast<vvp_island_port*>(b->fun);
-      if (port->value.size() == 0) {
-	    vvp_branch_ptr_t b_side(this, 1);
-	    island_collect_node(connections, b_side);
-
-	    port->value = island_get_value(b);
-	    if (port->value.size() != 0)
-	          push_value_through_branches(port->value, connections);
-
-            connections.clear();
-      }
-}
-
-void vvp_island_branch_tran::run_output()
-{
-      vvp_island_port*port;
-
-	// If the A side port hasn't already been updated, send the
-        // resolved value to the output.
-      port = dynamic_cast<vvp_island_port*>(a->fun);
-      if (port->value.size() != 0) {
-	    island_send_value(a, port->value);
-	    port->value = vvp_vector8_t::nil;
-      }
-
-	// Do the same for the B side port.
-      port = dynamic_cast<vvp_island_port*>(b->fun);
-      if (port->value.size() != 0) {
-	    island_send_value(b, port->value);
-	    port->value = vvp_vector8_t::nil;
-      }
-}
-
 void compile_island_tran(char*label)
 {
       vvp_island*use_island = new vvp_island_tran;
@@ -417,6 +455,14 @@ void compile_island_tranif(int sense, char*island, char*pa, char*pb, char*pe)
 
       use_island->add_branch(br, pa, pb);
 
+	// Add the branch to the list of branches controlled by the
+	// enable port, so that the island knows which branches to
+	// retest when the enable changes.
+      if (br->en_port) {
+	    br->next_ctrl = br->en_port->ctrl_branches;
+	    br->en_port->ctrl_branches = br;
+      }
+
       free(pa);
       free(pb);
 }
@@ -24,22 +24,271 @@
 # include  "schedule.h"
 # include  "delay.h"
 # include  "statistics.h"
+# include  "arith.h"
+# include  "dff.h"
+# include  "part.h"
+# include  "vvp_net_sig.h"
 # include  <iostream>
 # include  <cstring>
 # include  <cassert>
 # include  <cstdlib>
+# include  <map>
+# include  <set>
+# include  <vector>
 
-vvp_fun_boolean_::vvp_fun_boolean_(unsigned wid)
+vvp_fun_boolean_::vvp_fun_boolean_(unsigned wid, op_t op, bool invert)
+: invert_(invert), op_(op), scalar_(wid == 1)
 {
       net_ = 0;
       for (unsigned idx = 0 ;  idx < 4 ;  idx += 1)
 	    input_[idx] = vvp_vector4_t(wid, BIT4_Z);
+      val_ = 0;
+      unk_ = 0x0f;
+      count_functors_logic += 1;
 }
 
 vvp_fun_boolean_::~vvp_fun_boolean_()
 {
 }
 
+/*
+ * All the scalar gates that are scheduled in a time step are
+ * collected here, and the batch is scheduled as a single functor
+ * event. Gates that are triggered while the batch runs go into the
+ * next batch, so the gates are evaluated a level at a time as the
+ * change ripples through the netlist.
+ *
+ * If the netlist is levelized, leveled functors go into the bucket
+ * for their level instead. While the batch runs, a functor triggered
+ * at a level above the one being evaluated joins the current pass.
+ */
+class gate_batch_s : public vvp_gen_event_s {
+
+    public:
+      gate_batch_s() : scheduled_(false), running_(false), cur_level_(0) { }
+
+      void push(vvp_leveled_s*obj);
+      void set_levels(unsigned nlevels) { levels_.resize(nlevels); }
+
+    private:
+      void run_run();
+
+    private:
+      std::vector<vvp_leveled_s*> gates_;
+      std::vector<vvp_leveled_s*> work_;
+      std::vector< std::vector<vvp_leveled_s*> > levels_;
+      bool scheduled_;
+      bool running_;
+      unsigned cur_level_;
+};
+
+static gate_batch_s gate_batch;
+
+void gate_batch_s::push(vvp_leveled_s*obj)
+{
+      unsigned lev = obj->level();
+      if (lev < levels_.size() && (!running_ || lev > cur_level_)) {
+	    levels_[lev].push_back(obj);
+	    if (running_)
+		  return;
+      } else {
+	    gates_.push_back(obj);
+      }
+
+      if (! scheduled_) {
+	    scheduled_ = true;
+	    schedule_functor(this);
+      }
+}
+
+void gate_batch_s::run_run()
+{
+      count_gate_batches += 1;
+      scheduled_ = false;
+      running_ = true;
+
+      work_.swap(gates_);
+      count_gate_evals += work_.size();
+      for (size_t idx = 0 ;  idx < work_.size() ;  idx += 1)
+	    work_[idx]->run_leveled();
+      work_.clear();
+
+      for (cur_level_ = 0 ;  cur_level_ < levels_.size() ;  cur_level_ += 1) {
+	    std::vector<vvp_leveled_s*>&cur = levels_[cur_level_];
+	    count_gate_evals += cur.size();
+	    for (size_t idx = 0 ;  idx < cur.size() ;  idx += 1)
+		  cur[idx]->run_leveled();
+	    cur.clear();
+      }
+
+      running_ = false;
+      cur_level_ = 0;
+}
+
+void schedule_leveled(vvp_leveled_s*obj, vvp_gen_event_t ev)
+{
+      if (obj->level() == vvp_leveled_s::NO_LEVEL)
+	    schedule_functor(ev);
+      else
+	    gate_batch.push(obj);
+}
+
+/*
+ * The compile functions collect the functors that can be leveled
+ * here when levelization is enabled, along with the net of each.
+ */
+bool levelize_flag = false;
+static std::vector<vvp_net_t*> levelize_nets;
+
+void compile_levelize_net(vvp_net_t*net)
+{
+      if (levelize_flag && dynamic_cast<vvp_leveled_s*>(net->fun))
+	    levelize_nets.push_back(net);
+}
+
+/*
+ * These functors pass a change on to their output as they receive
+ * it, so a path through them is a path between leveled functors. A
+ * DFF only does this for the clock and asynchronous inputs, and the
+ * D and enable inputs are a boundary.
+ */
+static bool levelize_transparent(vvp_net_ptr_t ptr)
+{
+      vvp_net_fun_t*fun = ptr.ptr()->fun;
+
+      if (dynamic_cast<vvp_dff*>(fun))
+	    return ptr.port() == 1 || ptr.port() == 3;
+      if (dynamic_cast<vvp_fun_signal4_sa*>(fun))
+	    return ptr.port() == 0;
+
+      return dynamic_cast<vvp_arith_*>(fun)
+	  || dynamic_cast<vvp_arith_real_*>(fun)
+	  || dynamic_cast<vvp_fun_concat*>(fun)
+	  || dynamic_cast<vvp_fun_part_pv*>(fun)
+	  || dynamic_cast<vvp_fun_part_var_sa*>(fun)
+	  || dynamic_cast<vvp_fun_bufz*>(fun)
+	  || dynamic_cast<vvp_fun_drive*>(fun);
+}
+
+void compile_levelize_gates(void)
+{
+      if (levelize_nets.empty())
+	    return;
+
+      size_t nnodes = levelize_nets.size();
+      std::map<vvp_net_t*,unsigned> index;
+      for (unsigned idx = 0 ;  idx < nnodes ;  idx += 1)
+	    index[levelize_nets[idx]] = idx;
+
+	/* Collect the edges between leveled functors, following the
+	   fan-out through the transparent functors. Anything else
+	   that a functor drives (a resolver, a delay, a thread) is a
+	   boundary of the cone. */
+      std::vector< std::vector<unsigned> > succ (nnodes);
+      std::vector<unsigned> indeg (nnodes, 0);
+      for (unsigned idx = 0 ;  idx < nnodes ;  idx += 1) {
+	    std::set<vvp_net_t*> seen;
+	    std::vector<vvp_net_t*> todo;
+	    todo.push_back(levelize_nets[idx]);
+	    while (! todo.empty()) {
+		  vvp_net_ptr_t cur = todo.back()->fanout();
+		  todo.pop_back();
+		  while (vvp_net_t*dst = cur.ptr()) {
+			std::map<vvp_net_t*,unsigned>::iterator hit = index.find(dst);
+			if (hit != index.end()) {
+			      if (seen.insert(dst).second) {
+				    succ[idx].push_back(hit->second);
+				    indeg[hit->second] += 1;
+			      }
+			} else if (levelize_transparent(cur)
+				   && seen.insert(dst).second) {
+			      todo.push_back(dst);
+			}
+			cur = dst->port[cur.port()];
+		  }
+	    }
+      }
+
+	/* Sort the functors topologically. Functors that are still
+	   waiting for an input when the sort runs dry are in or
+	   behind a loop, and stay unleveled. */
+      std::vector<unsigned> level (nnodes, 0);
+      std::vector<unsigned> ready;
+      for (unsigned idx = 0 ;  idx < nnodes ;  idx += 1) {
+	    if (indeg[idx] == 0)
+		  ready.push_back(idx);
+      }
+
+      unsigned nlevels = 0;
+      unsigned nleveled = 0;
+      while (! ready.empty()) {
+	    unsigned cur = ready.back();
+	    ready.pop_back();
+
+	    vvp_leveled_s*obj =
+		  dynamic_cast<vvp_leveled_s*>(levelize_nets[cur]->fun);
+	    obj->set_level(level[cur]);
+	    nleveled += 1;
+	    if (level[cur] >= nlevels)
+		  nlevels = level[cur] + 1;
+
+	    for (size_t idx = 0 ;  idx < succ[cur].size() ;  idx += 1) {
+		  unsigned dst = succ[cur][idx];
+		  if (level[dst] < level[cur] + 1)
+			level[dst] = level[cur] + 1;
+		  indeg[dst] -= 1;
+		  if (indeg[dst] == 0)
+			ready.push_back(dst);
+	    }
+      }
+
+      gate_batch.set_levels(nlevels);
+      count_gates_leveled = nleveled;
+      count_gate_levels = nlevels;
+
+      levelize_nets.clear();
+}
+
+void vvp_fun_boolean_::input_changed_(vvp_net_ptr_t ptr)
+{
+      if (scalar_) {
+	    unsigned port = ptr.port();
+	    unsigned char mask = 1 << port;
+	    if (input_[port].size() != 1) {
+		    // A mis-sized input. Let the general evaluation
+		    // deal with it from now on.
+		  scalar_ = false;
+	    } else switch (input_[port].value(0)) {
+		case BIT4_0:
+		  val_ &= ~mask;
+		  unk_ &= ~mask;
+		  break;
+		case BIT4_1:
+		  val_ |= mask;
+		  unk_ &= ~mask;
+		  break;
+		default:
+		  val_ &= ~mask;
+		  unk_ |= mask;
+		  break;
+	    }
+      }
+
+      if (net_ != 0)
+	    return;
+
+      net_ = ptr.ptr();
+      if (scalar_)
+	    gate_batch.push(this);
+      else
+	    schedule_leveled(this, this);
+}
+
+void vvp_fun_boolean_::run_leveled()
+{
+      run_scalar();
+}
+
 void vvp_fun_boolean_::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                                  vvp_context_t)
 {
@@ -48,10 +297,7 @@ void vvp_fun_boolean_::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
 	    return;
 
       input_[port] = bit;
-      if (net_ == 0) {
-	    net_ = ptr.ptr();
-	    schedule_functor(this);
-      }
+      input_changed_(ptr);
 }
 
 void vvp_fun_boolean_::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
@@ -68,16 +314,59 @@ void vvp_fun_boolean_::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
       if (flag == false)
 	    return;
 
-      if (net_ == 0) {
-	    net_ = ptr.ptr();
-	    schedule_functor(this);
+      input_changed_(ptr);
+}
+
+/*
+ * Evaluate a scalar gate from the packed inputs. A single 0 forces
+ * an AND gate and a single 1 forces an OR gate, otherwise any x or z
+ * input makes the result x.
+ */
+void vvp_fun_boolean_::run_scalar()
+{
+      static const unsigned char parity[16] = {
+	    0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0
+      };
+
+      if (! scalar_) {
+	    run_run();
+	    return;
+      }
+
+      vvp_net_t*ptr = net_;
+      net_ = 0;
+
+      vvp_bit4_t res;
+      switch (op_) {
+	  case OP_AND:
+	    if (~(val_|unk_) & 0x0f)
+		  res = BIT4_0;
+	    else
+		  res = unk_? BIT4_X : BIT4_1;
+	    break;
+	  case OP_OR:
+	    if (val_ & ~unk_)
+		  res = BIT4_1;
+	    else
+		  res = unk_? BIT4_X : BIT4_0;
+	    break;
+	  default:
+	    if (unk_)
+		  res = BIT4_X;
+	    else
+		  res = parity[val_]? BIT4_1 : BIT4_0;
+	    break;
       }
+
+      if (invert_)
+	    res = ~res;
+
+      ptr->send_vec4(vvp_vector4_t(1, res), 0);
 }
 
 vvp_fun_and::vvp_fun_and(unsigned wid, bool invert)
-: vvp_fun_boolean_(wid), invert_(invert)
+: vvp_fun_boolean_(wid, OP_AND, invert)
 {
-      count_functors_logic += 1;
 }
 
 vvp_fun_and::~vvp_fun_and()
@@ -138,7 +427,7 @@ void vvp_fun_buf::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
 
       if (net_ == 0) {
 	    net_ = ptr.ptr();
-	    schedule_functor(this);
+	    schedule_leveled(this, this);
       }
 }
 
@@ -159,7 +448,7 @@ void vvp_fun_buf::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
 
       if (net_ == 0) {
 	    net_ = ptr.ptr();
-	    schedule_functor(this);
+	    schedule_leveled(this, this);
       }
 }
 
@@ -260,7 +549,7 @@ void vvp_fun_muxr::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
 
       if (net_ == 0) {
 	    net_ = ptr.ptr();
-	    schedule_functor(this);
+	    schedule_leveled(this, this);
       }
 }
 
@@ -287,7 +576,7 @@ void vvp_fun_muxr::recv_real(vvp_net_ptr_t ptr, double bit,
 
       if (net_ == 0) {
 	    net_ = ptr.ptr();
-	    schedule_functor(this);
+	    schedule_leveled(this, this);
       }
 }
 
@@ -362,7 +651,7 @@ void vvp_fun_muxz::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
 
       if (net_ == 0) {
 	    net_ = ptr.ptr();
-	    schedule_functor(this);
+	    schedule_leveled(this, this);
       }
 }
 
@@ -393,7 +682,7 @@ void vvp_fun_muxz::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
       }
       if (net_ == 0) {
 	    net_ = ptr.ptr();
-	    schedule_functor(this);
+	    schedule_leveled(this, this);
       }
 }
 
@@ -464,7 +753,7 @@ void vvp_fun_not::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
       input_ = bit;
       if (net_ == 0) {
 	    net_ = ptr.ptr();
-	    schedule_functor(this);
+	    schedule_leveled(this, this);
       }
 }
 
@@ -485,7 +774,7 @@ void vvp_fun_not::recv_vec4_pv(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
 
       if (net_ == 0) {
 	    net_ = ptr.ptr();
-	    schedule_functor(this);
+	    schedule_leveled(this, this);
       }
 }
 
@@ -499,9 +788,8 @@ void vvp_fun_not::run_run()
 }
 
 vvp_fun_or::vvp_fun_or(unsigned wid, bool invert)
-: vvp_fun_boolean_(wid), invert_(invert)
+: vvp_fun_boolean_(wid, OP_OR, invert)
 {
-      count_functors_logic += 1;
 }
 
 vvp_fun_or::~vvp_fun_or()
@@ -535,9 +823,8 @@ void vvp_fun_or::run_run()
 }
 
 vvp_fun_xor::vvp_fun_xor(unsigned wid, bool invert)
-: vvp_fun_boolean_(wid), invert_(invert)
+: vvp_fun_boolean_(wid, OP_XOR, invert)
 {
-      count_functors_logic += 1;
 }
 
 vvp_fun_xor::~vvp_fun_xor()
@@ -670,6 +957,8 @@ void compile_functor(char*label, char*type, unsigned width,
       inputs_connect(net, argc, argv);
       free(argv);
 
+      compile_levelize_net(net);
+
 	/* If both the strengths are the default strong drive, then
 	   there is no need for a specialized driver. Attach the label
 	   to this node and we are finished. */
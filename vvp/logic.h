@@ -23,13 +23,62 @@
 # include  "schedule.h"
 # include  <cstddef>
 
+/*
+ * With the levelize_flag set (vvp -L) the functors that evaluate
+ * through an event of their own (the gates, muxes and part selects)
+ * are sorted into topological levels after the netlist is linked. The
+ * levels are carried through the functors that pass a change on as
+ * they receive it (arithmetic, compares, concatenations, signals and
+ * the clock and asynchronous inputs of a DFF). A gate batch then
+ * evaluates the levels in order, and functors that are triggered at
+ * a higher level are evaluated in the same pass. Thus a change that
+ * enters a loop free cone of zero delay logic evaluates each leveled
+ * functor of the cone at most once, without further events. Functors
+ * that are part of (or fed by) a combinational loop are left
+ * unleveled and schedule themselves as usual.
+ *
+ * A functor that can be leveled derives from vvp_leveled_s, and
+ * calls schedule_leveled instead of schedule_functor.
+ */
+class vvp_leveled_s {
+
+    public:
+      static const unsigned NO_LEVEL = ~0U;
+
+      vvp_leveled_s() : level_(NO_LEVEL) { }
+      virtual ~vvp_leveled_s() { }
+
+      unsigned level() const { return level_; }
+      void set_level(unsigned lev) { level_ = lev; }
+
+	// Evaluate and propagate the functor from the batch.
+      virtual void run_leveled() =0;
+
+    private:
+      unsigned level_;
+};
+
+extern bool levelize_flag;
+extern void schedule_leveled(vvp_leveled_s*obj, vvp_gen_event_t ev);
+extern void compile_levelize_net(vvp_net_t*net);
+extern void compile_levelize_gates(void);
+
 /*
  * vvp_fun_boolean_ is just a common hook for holding operands.
+ *
+ * Gates that are 1 bit wide (the common case in gate level netlists)
+ * also keep their inputs packed as a value and an unknown bit per
+ * port. These gates do not schedule themselves as individual events,
+ * but are collected into a batch that is evaluated by a single event
+ * with a few bit operations per gate.
  */
-class vvp_fun_boolean_ : public vvp_net_fun_t, protected vvp_gen_event_s {
+class vvp_fun_boolean_ : public vvp_net_fun_t, protected vvp_gen_event_s,
+			 public vvp_leveled_s {
 
     public:
-      explicit vvp_fun_boolean_(unsigned wid);
+      enum op_t { OP_AND, OP_OR, OP_XOR };
+
+      explicit vvp_fun_boolean_(unsigned wid, op_t op, bool invert);
       ~vvp_fun_boolean_();
 
       void recv_vec4(vvp_net_ptr_t p, const vvp_vector4_t&bit,
@@ -38,9 +87,24 @@ class vvp_fun_boolean_ : public vvp_net_fun_t, protected vvp_gen_event_s {
 			unsigned base, unsigned wid, unsigned vwid,
                         vvp_context_t);
 
+	// Evaluate and propagate a scalar gate from the batch.
+      void run_scalar();
+
+    private:
+      void input_changed_(vvp_net_ptr_t ptr);
+      void run_leveled();
+
     protected:
       vvp_vector4_t input_[4];
       vvp_net_t*net_;
+      bool invert_;
+
+    private:
+      unsigned char op_;
+      bool scalar_;
+	// Packed inputs of a scalar gate, one bit per port. A port
+	// with the unk_ bit set is x or z.
+      unsigned char val_, unk_;
 };
 
 class vvp_fun_and  : public vvp_fun_boolean_ {
@@ -51,7 +115,6 @@ class vvp_fun_and  : public vvp_fun_boolean_ {
 
     private:
       void run_run();
-      bool invert_;
 };
 
 /*
@@ -60,7 +123,8 @@ class vvp_fun_and  : public vvp_fun_boolean_ {
  * The retransmitted vector has all Z values changed to X, just like
  * the buf(Q,D) gate in Verilog.
  */
-class vvp_fun_buf: public vvp_net_fun_t, private vvp_gen_event_s {
+class vvp_fun_buf: public vvp_net_fun_t, private vvp_gen_event_s,
+		   public vvp_leveled_s {
 
     public:
       explicit vvp_fun_buf(unsigned wid);
@@ -74,6 +138,7 @@ class vvp_fun_buf: public vvp_net_fun_t, private vvp_gen_event_s {
 
     private:
       void run_run();
+      void run_leveled() { run_run(); }
 
     private:
       vvp_vector4_t input_;
@@ -126,7 +191,8 @@ enum sel_type {SEL_PORT0, SEL_PORT1, SEL_BOTH};
  * input (port-0 or port-1) to enter the device. The narrow vector is
  * padded with X values.
  */
-class vvp_fun_muxz : public vvp_net_fun_t, private vvp_gen_event_s {
+class vvp_fun_muxz : public vvp_net_fun_t, private vvp_gen_event_s,
+		     public vvp_leveled_s {
 
     public:
       explicit vvp_fun_muxz(unsigned width);
@@ -140,6 +206,7 @@ class vvp_fun_muxz : public vvp_net_fun_t, private vvp_gen_event_s {
 
     private:
       void run_run();
+      void run_leveled() { run_run(); }
 
     private:
       vvp_vector4_t a_;
@@ -149,7 +216,8 @@ class vvp_fun_muxz : public vvp_net_fun_t, private vvp_gen_event_s {
       bool has_run_;
 };
 
-class vvp_fun_muxr : public vvp_net_fun_t, private vvp_gen_event_s {
+class vvp_fun_muxr : public vvp_net_fun_t, private vvp_gen_event_s,
+		     public vvp_leveled_s {
 
     public:
       explicit vvp_fun_muxr();
@@ -162,6 +230,7 @@ class vvp_fun_muxr : public vvp_net_fun_t, private vvp_gen_event_s {
 
     private:
       void run_run();
+      void run_leveled() { run_run(); }
 
     private:
       double a_;
@@ -170,7 +239,8 @@ class vvp_fun_muxr : public vvp_net_fun_t, private vvp_gen_event_s {
       sel_type select_;
 };
 
-class vvp_fun_not: public vvp_net_fun_t, private vvp_gen_event_s {
+class vvp_fun_not: public vvp_net_fun_t, private vvp_gen_event_s,
+		   public vvp_leveled_s {
 
     public:
       explicit vvp_fun_not(unsigned wid);
@@ -184,6 +254,7 @@ class vvp_fun_not: public vvp_net_fun_t, private vvp_gen_event_s {
 
     private:
       void run_run();
+      void run_leveled() { run_run(); }
 
     private:
       vvp_vector4_t input_;
@@ -198,7 +269,6 @@ class vvp_fun_or  : public vvp_fun_boolean_ {
 
     private:
       void run_run();
-      bool invert_;
 };
 
 class vvp_fun_xor  : public vvp_fun_boolean_ {
@@ -209,7 +279,6 @@ class vvp_fun_xor  : public vvp_fun_boolean_ {
 
     private:
       void run_run();
-      bool invert_;
 };
 
 #endif // __logic_H
@@ -23,10 +23,13 @@
 # include  "parse_misc.h"
 # include  "compile.h"
 # include  "schedule.h"
+# include  "vthread.h"
+# include  "logic.h"
 # include  "vpi_priv.h"
 # include  "statistics.h"
 # include  "vvp_cleanup.h"
 # include  "vvp_object.h"
+# include  "checkpoint.h"
 # include  <cstdio>
 # include  <cstdlib>
 # include  <cstring>
@@ -96,9 +99,9 @@ static void my_getrusage(struct rusage *a)
 #     endif
 }
 
-static void print_rusage(struct rusage *a, struct rusage *b)
+static double rusage_seconds(struct rusage *a, struct rusage *b)
 {
-      double delta = a->ru_utime.tv_sec
+      return a->ru_utime.tv_sec
 	    +        a->ru_utime.tv_usec/1E6
 	    +        a->ru_stime.tv_sec
 	    +        a->ru_stime.tv_usec/1E6
@@ -107,6 +110,11 @@ static void print_rusage(struct rusage *a, struct rusage *b)
 	    -        b->ru_stime.tv_sec
 	    -        b->ru_stime.tv_usec/1E6
 	    ;
+}
+
+static void print_rusage(struct rusage *a, struct rusage *b)
+{
+      double delta = rusage_seconds(a, b);
 
       vpi_mcd_printf(1,
 	      " ... %G seconds,"
@@ -117,12 +125,30 @@ static void print_rusage(struct rusage *a, struct rusage *b)
 	      a->ru_ixrss/1024.0 );
 }
 
+/*
+ * On Linux my_getrusage() replaces ru_maxrss with the current size,
+ * so get the peak resident set size from the system separately. It
+ * is in KBytes except on Mac OS X, which reports bytes.
+ */
+static void print_peak_rss(void)
+{
+      struct rusage tmp;
+      getrusage(RUSAGE_SELF, &tmp);
+#if defined(__APPLE__)
+      tmp.ru_maxrss /= 1024;
+#endif
+      vpi_mcd_printf(1, " ... %ld KBytes peak rss\n", (long)tmp.ru_maxrss);
+}
+
 #else // ! defined(HAVE_SYS_RESOURCE_H)
 
 // Provide dummies
 struct rusage { int x; };
 inline static void my_getrusage(struct rusage *) { }
+inline static double rusage_seconds(struct rusage *, struct rusage *)
+{ return 0.0; }
 inline static void print_rusage(struct rusage *, struct rusage *){};
+inline static void print_peak_rss(void) { }
 
 #endif // ! defined(HAVE_SYS_RESOURCE_H)
 
@@ -227,6 +253,7 @@ static void final_cleanup()
       signal_pool_delete();
       vvp_net_pool_delete();
       ufunc_pool_delete();
+      vthread_pool_delete();
 #endif
 	/*
 	 * Unload the VPI modules. This is essential for MinGW, to ensure
@@ -256,8 +283,10 @@ int main(int argc, char*argv[])
       int opt;
       unsigned flag_errors = 0;
       const char*design_path = 0;
+      const char*restore_path = 0;
       struct rusage cycles[3];
       const char *logfile_name = 0x0;
+      const char *stats_path = 0;
       FILE *logfile = 0x0;
       extern void vpi_set_vlog_info(int, char**);
       extern bool stop_is_finish;
@@ -316,22 +345,28 @@ int main(int argc, char*argv[])
         /* For non-interactive runs we do not want to run the interactive
          * debugger, so make $stop just execute a $finish. */
       stop_is_finish = false;
-      while ((opt = getopt(argc, argv, "+hl:M:m:nNsvV")) != EOF) switch (opt) {
+      while ((opt = getopt(argc, argv, "+hLl:M:m:nNr:svV")) != EOF) switch (opt) {
          case 'h':
            fprintf(stderr,
                    "Usage: vvp [options] input-file [+plusargs...]\n"
+                   "       vvp [options] -r checkpoint [input-file] [+plusargs...]\n"
                    "Options:\n"
                    " -h             Print this help message.\n"
+                   " -L             Levelize zero-delay gate logic.\n"
                    " -l file        Logfile, '-' for <stderr>\n"
                    " -M path        VPI module directory\n"
 		   " -M -           Clear VPI module path\n"
                    " -m module      Load vpi module.\n"
 		   " -n             Non-interactive ($stop = $finish).\n"
                    " -N             Same as -n, but exit code is 1 instead of 0\n"
+                   " -r file        Resume from a $save checkpoint.\n"
 		   " -s             $stop right away.\n"
                    " -v             Verbose progress messages.\n"
                    " -V             Print the version information.\n" );
            exit(0);
+	  case 'L':
+	    levelize_flag = true;
+	    break;
 	  case 'l':
 	    logfile_name = optarg;
 	    break;
@@ -353,6 +388,9 @@ int main(int argc, char*argv[])
             stop_is_finish = true;
             stop_is_finish_exit_code = 1;
             break;
+	  case 'r':
+	    restore_path = optarg;
+	    break;
 	  case 's':
 	    schedule_stop(0);
 	    break;
@@ -391,7 +429,28 @@ int main(int argc, char*argv[])
 	    return 0;
       }
 
-      if (optind == argc) {
+	/* The extended arguments start with the input file. With -r,
+	   the input file may be left out, and is then taken from the
+	   checkpoint. */
+      int vlog_argc = argc-optind;
+      char**vlog_argv = argv+optind;
+
+      if (restore_path) {
+	    std::string restore_design;
+	    if (! checkpoint_open(restore_path, restore_design))
+		  return 1;
+
+	    if (optind == argc || argv[optind][0] == '+') {
+		  vlog_argv = new char*[vlog_argc+2];
+		  vlog_argv[0] = strdup(restore_design.c_str());
+		  for (int idx = 0 ; idx < vlog_argc ; idx += 1)
+			vlog_argv[idx+1] = argv[optind+idx];
+		  vlog_argc += 1;
+		  vlog_argv[vlog_argc] = 0;
+	    }
+      }
+
+      if (vlog_argc == 0) {
 	    fprintf(stderr, "%s: no input file.\n", argv[0]);
 	    return -1;
       }
@@ -403,7 +462,8 @@ int main(int argc, char*argv[])
 	    debug_file.open(path, ios::out);
       }
 
-      design_path = argv[optind];
+      design_path = vlog_argv[0];
+      checkpoint_design_path = design_path;
 
 	/* This is needed to get the MCD I/O routines ready for
 	   anything. It is done early because it is plausible that the
@@ -425,14 +485,33 @@ int main(int argc, char*argv[])
       vpip_mcd_init(logfile);
 
       if (verbose_flag) {
-	    my_getrusage(cycles+0);
 	    vpi_mcd_printf(1, "Compiling VVP ...\n");
       }
 
       vvp_vpi_init();
 
 	/* Make the extended arguments available to the simulation. */
-      vpi_set_vlog_info(argc-optind, argv+optind);
+      vpi_set_vlog_info(vlog_argc, vlog_argv);
+
+	/* The +word-ops extended argument enables the word-sized
+	   opcode variants, and +word-ops=check also cross-checks them
+	   against the generic opcodes. */
+      for (int idx = 1 ;  idx < vlog_argc ;  idx += 1) {
+	    if (strcmp(vlog_argv[idx], "+word-ops") == 0) {
+		  vthread_word_ops = true;
+	    } else if (strcmp(vlog_argv[idx], "+word-ops=check") == 0) {
+		  vthread_word_ops = true;
+		  vthread_word_check = true;
+	    } else if (strncmp(vlog_argv[idx], "+vvp-stats=", 11) == 0) {
+		  stats_path = vlog_argv[idx]+11;
+		  schedule_stats_flag = true;
+	    } else if (strncmp(vlog_argv[idx], "+vvp-delta-limit=", 17) == 0) {
+		  schedule_delta_limit = strtoul(vlog_argv[idx]+17, 0, 10);
+	    }
+      }
+
+      if (verbose_flag || stats_path)
+	    my_getrusage(cycles+0);
 
       compile_init();
 
@@ -471,6 +550,9 @@ int main(int argc, char*argv[])
 #endif
 			   count_functors, vvp_net_fun_t::heap_total());
 	    vpi_mcd_printf(1, "           %8lu logic\n",  count_functors_logic);
+	    if (levelize_flag)
+		  vpi_mcd_printf(1, "           %8lu leveled functors (%lu levels)\n",
+				 count_gates_leveled, count_gate_levels);
 	    vpi_mcd_printf(1, "           %8lu bufif\n",  count_functors_bufif);
 	    vpi_mcd_printf(1, "           %8lu resolv\n",count_functors_resolv);
 	    vpi_mcd_printf(1, "           %8lu signals\n", count_functors_sig);
@@ -504,8 +586,9 @@ int main(int argc, char*argv[])
 	    vpi_mcd_printf(1, " ... %8lu scopes\n",   count_vpi_scopes);
       }
 
-      if (verbose_flag) {
+      if (verbose_flag || stats_path)
 	    my_getrusage(cycles+1);
+      if (verbose_flag) {
 	    print_rusage(cycles+1, cycles+0);
 	    vpi_mcd_printf(1, "Running ...\n");
       }
@@ -513,15 +596,27 @@ int main(int argc, char*argv[])
 
       schedule_simulate();
 
-      if (verbose_flag) {
+      if (verbose_flag || stats_path)
 	    my_getrusage(cycles+2);
+      if (verbose_flag) {
 	    print_rusage(cycles+2, cycles+1);
+	    print_peak_rss();
 
 	    vpi_mcd_printf(1, "Event counts:\n");
 	    vpi_mcd_printf(1, "    %8lu time steps (pool=%lu)\n",
 			   count_time_events, count_time_pool());
 	    vpi_mcd_printf(1, "    %8lu thread schedule events\n",
 		    count_thread_events);
+	    vpi_mcd_printf(1, "    %8lu threads created (allocated=%lu)\n",
+			   count_vthreads, count_vthread_allocs);
+	    vpi_mcd_printf(1, "    %8lu inline function calls\n",
+			   count_vthread_calls);
+	    vpi_mcd_printf(1, "    %8lu instructions executed\n",
+			   count_vthread_instructions);
+	    if (vthread_word_ops)
+		  vpi_mcd_printf(1, "    %8lu opcodes replaced by word variants "
+				 "(mismatches=%lu)\n", count_word_opcodes,
+				 count_word_mismatches);
 	    vpi_mcd_printf(1, "    %8lu assign events\n",
 		    count_assign_events);
 	    vpi_mcd_printf(1, "             ...assign(vec4) pool=%lu\n",
@@ -536,6 +631,16 @@ int main(int argc, char*argv[])
 			   count_assign_arword_pool());
 	    vpi_mcd_printf(1, "    %8lu other events (pool=%lu)\n",
 			   count_gen_events, count_gen_pool());
+	    vpi_mcd_printf(1, "    %8lu gate evaluations (batches=%lu)\n",
+			   count_gate_evals, count_gate_batches);
+      }
+
+	/* A test of $ivl_fork_tests writes its own statistics file. */
+      if (stats_path) {
+	    char*path = vpip_fork_path(stats_path);
+	    stats_write_json(path, rusage_seconds(cycles+1, cycles+0),
+			     rusage_seconds(cycles+2, cycles+1));
+	    free(path);
       }
 
       final_cleanup();
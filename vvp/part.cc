@@ -20,6 +20,7 @@
 # define __STDC_LIMIT_MACROS
 # include  "compile.h"
 # include  "part.h"
+# include  "checkpoint.h"
 # include  <cstdlib>
 # include  <climits>
 # include  <stdint.h>
@@ -69,7 +70,7 @@ void vvp_fun_part_sa::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
 
       if (net_ == 0) {
 	    net_ = port.ptr();
-	    schedule_functor(this);
+	    schedule_leveled(this, this);
       }
 }
 
@@ -131,6 +132,24 @@ void vvp_fun_part_aa::free_instance(vvp_context_t context)
 }
 #endif
 
+void vvp_fun_part_aa::checkpoint_save(vvp_context_t context,
+				      checkpoint_out&out) const
+{
+      vvp_vector4_t*val = static_cast<vvp_vector4_t*>
+            (vvp_get_context_item(context, context_idx_));
+
+      out.put_vec4(*val);
+}
+
+void vvp_fun_part_aa::checkpoint_restore(vvp_context_t context,
+					 checkpoint_in&in)
+{
+      vvp_vector4_t*val = static_cast<vvp_vector4_t*>
+            (vvp_get_context_item(context, context_idx_));
+
+      *val = in.get_vec4();
+}
+
 void vvp_fun_part_aa::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
                                 vvp_context_t context)
 {
@@ -351,6 +370,28 @@ void vvp_fun_part_var_aa::free_instance(vvp_context_t context)
 }
 #endif
 
+void vvp_fun_part_var_aa::checkpoint_save(vvp_context_t context,
+					  checkpoint_out&out) const
+{
+      vvp_fun_part_var_state_s*state = static_cast<vvp_fun_part_var_state_s*>
+            (vvp_get_context_item(context, context_idx_));
+
+      out.put_int(state->base);
+      out.put_vec4(state->source);
+      out.put_vec4(state->ref);
+}
+
+void vvp_fun_part_var_aa::checkpoint_restore(vvp_context_t context,
+					     checkpoint_in&in)
+{
+      vvp_fun_part_var_state_s*state = static_cast<vvp_fun_part_var_state_s*>
+            (vvp_get_context_item(context, context_idx_));
+
+      state->base = in.get_int();
+      state->source = in.get_vec4();
+      state->ref = in.get_vec4();
+}
+
 void vvp_fun_part_var_aa::recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
                                     vvp_context_t context)
 {
@@ -409,6 +450,7 @@ void link_node_1(char*label, char*source, vvp_net_fun_t*fun)
       free(label);
 
       input_connect(net, 0, source);
+      compile_levelize_net(net);
 }
 
 void compile_part_select(char*label, char*source,
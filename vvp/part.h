@@ -20,6 +20,7 @@
  */
 
 # include  "schedule.h"
+# include  "logic.h"
 # include  "config.h"
 
 /* vvp_fun_part
@@ -42,7 +43,8 @@ class vvp_fun_part  : public vvp_net_fun_t {
 /*
  * Statically allocated vvp_fun_part.
  */
-class vvp_fun_part_sa  : public vvp_fun_part, public vvp_gen_event_s {
+class vvp_fun_part_sa  : public vvp_fun_part, public vvp_gen_event_s,
+			 public vvp_leveled_s {
 
     public:
       vvp_fun_part_sa(unsigned base, unsigned wid);
@@ -58,6 +60,7 @@ class vvp_fun_part_sa  : public vvp_fun_part, public vvp_gen_event_s {
 
     private:
       void run_run();
+      void run_leveled() { run_run(); }
 
     private:
       vvp_vector4_t val_;
@@ -79,6 +82,8 @@ class vvp_fun_part_aa  : public vvp_fun_part, public automatic_hooks_s {
 #ifdef CHECK_WITH_VALGRIND
       void free_instance(vvp_context_t context);
 #endif
+      void checkpoint_save(vvp_context_t context, checkpoint_out&out) const;
+      void checkpoint_restore(vvp_context_t context, checkpoint_in&in);
 
       void recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
                      vvp_context_t context);
@@ -176,6 +181,8 @@ class vvp_fun_part_var_aa  : public vvp_fun_part_var, public automatic_hooks_s {
 #ifdef CHECK_WITH_VALGRIND
       void free_instance(vvp_context_t context);
 #endif
+      void checkpoint_save(vvp_context_t context, checkpoint_out&out) const;
+      void checkpoint_restore(vvp_context_t context, checkpoint_in&in);
 
       void recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
                      vvp_context_t context);
@@ -157,7 +157,7 @@ void resolv_tri::recv_vec8_(unsigned port, const vvp_vector8_t&bit)
                   if (out.size() == 0)
                         out = val_[ip];
                   else
-                        out = resolve(out, val_[ip]);
+                        resolve_in_place(out, val_[ip]);
             }
             if (val_[op].eeq(out))
                   return;
@@ -169,10 +169,12 @@ void resolv_tri::recv_vec8_(unsigned port, const vvp_vector8_t&bit)
       }
 
       if (! hiz_value_.is_hiz()) {
-	    for (unsigned idx = 0 ;  idx < val_[base].size() ;  idx += 1) {
-		  val_[base].set_bit(idx, resolve(val_[base].value(idx),
-						  hiz_value_));
+	    if (hiz_vec_.size() != val_[base].size()) {
+		  hiz_vec_ = vvp_vector8_t(val_[base].size());
+		  for (unsigned idx = 0 ;  idx < hiz_vec_.size() ;  idx += 1)
+			hiz_vec_.set_bit(idx, hiz_value_);
 	    }
+	    resolve_in_place(val_[base], hiz_vec_);
       }
 
       net_->send_vec8(val_[base]);
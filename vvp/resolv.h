@@ -124,8 +124,10 @@ class resolv_tri : public resolv_core {
       void recv_vec8_(unsigned port, const vvp_vector8_t&bit);
 
     private:
-        // The puller value to be used when a bit is not driven.
+        // The puller value to be used when a bit is not driven, and
+        // a vector of that value to resolve with the output.
       vvp_scalar_t hiz_value_;
+      vvp_vector8_t hiz_vec_;
         // The array of input values.
       vvp_vector8_t*val_;
 };
@@ -22,13 +22,19 @@
 # include  "vpi_priv.h"
 # include  "slab.h"
 # include  "compile.h"
+# include  "checkpoint.h"
+# include  "statistics.h"
 # include  <new>
 # include  <typeinfo>
 # include  <csignal>
 # include  <cstdlib>
 # include  <cassert>
+# include  <cstring>
 
+# include  <algorithm>
 # include  <iostream>
+# include  <map>
+# include  <vector>
 
 unsigned long count_assign_events = 0;
 unsigned long count_gen_events = 0;
@@ -38,6 +44,21 @@ unsigned long count_time_events = 0;
 
 
 
+/*
+ * A hot spot is an object that the events of a time step trigger
+ * again and again. The scheduler counts them when a time step gets
+ * close to the delta limit.
+ */
+enum hot_spot_kind_t { HOT_NONE, HOT_NET, HOT_FUNCTOR, HOT_EVENT, HOT_THREAD,
+		       HOT_ARRAY };
+
+struct hot_spot_s {
+      hot_spot_kind_t kind;
+      void*obj;
+      const char*type;
+      unsigned long count;
+};
+
 /*
  * The event_s and event_time_s structures implement the Verilog
  * stratified event queue.
@@ -55,6 +76,12 @@ struct event_s {
 
 	// Write something about the event to stderr
       virtual void single_step_display(void);
+	// The (mangled) name of the type of functor that the event
+	// runs, for the +vvp-stats counts.
+      virtual const char*functor_type(void);
+	// The net, functor or thread that the event triggers, for the
+	// +vvp-delta-limit report.
+      virtual void hot_spot(struct hot_spot_s&spot);
 
 	// Fallback new/delete
       static void*operator new (size_t size) { return ::new char[size]; }
@@ -66,6 +93,23 @@ void event_s::single_step_display(void)
       std::cerr << "event_s: Step into event " << typeid(*this).name() << std::endl;
 }
 
+const char* event_s::functor_type(void)
+{
+      return typeid(*this).name();
+}
+
+static const char* net_functor_type(vvp_net_t*net)
+{
+      if (net == 0 || net->fun == 0) return "vvp_net_t";
+      return typeid(*net->fun).name();
+}
+
+void event_s::hot_spot(struct hot_spot_s&spot)
+{
+      spot.kind = HOT_NONE;
+      spot.obj = 0;
+}
+
 struct event_time_s {
       event_time_s() {
 	    count_time_events += 1;
@@ -108,6 +152,9 @@ struct vthread_event_s : public event_s {
       vthread_t thr;
       void run_run(void);
       void single_step_display(void);
+      const char*functor_type(void) { return "vthread"; }
+      void hot_spot(struct hot_spot_s&spot)
+      { spot.kind = HOT_THREAD; spot.obj = thr; }
 
       static void* operator new(size_t);
       static void operator delete(void*);
@@ -182,6 +229,9 @@ struct assign_vector4_event_s  : public event_s {
       unsigned vwid;
       void run_run(void);
       void single_step_display(void);
+      const char*functor_type(void) { return net_functor_type(ptr.ptr()); }
+      void hot_spot(struct hot_spot_s&spot)
+      { spot.kind = HOT_NET; spot.obj = ptr.ptr(); }
 
       static void* operator new(size_t);
       static void operator delete(void*);
@@ -223,6 +273,9 @@ struct assign_vector8_event_s  : public event_s {
       vvp_vector8_t val;
       void run_run(void);
       void single_step_display(void);
+      const char*functor_type(void) { return net_functor_type(ptr.ptr()); }
+      void hot_spot(struct hot_spot_s&spot)
+      { spot.kind = HOT_NET; spot.obj = ptr.ptr(); }
 
       static void* operator new(size_t);
       static void operator delete(void*);
@@ -260,6 +313,9 @@ struct assign_real_event_s  : public event_s {
       double val;
       void run_run(void);
       void single_step_display(void);
+      const char*functor_type(void) { return net_functor_type(ptr.ptr()); }
+      void hot_spot(struct hot_spot_s&spot)
+      { spot.kind = HOT_NET; spot.obj = ptr.ptr(); }
 
       static void* operator new(size_t);
       static void operator delete(void*);
@@ -298,6 +354,9 @@ struct assign_array_word_s  : public event_s {
       vvp_vector4_t val;
       unsigned off;
       void run_run(void);
+      const char*functor_type(void) { return "array"; }
+      void hot_spot(struct hot_spot_s&spot)
+      { spot.kind = HOT_ARRAY; spot.obj = mem; }
 
       static void* operator new(size_t);
       static void operator delete(void*);
@@ -347,6 +406,9 @@ struct propagate_vector4_event_s : public event_s {
 	/* Action */
       void run_run(void);
       void single_step_display(void);
+      const char*functor_type(void) { return net_functor_type(net); }
+      void hot_spot(struct hot_spot_s&spot)
+      { spot.kind = HOT_NET; spot.obj = net; }
 };
 
 void propagate_vector4_event_s::run_run(void)
@@ -371,6 +433,9 @@ struct propagate_real_event_s : public event_s {
 	/* Action */
       void run_run(void);
       void single_step_display(void);
+      const char*functor_type(void) { return net_functor_type(net); }
+      void hot_spot(struct hot_spot_s&spot)
+      { spot.kind = HOT_NET; spot.obj = net; }
 };
 
 void propagate_real_event_s::run_run(void)
@@ -388,6 +453,9 @@ struct assign_array_r_word_s  : public event_s {
       unsigned adr;
       double val;
       void run_run(void);
+      const char*functor_type(void) { return "array"; }
+      void hot_spot(struct hot_spot_s&spot)
+      { spot.kind = HOT_ARRAY; spot.obj = mem; }
 
       static void* operator new(size_t);
       static void operator delete(void*);
@@ -419,6 +487,8 @@ struct generic_event_s : public event_s {
       bool delete_obj_when_done;
       void run_run(void);
       void single_step_display(void);
+      const char*functor_type(void);
+      void hot_spot(struct hot_spot_s&spot);
 
       static void* operator new(size_t);
       static void operator delete(void*);
@@ -439,6 +509,25 @@ void generic_event_s::single_step_display(void)
       obj->single_step_display();
 }
 
+const char* generic_event_s::functor_type(void)
+{
+      if (obj == 0) return "vvp_gen_event_s";
+      return typeid(*obj).name();
+}
+
+  /* An object that is deleted when done is made for this one event,
+     so these are counted by type. */
+void generic_event_s::hot_spot(struct hot_spot_s&spot)
+{
+      if (delete_obj_when_done) {
+	    spot.kind = HOT_EVENT;
+	    spot.obj = const_cast<char*>(functor_type());
+      } else {
+	    spot.kind = HOT_FUNCTOR;
+	    spot.obj = obj;
+      }
+}
+
 static const size_t GENERIC_CHUNK_COUNT = 131072 / sizeof(struct generic_event_s);
 static slab_t<sizeof(generic_event_s),GENERIC_CHUNK_COUNT> generic_event_heap;
 
@@ -953,6 +1042,357 @@ extern void vpiStartOfSim();
 extern void vpiPostsim();
 extern void vpiNextSimTime(void);
 
+/*
+ * With +vvp-stats=<file>, the main loop also keeps counts for each
+ * time step: the events that run from each queue, and the number of
+ * delta cycles (see below). The active events that a time step runs
+ * are those it pulls from the active queue less those moved there
+ * from the nbassign and rwsync queues, and the events that run are
+ * also counted by the type of functor that they run. The counts are
+ * written by schedule_stats_json.
+ */
+bool schedule_stats_flag = false;
+
+enum { STATS_ACTIVE = 0, STATS_NBASSIGN, STATS_RWSYNC, STATS_ROSYNC,
+       STATS_QUEUES };
+
+static const char*stats_queue_name[STATS_QUEUES] = {
+      "active", "nbassign", "rwsync", "rosync"
+};
+
+struct stats_step_s {
+      vvp_time64_t time;
+      unsigned long events[STATS_QUEUES];
+      unsigned long deltas;
+
+      unsigned long total() const
+      { return events[STATS_ACTIVE] + events[STATS_NBASSIGN]
+	      + events[STATS_RWSYNC] + events[STATS_ROSYNC]; }
+};
+
+static const unsigned STATS_BUSIEST = 10;
+
+static struct stats_step_s stats_step;
+static unsigned long stats_pulled = 0;
+static unsigned long stats_steps = 0;
+static unsigned long stats_total[STATS_QUEUES];
+static unsigned long stats_max[STATS_QUEUES];
+static unsigned long stats_max_deltas = 0;
+static vvp_time64_t stats_max_deltas_time = 0;
+static unsigned long stats_delta_hist[STATS_HIST_SIZE];
+static unsigned long stats_event_hist[STATS_HIST_SIZE];
+static struct stats_step_s stats_busiest[STATS_BUSIEST];
+static unsigned stats_busiest_count = 0;
+static std::map<const char*,unsigned long> stats_functor_events;
+
+static unsigned long stats_list_length(struct event_s*list)
+{
+      if (list == 0) return 0;
+
+      unsigned long cnt = 1;
+      for (struct event_s*cur = list->next ; cur != list ; cur = cur->next)
+	    cnt += 1;
+      return cnt;
+}
+
+  /* The nbassign or rwsync queue was moved to the active queue. */
+static void stats_move_queue(unsigned queue, struct event_s*list)
+{
+      stats_step.events[queue] += stats_list_length(list);
+}
+
+static void stats_pull_event(struct event_s*cur)
+{
+      stats_pulled += 1;
+      stats_functor_events[cur->functor_type()] += 1;
+}
+
+static void stats_end_step(unsigned long deltas, unsigned long rosync)
+{
+      stats_step.time = schedule_time;
+      stats_step.deltas = deltas;
+      stats_step.events[STATS_ROSYNC] = rosync;
+      stats_step.events[STATS_ACTIVE] = stats_pulled
+	    - stats_step.events[STATS_NBASSIGN]
+	    - stats_step.events[STATS_RWSYNC];
+
+      stats_steps += 1;
+      for (unsigned idx = 0 ; idx < STATS_QUEUES ; idx += 1) {
+	    stats_total[idx] += stats_step.events[idx];
+	    if (stats_step.events[idx] > stats_max[idx])
+		  stats_max[idx] = stats_step.events[idx];
+      }
+      if (stats_step.deltas > stats_max_deltas) {
+	    stats_max_deltas = stats_step.deltas;
+	    stats_max_deltas_time = schedule_time;
+      }
+      stats_delta_hist[stats_hist_bucket(stats_step.deltas)] += 1;
+      stats_event_hist[stats_hist_bucket(stats_step.total())] += 1;
+
+	/* Keep the busiest time steps, busiest first. */
+      unsigned long total = stats_step.total();
+      unsigned pos = stats_busiest_count;
+      while (pos > 0 && stats_busiest[pos-1].total() < total)
+	    pos -= 1;
+      if (pos < STATS_BUSIEST) {
+	    unsigned last = stats_busiest_count < STATS_BUSIEST
+		  ? stats_busiest_count : STATS_BUSIEST-1;
+	    for (unsigned idx = last ; idx > pos ; idx -= 1)
+		  stats_busiest[idx] = stats_busiest[idx-1];
+	    stats_busiest[pos] = stats_step;
+	    if (stats_busiest_count < STATS_BUSIEST)
+		  stats_busiest_count += 1;
+      }
+
+      memset(&stats_step, 0, sizeof stats_step);
+      stats_pulled = 0;
+}
+
+static void stats_json_step(FILE*fd, const struct stats_step_s&step)
+{
+      fprintf(fd, "{\"time\": %" TIME_FMT_U ", \"deltas\": %lu",
+	      step.time, step.deltas);
+      for (unsigned idx = 0 ; idx < STATS_QUEUES ; idx += 1)
+	    fprintf(fd, ", \"%s\": %lu", stats_queue_name[idx],
+		    step.events[idx]);
+      fprintf(fd, "}");
+}
+
+void schedule_stats_json(FILE*fd)
+{
+      fprintf(fd, "  \"scheduler\": {\n");
+      fprintf(fd, "    \"time_steps\": %lu,\n", stats_steps);
+
+      fprintf(fd, "    \"queues\": {");
+      for (unsigned idx = 0 ; idx < STATS_QUEUES ; idx += 1)
+	    fprintf(fd, "%s\n      \"%s\": {\"events\": %lu, "
+		    "\"max_per_step\": %lu}", idx? "," : "",
+		    stats_queue_name[idx], stats_total[idx], stats_max[idx]);
+      fprintf(fd, "\n    },\n");
+
+      fprintf(fd, "    \"max_deltas_per_step\": %lu,\n", stats_max_deltas);
+      fprintf(fd, "    \"max_deltas_time\": %" TIME_FMT_U ",\n",
+	      stats_max_deltas_time);
+      fprintf(fd, "    \"delta_histogram\": ");
+      stats_json_histogram(fd, stats_delta_hist);
+      fprintf(fd, ",\n    \"events_per_step_histogram\": ");
+      stats_json_histogram(fd, stats_event_hist);
+
+      fprintf(fd, ",\n    \"busiest_steps\": [");
+      for (unsigned idx = 0 ; idx < stats_busiest_count ; idx += 1) {
+	    fprintf(fd, "%s\n      ", idx? "," : "");
+	    stats_json_step(fd, stats_busiest[idx]);
+      }
+      fprintf(fd, "\n    ],\n");
+
+	/* The same type may have more than one name pointer, so
+	   merge the counts by name. */
+      std::map<std::string,unsigned long> by_name;
+      for (std::map<const char*,unsigned long>::const_iterator cur
+		 = stats_functor_events.begin()
+		 ; cur != stats_functor_events.end() ; ++ cur )
+	    by_name[stats_type_name(cur->first)] += cur->second;
+
+      fprintf(fd, "    \"events_per_functor\": {");
+      bool first = true;
+      for (std::map<std::string,unsigned long>::const_iterator cur
+		 = by_name.begin() ; cur != by_name.end() ; ++ cur ) {
+	    fprintf(fd, "%s\n      ", first? "" : ",");
+	    stats_json_string(fd, cur->first.c_str());
+	    fprintf(fd, ": %lu", cur->second);
+	    first = false;
+      }
+      fprintf(fd, "\n    }\n");
+      fprintf(fd, "  }");
+}
+
+/*
+ * The main loop counts the delta cycles of a time step when the
+ * statistics or the delta limit need them. A delta cycle is a
+ * generation of active events: it starts with the events that are
+ * in the active queue, and ends when the last of them has run. The
+ * events that these schedule in the current time step (directly, or
+ * through the nbassign and rwsync queues) make the next delta cycle.
+ * The delta_mark is the last event of the current delta cycle, or
+ * nil if the next event that runs starts a new one.
+ *
+ * A zero delay loop never leaves its time step, so with
+ * +vvp-delta-limit=<n> the time step is stopped at delta cycle n+1.
+ * For the last HOT_SPOT_DELTAS delta cycles before that, the loop
+ * counts the objects that the events trigger, and the report lists
+ * those that are triggered the most, which are the objects of the
+ * loop.
+ */
+unsigned long schedule_delta_limit = 0;
+
+static bool schedule_count_deltas = false;
+static struct event_s*delta_mark = 0;
+static unsigned long step_deltas = 0;
+
+static const unsigned long HOT_SPOT_DELTAS = 100;
+static const unsigned HOT_SPOT_REPORT = 10;
+static bool hot_spot_flag = false;
+static std::map<void*,struct hot_spot_s> hot_spot_map;
+
+  /* The first delta cycle of a time step whose hot spots count. */
+static unsigned long hot_spot_start(void)
+{
+      if (schedule_delta_limit > HOT_SPOT_DELTAS)
+	    return schedule_delta_limit - HOT_SPOT_DELTAS + 1;
+      return 1;
+}
+
+static bool hot_spot_order(const struct hot_spot_s&a, const struct hot_spot_s&b)
+{
+      return a.count > b.count;
+}
+
+static void hot_spot_count(struct event_s*cur)
+{
+      struct hot_spot_s spot;
+      cur->hot_spot(spot);
+      if (spot.obj == 0) return;
+
+      std::map<void*,struct hot_spot_s>::iterator cur_spot
+	    = hot_spot_map.find(spot.obj);
+      if (cur_spot == hot_spot_map.end()) {
+	    spot.type = cur->functor_type();
+	    spot.count = 1;
+	    hot_spot_map[spot.obj] = spot;
+      } else {
+	    cur_spot->second.count += 1;
+      }
+}
+
+/*
+ * The signals, variables and memories of the design, by the nets (and
+ * functors) that hold their value. Only the report uses these, so
+ * they are made when it is needed.
+ */
+static std::map<void*,vpiHandle> hot_spot_names;
+
+class hot_spot_walker : public vpip_scope_walker {
+    public:
+      void visit_item(vpiHandle item);
+};
+
+void hot_spot_walker::visit_item(vpiHandle item)
+{
+      if (vvp_net_t*net = vpip_item_net(item)) {
+	    hot_spot_names[net] = item;
+	    if (net->fun)
+		  hot_spot_names[dynamic_cast<void*>(net->fun)] = item;
+      } else if (vvp_array_t array = array_from_handle(item)) {
+	    hot_spot_names[array] = item;
+      }
+}
+
+static vpiHandle hot_spot_name(void*obj)
+{
+      if (hot_spot_names.empty()) {
+	    hot_spot_walker walker;
+	    vpip_walk_scopes(walker);
+      }
+
+      std::map<void*,vpiHandle>::const_iterator cur = hot_spot_names.find(obj);
+      if (cur == hot_spot_names.end())
+	    return 0;
+      return cur->second;
+}
+
+static void hot_spot_print_scope(struct __vpiScope*scope)
+{
+      if (scope == 0) return;
+      vpi_printf(" in %s", scope->vpi_get_str(vpiFullName));
+      if (scope->file_idx < file_names.size())
+	    vpi_printf(" (%s:%u)", file_names[scope->file_idx], scope->lineno);
+}
+
+static void hot_spot_print_named(vpiHandle item)
+{
+      vpi_printf(" %s", vpi_get_str(vpiFullName, item));
+      hot_spot_print_scope(dynamic_cast<__vpiScope*>(vpi_handle(vpiScope, item)));
+}
+
+/*
+ * A net that is not a signal is the output of a functor, so name the
+ * first signal that it drives instead.
+ */
+static void hot_spot_print_net(vvp_net_t*net)
+{
+      vpi_printf(" net");
+      if (vpiHandle item = hot_spot_name(net)) {
+	    hot_spot_print_named(item);
+	    return;
+      }
+
+      for (vvp_net_ptr_t cur = net->fanout() ; ! cur.nil()
+		 ; cur = cur.ptr()->port[cur.port()]) {
+	    if (vpiHandle item = hot_spot_name(cur.ptr())) {
+		  vpi_printf(" that drives");
+		  hot_spot_print_named(item);
+		  return;
+	    }
+      }
+}
+
+static void hot_spot_report(void)
+{
+      vpi_printf("ERROR: The time step at %" TIME_FMT_U " has run %lu delta "
+		 "cycles, which is the limit set with +vvp-delta-limit.\n",
+		 schedule_time, schedule_delta_limit);
+      vpi_printf("     : There is probably a zero delay loop. These are the "
+		 "objects that were\n");
+      vpi_printf("     : triggered the most in the last %lu delta cycles:\n",
+		 schedule_delta_limit - hot_spot_start() + 1);
+
+      std::vector<struct hot_spot_s> spots;
+      for (std::map<void*,struct hot_spot_s>::const_iterator cur
+		 = hot_spot_map.begin() ; cur != hot_spot_map.end() ; ++ cur )
+	    spots.push_back(cur->second);
+      std::stable_sort(spots.begin(), spots.end(), hot_spot_order);
+      if (spots.size() > HOT_SPOT_REPORT)
+	    spots.resize(HOT_SPOT_REPORT);
+
+      for (unsigned idx = 0 ; idx < spots.size() ; idx += 1) {
+	    const struct hot_spot_s&spot = spots[idx];
+	    vpi_printf("     : %8lu", spot.count);
+	    switch (spot.kind) {
+		case HOT_NET:
+		  hot_spot_print_net(static_cast<vvp_net_t*>(spot.obj));
+		  break;
+		case HOT_THREAD:
+		  vpi_printf(" thread");
+		  hot_spot_print_scope(vthread_scope(static_cast<vthread_t>(spot.obj)));
+		  break;
+		case HOT_ARRAY:
+		  vpi_printf(" memory");
+		  if (vpiHandle item = hot_spot_name(spot.obj))
+			hot_spot_print_named(item);
+		  break;
+		case HOT_FUNCTOR:
+		    /* A functor may also be a net functor, so look
+		       it up by the address of the whole object. */
+		  if (vpiHandle item = hot_spot_name(dynamic_cast<void*>
+				     (static_cast<vvp_gen_event_t>(spot.obj)))) {
+			vpi_printf(" functor of");
+			hot_spot_print_named(item);
+		  } else {
+			vpi_printf(" functor");
+		  }
+		  break;
+		case HOT_EVENT:
+		  vpi_printf(" events");
+		  break;
+		case HOT_NONE:
+		  break;
+	    }
+	    vpi_printf(" [%s]\n", stats_type_name(spot.type).c_str());
+      }
+
+      hot_spot_names.clear();
+}
+
 /*
  * The scheduler uses this function to drain the rosync events of the
  * current time. The ctim object is still in the event queue, because
@@ -963,8 +1403,9 @@ extern void vpiNextSimTime(void);
  * Once all the rosync callbacks are done we can safely delete any
  * threads that finished during this time step.
  */
-static void run_rosync(struct event_time_s*ctim)
+static unsigned long run_rosync(struct event_time_s*ctim)
 {
+      unsigned long count = 0;
       while (ctim->rosync) {
 	    struct event_s*cur = ctim->rosync->next;
 	    if (cur->next == cur) {
@@ -975,6 +1416,7 @@ static void run_rosync(struct event_time_s*ctim)
 
 	    cur->run_run();
 	    delete cur;
+	    count += 1;
       }
 
       while (ctim->del_thr) {
@@ -993,6 +1435,393 @@ static void run_rosync(struct event_time_s*ctim)
 	    cerr << "SCHEDULER ERROR: read-only sync events "
 		 << "created RW events!" << endl;
       }
+
+      return count;
+}
+
+/*
+ * Checkpoints save the event queue as a list of time steps, each
+ * with its absolute time and its lists of events. Only the kinds of
+ * events that a suspended design holds are known: resumed threads,
+ * non-blocking assignments to variables and array words. A delayed
+ * net value and a VPI callback are generic events, and carry state
+ * that a checkpoint cannot name, so they prevent the checkpoint.
+ */
+enum { CKPT_EV_END = 0, CKPT_EV_THREAD, CKPT_EV_ASSIGN4, CKPT_EV_ASSIGNR,
+       CKPT_EV_AWORD, CKPT_EV_ARWORD };
+
+static void checkpoint_save_event(checkpoint_out&out, struct event_s*cur)
+{
+      if (vthread_event_s*thr_ev = dynamic_cast<vthread_event_s*>(cur)) {
+	      /* A disabled thread that is still scheduled is not
+		 saved, so neither is its event. */
+	    unsigned long id = vthread_checkpoint_id(thr_ev->thr);
+	    if (id == 0) return;
+	    out.put_uint(CKPT_EV_THREAD);
+	    out.put_uint(id);
+
+      } else if (assign_vector4_event_s*as4 = dynamic_cast<assign_vector4_event_s*>(cur)) {
+	    unsigned long idx = checkpoint_net_index(as4->ptr.ptr());
+	    if (idx == 0) {
+		  out.refuse("a non-blocking assignment to a net or "
+			     "automatic variable is pending");
+		  return;
+	    }
+	    out.put_uint(CKPT_EV_ASSIGN4);
+	    out.put_uint(idx);
+	    out.put_uint(as4->ptr.port());
+	    out.put_uint(as4->base);
+	    out.put_uint(as4->vwid);
+	    out.put_vec4(as4->val);
+
+      } else if (assign_real_event_s*asr = dynamic_cast<assign_real_event_s*>(cur)) {
+	    unsigned long idx = checkpoint_net_index(asr->ptr.ptr());
+	    if (idx == 0) {
+		  out.refuse("a non-blocking assignment to a net or "
+			     "automatic variable is pending");
+		  return;
+	    }
+	    out.put_uint(CKPT_EV_ASSIGNR);
+	    out.put_uint(idx);
+	    out.put_uint(asr->ptr.port());
+	    out.put_real(asr->val);
+
+      } else if (assign_array_word_s*aw = dynamic_cast<assign_array_word_s*>(cur)) {
+	    unsigned long idx = checkpoint_array_index(aw->mem);
+	    if (idx == 0) {
+		  out.refuse("a non-blocking assignment to an automatic "
+			     "array is pending");
+		  return;
+	    }
+	    out.put_uint(CKPT_EV_AWORD);
+	    out.put_uint(idx);
+	    out.put_uint(aw->adr);
+	    out.put_uint(aw->off);
+	    out.put_vec4(aw->val);
+
+      } else if (assign_array_r_word_s*arw = dynamic_cast<assign_array_r_word_s*>(cur)) {
+	    unsigned long idx = checkpoint_array_index(arw->mem);
+	    if (idx == 0) {
+		  out.refuse("a non-blocking assignment to an automatic "
+			     "array is pending");
+		  return;
+	    }
+	    out.put_uint(CKPT_EV_ARWORD);
+	    out.put_uint(idx);
+	    out.put_uint(arw->adr);
+	    out.put_real(arw->val);
+
+      } else if (dynamic_cast<generic_event_s*>(cur)) {
+	    out.refuse("a delayed net value or a VPI callback is scheduled");
+
+      } else if (dynamic_cast<propagate_vector4_event_s*>(cur)
+		 || dynamic_cast<propagate_real_event_s*>(cur)) {
+	    out.refuse("a delayed net value is scheduled");
+
+      } else {
+	    out.refuse("an event of type %s is scheduled", typeid(*cur).name());
+      }
+}
+
+static void checkpoint_save_list(checkpoint_out&out, struct event_s*list)
+{
+      if (list) {
+	    struct event_s*cur = list->next;
+	    do {
+		  checkpoint_save_event(out, cur);
+		  cur = cur->next;
+	    } while (out.ok() && cur != list->next);
+      }
+      out.put_uint(CKPT_EV_END);
+}
+
+void schedule_checkpoint_save(checkpoint_out&out)
+{
+      vvp_time64_t abs_time = schedule_time;
+      for (struct event_time_s*ctim = sched_list ; ctim ; ctim = ctim->next) {
+	    abs_time += ctim->delay;
+	    out.put_uint(1);
+	    out.put_uint(abs_time);
+	    checkpoint_save_list(out, ctim->start);
+	    checkpoint_save_list(out, ctim->active);
+	    checkpoint_save_list(out, ctim->nbassign);
+	    checkpoint_save_list(out, ctim->rwsync);
+	    checkpoint_save_list(out, ctim->rosync);
+	    checkpoint_save_list(out, ctim->del_thr);
+	    if (! out.ok()) return;
+      }
+      out.put_uint(0);
+
+      checkpoint_save_list(out, schedule_final_list);
+}
+
+/*
+ * Read the events of one list. A null delay pointer means the list
+ * is the list of final events.
+ */
+static void checkpoint_restore_list(checkpoint_in&in, const vvp_time64_t*delay,
+				    event_queue_t select_queue)
+{
+      while (in.ok()) {
+	    struct event_s*cur = 0;
+	    vthread_t thr = 0;
+	    switch (in.get_uint()) {
+		case CKPT_EV_END:
+		  return;
+
+		case CKPT_EV_THREAD: {
+		      thr = vthread_checkpoint_thread(in.get_uint());
+		      if (thr == 0) {
+			    in.corrupt("a scheduled thread does not exist");
+			    return;
+		      }
+		      vthread_event_s*ev = new vthread_event_s;
+		      ev->thr = thr;
+		      cur = ev;
+		      break;
+		}
+
+		case CKPT_EV_ASSIGN4: {
+		      vvp_net_t*net = checkpoint_net(in.get_uint());
+		      unsigned port = in.get_uint();
+		      unsigned base = in.get_uint();
+		      unsigned vwid = in.get_uint();
+		      vvp_vector4_t val = in.get_vec4();
+		      if (net == 0 || port > 3) {
+			    in.corrupt("an assignment does not match the design");
+			    return;
+		      }
+		      assign_vector4_event_s*ev = new assign_vector4_event_s(val);
+		      ev->ptr = vvp_net_ptr_t(net, port);
+		      ev->base = base;
+		      ev->vwid = vwid;
+		      cur = ev;
+		      break;
+		}
+
+		case CKPT_EV_ASSIGNR: {
+		      vvp_net_t*net = checkpoint_net(in.get_uint());
+		      unsigned port = in.get_uint();
+		      double val = in.get_real();
+		      if (net == 0 || port > 3) {
+			    in.corrupt("an assignment does not match the design");
+			    return;
+		      }
+		      assign_real_event_s*ev = new assign_real_event_s;
+		      ev->ptr = vvp_net_ptr_t(net, port);
+		      ev->val = val;
+		      cur = ev;
+		      break;
+		}
+
+		case CKPT_EV_AWORD: {
+		      vvp_array_t mem = checkpoint_array(in.get_uint());
+		      unsigned adr = in.get_uint();
+		      unsigned off = in.get_uint();
+		      vvp_vector4_t val = in.get_vec4();
+		      if (mem == 0) {
+			    in.corrupt("an assignment does not match the design");
+			    return;
+		      }
+		      assign_array_word_s*ev = new assign_array_word_s;
+		      ev->mem = mem;
+		      ev->adr = adr;
+		      ev->off = off;
+		      ev->val = val;
+		      cur = ev;
+		      break;
+		}
+
+		case CKPT_EV_ARWORD: {
+		      vvp_array_t mem = checkpoint_array(in.get_uint());
+		      unsigned adr = in.get_uint();
+		      double val = in.get_real();
+		      if (mem == 0) {
+			    in.corrupt("an assignment does not match the design");
+			    return;
+		      }
+		      assign_array_r_word_s*ev = new assign_array_r_word_s;
+		      ev->mem = mem;
+		      ev->adr = adr;
+		      ev->val = val;
+		      cur = ev;
+		      break;
+		}
+
+		default:
+		  in.corrupt("unknown event type");
+		  return;
+	    }
+
+	    if (! in.ok()) {
+		  delete cur;
+		  return;
+	    }
+
+	    if (thr) vthread_mark_scheduled(thr);
+	    if (delay)
+		  schedule_event_(cur, *delay, select_queue);
+	    else
+		  schedule_final_event(cur);
+      }
+}
+
+void schedule_checkpoint_restore(checkpoint_in&in)
+{
+      static const event_queue_t queues[6] = {
+	    SEQ_START, SEQ_ACTIVE, SEQ_NBASSIGN, SEQ_RWSYNC, SEQ_ROSYNC, DEL_THREAD
+      };
+
+      while (in.ok() && in.get_uint() != 0) {
+	    vvp_time64_t abs_time = in.get_uint();
+	    if (abs_time < schedule_time) {
+		  in.corrupt("an event is before the checkpoint time");
+		  return;
+	    }
+	    vvp_time64_t delay = abs_time - schedule_time;
+	    for (unsigned idx = 0 ; idx < 6 && in.ok() ; idx += 1)
+		  checkpoint_restore_list(in, &delay, queues[idx]);
+      }
+
+      checkpoint_restore_list(in, 0, SEQ_ACTIVE);
+}
+
+/*
+ * Remove the events of the threads that the compiler scheduled, so
+ * that vthread_checkpoint_discard can delete those threads. Other
+ * events are kept. The delay functors cancel their own events with
+ * schedule_checkpoint_cancel when their outputs are restored.
+ */
+static void checkpoint_discard_list(struct event_s*&list)
+{
+      if (list == 0) return;
+
+      struct event_s*keep = 0;
+      struct event_s*cur = list->next;
+      list->next = 0;
+      while (cur) {
+	    struct event_s*next = cur->next;
+	    if (dynamic_cast<vthread_event_s*>(cur)) {
+		  delete cur;
+	    } else if (keep == 0) {
+		  cur->next = cur;
+		  keep = cur;
+	    } else {
+		  cur->next = keep->next;
+		  keep->next = cur;
+		  keep = cur;
+	    }
+	    cur = next;
+      }
+      list = keep;
+}
+
+void schedule_checkpoint_discard(vvp_time64_t now)
+{
+      schedule_time = now;
+      for (struct event_time_s*ctim = sched_list ; ctim ; ctim = ctim->next) {
+	    checkpoint_discard_list(ctim->start);
+	    checkpoint_discard_list(ctim->active);
+	    checkpoint_discard_list(ctim->nbassign);
+	    checkpoint_discard_list(ctim->rwsync);
+	    checkpoint_discard_list(ctim->rosync);
+	    checkpoint_discard_list(ctim->del_thr);
+      }
+      checkpoint_discard_list(schedule_final_list);
+}
+
+/*
+ * Remove the generic events of the object obj from the queue, and
+ * the time steps that this leaves empty, so that the main loop does
+ * not stop at them.
+ */
+static void checkpoint_cancel_list(struct event_s*&list, vvp_gen_event_t obj)
+{
+      if (list == 0) return;
+
+      struct event_s*keep = 0;
+      struct event_s*cur = list->next;
+      list->next = 0;
+      while (cur) {
+	    struct event_s*next = cur->next;
+	    generic_event_s*gen = dynamic_cast<generic_event_s*>(cur);
+	    if (gen && gen->obj == obj) {
+		  delete cur;
+	    } else if (keep == 0) {
+		  cur->next = cur;
+		  keep = cur;
+	    } else {
+		  cur->next = keep->next;
+		  keep->next = cur;
+		  keep = cur;
+	    }
+	    cur = next;
+      }
+      list = keep;
+}
+
+void schedule_checkpoint_cancel(vvp_gen_event_t obj)
+{
+      struct event_time_s**ref = &sched_list;
+      while (struct event_time_s*ctim = *ref) {
+	    checkpoint_cancel_list(ctim->active, obj);
+	    checkpoint_cancel_list(ctim->rwsync, obj);
+	    checkpoint_cancel_list(ctim->rosync, obj);
+
+	    if (ctim->start || ctim->active || ctim->nbassign
+		|| ctim->rwsync || ctim->rosync || ctim->del_thr) {
+		  ref = &ctim->next;
+		  continue;
+	    }
+
+	    *ref = ctim->next;
+	    if (ctim->next)
+		  ctim->next->delay += ctim->delay;
+	    delete ctim;
+      }
+}
+
+/*
+ * The restored variables propagate to the nets they drive. Run the
+ * zero delay events that this creates, the way the main loop runs a
+ * time step, so that the design is settled before the saved events
+ * are put back into the queue.
+ */
+void schedule_checkpoint_settle(void)
+{
+      while (sched_list && sched_list->delay == 0) {
+	    struct event_time_s*ctim = sched_list;
+
+	    if (ctim->active == 0) {
+		  ctim->active = ctim->nbassign;
+		  ctim->nbassign = 0;
+
+		  if (ctim->active == 0) {
+			ctim->active = ctim->rwsync;
+			ctim->rwsync = 0;
+
+			if (ctim->active == 0) {
+			      run_rosync(ctim);
+				/* Leave the start of time callbacks for
+				   the main loop. */
+			      if (ctim->start) break;
+			      sched_list = ctim->next;
+			      delete ctim;
+			      continue;
+			}
+		  }
+	    }
+
+	    struct event_s*cur = ctim->active->next;
+	    if (cur->next == cur) {
+		  ctim->active = 0;
+	    } else {
+		  ctim->active->next = cur->next;
+	    }
+
+	    cur->run_run();
+	    delete cur;
+      }
 }
 
 void schedule_simulate(void)
@@ -1025,6 +1854,18 @@ void schedule_simulate(void)
 	    delete cur;
       }
 
+	// Replace the initial state with the state of a checkpoint.
+      if (checkpoint_restoring()) {
+	    if (verbose_flag) {
+		  vpi_mcd_printf(1, " ...restore checkpoint\n");
+	    }
+	    sim_started = true;
+	    if (! checkpoint_restore()) {
+		  schedule_runnable = false;
+		  vpip_set_return_value(1);
+	    }
+      }
+
       if (verbose_flag) {
 	    vpi_mcd_printf(1, " ...execute StartOfSim callbacks\n");
       }
@@ -1044,6 +1885,8 @@ void schedule_simulate(void)
       // process events and when done run the final blocks.
       run_finals = schedule_runnable;
 
+      schedule_count_deltas = schedule_stats_flag || schedule_delta_limit > 0;
+
       if (schedule_runnable) while (sched_list) {
 
 	    if (schedule_stopped_flag) {
@@ -1092,23 +1935,54 @@ void schedule_simulate(void)
 	    if (ctim->active == 0) {
 		  ctim->active = ctim->nbassign;
 		  ctim->nbassign = 0;
+		  if (schedule_stats_flag)
+			stats_move_queue(STATS_NBASSIGN, ctim->active);
 
 		  if (ctim->active == 0) {
 			ctim->active = ctim->rwsync;
 			ctim->rwsync = 0;
+			if (schedule_stats_flag)
+			      stats_move_queue(STATS_RWSYNC, ctim->active);
 
 			  /* If out of rw events, then run the rosync
 			     events and delete this time step. This also
 			     deletes threads as needed. */
 			if (ctim->active == 0) {
-			      run_rosync(ctim);
+			      unsigned long rosync = run_rosync(ctim);
+			      if (schedule_stats_flag)
+				    stats_end_step(step_deltas, rosync);
+			      step_deltas = 0;
+			      if (hot_spot_flag) {
+				    hot_spot_flag = false;
+				    hot_spot_map.clear();
+			      }
 			      sched_list = ctim->next;
 			      delete ctim;
+				/* The time step is done, so this is
+				   where $save takes its checkpoint. */
+			      if (checkpoint_pending)
+				    checkpoint_save();
 			      continue;
 			}
 		  }
 	    }
 
+	      /* The events now in the active queue are the next delta
+		 cycle, if the last one is done. */
+	    if (schedule_count_deltas && delta_mark == 0) {
+		  delta_mark = ctim->active;
+		  step_deltas += 1;
+		  if (schedule_delta_limit && step_deltas >= hot_spot_start()) {
+			if (step_deltas > schedule_delta_limit) {
+			      hot_spot_report();
+			      vpip_set_return_value(1);
+			      schedule_runnable = false;
+			      break;
+			}
+			hot_spot_flag = true;
+		  }
+	    }
+
 	      /* Pull the first item off the list. If this is the last
 		 cell in the list, then clear the list. Execute that
 		 event type, and delete it. */
@@ -1119,6 +1993,11 @@ void schedule_simulate(void)
 		  ctim->active->next = cur->next;
 	    }
 
+	    if (schedule_stats_flag)
+		  stats_pull_event(cur);
+	    if (hot_spot_flag)
+		  hot_spot_count(cur);
+
 	    if (schedule_single_step_flag) {
 		  cur->single_step_display();
 		  schedule_stopped_flag = true;
@@ -1127,6 +2006,8 @@ void schedule_simulate(void)
 
 	    cur->run_run();
 
+	    if (cur == delta_mark)
+		  delta_mark = 0;
 	    delete (cur);
       }
 
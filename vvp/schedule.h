@@ -22,6 +22,7 @@
 # include  "vthread.h"
 # include  "vvp_net.h"
 # include  "array.h"
+# include  <cstdio>
 
 /*
  * This causes a thread to be scheduled for execution. The schedule
@@ -189,4 +190,22 @@ extern unsigned long count_prop_events;
 extern unsigned long count_thread_events;
 extern unsigned long count_event_pool;
 
+/*
+ * The +vvp-stats=<file> argument sets schedule_stats_flag, which
+ * makes the scheduler also count the events of each time step by
+ * queue and by the type of functor they run, and the delta cycles of
+ * each time step. schedule_stats_json writes these counts as the
+ * "scheduler" member of the statistics file.
+ */
+extern bool schedule_stats_flag;
+extern void schedule_stats_json(FILE*fd);
+
+/*
+ * The +vvp-delta-limit=<n> argument sets the most delta cycles that
+ * a time step may run. A time step that needs more is stopped, with
+ * a report of the nets, functors and threads that it triggered the
+ * most, and the simulation ends. 0 means there is no limit.
+ */
+extern unsigned long schedule_delta_limit;
+
 #endif
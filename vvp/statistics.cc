@@ -18,6 +18,16 @@
  */
 
 # include  "statistics.h"
+# include  "schedule.h"
+# include  "vthread.h"
+# include  "vvp_net.h"
+# include  "vpi_priv.h"
+# include  <cstdlib>
+#if defined(__GNUC__)
+# include  <cxxabi.h>
+#endif
+
+using namespace std;
 
 /*
  * This is a count of the instruction opcodes that were created.
@@ -35,5 +45,195 @@ unsigned long count_vpi_nets = 0;
 
 unsigned long count_vpi_scopes = 0;
 
+unsigned long count_gate_batches = 0;
+unsigned long count_gate_evals = 0;
+unsigned long count_gates_leveled = 0;
+unsigned long count_gate_levels = 0;
+
 size_t size_opcodes = 0;
 
+
+unsigned long count_vpi_callbacks[STATS_CB_REASONS];
+
+/*
+ * The waveform dumpers report the size of each dump file that they
+ * close, so that the statistics can include the dump output.
+ */
+static PLI_UINT64 count_dump_bytes = 0;
+static unsigned long count_dump_files = 0;
+
+extern "C" void vpip_count_dump_bytes(PLI_UINT64 bytes)
+{
+      count_dump_bytes += bytes;
+      count_dump_files += 1;
+}
+
+string stats_type_name(const char*name)
+{
+#if defined(__GNUC__)
+      int status;
+      char*res = abi::__cxa_demangle(name, 0, 0, &status);
+      if (res) {
+	    string tmp = res;
+	    free(res);
+	    return tmp;
+      }
+#endif
+      return name;
+}
+
+void stats_json_string(FILE*fd, const char*text)
+{
+      fputc('"', fd);
+      for (const char*cp = text ; *cp ; cp += 1) {
+	    switch (*cp) {
+		case '"':
+		case '\\':
+		  fputc('\\', fd);
+		  fputc(*cp, fd);
+		  break;
+		case '\n':
+		  fputs("\\n", fd);
+		  break;
+		case '\t':
+		  fputs("\\t", fd);
+		  break;
+		default:
+		  if ((unsigned char)*cp < 0x20)
+			fprintf(fd, "\\u%04x", (unsigned char)*cp);
+		  else
+			fputc(*cp, fd);
+		  break;
+	    }
+      }
+      fputc('"', fd);
+}
+
+/*
+ * A histogram is written as a list of its non-empty buckets, each
+ * with the smallest and largest value of the bucket.
+ */
+void stats_json_histogram(FILE*fd, const unsigned long*hist)
+{
+      bool first = true;
+      fprintf(fd, "[");
+      for (unsigned idx = 0 ; idx < STATS_HIST_SIZE ; idx += 1) {
+	    if (hist[idx] == 0) continue;
+
+	    unsigned long min = idx? 1UL << (idx-1) : 0;
+	    unsigned long max = idx? min + (min-1) : 0;
+	    fprintf(fd, "%s{\"min\": %lu, \"max\": %lu, \"count\": %lu}",
+		    first? "" : ", ", min, max, hist[idx]);
+	    first = false;
+      }
+      fprintf(fd, "]");
+}
+
+static const char*cb_reason_name[STATS_CB_REASONS] = {
+      0,                   "cbValueChange",       "cbStmt",
+      "cbForce",           "cbRelease",           "cbAtStartOfSimTime",
+      "cbReadWriteSynch",  "cbReadOnlySynch",     "cbNextSimTime",
+      "cbAfterDelay",      "cbEndOfCompile",      "cbStartOfSimulation",
+      "cbEndOfSimulation", "cbError",             "cbTchkViolation",
+      "cbStartOfSave",     "cbEndOfSave",         "cbStartOfRestart",
+      "cbEndOfRestart",    "cbStartOfReset",      "cbEndOfReset",
+      "cbEnterInteractive", "cbExitInteractive",
+      "cbInteractiveScopeChange", "cbUnresolvedSystf"
+};
+
+/*
+ * Write the statistics file. The members of the object are grouped
+ * the way "vvp -v" prints them, and the counts have the same
+ * meaning. The pool sizes are numbers of items, and the heap sizes
+ * are bytes.
+ */
+void stats_write_json(const char*path, double compile_time, double run_time)
+{
+      FILE*fd = fopen(path, "w");
+      if (fd == 0) {
+	    perror(path);
+	    return;
+      }
+
+      fprintf(fd, "{\n");
+      fprintf(fd, "  \"sim_time\": %" TIME_FMT_U ",\n", schedule_simtime());
+      fprintf(fd, "  \"seconds\": {\"compile\": %.6f, \"run\": %.6f},\n",
+	      compile_time, run_time);
+
+      fprintf(fd, "  \"design\": {\n");
+      fprintf(fd, "    \"functors\": %lu,\n", count_functors);
+      fprintf(fd, "    \"functors_logic\": %lu,\n", count_functors_logic);
+      fprintf(fd, "    \"functors_bufif\": %lu,\n", count_functors_bufif);
+      fprintf(fd, "    \"functors_resolv\": %lu,\n", count_functors_resolv);
+      fprintf(fd, "    \"functors_signal\": %lu,\n", count_functors_sig);
+      fprintf(fd, "    \"filters\": %lu,\n", count_filters);
+      fprintf(fd, "    \"opcodes\": %lu,\n", count_opcodes);
+      fprintf(fd, "    \"nets\": %lu,\n", count_vpi_nets);
+      fprintf(fd, "    \"vvp_nets\": %lu,\n", count_vvp_nets);
+      fprintf(fd, "    \"net_arrays\": %lu,\n", count_net_arrays);
+      fprintf(fd, "    \"net_array_words\": %lu,\n", count_net_array_words);
+      fprintf(fd, "    \"var_arrays\": %lu,\n", count_var_arrays);
+      fprintf(fd, "    \"var_array_words\": %lu,\n", count_var_array_words);
+      fprintf(fd, "    \"real_arrays\": %lu,\n", count_real_arrays);
+      fprintf(fd, "    \"real_array_words\": %lu,\n", count_real_array_words);
+      fprintf(fd, "    \"scopes\": %lu,\n", count_vpi_scopes);
+      fprintf(fd, "    \"leveled_gates\": %lu,\n", count_gates_leveled);
+      fprintf(fd, "    \"gate_levels\": %lu\n", count_gate_levels);
+      fprintf(fd, "  },\n");
+
+      fprintf(fd, "  \"memory\": {\n");
+      fprintf(fd, "    \"net_fun_heap\": %lu,\n",
+	      (unsigned long)vvp_net_fun_t::heap_total());
+      fprintf(fd, "    \"net_fil_heap\": %lu,\n",
+	      (unsigned long)vvp_net_fil_t::heap_total());
+      fprintf(fd, "    \"opcodes\": %lu,\n", (unsigned long)size_opcodes);
+      fprintf(fd, "    \"vvp_nets\": %lu,\n", (unsigned long)size_vvp_nets);
+      fprintf(fd, "    \"pools\": {\n");
+      fprintf(fd, "      \"time\": %lu,\n", count_time_pool());
+      fprintf(fd, "      \"assign4\": %lu,\n", count_assign4_pool());
+      fprintf(fd, "      \"assign8\": %lu,\n", count_assign8_pool());
+      fprintf(fd, "      \"assign_real\": %lu,\n", count_assign_real_pool());
+      fprintf(fd, "      \"assign_aword\": %lu,\n", count_assign_aword_pool());
+      fprintf(fd, "      \"assign_arword\": %lu,\n",
+	      count_assign_arword_pool());
+      fprintf(fd, "      \"gen\": %lu\n", count_gen_pool());
+      fprintf(fd, "    }\n");
+      fprintf(fd, "  },\n");
+
+      fprintf(fd, "  \"events\": {\n");
+      fprintf(fd, "    \"time_steps\": %lu,\n", count_time_events);
+      fprintf(fd, "    \"thread\": %lu,\n", count_thread_events);
+      fprintf(fd, "    \"assign\": %lu,\n", count_assign_events);
+      fprintf(fd, "    \"other\": %lu,\n", count_gen_events);
+      fprintf(fd, "    \"gate_evaluations\": %lu,\n", count_gate_evals);
+      fprintf(fd, "    \"gate_batches\": %lu\n", count_gate_batches);
+      fprintf(fd, "  },\n");
+
+      fprintf(fd, "  \"threads\": {\n");
+      fprintf(fd, "    \"created\": %lu,\n", count_vthreads);
+      fprintf(fd, "    \"allocated\": %lu,\n", count_vthread_allocs);
+      fprintf(fd, "    \"function_calls\": %lu,\n", count_vthread_calls);
+      fprintf(fd, "    \"instructions\": %lu,\n", count_vthread_instructions);
+      fprintf(fd, "    \"word_opcodes\": %lu,\n", count_word_opcodes);
+      fprintf(fd, "    \"word_mismatches\": %lu\n", count_word_mismatches);
+      fprintf(fd, "  },\n");
+
+      fprintf(fd, "  \"vpi_callbacks\": {");
+      bool first = true;
+      for (unsigned idx = 1 ; idx < STATS_CB_REASONS ; idx += 1) {
+	    if (count_vpi_callbacks[idx] == 0) continue;
+	    fprintf(fd, "%s\n    \"%s\": %lu", first? "" : ",",
+		    cb_reason_name[idx], count_vpi_callbacks[idx]);
+	    first = false;
+      }
+      fprintf(fd, "%s},\n", first? "" : "\n  ");
+
+      fprintf(fd, "  \"dump\": {\"files\": %lu, \"bytes\": %" PLI_UINT64_FMT
+	      "},\n", count_dump_files, count_dump_bytes);
+
+      schedule_stats_json(fd);
+      fprintf(fd, "\n}\n");
+
+      if (fclose(fd) != 0)
+	    perror(path);
+}
@@ -25,6 +25,8 @@
 #else
 # include  <cstddef>
 #endif
+# include  <cstdio>
+# include  <string>
 
 extern unsigned long count_opcodes;
 extern unsigned long count_functors;
@@ -58,8 +60,49 @@ extern unsigned long count_assign_arword_pool(void);
 extern unsigned long count_gen_events;
 extern unsigned long count_gen_pool(void);
 
+extern unsigned long count_gate_batches;
+extern unsigned long count_gate_evals;
+extern unsigned long count_gates_leveled;
+extern unsigned long count_gate_levels;
+
 extern size_t size_opcodes;
 extern size_t size_vvp_nets;
 extern size_t size_vvp_net_funs;
 
+/*
+ * This counts the VPI callbacks that are run, by reason (the
+ * cbValueChange, etc., value).
+ */
+static const unsigned STATS_CB_REASONS = 25;
+extern unsigned long count_vpi_callbacks[STATS_CB_REASONS];
+
+/*
+ * The +vvp-stats=<file> extended argument writes these counts, and
+ * the scheduler counts, to <file> as a JSON object at the end of the
+ * simulation. The compile and run times are in seconds.
+ */
+extern void stats_write_json(const char*path, double compile_time,
+			     double run_time);
+
+/*
+ * Histograms of the statistics file have a bucket for 0, and then a
+ * bucket for each power of 2: 1, 2-3, 4-7, and so on.
+ */
+static const unsigned STATS_HIST_SIZE = 8*sizeof(unsigned long) + 1;
+
+inline unsigned stats_hist_bucket(unsigned long val)
+{
+      unsigned res = 0;
+      while (val) {
+	    res += 1;
+	    val >>= 1;
+      }
+      return res;
+}
+
+extern void stats_json_histogram(FILE*fd, const unsigned long*hist);
+extern void stats_json_string(FILE*fd, const char*text);
+  /* The readable name of a (mangled) typeid name. */
+extern std::string stats_type_name(const char*name);
+
 #endif
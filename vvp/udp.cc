@@ -24,6 +24,7 @@
 #include "schedule.h"
 #include "symbols.h"
 #include "compile.h"
+#include "checkpoint.h"
 #include "config.h"
 #include <cassert>
 #include <cstdlib>
@@ -84,7 +85,8 @@ ostream& operator <<(ostream&o, const struct udp_levels_table&table)
 
 vvp_udp_s::vvp_udp_s(char*label, char*name__, unsigned ports,
                      vvp_bit4_t init, bool type)
-: name_(name__), ports_(ports), init_(init), seq_(type)
+: name_(name__), ports_(ports), init_(init), seq_(type),
+  lut_(0), lut_stride_(0)
 {
       if (!udp_table)
 	    udp_table = new_symbol_table();
@@ -106,6 +108,7 @@ vvp_udp_s::vvp_udp_s(char*label, char*name__, unsigned ports,
 vvp_udp_s::~vvp_udp_s()
 {
       delete[] name_;
+      delete[] lut_;
 }
 
 unsigned vvp_udp_s::port_count() const
@@ -118,6 +121,94 @@ vvp_bit4_t vvp_udp_s::get_init() const
       return init_;
 }
 
+/*
+ * Powers of 3, for building and indexing the lookup tables. These
+ * cover the widest primitives that get a table.
+ */
+static const unsigned UDP_LUT_MAX_COMB = 10;
+static const unsigned UDP_LUT_MAX_SEQ = 6;
+static const unsigned long udp_pow3[UDP_LUT_MAX_COMB+1] = {
+      1, 3, 9, 27, 81, 243, 729, 2187, 6561, 19683, 59049
+};
+
+static void udp_levels_from_index(udp_levels_table&cur, unsigned long idx,
+				  unsigned nports)
+{
+      cur.mask0 = 0;
+      cur.mask1 = 0;
+      cur.maskx = 0;
+      for (unsigned pp = 0 ;  pp < nports ;  pp += 1) {
+	    unsigned long mask_bit = 1UL << pp;
+	    switch (idx % 3) {
+		case 0:
+		  cur.mask0 |= mask_bit;
+		  break;
+		case 1:
+		  cur.mask1 |= mask_bit;
+		  break;
+		default:
+		  cur.maskx |= mask_bit;
+		  break;
+	    }
+	    idx /= 3;
+      }
+}
+
+/*
+ * Standard cell libraries are mostly made of primitives with only a
+ * few inputs, and share each definition across very many
+ * instances. For these it is worth evaluating every possible input
+ * once, with the row tables, and saving the results so that the
+ * instances can evaluate with a single lookup.
+ *
+ * A combinational primitive has 3^N entries. A sequential primitive
+ * depends also on the current output and the edge of the input that
+ * changed, so there are 3^(N+1) entries for every port and previous
+ * value of that port. If the previous value is the same as the
+ * current value there is no edge, and the entry is the current
+ * output.
+ */
+void vvp_udp_s::compile_lut_()
+{
+      if (ports_ > (seq_? UDP_LUT_MAX_SEQ : UDP_LUT_MAX_COMB))
+	    return;
+
+      if (! seq_) {
+	    lut_stride_ = udp_pow3[ports_];
+	    lut_ = new unsigned char[lut_stride_];
+	    udp_levels_table dummy = { 0, 0, 0 };
+	    for (unsigned long idx = 0 ;  idx < lut_stride_ ;  idx += 1) {
+		  udp_levels_table cur;
+		  udp_levels_from_index(cur, idx, ports_);
+		  lut_[idx] = calculate_output(cur, dummy, BIT4_X);
+	    }
+	    return;
+      }
+
+      static const vvp_bit4_t out_vals[3] = { BIT4_0, BIT4_1, BIT4_X };
+      unsigned long in_count = udp_pow3[ports_];
+      lut_stride_ = 3 * in_count;
+      lut_ = new unsigned char[lut_stride_ * 3 * ports_];
+
+      for (unsigned port = 0 ;  port < ports_ ;  port += 1) {
+	    for (unsigned prev = 0 ;  prev < 3 ;  prev += 1) {
+		  unsigned char*blk = lut_ + (port*3 + prev) * lut_stride_;
+		  for (unsigned long idx = 0 ;  idx < in_count ;  idx += 1) {
+			udp_levels_table cur, old;
+			udp_levels_from_index(cur, idx, ports_);
+			unsigned digit = (idx / udp_pow3[port]) % 3;
+			unsigned long old_idx = idx + prev*udp_pow3[port]
+			                            - digit*udp_pow3[port];
+			udp_levels_from_index(old, old_idx, ports_);
+			for (unsigned out = 0 ;  out < 3 ;  out += 1) {
+			      blk[out*in_count + idx] =
+				    calculate_output(cur, old, out_vals[out]);
+			}
+		  }
+	    }
+      }
+}
+
 vvp_udp_comb_s::vvp_udp_comb_s(char*label, char*name__, unsigned ports)
 : vvp_udp_s(label, name__, ports, BIT4_X, false)
 {
@@ -294,6 +385,8 @@ void vvp_udp_comb_s::compile_table(char**tab)
 
       assert(nrows0 == nlevels0_);
       assert(nrows1 == nlevels1_);
+
+      compile_lut_();
 }
 
 vvp_udp_seq_s::vvp_udp_seq_s(char*label, char*name__,
@@ -674,6 +767,7 @@ void vvp_udp_seq_s::compile_table(char**tab)
       assert(idx_edg1 == nedges1_);
       assert(idx_edgL == nedgesL_);
 
+      compile_lut_();
 }
 
 bool operator == (const udp_levels_table&a, const udp_levels_table&b)
@@ -910,6 +1004,9 @@ vvp_udp_fun_core::vvp_udp_fun_core(vvp_net_t*net, vvp_udp_s*def)
       current_.mask0 = 0;
       current_.mask1 = 0;
       current_.maskx = ~ ((-1UL) << port_count());
+      cur_idx_ = 0;
+      if (def_->has_lut())
+	    cur_idx_ = udp_pow3[port_count()] - 1;
 
       if (cur_out_ != BIT4_X)
 	    schedule_functor(this);
@@ -957,7 +1054,20 @@ void vvp_udp_fun_core::recv_vec4_from_inputs(unsigned port)
 	    break;
       }
 
-      vvp_bit4_t out_bit = def_->calculate_output(current_, prev, cur_out_);
+      vvp_bit4_t out_bit;
+      if (def_->has_lut()) {
+	    unsigned old_digit = 2;
+	    if (prev.mask0 & mask)
+		  old_digit = 0;
+	    else if (prev.mask1 & mask)
+		  old_digit = 1;
+	    unsigned new_digit = udp_digit(value(port).value(0));
+	    cur_idx_ += new_digit * udp_pow3[port];
+	    cur_idx_ -= old_digit * udp_pow3[port];
+	    out_bit = def_->lut_output(cur_idx_, port, old_digit, cur_out_);
+      } else {
+	    out_bit = def_->calculate_output(current_, prev, cur_out_);
+      }
 
       if (out_bit == cur_out_)
 	    return;
@@ -966,6 +1076,41 @@ void vvp_udp_fun_core::recv_vec4_from_inputs(unsigned port)
       schedule_functor(this);
 }
 
+void vvp_udp_fun_core::checkpoint_save(checkpoint_out&out) const
+{
+      out.put_uint(cur_out_);
+      out.put_uint(current_.mask0);
+      out.put_uint(current_.mask1);
+      out.put_uint(current_.maskx);
+      out.put_uint(cur_idx_);
+}
+
+void vvp_udp_fun_core::checkpoint_restore(checkpoint_in&in)
+{
+      vvp_bit4_t out = (vvp_bit4_t) (in.get_uint() & 3);
+      udp_levels_table cur;
+      cur.mask0 = in.get_uint();
+      cur.mask1 = in.get_uint();
+      cur.maskx = in.get_uint();
+      unsigned long idx = in.get_uint();
+
+      unsigned long ports = ~ ((-1UL) << port_count());
+      if (((cur.mask0 | cur.mask1 | cur.maskx) & ~ports)
+	  || (def_->has_lut() && idx >= udp_pow3[port_count()])) {
+	    in.corrupt("a UDP does not match the design");
+	    return;
+      }
+
+      cur_out_ = out;
+      current_ = cur;
+      cur_idx_ = idx;
+}
+
+void vvp_udp_fun_core::checkpoint_send()
+{
+      schedule_functor(this);
+}
+
 
 /*
  * This function is called by the parser in response to a .udp
@@ -982,6 +1127,9 @@ void compile_udp_functor(char*label, char*type,
       vvp_net_t*ptr = new vvp_net_t;
       vvp_udp_fun_core*core = new vvp_udp_fun_core(ptr, def);
       ptr->fun = core;
+	/* The output of a sequential UDP is state of its own. */
+      if (def->is_sequential())
+	    checkpoint_add_functor(ptr);
 
       define_functor_symbol(label, ptr);
       free(label);
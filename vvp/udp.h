@@ -48,13 +48,60 @@ struct vvp_udp_s {
 					  const udp_levels_table&prev,
 					  vvp_bit4_t cur_out) =0;
 
+	// Small primitives are also compiled into a direct lookup
+	// table. The in_idx is the base 3 encoding of the inputs (see
+	// udp_digit), and the port/prev pair is the input that most
+	// recently changed and its previous digit. The result is
+	// exactly what calculate_output would return.
+      bool has_lut() const { return lut_ != 0; }
+      vvp_bit4_t lut_output(unsigned long in_idx, unsigned port,
+			    unsigned prev, vvp_bit4_t cur_out) const;
+
+    protected:
+	// Derived classes call this after their rows are compiled.
+      void compile_lut_();
+
     private:
       char *name_;
       unsigned ports_;
       vvp_bit4_t init_;
       bool seq_;
+
+	// The lookup table, or nil if the primitive is too wide. For
+	// a sequential primitive the current output is the most
+	// significant digit of the level index, and there is a block
+	// of lut_stride_ entries for each port/previous digit pair.
+      unsigned char*lut_;
+      unsigned long lut_stride_;
 };
 
+/*
+ * The lookup tables encode each input as a base 3 digit: 0 and 1 for
+ * themselves and 2 for x or z.
+ */
+inline unsigned udp_digit(vvp_bit4_t val)
+{
+      switch (val) {
+	  case BIT4_0:
+	    return 0;
+	  case BIT4_1:
+	    return 1;
+	  default:
+	    return 2;
+      }
+}
+
+inline vvp_bit4_t vvp_udp_s::lut_output(unsigned long in_idx, unsigned port,
+					unsigned prev, vvp_bit4_t cur_out) const
+{
+      if (! seq_)
+	    return (vvp_bit4_t) lut_[in_idx];
+
+      unsigned long idx = (port*3 + prev) * lut_stride_;
+      idx += udp_digit(cur_out) * (lut_stride_/3) + in_idx;
+      return (vvp_bit4_t) lut_[idx];
+}
+
 /*
  * The vvp_udp_async_s instance represents a *definition* of a
  * primitive. netlist instances refer to these definitions.
@@ -230,12 +277,21 @@ class vvp_udp_fun_core  : public vvp_wide_fun_core, private vvp_gen_event_s {
 
       void recv_vec4_from_inputs(unsigned);
 
+	// Save and restore the state of a sequential UDP for a
+	// checkpoint. The checkpoint calls checkpoint_send when all
+	// the functors are restored.
+      void checkpoint_save(checkpoint_out&out) const;
+      void checkpoint_restore(checkpoint_in&in);
+      void checkpoint_send();
+
     private:
       void run_run();
 
       vvp_udp_s*def_;
       vvp_bit4_t cur_out_;
       udp_levels_table current_;
+	// Base 3 encoding of current_, for the definition lookup table.
+      unsigned long cur_idx_;
 };
 
 #endif
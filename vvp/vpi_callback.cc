@@ -30,6 +30,7 @@
 # include  "schedule.h"
 # include  "event.h"
 # include  "vvp_net_sig.h"
+# include  "statistics.h"
 # include  "config.h"
 #ifdef CHECK_WITH_VALGRIND
 #include  "vvp_cleanup.h"
@@ -54,6 +55,18 @@
 
 class sync_callback;
 
+/*
+ * All the callbacks are run by this, so that they can be counted
+ * (by reason) for the statistics.
+ */
+static inline void run_callback(struct __vpiCallback*cur)
+{
+      PLI_INT32 reason = cur->cb_data.reason;
+      if (reason > 0 && (unsigned)reason < STATS_CB_REASONS)
+	    count_vpi_callbacks[reason] += 1;
+      (cur->cb_data.cb_rtn)(&cur->cb_data);
+}
+
 struct sync_cb  : public vvp_gen_event_s {
       sync_callback*handle;
       bool sync_flag;
@@ -316,7 +329,7 @@ void sync_cb::run_run()
       if (cur->cb_data.cb_rtn != 0) {
 	    assert(vpi_mode_flag == VPI_MODE_NONE);
 	    vpi_mode_flag = sync_flag? VPI_MODE_ROSYNC : VPI_MODE_RWSYNC;
-	    (cur->cb_data.cb_rtn)(&cur->cb_data);
+	    run_callback(cur);
 	    vpi_mode_flag = VPI_MODE_NONE;
       }
 
@@ -458,7 +471,7 @@ void vpiEndOfCompile(void) {
       while (EndOfCompile) {
 	    cur = EndOfCompile;
 	    EndOfCompile = dynamic_cast<simulator_callback*>(cur->next);
-	    (cur->cb_data.cb_rtn)(&cur->cb_data);
+	    run_callback(cur);
 	    delete cur;
       }
 
@@ -478,7 +491,7 @@ void vpiStartOfSim(void) {
       while (StartOfSimulation) {
 	    cur = StartOfSimulation;
 	    StartOfSimulation = dynamic_cast<simulator_callback*>(cur->next);
-	    (cur->cb_data.cb_rtn)(&cur->cb_data);
+	    run_callback(cur);
 	    delete cur;
       }
 
@@ -500,7 +513,7 @@ void vpiPostsim(void) {
 	      /* Only set the time if it is not NULL. */
 	    if (cur->cb_data.time)
 	          vpip_time_to_timestruct(cur->cb_data.time, schedule_simtime());
-	    (cur->cb_data.cb_rtn)(&cur->cb_data);
+	    run_callback(cur);
 	    delete cur;
       }
 
@@ -521,7 +534,7 @@ void vpiNextSimTime(void)
       while (NextSimTime) {
 	    cur = NextSimTime;
 	    NextSimTime = dynamic_cast<simulator_callback*>(cur->next);
-	    (cur->cb_data.cb_rtn)(&cur->cb_data);
+	    run_callback(cur);
 	    delete cur;
       }
 
@@ -637,7 +650,7 @@ void callback_execute(struct __vpiCallback*cur)
 	    assert(0);
 	    break;
       }
-      (cur->cb_data.cb_rtn)(&cur->cb_data);
+      run_callback(cur);
 
       vpi_mode_flag = save_mode;
 }
@@ -0,0 +1,351 @@
+/*
+ * Copyright (c) 2026 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+# include  "vpi_priv.h"
+# include  "config.h"
+# include  <cerrno>
+# include  <cstdio>
+# include  <cstdlib>
+# include  <cstring>
+# include  <map>
+# include  <string>
+#ifndef __MINGW32__
+# include  <unistd.h>
+# include  <sys/types.h>
+# include  <sys/wait.h>
+#endif
+# include  "ivl_alloc.h"
+
+using namespace std;
+
+/*
+ * The $ivl_fork_tests system function clones a simulation that has
+ * finished its warm up into a number of child processes, each of
+ * which continues from that point as a separate test. The children
+ * share the memory of the parent, copy on write, so the clones are
+ * cheap. This file holds the process side of it: the fork itself,
+ * the changes that make each child independent of the others, and
+ * the collection of the exit statuses.
+ *
+ * A child differs from its siblings only in its index (from 1), so
+ * everything that a child does differently follows from the index:
+ *
+ *    - Its standard output and error go to fork<index>.log.
+ *    - It gets the +ivl_fork_index=<index> plusarg, and the plusargs
+ *      of line <index> of the plusargs file, if one is given.
+ *    - The internal seeds of $random and $urandom are offset by the
+ *      index.
+ *    - Files that are open for writing are copied to a name with
+ *      the index in it, and the child continues writing the copy.
+ *      Files opened after the fork get the index in their name too
+ *      (see vpip_fork_path).
+ */
+static unsigned fork_index = 0;
+
+extern "C" PLI_INT32 vpip_fork_index(void)
+{
+      return fork_index;
+}
+
+/*
+ * Insert the index of the child in front of the extension of the
+ * file name, so that "dump.vcd" becomes "dump.3.vcd" in child 3.
+ */
+extern "C" char* vpip_fork_path(const char*path)
+{
+      if (fork_index == 0)
+	    return strdup(path);
+
+      string res = path;
+      size_t base = res.find_last_of("/\\");
+      base = base == string::npos? 0 : base+1;
+      size_t dot = res.rfind('.');
+      if (dot == string::npos || dot <= base)
+	    dot = res.size();
+
+      char buf[32];
+      snprintf(buf, sizeof buf, ".%u", fork_index);
+      res.insert(dot, buf);
+      return strdup(res.c_str());
+}
+
+static bool copy_file(const char*from, const char*to, long len)
+{
+      FILE*src = fopen(from, "rb");
+      if (src == 0)
+	    return false;
+      FILE*dst = fopen(to, "wb");
+      if (dst == 0) {
+	    fclose(src);
+	    return false;
+      }
+
+      char buf[65536];
+      while (len > 0) {
+	    size_t cnt = fread(buf, 1, len < (long)sizeof buf? len : sizeof buf, src);
+	    if (cnt == 0)
+		  break;
+	    fwrite(buf, 1, cnt, dst);
+	    len -= cnt;
+      }
+
+      bool rc = ! ferror(src) && ! ferror(dst);
+      fclose(src);
+      if (fclose(dst) != 0)
+	    rc = false;
+      return rc;
+}
+
+/*
+ * Give an open file to the child. The parent and the children share
+ * the file offset of an inherited descriptor, so even a file that
+ * is only read must be opened again. A file that is written is first
+ * copied to the child's own name, so that the child continues a
+ * complete file. The caller gets the (new) path of the file, or nil
+ * if the file could not be moved, in which case fp is closed.
+ */
+extern "C" char* vpip_fork_file(FILE*fp, const char*path, const char*mode)
+{
+      bool binary = strchr(mode, 'b') != 0;
+      long pos = ftell(fp);
+
+      if (mode[0] == 'r' && strchr(mode, '+') == 0) {
+	    if (freopen(path, mode, fp) == 0)
+		  return 0;
+	    if (pos > 0) fseek(fp, pos, SEEK_SET);
+	    return strdup(path);
+      }
+
+	/* Copy all of the file, in case the file is written out of
+	   order (r+ or w+) and the position is not at the end. */
+      fseek(fp, 0, SEEK_END);
+      long len = ftell(fp);
+
+      char*child_path = vpip_fork_path(path);
+      if (len < 0 || ! copy_file(path, child_path, len)) {
+	    fclose(fp);
+	    free(child_path);
+	    return 0;
+      }
+
+      const char*reopen_mode = mode[0] == 'a'? mode : (binary? "r+b" : "r+");
+      if (freopen(child_path, reopen_mode, fp) == 0) {
+	    free(child_path);
+	    return 0;
+      }
+      if (mode[0] != 'a' && pos >= 0)
+	    fseek(fp, pos, SEEK_SET);
+
+      return child_path;
+}
+
+/*
+ * Read the plusargs of the child from line <index> of the plusargs
+ * file. The arguments on a line are separated by white space.
+ */
+static void add_plusargs_from_file(const char*path, unsigned index)
+{
+      FILE*fd = fopen(path, "r");
+      if (fd == 0) {
+	    vpi_printf("WARNING: $ivl_fork_tests: Unable to open %s.\n", path);
+	    return;
+      }
+
+      string line;
+      unsigned lineno = 1;
+      int ch;
+      while ((ch = fgetc(fd)) != EOF) {
+	    if (ch == '\n') {
+		  if (lineno == index) break;
+		  lineno += 1;
+		  line.clear();
+	    } else if (lineno == index) {
+		  line += (char)ch;
+	    }
+      }
+      fclose(fd);
+
+      if (lineno != index)
+	    return;
+
+      size_t pos = 0;
+      while (pos < line.size()) {
+	    pos = line.find_first_not_of(" \t\r", pos);
+	    if (pos == string::npos)
+		  break;
+	    size_t end = line.find_first_of(" \t\r", pos);
+	    if (end == string::npos)
+		  end = line.size();
+	    vpip_add_vlog_arg(strdup(line.substr(pos, end-pos).c_str()));
+	    pos = end;
+      }
+}
+
+#ifndef __MINGW32__
+static void make_child(unsigned index, const char*plusargs_path)
+{
+      fork_index = index;
+
+      char log_path[64];
+      snprintf(log_path, sizeof log_path, "fork%u.log", index);
+      if (freopen(log_path, "w", stdout) == 0) {
+	    fprintf(stderr, "$ivl_fork_tests: Unable to open %s.\n", log_path);
+	    _exit(2);
+      }
+      dup2(fileno(stdout), STDERR_FILENO);
+
+      char buf[64];
+      snprintf(buf, sizeof buf, "+ivl_fork_index=%u", index);
+      vpip_add_vlog_arg(strdup(buf));
+      if (plusargs_path)
+	    add_plusargs_from_file(plusargs_path, index);
+
+      vpip_random_fork(index);
+      vpip_mcd_fork(index);
+}
+
+/*
+ * Report a child that has exited with the wait status rc, and return
+ * true if it failed.
+ */
+static bool child_failed(unsigned index, int rc)
+{
+      if (WIFEXITED(rc) && WEXITSTATUS(rc) == 0)
+	    return false;
+
+      if (WIFSIGNALED(rc))
+	    vpi_printf("Fork info: test %u was killed by signal %d, "
+		       "see fork%u.log.\n", index, WTERMSIG(rc), index);
+      else
+	    vpi_printf("Fork info: test %u exited with status %d, "
+		       "see fork%u.log.\n", index, WEXITSTATUS(rc), index);
+      return true;
+}
+
+/*
+ * Wait for each of the running children in turn. This is the
+ * fallback if waiting for any child fails, so that the children
+ * are not left behind and their failures are still counted.
+ */
+static unsigned wait_for_running(map<pid_t,unsigned>&running)
+{
+      unsigned failed = 0;
+
+      for (map<pid_t,unsigned>::iterator cur = running.begin()
+		 ; cur != running.end() ; ++cur) {
+	    int rc;
+	    pid_t pid;
+	    do {
+		  pid = waitpid(cur->first, &rc, 0);
+	    } while (pid < 0 && errno == EINTR);
+
+	    if (pid < 0) {
+		  vpi_printf("Fork info: test %u could not be waited for: "
+			     "%s.\n", cur->second, strerror(errno));
+		  failed += 1;
+	    } else if (child_failed(cur->second, rc)) {
+		  failed += 1;
+	    }
+      }
+      running.clear();
+
+      return failed;
+}
+#endif
+
+/*
+ * Fork count children, at most jobs of them at a time, or one per
+ * processor if jobs is not given (<= 0). In a child, this returns
+ * the index of the child. In the parent, it returns 0 once all the
+ * children have exited, and sets the return value of the simulation
+ * if any child failed. It returns -1 if no child could be made.
+ */
+extern "C" PLI_INT32 vpip_fork_tests(PLI_INT32 count, PLI_INT32 jobs,
+				     const char*plusargs_path)
+{
+#ifdef __MINGW32__
+      vpi_printf("SORRY: $ivl_fork_tests is not supported on this "
+		 "platform.\n");
+      return -1;
+#else
+      if (fork_index != 0) {
+	    vpi_printf("ERROR: $ivl_fork_tests cannot be called in a "
+		       "forked test.\n");
+	    return -1;
+      }
+      if (count <= 0)
+	    return -1;
+      if (jobs <= 0)
+	    jobs = sysconf(_SC_NPROCESSORS_ONLN);
+      if (jobs <= 0)
+	    jobs = 1;
+
+	/* Anything buffered now would be written by every child. */
+      fflush(0);
+
+      map<pid_t,unsigned> running;
+      unsigned next = 1;
+      unsigned failed = 0;
+
+      while (next <= (unsigned)count || ! running.empty()) {
+	    while (next <= (unsigned)count && running.size() < (unsigned)jobs) {
+		  pid_t pid = fork();
+		  if (pid == 0) {
+			make_child(next, plusargs_path);
+			return next;
+		  }
+		  if (pid < 0) {
+			perror("$ivl_fork_tests: fork");
+			if (running.empty()) return -1;
+			break;
+		  }
+		  running[pid] = next;
+		  next += 1;
+	    }
+
+	    int rc;
+	    pid_t pid = waitpid(-1, &rc, 0);
+	    if (pid < 0 && errno == EINTR)
+		  continue;
+	    if (pid < 0) {
+		    /* Start no more tests, and count the ones that
+		       were never started as failed. */
+		  perror("$ivl_fork_tests: waitpid");
+		  failed += wait_for_running(running);
+		  failed += (unsigned)count - next + 1;
+		  break;
+	    }
+	    map<pid_t,unsigned>::iterator cur = running.find(pid);
+	    if (cur == running.end())
+		  continue;
+
+	    unsigned index = cur->second;
+	    running.erase(cur);
+	    if (child_failed(index, rc))
+		  failed += 1;
+      }
+
+      vpi_printf("Fork info: %u of %d tests passed.\n",
+		 (unsigned)count - failed, (int)count);
+      if (failed)
+	    vpip_set_return_value(1);
+
+      return 0;
+#endif
+}
@@ -18,6 +18,7 @@
  */
 
 # include  "vpi_priv.h"
+# include  "checkpoint.h"
 # include  "config.h"
 #ifdef CHECK_WITH_VALGRIND
 # include  "vvp_cleanup.h"
@@ -27,6 +28,9 @@
 # include  <cstdio>
 # include  <cstdlib>
 # include  <cstring>
+#ifndef __MINGW32__
+# include  <unistd.h>
+#endif
 # include  "ivl_alloc.h"
 
 extern FILE* vpi_trace;
@@ -48,6 +52,7 @@ extern FILE* vpi_trace;
 typedef struct mcd_entry {
 	FILE *fp;
 	char *filename;
+	char *mode;
 } mcd_entry_s;
 static mcd_entry_s mcd_table[31];
 static mcd_entry_s *fd_table = NULL;
@@ -65,6 +70,7 @@ void vpip_mcd_init(FILE *log)
       for (unsigned idx = 0; idx < fd_table_len; idx += 1) {
 	    fd_table[idx].fp = NULL;
 	    fd_table[idx].filename = NULL;
+	    fd_table[idx].mode = NULL;
       }
 
       mcd_table[0].fp = stdout;
@@ -128,8 +134,10 @@ extern "C" PLI_UINT32 vpi_mcd_close(PLI_UINT32 mcd)
 		if (idx > 2 && idx < fd_table_len && fd_table[idx].fp) {
 			rc = fclose(fd_table[idx].fp);
 			free(fd_table[idx].filename);
+			free(fd_table[idx].mode);
 			fd_table[idx].fp = NULL;
 			fd_table[idx].filename = NULL;
+			fd_table[idx].mode = NULL;
 		}
 	}
 	return rc;
@@ -161,10 +169,14 @@ extern "C" PLI_UINT32 vpi_mcd_open(char *name)
 	return 0;  /* too many open mcd's */
 
 got_entry:
-	mcd_table[i].fp = fopen(name, "w");
-	if(mcd_table[i].fp == NULL)
+	  /* A forked test writes its own copy of the file. */
+	char *path = vpip_fork_path(name);
+	mcd_table[i].fp = fopen(path, "w");
+	if(mcd_table[i].fp == NULL) {
+		free(path);
 		return 0;
-	mcd_table[i].filename = strdup(name);
+	}
+	mcd_table[i].filename = path;
 
 	if (vpi_trace) {
 	      fprintf(vpi_trace, "vpi_mcd_open(%s) --> 0x%08x\n",
@@ -303,12 +315,19 @@ extern "C" PLI_INT32 vpi_fopen(const char*name, const char*mode)
       for (unsigned idx = i; idx < fd_table_len; idx += 1) {
 	    fd_table[idx].fp = NULL;
 	    fd_table[idx].filename = NULL;
+	    fd_table[idx].mode = NULL;
       }
 
 got_entry:
-      fd_table[i].fp = fopen(name, mode);
-      if (fd_table[i].fp == NULL) return 0;
-      fd_table[i].filename = strdup(name);
+	/* A forked test writes its own copy of the file. */
+      char *path = mode[0] == 'r' ? strdup(name) : vpip_fork_path(name);
+      fd_table[i].fp = fopen(path, mode);
+      if (fd_table[i].fp == NULL) {
+	    free(path);
+	    return 0;
+      }
+      fd_table[i].filename = path;
+      fd_table[i].mode = strdup(mode);
       return ((1U<<31)|i);
 }
 
@@ -322,3 +341,159 @@ extern "C" FILE *vpi_get_file(PLI_INT32 fd)
 
       return fd_table[FD_IDX(fd)].fp;
 }
+
+/*
+ * In a test made by $ivl_fork_tests, move each open file to the
+ * child (see vpip_fork_file). The log file of the parent is left to
+ * the parent, since the output of the child goes to its own log.
+ */
+void vpip_mcd_fork(unsigned)
+{
+      logfile = NULL;
+
+      for (unsigned idx = 1 ; idx < 31 ; idx += 1) {
+	    if (mcd_table[idx].fp == NULL) continue;
+	    char *path = vpip_fork_file(mcd_table[idx].fp,
+					mcd_table[idx].filename, "w");
+	    if (path == NULL) {
+		  fprintf(stderr, "WARNING: Unable to copy %s for the forked "
+			  "test.\n", mcd_table[idx].filename);
+		  mcd_table[idx].fp = NULL;
+	    }
+	    free(mcd_table[idx].filename);
+	    mcd_table[idx].filename = path;
+      }
+
+      for (unsigned idx = 3 ; idx < fd_table_len ; idx += 1) {
+	    if (fd_table[idx].fp == NULL) continue;
+	    char *path = vpip_fork_file(fd_table[idx].fp,
+					fd_table[idx].filename,
+					fd_table[idx].mode);
+	    if (path == NULL) {
+		  fprintf(stderr, "WARNING: Unable to copy %s for the forked "
+			  "test.\n", fd_table[idx].filename);
+		  fd_table[idx].fp = NULL;
+		  free(fd_table[idx].mode);
+		  fd_table[idx].mode = NULL;
+	    }
+	    free(fd_table[idx].filename);
+	    fd_table[idx].filename = path;
+      }
+}
+
+/*
+ * A checkpoint records the name, mode and position of each open
+ * file. The restore opens the file again, at the same position,
+ * without losing the contents that were written before the
+ * checkpoint. A file that was opened for writing is cut back to the
+ * saved position, so that the output of a resumed simulation follows
+ * the output up to the checkpoint.
+ */
+static void checkpoint_save_file(checkpoint_out&out, unsigned idx,
+				 const mcd_entry_s&ent, const char*mode)
+{
+      fflush(ent.fp);
+      long pos = ftell(ent.fp);
+      if (pos < 0) {
+	    out.refuse("file %s cannot be repositioned", ent.filename);
+	    return;
+      }
+
+      out.put_uint(idx);
+      out.put_str(ent.filename);
+      out.put_str(mode);
+      out.put_uint(pos);
+}
+
+void vpip_mcd_checkpoint_save(checkpoint_out&out)
+{
+      for (unsigned idx = 1 ; idx < 31 && out.ok() ; idx += 1) {
+	    if (mcd_table[idx].fp)
+		  checkpoint_save_file(out, idx, mcd_table[idx], "w");
+      }
+      out.put_uint(0);
+
+      for (unsigned idx = 3 ; idx < fd_table_len && out.ok() ; idx += 1) {
+	    if (fd_table[idx].fp)
+		  checkpoint_save_file(out, idx, fd_table[idx], fd_table[idx].mode);
+      }
+      out.put_uint(0);
+}
+
+static FILE* checkpoint_reopen(const std::string&name, const std::string&mode,
+			       long pos)
+{
+      bool binary = mode.find('b') != std::string::npos;
+
+      if (mode[0] == 'w' || mode[0] == 'a') {
+#ifndef __MINGW32__
+	    if (truncate(name.c_str(), pos) != 0)
+		  return NULL;
+#endif
+      }
+
+      FILE*fp;
+      if (mode[0] == 'w') {
+	    fp = fopen(name.c_str(), binary? "r+b" : "r+");
+      } else {
+	    fp = fopen(name.c_str(), mode.c_str());
+      }
+      if (fp == NULL)
+	    return NULL;
+
+      if (mode[0] != 'a' && fseek(fp, pos, SEEK_SET) != 0) {
+	    fclose(fp);
+	    return NULL;
+      }
+      return fp;
+}
+
+void vpip_mcd_checkpoint_restore(checkpoint_in&in)
+{
+      for (unsigned section = 0 ; section < 2 ; section += 1) {
+	    while (in.ok()) {
+		  unsigned idx = in.get_uint();
+		  if (idx == 0)
+			break;
+		  std::string name = in.get_str();
+		  std::string mode = in.get_str();
+		  long pos = in.get_uint();
+		  if (! in.ok())
+			return;
+
+		  bool bad = section == 0 ? (idx >= 31) : (idx < 3 || idx >= 1024);
+		  if (bad || mode.empty()) {
+			in.corrupt("a file descriptor is out of range");
+			return;
+		  }
+
+		  if (section == 1 && idx >= fd_table_len) {
+			unsigned len = (idx / FD_INCR + 1) * FD_INCR;
+			fd_table = (mcd_entry_s *) realloc(fd_table,
+							  len*sizeof(mcd_entry_s));
+			for (unsigned cur = fd_table_len; cur < len; cur += 1) {
+			      fd_table[cur].fp = NULL;
+			      fd_table[cur].filename = NULL;
+			      fd_table[cur].mode = NULL;
+			}
+			fd_table_len = len;
+		  }
+
+		  mcd_entry_s&ent = section == 0 ? mcd_table[idx] : fd_table[idx];
+		  if (ent.fp) {
+			in.corrupt("a file descriptor is already open");
+			return;
+		  }
+
+		  ent.fp = checkpoint_reopen(name, mode, pos);
+		  if (ent.fp == NULL) {
+			vpi_printf("WARNING: Unable to reopen file %s from the "
+				   "checkpoint.\n", name.c_str());
+			continue;
+		  }
+		  ent.filename = strdup(name.c_str());
+		  if (section == 1)
+			ent.mode = strdup(mode.c_str());
+	    }
+      }
+}
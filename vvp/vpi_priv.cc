@@ -576,6 +576,26 @@ void vpi_set_vlog_info(int argc, char** argv)
     }
 }
 
+/*
+ * Add an argument to the end of the extended arguments. The argv of
+ * main() cannot grow, so the first call copies it.
+ */
+void vpip_add_vlog_arg(char*arg)
+{
+    static char**own_argv = 0;
+    int argc = vpi_vlog_info.argc;
+    char**argv = (char**)realloc(own_argv, (argc+2)*sizeof(char*));
+    if (own_argv == 0) {
+	  for (int idx = 0 ; idx < argc ; idx += 1)
+		argv[idx] = vpi_vlog_info.argv[idx];
+    }
+    argv[argc] = arg;
+    argv[argc+1] = 0;
+    own_argv = argv;
+    vpi_vlog_info.argc = argc+1;
+    vpi_vlog_info.argv = argv;
+}
+
 static void vec4_get_value_string(const vvp_vector4_t&word_val, unsigned width,
 				  s_vpi_value*vp)
 {
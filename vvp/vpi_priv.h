@@ -248,8 +248,12 @@ struct __vpiScope : public __vpiHandle {
       vvp_context_t live_contexts;
         /* Keep a list of freed contexts. */
       vvp_context_t free_contexts;
-	/* Keep a list of threads in the scope. */
-      std::set<vthread_t> threads;
+	/* The layout of the contexts, computed at the first
+	   allocation (see vthread.cc). */
+      struct context_layout_s*context_layout;
+	/* Keep a list of threads in the scope. The list is linked
+	   through the threads themselves (see vthread.cc). */
+      vthread_t threads;
       signed int time_units :8;
       signed int time_precision :8;
 
@@ -585,14 +589,32 @@ struct __vpiSysTaskCall : public __vpiHandle {
       unsigned file_idx;
       unsigned lineno;
       bool put_value;
+	/* Some built-in system functions have a native implementation
+	   (an intrinsic) that the call uses instead of the calltf of
+	   the definition. The intrinsic_units is the time units of
+	   the module that contains the call, for the time functions,
+	   and the intrinsic_data is private (malloc'ed) state. */
+      void (*intrinsic)(vthread_t thr, struct __vpiSysTaskCall*obj);
+      int intrinsic_units;
+      void*intrinsic_data;
     protected:
       inline __vpiSysTaskCall()
       {
 	    real_stack = 0;
 	    string_stack = 0;
+	    intrinsic = 0;
+	    intrinsic_units = 0;
+	    intrinsic_data = 0;
       }
 };
 
+/*
+ * Attach the intrinsic for a call to one of the random number system
+ * functions (or $ivl_random_fill), if there is one. This returns true
+ * if an intrinsic was attached.
+ */
+extern bool vpip_attach_random_intrinsic(struct __vpiSysTaskCall*obj);
+
 extern struct __vpiSysTaskCall*vpip_cur_task;
 
 /*
@@ -799,4 +821,30 @@ extern vpiHandle vpip_module(struct __vpiScope*scope);
 
 extern int vpip_delay_selection;
 
+/*
+ * $ivl_fork_tests (vpi_fork.cc) uses these in each child to give the
+ * child its own arguments, random seeds and files.
+ */
+extern void vpip_add_vlog_arg(char*arg);
+extern void vpip_random_fork(unsigned index);
+extern void vpip_mcd_fork(unsigned index);
+
+/*
+ * Walk the scope tree from the root scopes in the order of the
+ * design, which is the same in every run. The walker calls
+ * visit_scope for each scope before its items, and visit_item for
+ * each item of a scope that is not itself a scope. vpip_item_net
+ * returns the net that holds the value of a signal or variable item,
+ * or nil if the item is something else.
+ */
+class vpip_scope_walker {
+    public:
+      virtual ~vpip_scope_walker() { }
+      virtual void visit_scope(struct __vpiScope*scope);
+      virtual void visit_item(vpiHandle item) =0;
+};
+
+extern void vpip_walk_scopes(vpip_scope_walker&walker);
+extern vvp_net_t* vpip_item_net(vpiHandle item);
+
 #endif
@@ -0,0 +1,722 @@
+/*
+ * Copyright (c) 2000-2013 Stephen Williams (steve@icarus.com)
+ *
+ *    This source code is free software; you can redistribute it
+ *    and/or modify it in source code form under the terms of the GNU
+ *    General Public License as published by the Free Software
+ *    Foundation; either version 2 of the License, or (at your option)
+ *    any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * This file holds the random number generators of IEEE 1364 ($random
+ * and the $dist_* functions) and of SystemVerilog ($urandom and
+ * $urandom_range). The generators live in the simulator so that the
+ * system.vpi module (through the vpip_dist_* functions) and the
+ * intrinsics for these functions share a single implementation and
+ * a single internal seed. The sequences are exactly those of the
+ * standard.
+ */
+# include  "vpi_priv.h"
+# include  "vthread.h"
+# include  "array.h"
+# include  "vvp_net_sig.h"
+# include  "checkpoint.h"
+# include  "config.h"
+# include  <cstdlib>
+# include  <cstring>
+# include  <cmath>
+# include  <climits>
+# include  <cassert>
+
+#if ULONG_MAX > 4294967295UL
+# define UNIFORM_MAX INT_MAX
+# define UNIFORM_MIN INT_MIN
+#else
+# define UNIFORM_MAX LONG_MAX
+# define UNIFORM_MIN LONG_MIN
+#endif
+
+static double uniform(long *seed, long start, long end);
+static double normal(long *seed, long mean, long deviation);
+static double exponential(long *seed, long mean);
+static long poisson(long *seed, long mean);
+static double chi_square(long *seed, long deg_of_free);
+static double t(long *seed, long deg_of_free);
+static double erlangian(long *seed, long k, long mean);
+
+extern "C" long vpip_dist_chi_square(long *seed, long df)
+{
+      double r;
+      long i;
+
+      if (df > 0) {
+            r = chi_square(seed, df);
+            if (r >= 0) {
+                  i = (long) (r + 0.5);
+            } else {
+                  r = -r;
+                  i = (long) (r + 0.5);
+                  i = -i;
+            }
+      } else {
+            vpi_printf("WARNING: Chi_square distribution must have "
+                       "a positive degree of freedom\n");
+            i = 0;
+      }
+
+      return i;
+}
+
+extern "C" long vpip_dist_erlang(long *seed, long k, long mean)
+{
+      double r;
+      long i;
+
+      if (k > 0) {
+            r = erlangian(seed, k, mean);
+            if (r >= 0) {
+                  i = (long) (r + 0.5);
+            } else {
+                  r = -r;
+                  i = (long) (r + 0.5);
+                  i = -i;
+            }
+      } else {
+            vpi_printf("WARNING: K-stage erlangian distribution must have "
+                       "a positive k\n");
+            i = 0;
+      }
+
+      return i;
+}
+
+extern "C" long vpip_dist_exponential(long *seed, long mean)
+{
+      double r;
+      long i;
+
+      if (mean > 0) {
+            r = exponential(seed, mean);
+            if (r >= 0) {
+                  i = (long) (r + 0.5);
+            } else {
+                  r = -r;
+                  i = (long) (r + 0.5);
+                  i = -i;
+            }
+      } else {
+            vpi_printf("WARNING: Exponential distribution must have "
+                       "a positive mean\n");
+            i = 0;
+      }
+
+      return i;
+}
+
+extern "C" long vpip_dist_normal(long *seed, long mean, long sd)
+{
+      double r;
+      long i;
+
+      r = normal(seed, mean, sd);
+      if (r >= 0) {
+            i = (long) (r + 0.5);
+      } else {
+            r = -r;
+            i = (long) (r + 0.5);
+            i = -i;
+      }
+
+      return i;
+}
+
+extern "C" long vpip_dist_poisson(long *seed, long mean)
+{
+      long i;
+
+      if (mean > 0) {
+            i = poisson(seed, mean);
+      } else {
+            vpi_printf("WARNING: Poisson distribution must have "
+                       "a positive mean\n");
+            i = 0;
+      }
+
+      return i;
+}
+
+extern "C" long vpip_dist_t(long *seed, long df)
+{
+      double r;
+      long i;
+
+      if (df > 0) {
+            r = t(seed, df);
+            if (r >= 0) {
+                  i = (long) (r + 0.5);
+            } else {
+                  r = -r;
+                  i = (long) (r + 0.5);
+                  i = -i;
+            }
+      } else {
+            vpi_printf("WARNING: t distribution must have "
+                       "a positive degree of freedom\n");
+            i = 0;
+      }
+
+      return i;
+}
+
+/* copied from IEEE1364-2001, with slight modifications for 64bit machines. */
+extern "C" long vpip_dist_uniform(long *seed, long start, long end)
+{
+      double r;
+      long i;
+
+      if (start >= end) return(start);
+
+      /* NOTE: The cast of r to i can overflow and generate strange
+         values, so cast to unsigned long first. This eliminates
+         the underflow and gets the twos complement value. That in
+         turn can be cast to the long value that is expected. */
+
+      if (end != UNIFORM_MAX) {
+            end++;
+            r = uniform(seed, start, end);
+            if (r >= 0) {
+                  i = (unsigned long) r;
+            } else {
+	          i = - ( (unsigned long) (-(r - 1)) );
+            }
+            if (i < start) i = start;
+            if (i >= end) i = end - 1;
+      } else if (start != UNIFORM_MIN) {
+            start--;
+            r = uniform( seed, start, end) + 1.0;
+            if (r >= 0) {
+                  i = (unsigned long) r;
+            } else {
+	          i = - ( (unsigned long) (-(r - 1)) );
+            }
+            if (i <= start) i = start + 1;
+            if (i > end) i = end;
+      } else {
+            r = (uniform(seed, start, end) + 2147483648.0) / 4294967295.0;
+            r = r * 4294967296.0 - 2147483648.0;
+
+            if (r >= 0) {
+                  i = (unsigned long) r;
+            } else {
+	            /* At least some compilers will notice that (r-1)
+		       is <0 when castling to unsigned long and
+		       replace the result with a zero. This causes
+		       much wrongness, so do the casting to the
+		       positive version and invert it back. */
+	          i = - ( (unsigned long) (-(r - 1)) );
+            }
+      }
+
+      return i;
+}
+
+static double uniform(long *seed, long start, long end )
+{
+      double d = 0.00000011920928955078125;
+      double a, b, c;
+      unsigned long oldseed, newseed;
+
+      oldseed = *seed;
+      if (oldseed == 0)
+            oldseed = 259341593;
+
+      if (start >= end) {
+            a = 0.0;
+            b = 2147483647.0;
+      } else {
+            a = (double)start;
+            b = (double)end;
+      }
+
+      /* Original routine used signed arithmetic, and the (frequent)
+       * overflows trigger "Undefined Behavior" according to the
+       * C standard (both c89 and c99).  Using unsigned arithmetic
+       * forces a conforming C implementation to get the result
+       * that the IEEE-1364-2001 committee wants.
+       */
+      newseed = 69069 * oldseed + 1;
+
+      /* Emulate a 32-bit unsigned long, even if the native machine
+       * uses wider words.
+       */
+#if ULONG_MAX > 4294967295UL
+      newseed = newseed & 4294967295UL;
+#endif
+      *seed = newseed;
+
+      /* Equivalent of the Cadence-donated conversion from unsigned
+       * int to double, without assuming IEEE 32-bit float. The
+       * constant is 2^(-23). */
+      c = 1.0 + (newseed >> 9) * 0.00000011920928955078125;
+
+      c = c + (c*d);
+      c = ((b - a) * (c - 1.0)) + a;
+
+      return c;
+}
+
+static double normal(long *seed, long mean, long deviation)
+{
+      double v1, v2, s;
+
+      s = 1.0;
+      while ((s >= 1.0) || (s == 0.0)) {
+            v1 = uniform(seed, -1, 1);
+            v2 = uniform(seed, -1, 1);
+            s = v1 * v1 + v2 * v2;
+      }
+      s = v1 * sqrt(-2.0 * log(s) / s);
+      v1 = (double) deviation;
+      v2 = (double) mean;
+
+      return s * v1 + v2;
+}
+
+static double exponential(long *seed, long mean)
+{
+      double n;
+
+      n = uniform(seed, 0, 1);
+      if (n != 0.0) {
+            n = -log(n) * mean;
+      }
+
+      return n;
+}
+
+static long poisson(long *seed, long mean)
+{
+      long n;
+      double p, q;
+
+      n = 0;
+      q = -(double) mean;
+      p = exp(q);
+      q = uniform(seed, 0, 1);
+      while (p < q) {
+            n++;
+            q = uniform(seed, 0, 1) * q;
+      }
+
+      return n;
+}
+
+static double chi_square(long *seed, long deg_of_free)
+{
+      double x;
+      long k;
+
+      if (deg_of_free % 2) {
+            x = normal(seed, 0, 1);
+            x = x * x;
+      } else {
+            x = 0.0;
+      }
+      for (k = 2; k <= deg_of_free; k = k + 2) {
+            x = x + 2 * exponential(seed, 1);
+      }
+
+      return x;
+}
+
+static double t( long *seed, long deg_of_free)
+{
+      double x, chi2, dv, root;
+
+      chi2 = chi_square(seed, deg_of_free);
+      dv = chi2 / (double) deg_of_free;
+      root = sqrt(dv);
+      x = normal(seed, 0, 1) / root;
+
+      return x;
+}
+
+static double erlangian(long *seed, long k, long mean)
+{
+      double x, a, b;
+      long i;
+
+      x = 1.0;
+      for (i = 1; i <= k; i++) {
+            x = x * uniform(seed, 0, 1);
+      }
+      a = (double) mean;
+      b = (double) k;
+      x = -a * log(x) / b;
+
+      return x;
+}
+
+/*
+ * The $random and $urandom functions without a seed argument each
+ * use an internal seed. Passing a nil seed pointer selects it.
+ */
+static long random_seed = 0;
+static long urandom_seed = 0;
+
+extern "C" long vpip_random(long *seed)
+{
+      if (seed == 0) seed = &random_seed;
+      return vpip_dist_uniform(seed, INT_MIN, INT_MAX);
+}
+
+/* From System Verilog 3.1a. A seeded call also sets the internal
+   seed, so a later call without a seed continues from there. */
+extern "C" unsigned long vpip_urandom(long *seed, unsigned long max,
+                                      unsigned long min)
+{
+      unsigned long result;
+      long max_i, min_i;
+
+      max_i =  max + INT_MIN;
+      min_i =  min + INT_MIN;
+      if (seed != 0) urandom_seed = *seed;
+      result = vpip_dist_uniform(&urandom_seed, min_i, max_i) - INT_MIN;
+      if (seed != 0) *seed = urandom_seed;
+      return result;
+}
+
+/* Each test that $ivl_fork_tests makes starts from a different
+   internal seed. */
+void vpip_random_fork(unsigned index)
+{
+      random_seed += index;
+      urandom_seed += index;
+}
+
+void vpip_random_checkpoint_save(checkpoint_out&out)
+{
+      out.put_int(random_seed);
+      out.put_int(urandom_seed);
+}
+
+void vpip_random_checkpoint_restore(checkpoint_in&in)
+{
+      random_seed = in.get_int();
+      urandom_seed = in.get_int();
+}
+
+/*
+ * The intrinsics for the random functions. The seed argument of these
+ * functions is read and written back on every call, so when the seed
+ * is a plain variable the intrinsic accesses the value of the
+ * variable directly. Otherwise it goes through the VPI handle of the
+ * argument. The arguments are not linked when the call is built, so
+ * the seed is bound on the first call.
+ */
+struct random_seed_s {
+      struct __vpiSignal*sig;
+      vvp_signal_value*vsig;
+      unsigned wid;
+};
+
+static struct random_seed_s* bind_seed(struct __vpiSysTaskCall*obj,
+					unsigned idx)
+{
+      struct random_seed_s*res = (struct random_seed_s*)
+	    calloc(1, sizeof(struct random_seed_s));
+
+      struct __vpiSignal*sig = dynamic_cast<__vpiSignal*>(obj->args[idx]);
+      if (sig && ! sig->is_netarray) {
+	    res->vsig = dynamic_cast<vvp_signal_value*>(sig->node->fil);
+	    if (res->vsig) {
+		  res->sig = sig;
+		  res->wid = (sig->msb >= sig->lsb)
+			? (sig->msb - sig->lsb + 1)
+			: (sig->lsb - sig->msb + 1);
+	    }
+      }
+
+      obj->intrinsic_data = res;
+      return res;
+}
+
+/*
+ * Get and put the seed in argument idx the way that vpi_get_value and vpi_put_value
+ * with a vpiIntVal would, so the sequence is the same as through the
+ * system.vpi implementation.
+ */
+static long get_seed(struct __vpiSysTaskCall*obj, unsigned idx)
+{
+      struct random_seed_s*seed = (struct random_seed_s*) obj->intrinsic_data;
+      if (seed == 0) seed = bind_seed(obj, idx);
+
+      if (seed->sig == 0) {
+	    s_vpi_value val;
+	    val.format = vpiIntVal;
+	    vpi_get_value(obj->args[idx], &val);
+	    return val.value.integer;
+      }
+
+      vvp_vector4_t tmp;
+      seed->vsig->vec4_value(tmp);
+      if (tmp.size() != seed->wid) tmp = tmp.subvalue(0, seed->wid);
+
+	// Convert through the type of the s_vpi_value integer, as
+	// format_vpiIntVal does, so that a wide seed variable gives
+	// the same value as it would through vpi_get_value.
+      s_vpi_value vpi_val;
+      if (sizeof(vpi_val.value.integer) == sizeof(int32_t)) {
+	    int32_t val = 0;
+	    vector4_to_value(tmp, val, seed->sig->signed_flag, false);
+	    return val;
+      } else {
+	    assert(sizeof(vpi_val.value.integer) == sizeof(int64_t));
+	    int64_t val = 0;
+	    vector4_to_value(tmp, val, seed->sig->signed_flag, false);
+	    return val;
+      }
+}
+
+static void put_seed(struct __vpiSysTaskCall*obj, unsigned idx, long value)
+{
+      struct random_seed_s*seed = (struct random_seed_s*) obj->intrinsic_data;
+      assert(seed);
+
+      if (seed->sig == 0) {
+	    s_vpi_value val;
+	    val.format = vpiIntVal;
+	    val.value.integer = value;
+	    vpi_put_value(obj->args[idx], &val, 0, vpiNoDelay);
+	    return;
+      }
+
+	// This is the conversion of vec4_from_vpi_value: the value
+	// passes through the s_vpi_value integer, and is then sign
+	// extended to the width of the variable.
+      const unsigned bits_per_long = 8*sizeof(long);
+      s_vpi_value vpi_val;
+      vpi_val.value.integer = value;
+      long sval = vpi_val.value.integer;
+      vvp_vector4_t tmp (seed->wid, sval < 0? BIT4_1 : BIT4_0);
+      tmp.set_word(0, seed->wid < bits_per_long? seed->wid : bits_per_long,
+		   (unsigned long) sval);
+
+      vvp_net_ptr_t dest (seed->sig->node, 0);
+      vvp_send_vec4(dest, tmp, vthread_get_wt_context());
+}
+
+static long get_int_arg(struct __vpiSysTaskCall*obj, unsigned idx)
+{
+      s_vpi_value val;
+      val.format = vpiIntVal;
+      vpi_get_value(obj->args[idx], &val);
+      return val.value.integer;
+}
+
+static void put_int_result(vthread_t thr, struct __vpiSysTaskCall*obj,
+			   long value)
+{
+      vthread_put_word(thr, obj->vbit, obj->vwid,
+		       (uint64_t)(int64_t)(PLI_INT32)value);
+}
+
+static void intrinsic_random(vthread_t thr, struct __vpiSysTaskCall*obj)
+{
+      if (obj->nargs == 0) {
+	    put_int_result(thr, obj, vpip_random(0));
+	    return;
+      }
+
+      long seed = get_seed(obj, 0);
+      long res = vpip_random(&seed);
+      put_seed(obj, 0, seed);
+      put_int_result(thr, obj, res);
+}
+
+static void intrinsic_urandom(vthread_t thr, struct __vpiSysTaskCall*obj)
+{
+      if (obj->nargs == 0) {
+	    put_int_result(thr, obj, vpip_urandom(0, UINT_MAX, 0));
+	    return;
+      }
+
+      long seed = get_seed(obj, 0);
+      long res = vpip_urandom(&seed, UINT_MAX, 0);
+      put_seed(obj, 0, seed);
+      put_int_result(thr, obj, res);
+}
+
+static void intrinsic_urandom_range(vthread_t thr, struct __vpiSysTaskCall*obj)
+{
+      unsigned long maxval = get_int_arg(obj, 0);
+      unsigned long minval = get_int_arg(obj, 1);
+
+      if (minval > maxval) {
+	    unsigned long tmp = minval;
+	    minval = maxval;
+	    maxval = tmp;
+      }
+
+      put_int_result(thr, obj, vpip_urandom(0, maxval, minval));
+}
+
+static void intrinsic_dist_uniform(vthread_t thr, struct __vpiSysTaskCall*obj)
+{
+      long seed = get_seed(obj, 0);
+      long start = get_int_arg(obj, 1);
+      long end = get_int_arg(obj, 2);
+      long res = vpip_dist_uniform(&seed, start, end);
+      put_seed(obj, 0, seed);
+      put_int_result(thr, obj, res);
+}
+
+static void intrinsic_dist_normal(vthread_t thr, struct __vpiSysTaskCall*obj)
+{
+      long seed = get_seed(obj, 0);
+      long mean = get_int_arg(obj, 1);
+      long sd = get_int_arg(obj, 2);
+      long res = vpip_dist_normal(&seed, mean, sd);
+      put_seed(obj, 0, seed);
+      put_int_result(thr, obj, res);
+}
+
+static void intrinsic_dist_exponential(vthread_t thr, struct __vpiSysTaskCall*obj)
+{
+      long seed = get_seed(obj, 0);
+      long mean = get_int_arg(obj, 1);
+      long res = vpip_dist_exponential(&seed, mean);
+      put_seed(obj, 0, seed);
+      put_int_result(thr, obj, res);
+}
+
+static void intrinsic_dist_poisson(vthread_t thr, struct __vpiSysTaskCall*obj)
+{
+      long seed = get_seed(obj, 0);
+      long mean = get_int_arg(obj, 1);
+      long res = vpip_dist_poisson(&seed, mean);
+      put_seed(obj, 0, seed);
+      put_int_result(thr, obj, res);
+}
+
+static void intrinsic_dist_chi_square(vthread_t thr, struct __vpiSysTaskCall*obj)
+{
+      long seed = get_seed(obj, 0);
+      long df = get_int_arg(obj, 1);
+      long res = vpip_dist_chi_square(&seed, df);
+      put_seed(obj, 0, seed);
+      put_int_result(thr, obj, res);
+}
+
+static void intrinsic_dist_t(vthread_t thr, struct __vpiSysTaskCall*obj)
+{
+      long seed = get_seed(obj, 0);
+      long df = get_int_arg(obj, 1);
+      long res = vpip_dist_t(&seed, df);
+      put_seed(obj, 0, seed);
+      put_int_result(thr, obj, res);
+}
+
+static void intrinsic_dist_erlang(vthread_t thr, struct __vpiSysTaskCall*obj)
+{
+      long seed = get_seed(obj, 0);
+      long k = get_int_arg(obj, 1);
+      long mean = get_int_arg(obj, 2);
+      long res = vpip_dist_erlang(&seed, k, mean);
+      put_seed(obj, 0, seed);
+      put_int_result(thr, obj, res);
+}
+
+/*
+ * $ivl_random_fill(mem [, seed]) fills every word of the array with
+ * the next value from $random (or $random(seed)), from the first word
+ * to the last. The words of a variable array are written directly,
+ * other arrays are filled through the VPI.
+ */
+static void intrinsic_random_fill(vthread_t, struct __vpiSysTaskCall*obj)
+{
+      vpiHandle mem = obj->args[0];
+      long seed = obj->nargs > 1? get_seed(obj, 1) : 0;
+      long*seedp = obj->nargs > 1? &seed : 0;
+
+      if (mem->get_type_code() == vpiMemory
+	  && array_is_vec4_var((vvp_array_t) mem)) {
+	    vvp_array_t arr = (vvp_array_t) mem;
+	    unsigned count = mem->vpi_get(vpiSize);
+	    unsigned wid = get_array_word_size(arr);
+	    const unsigned bits_per_long = 8*sizeof(long);
+
+	    for (unsigned idx = 0 ; idx < count ; idx += 1) {
+		  long sval = (PLI_INT32) vpip_random(seedp);
+		  vvp_vector4_t tmp (wid, sval < 0? BIT4_1 : BIT4_0);
+		  tmp.set_word(0, wid < bits_per_long? wid : bits_per_long,
+			       (unsigned long) sval);
+		  array_set_word(arr, idx, 0, tmp);
+	    }
+
+      } else {
+	    vpiHandle words = vpi_iterate(vpiMemoryWord, mem);
+	    while (vpiHandle word = words? vpi_scan(words) : 0) {
+		  s_vpi_value val;
+		  val.format = vpiIntVal;
+		  val.value.integer = vpip_random(seedp);
+		  vpi_put_value(word, &val, 0, vpiNoDelay);
+	    }
+      }
+
+      if (seedp) put_seed(obj, 1, seed);
+}
+
+bool vpip_attach_random_intrinsic(struct __vpiSysTaskCall*obj)
+{
+      const char*name = obj->defn->info.tfname;
+
+      if (obj->defn->info.type == vpiSysTask) {
+	    if (strcmp(name, "$ivl_random_fill") == 0
+		&& (obj->nargs == 1 || obj->nargs == 2)) {
+		  obj->intrinsic = &intrinsic_random_fill;
+		  return true;
+	    }
+	    return false;
+      }
+
+	/* The functions must write a result of up to 64 bits to the
+	   thread. Calls in a net context go through the VPI. */
+      if (obj->fnet != 0 || obj->vwid <= 0 || obj->vwid > 64)
+	    return false;
+
+      if (strcmp(name, "$random") == 0 && obj->nargs <= 1)
+	    obj->intrinsic = &intrinsic_random;
+      else if (strcmp(name, "$urandom") == 0 && obj->nargs <= 1)
+	    obj->intrinsic = &intrinsic_urandom;
+      else if (strcmp(name, "$urandom_range") == 0 && obj->nargs == 2)
+	    obj->intrinsic = &intrinsic_urandom_range;
+      else if (strcmp(name, "$dist_uniform") == 0 && obj->nargs == 3)
+	    obj->intrinsic = &intrinsic_dist_uniform;
+      else if (strcmp(name, "$dist_normal") == 0 && obj->nargs == 3)
+	    obj->intrinsic = &intrinsic_dist_normal;
+      else if (strcmp(name, "$dist_exponential") == 0 && obj->nargs == 2)
+	    obj->intrinsic = &intrinsic_dist_exponential;
+      else if (strcmp(name, "$dist_poisson") == 0 && obj->nargs == 2)
+	    obj->intrinsic = &intrinsic_dist_poisson;
+      else if (strcmp(name, "$dist_chi_square") == 0 && obj->nargs == 2)
+	    obj->intrinsic = &intrinsic_dist_chi_square;
+      else if (strcmp(name, "$dist_t") == 0 && obj->nargs == 2)
+	    obj->intrinsic = &intrinsic_dist_t;
+      else if (strcmp(name, "$dist_erlang") == 0 && obj->nargs == 3)
+	    obj->intrinsic = &intrinsic_dist_erlang;
+      else
+	    return false;
+
+      return true;
+}
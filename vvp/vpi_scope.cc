@@ -48,6 +48,42 @@ void vpip_make_root_iterator(__vpiHandle**&table, unsigned&ntable)
       ntable = vpip_root_table_cnt;
 }
 
+void vpip_scope_walker::visit_scope(struct __vpiScope*)
+{
+}
+
+static void walk_scope(vpip_scope_walker&walker, struct __vpiScope*scope)
+{
+      walker.visit_scope(scope);
+
+      for (unsigned idx = 0 ; idx < scope->nintern ; idx += 1) {
+	    vpiHandle item = scope->intern[idx];
+	    if (struct __vpiScope*sub = dynamic_cast<__vpiScope*>(item))
+		  walk_scope(walker, sub);
+	    else
+		  walker.visit_item(item);
+      }
+}
+
+void vpip_walk_scopes(vpip_scope_walker&walker)
+{
+      for (unsigned idx = 0 ; idx < vpip_root_table_cnt ; idx += 1) {
+	    struct __vpiScope*scope = dynamic_cast<__vpiScope*>(vpip_root_table_ptr[idx]);
+	    if (scope) walk_scope(walker, scope);
+      }
+}
+
+vvp_net_t* vpip_item_net(vpiHandle item)
+{
+      if (struct __vpiSignal*sig = dynamic_cast<__vpiSignal*>(item))
+	    return sig->node;
+      if (struct __vpiRealVar*sig = dynamic_cast<__vpiRealVar*>(item))
+	    return sig->net;
+      if (__vpiBaseVar*sig = dynamic_cast<__vpiBaseVar*>(item))
+	    return sig->get_net();
+      return 0;
+}
+
 #ifdef CHECK_WITH_VALGRIND
 void port_delete(__vpiHandle*handle);
 
@@ -468,6 +504,8 @@ compile_scope_decl(char*label, char*type, char*name, char*tname,
       scope->nitem = 0;
       scope->live_contexts = 0;
       scope->free_contexts = 0;
+      scope->context_layout = 0;
+      scope->threads = 0;
 
       if (is_cell) scope->is_cell = true;
       else scope->is_cell = false;
@@ -25,6 +25,7 @@
 # include  "vpi_priv.h"
 # include  "vthread.h"
 # include  "compile.h"
+# include  "schedule.h"
 # include  "config.h"
 #ifdef CHECK_WITH_VALGRIND
 # include  "vvp_cleanup.h"
@@ -33,6 +34,7 @@
 # include  <cstdio>
 # include  <cstdlib>
 # include  <cstring>
+# include  <cmath>
 # include  <cassert>
 # include  "ivl_alloc.h"
 
@@ -45,10 +47,8 @@ int __vpiUserSystf::get_type_code(void) const
 { return vpiUserSystf; }
 
 
-static vpiHandle systask_handle(int type, vpiHandle ref)
+static vpiHandle systask_handle(int type, struct __vpiSysTaskCall*rfp)
 {
-      struct __vpiSysTaskCall*rfp = dynamic_cast<__vpiSysTaskCall*>(ref);
-
       switch (type) {
 	  case vpiScope:
 	    return rfp->scope;
@@ -63,10 +63,8 @@ static vpiHandle systask_handle(int type, vpiHandle ref)
       };
 }
 
-static int systask_get(int type, vpiHandle ref)
+static int systask_get(int type, struct __vpiSysTaskCall*rfp)
 {
-      struct __vpiSysTaskCall*rfp = dynamic_cast<__vpiSysTaskCall*>(ref);
-
       switch (type) {
 	    /* This is not the correct way to get this information, but
 	     * some of the code that implements the acc and tf routines
@@ -88,10 +86,8 @@ static int systask_get(int type, vpiHandle ref)
 }
 
 // support getting vpiSize for a system function call
-static int sysfunc_get(int type, vpiHandle ref)
+static int sysfunc_get(int type, struct __vpiSysTaskCall*rfp)
 {
-      struct __vpiSysTaskCall*rfp = dynamic_cast<__vpiSysTaskCall*>(ref);
-
       switch (type) {
 	  case vpiSize:
 	    return rfp->vwid;
@@ -111,10 +107,8 @@ static int sysfunc_get(int type, vpiHandle ref)
  * the get_str function only needs to support vpiName
  */
 
-static char *systask_get_str(int type, vpiHandle ref)
+static char *systask_get_str(int type, struct __vpiSysTaskCall*rfp)
 {
-      struct __vpiSysTaskCall*rfp = dynamic_cast<__vpiSysTaskCall*>(ref);
-
       switch (type) {
           case vpiFile:
             assert(rfp->file_idx < file_names.size());
@@ -131,10 +125,8 @@ static char *systask_get_str(int type, vpiHandle ref)
  * the iter function only supports getting an iterator of the
  * arguments. This works equally well for tasks and functions.
  */
-static vpiHandle systask_iter(int, vpiHandle ref)
+static vpiHandle systask_iter(int, struct __vpiSysTaskCall*rfp)
 {
-      struct __vpiSysTaskCall*rfp = dynamic_cast<__vpiSysTaskCall*>(ref);
-
       if (rfp->nargs == 0)
 	    return 0;
 
@@ -156,11 +148,8 @@ struct systask_def : public __vpiSysTaskCall {
  * bits and set into the thread space bits that were selected at
  * compile time.
  */
-static vpiHandle sysfunc_put_value(vpiHandle ref, p_vpi_value vp, int)
+static vpiHandle sysfunc_put_value(struct __vpiSysTaskCall*rfp, p_vpi_value vp, int)
 {
-      struct __vpiSysTaskCall*rfp = dynamic_cast<__vpiSysTaskCall*>(ref);
-      assert(rfp);
-
       rfp->put_value = true;
 
       assert(rfp->vbit >= 4);
@@ -169,6 +158,13 @@ static vpiHandle sysfunc_put_value(vpiHandle ref, p_vpi_value vp, int)
 
 	  case vpiIntVal: {
 		long val = vp->value.integer;
+		  // The common case is a result that fits in a machine
+		  // word, so write it as a word and skip the bit loop.
+		if (rfp->vwid <= 64) {
+		      vthread_put_word(vpip_current_vthread, rfp->vbit,
+				       rfp->vwid, (uint64_t)(int64_t)val);
+		      break;
+		}
 		for (int idx = 0 ;  idx < rfp->vwid ;  idx += 1) {
 		      vthread_put_bit(vpip_current_vthread,
 				      rfp->vbit+idx, (val&1)? BIT4_1 :BIT4_0);
@@ -178,6 +174,13 @@ static vpiHandle sysfunc_put_value(vpiHandle ref, p_vpi_value vp, int)
 	  }
 
 	  case vpiTimeVal:
+		if (rfp->vwid <= 64) {
+		      uint64_t val = (uint32_t)vp->value.time->high;
+		      val = (val << 32) | (uint32_t)vp->value.time->low;
+		      vthread_put_word(vpip_current_vthread, rfp->vbit,
+				       rfp->vwid, val);
+		      break;
+		}
 		for (int idx = 0 ;  idx < rfp->vwid ;  idx += 1) {
 		      PLI_INT32 word;
 		      if (idx >= 32)
@@ -285,10 +288,8 @@ static vpiHandle sysfunc_put_value(vpiHandle ref, p_vpi_value vp, int)
       return 0;
 }
 
-static vpiHandle sysfunc_put_4net_value(vpiHandle ref, p_vpi_value vp, int)
+static vpiHandle sysfunc_put_4net_value(struct __vpiSysTaskCall*rfp, p_vpi_value vp, int)
 {
-      struct __vpiSysTaskCall*rfp = dynamic_cast<__vpiSysTaskCall*>(ref);
-
       rfp->put_value = true;
 
       unsigned vwid = (unsigned) rfp->vwid;
@@ -388,10 +389,8 @@ static vpiHandle sysfunc_put_4net_value(vpiHandle ref, p_vpi_value vp, int)
       return 0;
 }
 
-static vpiHandle sysfunc_put_rnet_value(vpiHandle ref, p_vpi_value vp, int)
+static vpiHandle sysfunc_put_rnet_value(struct __vpiSysTaskCall*rfp, p_vpi_value vp, int)
 {
-      struct __vpiSysTaskCall*rfp = dynamic_cast<__vpiSysTaskCall*>(ref);
-
       rfp->put_value = true;
 
       double val;
@@ -717,6 +716,95 @@ static void cleanup_vpi_call_args(unsigned argc, vpiHandle*argv)
 }
 #endif
 
+/*
+ * These are the intrinsics, native implementations of some of the
+ * system functions in the standard system.vpi module. A call to an
+ * intrinsic does not go through the VPI at all: there is no calltf,
+ * no mode switch and no vpi_put_value of the result. The intrinsic
+ * writes the result directly into the thread, so it must give
+ * exactly the result that the VPI implementation would give.
+ */
+static const uint64_t intrinsic_pow10[] = {
+      1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+      10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+      100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+      100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+      100000000000000000ULL, 1000000000000000000ULL
+};
+
+/*
+ * $time, $stime and $simtime return the simulation time in the units
+ * of the module (or the precision, for $simtime), rounded to the
+ * nearest unit. This matches sys_time_calltf in sys_time.c.
+ */
+static void intrinsic_time(vthread_t thr, struct __vpiSysTaskCall*obj)
+{
+      uint64_t now = schedule_simtime();
+      int shift = obj->intrinsic_units - vpip_get_time_precision();
+      if (shift > 0) {
+	    uint64_t scale = intrinsic_pow10[shift];
+	    uint64_t frac = now % scale;
+	    now /= scale;
+	    if (frac >= scale/2)
+		  now += 1;
+      }
+
+      vthread_put_word(thr, obj->vbit, obj->vwid, now);
+}
+
+static void intrinsic_realtime(vthread_t thr, struct __vpiSysTaskCall*obj)
+{
+      double val = (double) schedule_simtime();
+      int scale = vpip_get_time_precision() - obj->intrinsic_units;
+      if (scale >= 0) val *= pow(10.0, scale);
+      else val /= pow(10.0, -scale);
+
+      vthread_push_real(thr, val);
+}
+
+/*
+ * Attach an intrinsic to the call if the call is to a system defined
+ * function that has one. Only calls with the result in the thread are
+ * candidates. A function defined by a user VPI module (even one that
+ * has the same name) is always called through the VPI. The random
+ * number intrinsics are in vpi_random.cc.
+ */
+static void attach_intrinsic(struct __vpiSysTaskCall*obj)
+{
+      if (obj->defn->is_user_defn) return;
+      if (vpip_attach_random_intrinsic(obj)) return;
+      if (obj->defn->info.type != vpiSysFunc) return;
+      if (obj->nargs != 0 || obj->fnet != 0) return;
+
+      const char*name = obj->defn->info.tfname;
+      bool time_func = strcmp(name, "$time") == 0
+	    || strcmp(name, "$stime") == 0
+	    || strcmp(name, "$simtime") == 0;
+      bool real_func = strcmp(name, "$realtime") == 0;
+      if (! (time_func || real_func)) return;
+
+	/* The time functions use the units of the containing module. */
+      struct __vpiScope*mod = obj->scope;
+      while (mod && mod->get_type_code() != vpiModule)
+	    mod = mod->scope;
+      if (mod == 0) return;
+
+      if (time_func && obj->vwid > 0 && obj->vwid <= 64) {
+	    if (strcmp(name, "$simtime") == 0)
+		  obj->intrinsic_units = vpip_get_time_precision();
+	    else
+		  obj->intrinsic_units = mod->time_units;
+	    int shift = obj->intrinsic_units - vpip_get_time_precision();
+	    if (shift >= (int)(sizeof intrinsic_pow10/sizeof intrinsic_pow10[0]))
+		  return;
+	    obj->intrinsic = &intrinsic_time;
+
+      } else if (real_func && obj->vwid == -vpiRealConst) {
+	    obj->intrinsic_units = mod->time_units;
+	    obj->intrinsic = &intrinsic_realtime;
+      }
+}
+
 /*
  * A vpi_call is actually built up into a vpiSysTaskCall VPI object
  * that refers back to the vpiUserSystf VPI object that is the
@@ -826,6 +914,7 @@ vpiHandle vpip_build_vpi_call(const char*name, unsigned vbit, int vwid,
       obj->put_value = false;
 
       compile_compiletf(obj);
+      attach_intrinsic(obj);
 
       return obj;
 }
@@ -873,6 +962,7 @@ void vpi_call_delete(vpiHandle item)
 	    }
       }
       free(obj->args);
+      free(obj->intrinsic_data);
       delete obj;
 }
 #endif
@@ -881,28 +971,43 @@ void vpi_call_delete(vpiHandle item)
  * This function is used by the %vpi_call instruction to actually
  * place the call to the system task/function. For now, only support
  * calls to system tasks.
+ *
+ * The handle is always one that vpip_build_vpi_call made, so it is
+ * known to be a __vpiSysTaskCall and a static_cast is enough. This is
+ * on the path of every system task call, so it avoids RTTI.
  */
 
 vthread_t vpip_current_vthread;
 
 void vpip_execute_vpi_call(vthread_t thr, vpiHandle ref)
 {
+      struct __vpiSysTaskCall*obj = static_cast<__vpiSysTaskCall*>(ref);
+
       vpip_current_vthread = thr;
 
-      vpip_cur_task = dynamic_cast<__vpiSysTaskCall*>(ref);
+	/* An intrinsic writes its result directly to the thread. */
+      if (obj->intrinsic) {
+	    obj->intrinsic(thr, obj);
+	    if (obj->real_stack > 0)
+		  vthread_pop_real(thr, obj->real_stack);
+	    if (obj->string_stack > 0)
+		  vthread_pop_str(thr, obj->string_stack);
+	    return;
+      }
+
+      vpip_cur_task = obj;
 
-      if (vpip_cur_task->defn->info.calltf) {
+      if (obj->defn->info.calltf) {
 	    assert(vpi_mode_flag == VPI_MODE_NONE);
 	    vpi_mode_flag = VPI_MODE_CALLTF;
-	    vpip_cur_task->put_value = false;
-	    vpip_cur_task->defn->info.calltf(vpip_cur_task->defn->info.user_data);
+	    obj->put_value = false;
+	    obj->defn->info.calltf(obj->defn->info.user_data);
 	    vpi_mode_flag = VPI_MODE_NONE;
 	      /* If the function call did not set a value then put a
 	       * default value (0). */
-	    if (ref->get_type_code() == vpiSysFuncCall &&
-	        !vpip_cur_task->put_value) {
+	    if (obj->defn->info.type == vpiSysFunc && !obj->put_value) {
 		  s_vpi_value val;
-		  if (vpip_cur_task->vwid == -vpiRealConst) {
+		  if (obj->vwid == -vpiRealConst) {
 			val.format = vpiRealVal;
 			val.value.real = 0.0;
 		  } else {
@@ -912,14 +1017,16 @@ void vpip_execute_vpi_call(vthread_t thr, vpiHandle ref)
 		  vpi_put_value(ref, &val, 0, vpiNoDelay);
 	    }
       }
-      if (vpip_cur_task->real_stack > 0)
-	    vthread_pop_real(thr, vpip_cur_task->real_stack);
-      if (vpip_cur_task->string_stack > 0)
-	    vthread_pop_str(thr, vpip_cur_task->string_stack);
+      if (obj->real_stack > 0)
+	    vthread_pop_real(thr, obj->real_stack);
+      if (obj->string_stack > 0)
+	    vthread_pop_str(thr, obj->string_stack);
 
 	/* If the function has a real value, then push the value
-	   to the thread stack. */
-      if (sysfunc_real*func_real = dynamic_cast<sysfunc_real*>(ref)) {
+	   to the thread stack. Only the sysfunc_real calls have a
+	   real result and no functor output. */
+      if (obj->vwid == -vpiRealConst && obj->fnet == 0) {
+	    sysfunc_real*func_real = static_cast<sysfunc_real*>(obj);
 	    vthread_push_real(thr, func_real->return_value_);
       }
 }
@@ -28,9 +28,11 @@
 # include  "vvp_cobject.h"
 # include  "vvp_darray.h"
 # include  "class_type.h"
+# include  "checkpoint.h"
 #ifdef CHECK_WITH_VALGRIND
 # include  "vvp_cleanup.h"
 #endif
+# include  <map>
 # include  <set>
 # include  <typeinfo>
 # include  <vector>
@@ -58,22 +60,33 @@ using namespace std;
  *
  * ** Notes On The Interactions of %fork/%join/%end:
  *
- * The %fork instruction creates a new thread and pushes that into a
- * set of children for the thread. This new thread, then, becomes a
+ * The %fork instruction creates a new thread and pushes that into the
+ * list of children for the thread. This new thread, then, becomes a
  * child of the current thread, and the current thread a parent of the
- * new thread. Any child can be reaped by a %join.
+ * new thread. Any child can be reaped by a %join. The child lists are
+ * intrusive: a thread is linked into its parent's list through its
+ * own sib_next/sib_pprev members, so adding and removing children
+ * does not allocate.
  *
  * Children that are detached with %join/detach need to have a different
  * parent/child relationship since the parent can still effect them if
  * it uses the %disable/fork or %wait/fork opcodes. The i_am_detached
- * flag and detached_children set are used for this relationship.
+ * flag and detached_children list are used for this relationship.
  *
  * Children placed into a task or function scope are given special
  * treatment, which is required to make task/function calls that they
- * represent work correctly. These task/function children are copied
- * into a task_func_children set to mark them for this handling. %join
- * operations will guarantee that task/function threads are joined first,
- * before any non-task/function threads.
+ * represent work correctly. There is at most one such child, and it is
+ * remembered in the task_func_child pointer. %join operations will
+ * guarantee that the task/function thread is joined first, before any
+ * non-task/function threads.
+ *
+ * Simple functions can also be invoked with %call, which does not
+ * create a thread at all. The caller saves its bits and index
+ * registers in a call frame, jumps to the function code and resumes
+ * at the instruction after the %call when the function executes its
+ * %end. The code generator only uses %call for static functions that
+ * cannot be disabled or fork, so the function never needs its own
+ * thread identity.
  *
  * It is a programming error for a thread that created threads to not
  * %join (or %join/detach) as many as it created before it %ends. The
@@ -214,15 +227,22 @@ struct vthread_s {
       unsigned is_scheduled      :1;
       unsigned delay_delete      :1;
 	/* This points to the children of the thread. */
-      set<struct vthread_s*>children;
+      struct vthread_s*children;
 	/* This points to the detached children of the thread. */
-      set<struct vthread_s*>detached_children;
+      struct vthread_s*detached_children;
 	/* No more than 1 of the children are tasks or functions. */
-      set<vthread_s*>task_func_children;
+      struct vthread_s*task_func_child;
+	/* These link me into my parent's children or
+	   detached_children list. */
+      struct vthread_s*sib_next;
+      struct vthread_s**sib_pprev;
 	/* This points to my parent, if I have one. */
       struct vthread_s*parent;
 	/* This points to the containing scope. */
       struct __vpiScope*parent_scope;
+	/* These link me into the thread list of the parent_scope. */
+      struct vthread_s*scope_next;
+      struct vthread_s**scope_pprev;
 	/* This is used for keeping wait queues. */
       struct vthread_s*wait_next;
 	/* These are used to access automatically allocated items. */
@@ -231,18 +251,78 @@ struct vthread_s {
       vvp_net_t*event;
       uint64_t ecount;
 
+	/* Frames saved by %call. The frames are kept (and their
+	   vectors reused) after the call returns, so call_depth_ is
+	   the number of frames in use. */
+      struct call_frame_s {
+	    vvp_code_t ret_pc;
+	    vvp_vector4_t bits4;
+	    union {
+		  int64_t  w_int;
+		  uint64_t w_uint;
+	    } words[16];
+      };
+      vector<call_frame_s> call_stack_;
+      unsigned call_depth_;
+
       inline void cleanup()
       {
-	    bits4 = vvp_vector4_t();
 	    assert(stack_real_.empty());
 	    assert(stack_str_.empty());
 	    assert(stack_obj_size_ == 0);
+	    assert(call_depth_ == 0);
       }
+
+	/* Save and restore the registers, stacks and call frames
+	   (see vthread_checkpoint_save). */
+      void checkpoint_save(checkpoint_out&out) const;
+      void checkpoint_restore(checkpoint_in&in);
 };
 
 inline vthread_s::vthread_s()
 {
       stack_obj_size_ = 0;
+      call_depth_ = 0;
+}
+
+/*
+ * Helpers for the intrusive thread lists. A thread is in at most one
+ * child list (children or detached_children of its parent) and at
+ * most one scope list at a time.
+ */
+static inline void sib_insert(vthread_t&head, vthread_t thr)
+{
+      assert(thr->sib_pprev == 0);
+      thr->sib_next = head;
+      if (head) head->sib_pprev = &thr->sib_next;
+      thr->sib_pprev = &head;
+      head = thr;
+}
+
+static inline void sib_remove(vthread_t thr)
+{
+      assert(thr->sib_pprev);
+      *thr->sib_pprev = thr->sib_next;
+      if (thr->sib_next) thr->sib_next->sib_pprev = thr->sib_pprev;
+      thr->sib_next = 0;
+      thr->sib_pprev = 0;
+}
+
+static inline void scope_insert(struct __vpiScope*scope, vthread_t thr)
+{
+      thr->scope_next = scope->threads;
+      if (scope->threads) scope->threads->scope_pprev = &thr->scope_next;
+      thr->scope_pprev = &scope->threads;
+      scope->threads = thr;
+}
+
+static inline void scope_remove(vthread_t thr)
+{
+      if (thr->scope_pprev == 0) return;
+      *thr->scope_pprev = thr->scope_next;
+      if (thr->scope_next) thr->scope_next->scope_pprev = thr->scope_pprev;
+      thr->scope_next = 0;
+      thr->scope_pprev = 0;
 }
 
 static bool test_joinable(vthread_t thr, vthread_t child);
@@ -255,6 +335,11 @@ struct __vpiScope* vthread_scope(struct vthread_s*thr)
 
 struct vthread_s*running_thread = 0;
 
+unsigned long count_vthreads = 0;
+unsigned long count_vthread_allocs = 0;
+unsigned long count_vthread_calls = 0;
+unsigned long count_vthread_instructions = 0;
+
 // this table maps the thread special index bit addresses to
 // vvp_bit4_t bit values.
 static vvp_bit4_t thr_index_to_bit4[4] = { BIT4_0, BIT4_1, BIT4_X, BIT4_Z };
@@ -295,6 +380,24 @@ void vthread_put_bit(struct vthread_s*thr, unsigned addr, vvp_bit4_t bit)
       thr_put_bit(thr, addr, bit);
 }
 
+void vthread_put_word(struct vthread_s*thr, unsigned addr, unsigned wid,
+		      uint64_t val)
+{
+      const unsigned bits_per_word = 8*sizeof(unsigned long);
+
+      assert(wid > 0);
+      thr_check_addr(thr, addr+wid-1);
+      for (unsigned idx = 0 ; idx < wid ; idx += bits_per_word) {
+	    unsigned cnt = wid - idx;
+	    if (cnt > bits_per_word)
+		  cnt = bits_per_word;
+	    thr->bits4.set_word(addr+idx, cnt, (unsigned long)val);
+	      // Shift in two steps, as a shift by the full width of
+	      // the value is undefined.
+	    val = (val >> (bits_per_word-1)) >> 1;
+      }
+}
+
 void vthread_push_real(struct vthread_s*thr, double val)
 {
       thr->push_real(val);
@@ -463,6 +566,66 @@ static void multiply_array_imm(unsigned long*res, unsigned long*val,
       }
 }
 
+/*
+ * The items of an automatic scope whose state is plain data (see
+ * automatic_hooks_s::image_size) have that state laid out after the
+ * item pointers in the context block, and the initial state of all
+ * of them is kept in an image. A new or recycled context is then
+ * initialized by copying the image. Only the remaining items need
+ * their alloc_instance/reset_instance methods called.
+ */
+struct context_layout_s {
+      size_t block_size;
+      size_t image_off;
+      size_t image_size;
+      char*image;
+	// The items in the image, and their offsets in the image.
+      std::vector<unsigned> image_items;
+      std::vector<size_t> image_offs;
+	// The items that manage their own state.
+      std::vector<unsigned> hook_items;
+};
+
+static size_t context_align(size_t off)
+{
+      const size_t align = sizeof(double) > sizeof(void*)? sizeof(double) : sizeof(void*);
+      return (off + align - 1) & ~(align - 1);
+}
+
+static struct context_layout_s* context_layout(struct __vpiScope*scope)
+{
+      if (scope->context_layout)
+	    return scope->context_layout;
+
+      context_layout_s*lay = new context_layout_s;
+      lay->image_off = context_align((2 + scope->nitem) * sizeof(void*));
+      lay->image_size = 0;
+
+      for (unsigned idx = 0 ; idx < scope->nitem ; idx += 1) {
+	    size_t size = scope->item[idx]->image_size();
+	    if (size == 0) {
+		  lay->hook_items.push_back(idx);
+		  continue;
+	    }
+	    lay->image_items.push_back(idx);
+	    lay->image_offs.push_back(lay->image_size);
+	    lay->image_size += context_align(size);
+      }
+
+      lay->image = 0;
+      if (lay->image_size) {
+	    lay->image = new char[lay->image_size];
+	    for (size_t idx = 0 ; idx < lay->image_items.size() ; idx += 1) {
+		  automatic_hooks_s*item = scope->item[lay->image_items[idx]];
+		  item->init_image(lay->image + lay->image_offs[idx]);
+	    }
+      }
+
+      lay->block_size = lay->image_off + lay->image_size;
+      scope->context_layout = lay;
+      return lay;
+}
+
 /*
  * Allocate a context for use by a child thread. By preference, use
  * the last freed context. If none available, create a new one. Add
@@ -472,16 +635,25 @@ static vvp_context_t vthread_alloc_context(struct __vpiScope*scope)
 {
       assert(scope->is_automatic);
 
+      context_layout_s*lay = context_layout(scope);
+
       vvp_context_t context = scope->free_contexts;
       if (context) {
             scope->free_contexts = vvp_get_next_context(context);
-            for (unsigned idx = 0 ; idx < scope->nitem ; idx += 1) {
-                  scope->item[idx]->reset_instance(context);
+	    memcpy((char*)context + lay->image_off, lay->image, lay->image_size);
+            for (size_t idx = 0 ; idx < lay->hook_items.size() ; idx += 1) {
+                  scope->item[lay->hook_items[idx]]->reset_instance(context);
             }
       } else {
-            context = vvp_allocate_context(scope->nitem);
-            for (unsigned idx = 0 ; idx < scope->nitem ; idx += 1) {
-                  scope->item[idx]->alloc_instance(context);
+            context = (vvp_context_t)malloc(lay->block_size);
+	    char*image = (char*)context + lay->image_off;
+	    memcpy(image, lay->image, lay->image_size);
+	    for (size_t idx = 0 ; idx < lay->image_items.size() ; idx += 1) {
+		  vvp_set_context_item(context, 2 + lay->image_items[idx],
+				       image + lay->image_offs[idx]);
+	    }
+            for (size_t idx = 0 ; idx < lay->hook_items.size() ; idx += 1) {
+                  scope->item[lay->hook_items[idx]]->alloc_instance(context);
             }
       }
 
@@ -520,27 +692,56 @@ static void vthread_free_context(vvp_context_t context, struct __vpiScope*scope)
 void contexts_delete(struct __vpiScope*scope)
 {
       vvp_context_t context = scope->free_contexts;
+      context_layout_s*lay = scope->context_layout;
 
       while (context) {
 	    scope->free_contexts = vvp_get_next_context(context);
-	    for (unsigned idx = 0; idx < scope->nitem; idx += 1) {
-		  scope->item[idx]->free_instance(context);
+	    assert(lay);
+	    for (size_t idx = 0; idx < lay->hook_items.size(); idx += 1) {
+		  scope->item[lay->hook_items[idx]]->free_instance(context);
 	    }
 	    free(context);
 	    context = scope->free_contexts;
       }
+      if (lay) {
+	    delete[] lay->image;
+	    delete lay;
+	    scope->context_layout = 0;
+      }
       free(scope->item);
 }
 #endif
 
+/*
+ * Threads that have been deleted are kept in a free list (chained
+ * through wait_next) and reused by vthread_new. Most threads are
+ * short lived task and function calls, so this saves the heap traffic
+ * of the thread object and lets the recycled thread keep the storage
+ * of its stacks.
+ */
+static vthread_t vthread_free_list = 0;
+
 /*
  * Create a new thread with the given start address.
  */
 vthread_t vthread_new(vvp_code_t pc, struct __vpiScope*scope)
 {
-      vthread_t thr = new struct vthread_s;
+      vthread_t thr = vthread_free_list;
+      if (thr) {
+	    vthread_free_list = thr->wait_next;
+      } else {
+	    thr = new struct vthread_s;
+	    count_vthread_allocs += 1;
+      }
+      count_vthreads += 1;
+
       thr->pc     = pc;
       thr->bits4  = vvp_vector4_t(32);
+      thr->children = 0;
+      thr->detached_children = 0;
+      thr->task_func_child = 0;
+      thr->sib_next = 0;
+      thr->sib_pprev = 0;
       thr->parent = 0;
       thr->parent_scope = scope;
       thr->wait_next = 0;
@@ -562,7 +763,7 @@ vthread_t vthread_new(vvp_code_t pc, struct __vpiScope*scope)
       thr_put_bit(thr, 2, BIT4_X);
       thr_put_bit(thr, 3, BIT4_Z);
 
-      scope->threads .insert(thr);
+      scope_insert(scope, thr);
       return thr;
 }
 
@@ -596,11 +797,20 @@ static void child_delete(vthread_t base)
 
 void vthreads_delete(struct __vpiScope*scope)
 {
-      for (std::set<vthread_t>::iterator cur = scope->threads.begin()
-		 ; cur != scope->threads.end() ; ++ cur ) {
-	    delete *cur;
+      while (scope->threads) {
+	    vthread_t thr = scope->threads;
+	    scope_remove(thr);
+	    delete thr;
+      }
+}
+
+void vthread_pool_delete(void)
+{
+      while (vthread_free_list) {
+	    vthread_t thr = vthread_free_list;
+	    vthread_free_list = thr->wait_next;
+	    delete thr;
       }
-      scope->threads.clear();
 }
 #endif
 
@@ -610,41 +820,37 @@ void vthreads_delete(struct __vpiScope*scope)
  */
 static void vthread_reap(vthread_t thr)
 {
-      if (! thr->children.empty()) {
-	    for (set<vthread_t>::iterator cur = thr->children.begin()
-		       ; cur != thr->children.end() ; ++cur) {
-		  vthread_t child = *cur;
-		  assert(child);
-		  assert(child->parent == thr);
-		  child->parent = thr->parent;
-	    }
+      for (vthread_t child = thr->children ; child ; child = child->sib_next) {
+	    assert(child->parent == thr);
+	    child->parent = thr->parent;
       }
-      if (! thr->detached_children.empty()) {
-	    for (set<vthread_t>::iterator cur = thr->detached_children.begin()
-		       ; cur != thr->detached_children.end() ; ++cur) {
-		  vthread_t child = *cur;
-		  assert(child);
-		  assert(child->parent == thr);
-		  assert(child->i_am_detached);
-		  child->parent = 0;
-		  child->i_am_detached = 0;
-	    }
+      while (vthread_t child = thr->detached_children) {
+	    assert(child->parent == thr);
+	    assert(child->i_am_detached);
+	    sib_remove(child);
+	    child->parent = 0;
+	    child->i_am_detached = 0;
       }
       if (thr->parent) {
-	      /* assert that the given element was removed. */
-	    if (thr->i_am_detached) {
-		  size_t res = thr->parent->detached_children.erase(thr);
-		  assert(res == 1);
-	    } else {
-		  size_t res = thr->parent->children.erase(thr);
-		  assert(res == 1);
+	      /* Remove myself from the parent's list. The remaining
+		 (non-detached) children were handed to my parent above,
+		 so move them to the parent's list as well. */
+	    if (! thr->i_am_detached && thr->parent->task_func_child == thr)
+		  thr->parent->task_func_child = 0;
+	    sib_remove(thr);
+	    while (vthread_t child = thr->children) {
+		  sib_remove(child);
+		  sib_insert(thr->parent->children, child);
 	    }
+      } else {
+	    while (vthread_t child = thr->children)
+		  sib_remove(child);
       }
 
       thr->parent = 0;
 
 	// Remove myself from the containing scope if needed.
-      thr->parent_scope->threads.erase(thr);
+      scope_remove(thr);
 
       thr->pc = codespace_null();
 
@@ -652,7 +858,7 @@ static void vthread_reap(vthread_t thr)
 	   it now. Otherwise, let the schedule event (which will
 	   execute the thread at of_ZOMBIE) delete the object. */
       if ((thr->is_scheduled == 0) && (thr->waiting_for_event == 0)) {
-	    assert(thr->children.empty());
+	    assert(thr->children == 0);
 	    assert(thr->wait_next == 0);
 	    if (thr->delay_delete)
 		  schedule_del_thr(thr);
@@ -664,7 +870,8 @@ static void vthread_reap(vthread_t thr)
 void vthread_delete(vthread_t thr)
 {
       thr->cleanup();
-      delete thr;
+      thr->wait_next = vthread_free_list;
+      vthread_free_list = thr;
 }
 
 void vthread_mark_scheduled(vthread_t thr)
@@ -682,6 +889,453 @@ void vthread_delay_delete()
 	    running_thread->delay_delete = 1;
 }
 
+/*
+ * A checkpoint is taken between time steps, so every thread is
+ * suspended. A thread is scheduled (its event is saved with the
+ * event queue), waiting for an event, joining its children, waiting
+ * for its detached children or ended and waiting to be joined. The
+ * threads are numbered (from 1) in the order of the scope walk, and
+ * the parent/child links, the wait lists and the scheduled events
+ * refer to threads by number.
+ *
+ * The live contexts of the automatic scopes are numbered (from 1)
+ * in the same way, and the threads refer to their write and read
+ * contexts by number. The object stack is not saved, so a thread
+ * that holds objects prevents the checkpoint.
+ */
+static vector<vthread_t> checkpoint_threads;
+static map<vthread_t,unsigned long> checkpoint_thread_ids;
+static vector<vvp_context_t> checkpoint_contexts;
+static map<vvp_context_t,unsigned long> checkpoint_context_ids;
+
+static unsigned long checkpoint_context_id(vvp_context_t context)
+{
+      map<vvp_context_t,unsigned long>::const_iterator cur = checkpoint_context_ids.find(context);
+      if (cur == checkpoint_context_ids.end())
+	    return 0;
+      return cur->second;
+}
+
+static vvp_context_t checkpoint_context(unsigned long id)
+{
+      if (id == 0 || id > checkpoint_contexts.size())
+	    return 0;
+      return checkpoint_contexts[id-1];
+}
+
+/*
+ * Each scope lists its live contexts most recent first, and
+ * vthread_alloc_context puts a new context at the head of the list,
+ * so save them last to first. The restore then rebuilds the lists in
+ * the same order.
+ */
+static void checkpoint_save_contexts(checkpoint_out&out,
+				     const vector<struct __vpiScope*>&scopes)
+{
+      checkpoint_contexts.clear();
+      checkpoint_context_ids.clear();
+
+      vector<unsigned long> context_scope;
+      for (size_t idx = 0 ; idx < scopes.size() ; idx += 1) {
+	    if (! scopes[idx]->is_automatic)
+		  continue;
+	    vector<vvp_context_t> live;
+	    for (vvp_context_t cur = scopes[idx]->live_contexts ; cur
+		       ; cur = vvp_get_next_context(cur))
+		  live.push_back(cur);
+	    for (size_t cdx = live.size() ; cdx > 0 ; cdx -= 1) {
+		  checkpoint_contexts.push_back(live[cdx-1]);
+		  checkpoint_context_ids[live[cdx-1]] = checkpoint_contexts.size();
+		  context_scope.push_back(idx);
+	    }
+      }
+
+      out.put_uint(checkpoint_contexts.size());
+      for (size_t idx = 0 ; idx < checkpoint_contexts.size() ; idx += 1) {
+	    vvp_context_t context = checkpoint_contexts[idx];
+	    struct __vpiScope*scope = scopes[context_scope[idx]];
+
+	      /* A context that is not on a thread stack may have a
+		 stale stacked link, which is never followed, so only
+		 links to live contexts are kept. */
+	    out.put_uint(context_scope[idx]+1);
+	    out.put_uint(checkpoint_context_id(vvp_get_stacked_context(context)));
+	    for (unsigned item = 0 ; item < scope->nitem ; item += 1)
+		  scope->item[item]->checkpoint_save(context, out);
+	    if (! out.ok())
+		  return;
+      }
+}
+
+static void checkpoint_restore_contexts(checkpoint_in&in)
+{
+      checkpoint_contexts.clear();
+      checkpoint_context_ids.clear();
+
+	/* The stacked context may be numbered after this one, so link
+	   the contexts once they all exist. */
+      uint64_t count = in.get_uint();
+      vector<unsigned long> stacked;
+      for (uint64_t idx = 0 ; idx < count && in.ok() ; idx += 1) {
+	    struct __vpiScope*scope = checkpoint_scope(in.get_uint());
+	    if (scope == 0 || ! scope->is_automatic) {
+		  in.corrupt("a context does not match the design");
+		  return;
+	    }
+
+	    vvp_context_t context = vthread_alloc_context(scope);
+	    checkpoint_contexts.push_back(context);
+	    checkpoint_context_ids[context] = checkpoint_contexts.size();
+	    stacked.push_back(in.get_uint());
+	    for (unsigned item = 0 ; item < scope->nitem && in.ok() ; item += 1)
+		  scope->item[item]->checkpoint_restore(context, in);
+      }
+
+      for (size_t idx = 0 ; idx < stacked.size() && in.ok() ; idx += 1) {
+	    vvp_context_t context = checkpoint_context(stacked[idx]);
+	    if (stacked[idx] && context == 0) {
+		  in.corrupt("a context does not match the design");
+		  return;
+	    }
+	    vvp_set_stacked_context(checkpoint_contexts[idx], context);
+      }
+}
+
+unsigned long vthread_checkpoint_id(vthread_t thr)
+{
+      map<vthread_t,unsigned long>::const_iterator cur = checkpoint_thread_ids.find(thr);
+      if (cur == checkpoint_thread_ids.end())
+	    return 0;
+      return cur->second;
+}
+
+vthread_t vthread_checkpoint_thread(unsigned long id)
+{
+      if (id == 0 || id > checkpoint_threads.size())
+	    return 0;
+      return checkpoint_threads[id-1];
+}
+
+void vthread_s::checkpoint_save(checkpoint_out&out) const
+{
+      if (stack_obj_size_ > 0) {
+	    out.refuse("a thread in scope %s holds class objects",
+		       parent_scope->vpi_get_str(vpiFullName));
+	    return;
+      }
+
+      out.put_vec4(bits4);
+      for (unsigned idx = 0 ; idx < 16 ; idx += 1)
+	    out.put_uint(words[idx].w_uint);
+
+      out.put_uint(stack_real_.size());
+      for (size_t idx = 0 ; idx < stack_real_.size() ; idx += 1)
+	    out.put_real(stack_real_[idx]);
+
+      out.put_uint(stack_str_.size());
+      for (size_t idx = 0 ; idx < stack_str_.size() ; idx += 1)
+	    out.put_str(stack_str_[idx]);
+
+      out.put_uint(call_depth_);
+      for (unsigned idx = 0 ; idx < call_depth_ ; idx += 1) {
+	    const call_frame_s&frame = call_stack_[idx];
+	    out.put_uint(codespace_index(frame.ret_pc));
+	    out.put_vec4(frame.bits4);
+	    for (unsigned wdx = 0 ; wdx < 16 ; wdx += 1)
+		  out.put_uint(frame.words[wdx].w_uint);
+      }
+}
+
+void vthread_s::checkpoint_restore(checkpoint_in&in)
+{
+      bits4 = in.get_vec4();
+      for (unsigned idx = 0 ; idx < 16 ; idx += 1)
+	    words[idx].w_uint = in.get_uint();
+
+      uint64_t count = in.get_uint();
+      for (uint64_t idx = 0 ; idx < count && in.ok() ; idx += 1)
+	    push_real(in.get_real());
+
+      count = in.get_uint();
+      for (uint64_t idx = 0 ; idx < count && in.ok() ; idx += 1)
+	    push_str(in.get_str());
+
+      count = in.get_uint();
+      if (count > 0x100000) {
+	    in.corrupt("a thread call stack is too deep");
+	    return;
+      }
+      call_stack_.resize(count);
+      for (unsigned idx = 0 ; idx < count && in.ok() ; idx += 1) {
+	    call_frame_s&frame = call_stack_[idx];
+	    frame.ret_pc = codespace_at(in.get_uint());
+	    frame.bits4 = in.get_vec4();
+	    for (unsigned wdx = 0 ; wdx < 16 ; wdx += 1)
+		  frame.words[wdx].w_uint = in.get_uint();
+	    if (frame.ret_pc == 0)
+		  in.corrupt("a thread does not match the design");
+	    else
+		  call_depth_ = idx+1;
+      }
+
+	/* Give a bad thread a clean stack, so that it can be
+	   deleted. */
+      if (! in.ok()) {
+	    stack_real_.clear();
+	    stack_str_.clear();
+	    call_depth_ = 0;
+      }
+}
+
+static void checkpoint_save_list(checkpoint_out&out, vthread_t list)
+{
+      unsigned long count = 0;
+      for (vthread_t cur = list ; cur ; cur = cur->sib_next)
+	    count += 1;
+
+      out.put_uint(count);
+      for (vthread_t cur = list ; cur ; cur = cur->sib_next)
+	    out.put_uint(vthread_checkpoint_id(cur));
+}
+
+void vthread_checkpoint_save(checkpoint_out&out,
+			     const vector<struct __vpiScope*>&scopes)
+{
+      checkpoint_save_contexts(out, scopes);
+      if (! out.ok())
+	    return;
+
+      checkpoint_threads.clear();
+      checkpoint_thread_ids.clear();
+
+      vector<unsigned long> thread_scope;
+      for (size_t idx = 0 ; idx < scopes.size() ; idx += 1) {
+	    for (vthread_t thr = scopes[idx]->threads ; thr ; thr = thr->scope_next) {
+		  checkpoint_threads.push_back(thr);
+		  checkpoint_thread_ids[thr] = checkpoint_threads.size();
+		  thread_scope.push_back(idx+1);
+	    }
+      }
+
+      out.put_uint(checkpoint_threads.size());
+      for (size_t idx = 0 ; idx < checkpoint_threads.size() ; idx += 1) {
+	    vthread_t thr = checkpoint_threads[idx];
+	    unsigned long wt_context = checkpoint_context_id(thr->wt_context);
+	    unsigned long rd_context = checkpoint_context_id(thr->rd_context);
+	    if ((thr->wt_context && wt_context == 0)
+		|| (thr->rd_context && rd_context == 0)) {
+		  out.refuse("a thread in scope %s uses a context that is not live",
+			     thr->parent_scope->vpi_get_str(vpiFullName));
+		  return;
+	    }
+
+	    unsigned flags = thr->i_am_joining
+		  | thr->i_am_detached << 1
+		  | thr->i_am_waiting  << 2
+		  | thr->i_have_ended  << 3
+		  | thr->delay_delete  << 4;
+
+	    out.put_uint(thread_scope[idx]);
+	    out.put_uint(codespace_index(thr->pc));
+	    out.put_uint(flags);
+	    out.put_uint(wt_context);
+	    out.put_uint(rd_context);
+	    out.put_uint(vthread_checkpoint_id(thr->task_func_child));
+	    checkpoint_save_list(out, thr->children);
+	    checkpoint_save_list(out, thr->detached_children);
+	    thr->checkpoint_save(out);
+	    if (! out.ok())
+		  return;
+      }
+
+	/* The threads that wait on an event are in a list in the
+	   event, most recent first, and are woken in that order. The
+	   list may also hold zombies (threads that were disabled
+	   while waiting) so find the head of each list by marking
+	   every thread that follows another. */
+      set<vthread_t> follows;
+      for (size_t idx = 0 ; idx < checkpoint_threads.size() ; idx += 1) {
+	    vthread_t thr = checkpoint_threads[idx];
+	    if (! thr->waiting_for_event)
+		  continue;
+	    for (vthread_t cur = thr->wait_next ; cur ; cur = cur->wait_next) {
+		  if (! follows.insert(cur).second)
+			break;
+	    }
+      }
+
+      vector< vector<unsigned long> > wait_lists;
+      for (size_t idx = 0 ; idx < checkpoint_threads.size() ; idx += 1) {
+	    vthread_t thr = checkpoint_threads[idx];
+	    if (! thr->waiting_for_event || follows.count(thr))
+		  continue;
+
+	    wait_lists.push_back(vector<unsigned long>());
+	    for (vthread_t cur = thr ; cur ; cur = cur->wait_next) {
+		  if (unsigned long id = vthread_checkpoint_id(cur))
+			wait_lists.back().push_back(id);
+	    }
+      }
+
+      out.put_uint(wait_lists.size());
+      for (size_t idx = 0 ; idx < wait_lists.size() ; idx += 1) {
+	    out.put_uint(wait_lists[idx].size());
+	    for (size_t wdx = 0 ; wdx < wait_lists[idx].size() ; wdx += 1)
+		  out.put_uint(wait_lists[idx][wdx]);
+      }
+}
+
+/*
+ * Before the restore, delete the threads that the compiler created
+ * for the initial and always statements, and free any contexts that
+ * they allocated. Their schedule events were already removed from
+ * the event queue.
+ */
+void vthread_checkpoint_discard(const vector<struct __vpiScope*>&scopes)
+{
+      for (size_t idx = 0 ; idx < scopes.size() ; idx += 1) {
+	    while (vthread_t thr = scopes[idx]->threads) {
+		  scope_remove(thr);
+		  thr->is_scheduled = 0;
+		  vthread_delete(thr);
+	    }
+      }
+
+      for (size_t idx = 0 ; idx < scopes.size() ; idx += 1) {
+	    while (vvp_context_t context = scopes[idx]->live_contexts)
+		  vthread_free_context(context, scopes[idx]);
+      }
+}
+
+void vthread_checkpoint_restore(checkpoint_in&in)
+{
+      checkpoint_restore_contexts(in);
+      if (! in.ok())
+	    return;
+
+      checkpoint_threads.clear();
+      checkpoint_thread_ids.clear();
+
+	/* The children may be numbered after their parent, so link
+	   the threads once they all exist. */
+      struct saved_links_s {
+	    unsigned long task_func_child;
+	    std::vector<unsigned long> lists[2];
+      };
+
+      uint64_t count = in.get_uint();
+      vector<saved_links_s> links;
+      for (uint64_t idx = 0 ; idx < count && in.ok() ; idx += 1) {
+	    struct __vpiScope*scope = checkpoint_scope(in.get_uint());
+	    unsigned long pc = in.get_uint();
+	    unsigned flags = in.get_uint();
+	    unsigned long wt_context = in.get_uint();
+	    unsigned long rd_context = in.get_uint();
+	    if (scope == 0 || codespace_at(pc) == 0
+		|| (wt_context && checkpoint_context(wt_context) == 0)
+		|| (rd_context && checkpoint_context(rd_context) == 0)) {
+		  in.corrupt("a thread does not match the design");
+		  return;
+	    }
+
+	    vthread_t thr = vthread_new(codespace_at(pc), scope);
+	    checkpoint_threads.push_back(thr);
+	    checkpoint_thread_ids[thr] = checkpoint_threads.size();
+	    thr->i_am_joining  = flags & 1;
+	    thr->i_am_detached = (flags >> 1) & 1;
+	    thr->i_am_waiting  = (flags >> 2) & 1;
+	    thr->i_have_ended  = (flags >> 3) & 1;
+	    thr->delay_delete  = (flags >> 4) & 1;
+	    thr->wt_context = checkpoint_context(wt_context);
+	    thr->rd_context = checkpoint_context(rd_context);
+
+	    links.push_back(saved_links_s());
+	    links.back().task_func_child = in.get_uint();
+	    for (unsigned list = 0 ; list < 2 ; list += 1) {
+		  uint64_t nchild = in.get_uint();
+		  for (uint64_t cdx = 0 ; cdx < nchild && in.ok() ; cdx += 1)
+			links.back().lists[list].push_back(in.get_uint());
+	    }
+	    thr->checkpoint_restore(in);
+      }
+
+      for (size_t idx = 0 ; idx < links.size() && in.ok() ; idx += 1) {
+	    vthread_t thr = checkpoint_threads[idx];
+	    for (unsigned list = 0 ; list < 2 ; list += 1) {
+		  vthread_t&head = list? thr->detached_children : thr->children;
+		  const vector<unsigned long>&ids = links[idx].lists[list];
+		    /* sib_insert puts the child at the head of the
+		       list, so insert the children last to first. */
+		  for (size_t cdx = ids.size() ; cdx > 0 ; cdx -= 1) {
+			vthread_t child = vthread_checkpoint_thread(ids[cdx-1]);
+			if (child == 0 || child->parent) {
+			      in.corrupt("a thread does not match the design");
+			      return;
+			}
+			child->parent = thr;
+			sib_insert(head, child);
+		  }
+	    }
+	    if (links[idx].task_func_child) {
+		  thr->task_func_child = vthread_checkpoint_thread(links[idx].task_func_child);
+		  if (thr->task_func_child == 0) {
+			in.corrupt("a thread does not match the design");
+			return;
+		  }
+	    }
+      }
+
+	/* vthread_new puts each thread at the head of its scope list,
+	   so the lists are now in reverse. Rebuild them in the saved
+	   order, so that a later checkpoint numbers them the same. */
+      for (size_t idx = checkpoint_threads.size() ; idx > 0 ; idx -= 1)
+	    scope_remove(checkpoint_threads[idx-1]);
+      for (size_t idx = checkpoint_threads.size() ; idx > 0 ; idx -= 1)
+	    scope_insert(checkpoint_threads[idx-1]->parent_scope,
+			 checkpoint_threads[idx-1]);
+
+	/* Put the waiting threads back on their events. Each list is
+	   saved head first, and add_waiting_thread puts the thread at
+	   the head, so add them last to first. Identical events are
+	   merged, so the threads of a list may be at different %wait
+	   instructions; find the event from the %wait of each thread.
+	   An automatic event keeps its list in the context of the
+	   thread, so the thread is the running thread while it is
+	   added. */
+      uint64_t nlists = in.get_uint();
+      for (uint64_t idx = 0 ; idx < nlists && in.ok() ; idx += 1) {
+	    vector<vthread_t> list (in.get_uint() & 0xfffff);
+	    for (size_t wdx = 0 ; wdx < list.size() && in.ok() ; wdx += 1) {
+		  list[wdx] = vthread_checkpoint_thread(in.get_uint());
+		  if (list[wdx] == 0 || list[wdx]->waiting_for_event) {
+			in.corrupt("a waiting thread does not match the design");
+			return;
+		  }
+	    }
+	    if (! in.ok())
+		  return;
+
+	    waitable_hooks_s*list_ep = 0;
+	    for (size_t wdx = list.size() ; wdx > 0 ; wdx -= 1) {
+		  vthread_t thr = list[wdx-1];
+		  vvp_code_t wait = codespace_at(codespace_index(thr->pc) - 1);
+		  waitable_hooks_s*ep = 0;
+		  if (wait && wait->opcode == &of_WAIT)
+			ep = dynamic_cast<waitable_hooks_s*> (wait->net->fun);
+		  if (ep == 0 || (list_ep && ep != list_ep)) {
+			in.corrupt("a waiting thread does not match the design");
+			return;
+		  }
+		  list_ep = ep;
+
+		  thr->waiting_for_event = 1;
+		  running_thread = thr;
+		  thr->wait_next = ep->add_waiting_thread(thr);
+		  running_thread = 0;
+	    }
+      }
+}
+
 /*
  * This function runs each thread by fetching an instruction,
  * incrementing the PC, and executing the instruction. The thread may
@@ -698,9 +1352,13 @@ void vthread_run(vthread_t thr)
 
             running_thread = thr;
 
+	      /* Count the instructions locally, and add the count to
+		 the statistics when the thread stops running. */
+	    unsigned long ninstr = 0;
 	    for (;;) {
 		  vvp_code_t cp = thr->pc;
 		  thr->pc += 1;
+		  ninstr += 1;
 
 		    /* Run the opcode implementation. If the execution of
 		       the opcode returns false, then the thread is meant to
@@ -709,6 +1367,7 @@ void vthread_run(vthread_t thr)
 		  if (rc == false)
 			break;
 	    }
+	    count_vthread_instructions += ninstr;
 
 	    thr = tmp;
       }
@@ -769,6 +1428,267 @@ vvp_context_item_t vthread_get_rd_context_item(unsigned context_idx)
       return vvp_get_context_item(running_thread->rd_context, context_idx);
 }
 
+/*
+ * The word-sized opcode variants. The generic vector arithmetic and
+ * compare opcodes replace themselves (the first time they are
+ * executed) with variants that work on a single machine word when
+ * the vector fits in one. These do the arithmetic directly on the
+ * thread bits with no temporary arrays. This is off by default, and
+ * the +word-ops extended argument turns it on. The +word-ops=check
+ * form instead replaces them with variants that run both the generic
+ * and the word implementation and compare the results. A mismatch is
+ * reported and the generic result is kept.
+ */
+bool vthread_word_ops = false;
+bool vthread_word_check = false;
+unsigned long count_word_opcodes = 0;
+unsigned long count_word_mismatches = 0;
+
+static bool of_CMPIS_the_hard_way(vthread_t thr, vvp_code_t cp);
+static bool of_CMPIU_the_hard_way(vthread_t thr, vvp_code_t cp);
+static bool of_CMPS_the_hard_way(vthread_t thr, vvp_code_t cp);
+bool of_CMPU_the_hard_way(vthread_t thr, vvp_code_t cp);
+
+static inline unsigned long word_op_mask(unsigned wid)
+{
+      return (wid < CPU_WORD_BITS)? (1UL << wid) - 1UL : -1UL;
+}
+
+/*
+ * Get a thread vector of wid <= CPU_WORD_BITS bits as a word. Return
+ * false if there are any X or Z bits.
+ */
+static inline bool word_op_get(vthread_t thr, unsigned adr, unsigned wid,
+				unsigned long&val)
+{
+      switch (adr) {
+	  case 0:
+	    val = 0;
+	    return true;
+	  case 1:
+	    val = word_op_mask(wid);
+	    return true;
+	  case 2:
+	  case 3:
+	    return false;
+	  default:
+	    thr_check_addr(thr, adr+wid-1);
+	    return thr->bits4.get_word(adr, wid, val);
+      }
+}
+
+static inline long word_op_signed(unsigned long val, unsigned wid)
+{
+      if (wid < CPU_WORD_BITS && (val >> (wid-1)) & 1UL)
+	    val |= -1UL << wid;
+      return (long)val;
+}
+
+static bool word_op_x_out(vthread_t thr, vvp_code_t cp)
+{
+      vvp_vector4_t tmp (cp->number, BIT4_X);
+      thr->bits4.set_vec(cp->bit_idx[0], tmp);
+      return true;
+}
+
+static bool of_ADD_word(vthread_t thr, vvp_code_t cp)
+{
+      unsigned wid = cp->number;
+      unsigned long lv, rv;
+      if (! word_op_get(thr, cp->bit_idx[0], wid, lv)
+	  || ! word_op_get(thr, cp->bit_idx[1], wid, rv))
+	    return word_op_x_out(thr, cp);
+
+      thr->bits4.set_word(cp->bit_idx[0], wid, lv + rv);
+      return true;
+}
+
+static bool of_ADDI_word(vthread_t thr, vvp_code_t cp)
+{
+      unsigned wid = cp->number;
+      unsigned long lv;
+      if (! word_op_get(thr, cp->bit_idx[0], wid, lv))
+	    return word_op_x_out(thr, cp);
+
+      thr->bits4.set_word(cp->bit_idx[0], wid, lv + cp->bit_idx[1]);
+      return true;
+}
+
+static bool of_SUB_word(vthread_t thr, vvp_code_t cp)
+{
+      unsigned wid = cp->number;
+      unsigned long lv, rv;
+      if (! word_op_get(thr, cp->bit_idx[0], wid, lv)
+	  || ! word_op_get(thr, cp->bit_idx[1], wid, rv))
+	    return word_op_x_out(thr, cp);
+
+      thr->bits4.set_word(cp->bit_idx[0], wid, lv - rv);
+      return true;
+}
+
+static bool of_SUBI_word(vthread_t thr, vvp_code_t cp)
+{
+      unsigned wid = cp->number;
+      unsigned long lv;
+      if (! word_op_get(thr, cp->bit_idx[0], wid, lv))
+	    return word_op_x_out(thr, cp);
+
+      thr->bits4.set_word(cp->bit_idx[0], wid, lv - cp->bit_idx[1]);
+      return true;
+}
+
+static bool of_MUL_word(vthread_t thr, vvp_code_t cp)
+{
+      unsigned wid = cp->number;
+      unsigned long lv, rv;
+      if (! word_op_get(thr, cp->bit_idx[0], wid, lv)
+	  || ! word_op_get(thr, cp->bit_idx[1], wid, rv))
+	    return word_op_x_out(thr, cp);
+
+      thr->bits4.set_word(cp->bit_idx[0], wid, lv * rv);
+      return true;
+}
+
+static bool of_MULI_word(vthread_t thr, vvp_code_t cp)
+{
+      unsigned wid = cp->number;
+      unsigned long lv;
+      if (! word_op_get(thr, cp->bit_idx[0], wid, lv))
+	    return word_op_x_out(thr, cp);
+
+      thr->bits4.set_word(cp->bit_idx[0], wid, lv * cp->bit_idx[1]);
+      return true;
+}
+
+static void word_op_flags(vthread_t thr, bool eq, bool lt)
+{
+      thr_put_bit(thr, 4, eq? BIT4_1 : BIT4_0);
+      thr_put_bit(thr, 5, lt? BIT4_1 : BIT4_0);
+      thr_put_bit(thr, 6, eq? BIT4_1 : BIT4_0);
+}
+
+static bool of_CMPU_word(vthread_t thr, vvp_code_t cp)
+{
+      unsigned wid = cp->number;
+      unsigned long lv, rv;
+      if (! word_op_get(thr, cp->bit_idx[0], wid, lv)
+	  || ! word_op_get(thr, cp->bit_idx[1], wid, rv))
+	    return of_CMPU_the_hard_way(thr, cp);
+
+      word_op_flags(thr, lv == rv, lv < rv);
+      return true;
+}
+
+static bool of_CMPS_word(vthread_t thr, vvp_code_t cp)
+{
+      unsigned wid = cp->number;
+      unsigned long lv, rv;
+      if (! word_op_get(thr, cp->bit_idx[0], wid, lv)
+	  || ! word_op_get(thr, cp->bit_idx[1], wid, rv))
+	    return of_CMPS_the_hard_way(thr, cp);
+
+      word_op_flags(thr, lv == rv, word_op_signed(lv, wid) < word_op_signed(rv, wid));
+      return true;
+}
+
+static bool of_CMPIU_word(vthread_t thr, vvp_code_t cp)
+{
+      unsigned wid = cp->number;
+      unsigned long lv, imm = cp->bit_idx[1];
+      if (! word_op_get(thr, cp->bit_idx[0], wid, lv))
+	    return of_CMPIU_the_hard_way(thr, cp);
+
+      word_op_flags(thr, lv == imm, lv < imm);
+      return true;
+}
+
+static bool of_CMPIS_word(vthread_t thr, vvp_code_t cp)
+{
+      unsigned wid = cp->number;
+      unsigned long lv, imm = cp->bit_idx[1] & word_op_mask(wid);
+      if (! word_op_get(thr, cp->bit_idx[0], wid, lv))
+	    return of_CMPIS_the_hard_way(thr, cp);
+
+	/* The immediate is never negative, so a negative vector is
+	   always less than it. */
+      bool lt = (lv < imm) || ((lv >> (wid-1)) & 1UL);
+      word_op_flags(thr, lv == imm, lt);
+      return true;
+}
+
+/*
+ * Run the generic implementation of an opcode (with the tier turned
+ * off so that it does not replace itself) and the word variant, and
+ * compare the thread bits that they leave behind.
+ */
+static bool word_op_check(vthread_t thr, vvp_code_t cp,
+			    vvp_code_fun generic, vvp_code_fun word,
+			    const char*name)
+{
+      vvp_vector4_t save = thr->bits4;
+
+      vthread_word_ops = false;
+      generic(thr, cp);
+      vthread_word_ops = true;
+
+      vvp_vector4_t ref = thr->bits4;
+      thr->bits4 = save;
+      word(thr, cp);
+
+      if (ref.size() < thr->bits4.size())
+	    ref.resize(thr->bits4.size());
+      if (thr->bits4.size() < ref.size())
+	    thr->bits4.resize(ref.size());
+
+      if (! thr->bits4.eeq(ref)) {
+	    count_word_mismatches += 1;
+	    fprintf(stderr, "vvp word opcodes: %s %u, %u, %lu: word result does "
+		    "not match the generic result.\n", name,
+		    cp->bit_idx[0], cp->bit_idx[1], cp->number);
+	    thr->bits4 = ref;
+      }
+
+      return true;
+}
+
+static bool of_ADD_check(vthread_t thr, vvp_code_t cp)
+{ return word_op_check(thr, cp, &of_ADD, &of_ADD_word, "%add"); }
+static bool of_ADDI_check(vthread_t thr, vvp_code_t cp)
+{ return word_op_check(thr, cp, &of_ADDI, &of_ADDI_word, "%addi"); }
+static bool of_SUB_check(vthread_t thr, vvp_code_t cp)
+{ return word_op_check(thr, cp, &of_SUB, &of_SUB_word, "%sub"); }
+static bool of_SUBI_check(vthread_t thr, vvp_code_t cp)
+{ return word_op_check(thr, cp, &of_SUBI, &of_SUBI_word, "%subi"); }
+static bool of_MUL_check(vthread_t thr, vvp_code_t cp)
+{ return word_op_check(thr, cp, &of_MUL, &of_MUL_word, "%mul"); }
+static bool of_MULI_check(vthread_t thr, vvp_code_t cp)
+{ return word_op_check(thr, cp, &of_MULI, &of_MULI_word, "%muli"); }
+static bool of_CMPU_check(vthread_t thr, vvp_code_t cp)
+{ return word_op_check(thr, cp, &of_CMPU, &of_CMPU_word, "%cmp/u"); }
+static bool of_CMPS_check(vthread_t thr, vvp_code_t cp)
+{ return word_op_check(thr, cp, &of_CMPS, &of_CMPS_word, "%cmp/s"); }
+static bool of_CMPIU_check(vthread_t thr, vvp_code_t cp)
+{ return word_op_check(thr, cp, &of_CMPIU, &of_CMPIU_word, "%cmpi/u"); }
+static bool of_CMPIS_check(vthread_t thr, vvp_code_t cp)
+{ return word_op_check(thr, cp, &of_CMPIS, &of_CMPIS_word, "%cmpi/s"); }
+
+/*
+ * The generic opcodes call this to replace themselves with the word
+ * (or checking) variant if the tier is enabled and the vector fits.
+ */
+static inline bool word_op_wants(vvp_code_t cp)
+{
+      return vthread_word_ops && cp->number > 0 && cp->number <= CPU_WORD_BITS;
+}
+
+static bool word_op_replace(vthread_t thr, vvp_code_t cp,
+			vvp_code_fun word, vvp_code_fun check)
+{
+      cp->opcode = vthread_word_check? check : word;
+      count_word_opcodes += 1;
+      return cp->opcode(thr, cp);
+}
+
 bool of_ABS_WR(vthread_t thr, vvp_code_t)
 {
       thr->push_real( fabs(thr->pop_real()) );
@@ -855,6 +1775,9 @@ bool of_ANDI(vthread_t thr, vvp_code_t cp)
 
 bool of_ADD(vthread_t thr, vvp_code_t cp)
 {
+      if (word_op_wants(cp))
+	    return word_op_replace(thr, cp, &of_ADD_word, &of_ADD_check);
+
       assert(cp->bit_idx[0] >= 4);
 
       unsigned long*lva = vector_to_array(thr, cp->bit_idx[0], cp->number);
@@ -903,6 +1826,9 @@ bool of_ADD_WR(vthread_t thr, vvp_code_t)
  */
 bool of_ADDI(vthread_t thr, vvp_code_t cp)
 {
+      if (word_op_wants(cp))
+	    return word_op_replace(thr, cp, &of_ADDI_word, &of_ADDI_check);
+
 	// Collect arguments
       unsigned bit_addr       = cp->bit_idx[0];
       unsigned long imm_value = cp->bit_idx[1];
@@ -1430,6 +2356,42 @@ bool of_BREAKPOINT(vthread_t, vvp_code_t)
       return true;
 }
 
+/*
+ * %call <code-label>
+ *
+ * Invoke a function in the current thread. The thread bits and index
+ * registers of the caller are saved in a call frame and the function
+ * starts with the (recycled) bits of an earlier call. The matching
+ * %end restores the caller state and continues after the %call.
+ */
+bool of_CALL(vthread_t thr, vvp_code_t cp)
+{
+      if (thr->call_depth_ == thr->call_stack_.size())
+	    thr->call_stack_.push_back(vthread_s::call_frame_s());
+
+      vthread_s::call_frame_s&frame = thr->call_stack_[thr->call_depth_];
+      thr->call_depth_ += 1;
+      count_vthread_calls += 1;
+
+      frame.ret_pc = thr->pc;
+      memcpy(frame.words, thr->words, sizeof thr->words);
+      thr->bits4.swap(frame.bits4);
+
+	/* A frame that has not been used before has no bits at all,
+	   so give it the constant bits 0-3. The function code never
+	   writes those, so a recycled frame already has them. */
+      if (thr->bits4.size() < 4) {
+	    thr->bits4 = vvp_vector4_t(32);
+	    thr_put_bit(thr, 0, BIT4_0);
+	    thr_put_bit(thr, 1, BIT4_1);
+	    thr_put_bit(thr, 2, BIT4_X);
+	    thr_put_bit(thr, 3, BIT4_Z);
+      }
+
+      thr->pc = cp->cptr;
+      return true;
+}
+
 /*
  * the %cassign/link instruction connects a source node to a
  * destination node. The destination node must be a signal, as it is
@@ -1570,7 +2532,7 @@ bool of_CAST2(vthread_t thr, vvp_code_t cp)
       return true;
 }
 
-bool of_CMPS(vthread_t thr, vvp_code_t cp)
+static bool of_CMPS_the_hard_way(vthread_t thr, vvp_code_t cp)
 {
       vvp_bit4_t eq  = BIT4_1;
       vvp_bit4_t eeq = BIT4_1;
@@ -1641,6 +2603,14 @@ bool of_CMPS(vthread_t thr, vvp_code_t cp)
       return true;
 }
 
+bool of_CMPS(vthread_t thr, vvp_code_t cp)
+{
+      if (word_op_wants(cp))
+	    return word_op_replace(thr, cp, &of_CMPS_word, &of_CMPS_check);
+
+      return of_CMPS_the_hard_way(thr, cp);
+}
+
 bool of_CMPSTR(vthread_t thr, vvp_code_t)
 {
       string re = thr->pop_str();
@@ -1668,7 +2638,7 @@ bool of_CMPSTR(vthread_t thr, vvp_code_t)
       return true;
 }
 
-bool of_CMPIS(vthread_t thr, vvp_code_t cp)
+static bool of_CMPIS_the_hard_way(vthread_t thr, vvp_code_t cp)
 {
       vvp_bit4_t eq  = BIT4_1;
       vvp_bit4_t eeq = BIT4_1;
@@ -1717,6 +2687,14 @@ bool of_CMPIS(vthread_t thr, vvp_code_t cp)
       return true;
 }
 
+bool of_CMPIS(vthread_t thr, vvp_code_t cp)
+{
+      if (word_op_wants(cp))
+	    return word_op_replace(thr, cp, &of_CMPIS_word, &of_CMPIS_check);
+
+      return of_CMPIS_the_hard_way(thr, cp);
+}
+
 /*
  * The of_CMPIU below punts to this function if there are any xz bits
  * in the vector part of the instruction. In this case we know that
@@ -1762,6 +2740,9 @@ static bool of_CMPIU_the_hard_way(vthread_t thr, vvp_code_t cp)
 
 bool of_CMPIU(vthread_t thr, vvp_code_t cp)
 {
+      if (word_op_wants(cp))
+	    return word_op_replace(thr, cp, &of_CMPIU_word, &of_CMPIU_check);
+
       unsigned addr = cp->bit_idx[0];
       unsigned long imm  = cp->bit_idx[1];
       unsigned wid  = cp->number;
@@ -1833,6 +2814,9 @@ bool of_CMPU_the_hard_way(vthread_t thr, vvp_code_t cp)
 
 bool of_CMPU(vthread_t thr, vvp_code_t cp)
 {
+      if (word_op_wants(cp))
+	    return word_op_replace(thr, cp, &of_CMPU_word, &of_CMPU_check);
+
       vvp_bit4_t eq = BIT4_1;
       vvp_bit4_t lt = BIT4_0;
 
@@ -2178,7 +3162,7 @@ static bool do_disable(vthread_t thr, vthread_t match)
       bool flag = false;
 
 	/* Pull the target thread out of its scope if needed. */
-      thr->parent_scope->threads.erase(thr);
+      scope_remove(thr);
 
 	/* Turn the thread off by setting is program counter to
 	   zero and setting an OFF bit. */
@@ -2188,10 +3172,8 @@ static bool do_disable(vthread_t thr, vthread_t match)
 	/* Turn off all the children of the thread. Simulate a %join
 	   for as many times as needed to clear the results of all the
 	   %forks that this thread has done. */
-      while (! thr->children.empty()) {
+      while (vthread_t tmp = thr->children) {
 
-	    vthread_t tmp = *(thr->children.begin());
-	    assert(tmp);
 	    assert(tmp->parent == thr);
 	    thr->i_am_joining = 0;
 	    if (do_disable(tmp, match))
@@ -2238,10 +3220,8 @@ bool of_DISABLE(vthread_t thr, vvp_code_t cp)
 
       bool disabled_myself_flag = false;
 
-      while (! scope->threads.empty()) {
-	    set<vthread_t>::iterator cur = scope->threads.begin();
-
-	    if (do_disable(*cur, thr))
+      while (scope->threads) {
+	    if (do_disable(scope->threads, thr))
 		  disabled_myself_flag = true;
       }
 
@@ -2259,12 +3239,10 @@ bool of_DISABLE_FORK(vthread_t thr, vvp_code_t)
       assert(! thr->i_am_joining);
 
 	/* There should be no active children to disable. */
-      assert(thr->children.empty());
+      assert(thr->children == 0);
 
 	/* Disable any detached children. */
-      while (! thr->detached_children.empty()) {
-	    vthread_t child = *(thr->detached_children.begin());
-	    assert(child);
+      while (vthread_t child = thr->detached_children) {
 	    assert(child->parent == thr);
 	      /* Disabling the children can never match the parent thread. */
 	    bool res = do_disable(child, thr);
@@ -2579,23 +3557,33 @@ bool of_DUP_REAL(vthread_t thr, vvp_code_t)
 bool of_END(vthread_t thr, vvp_code_t)
 {
       assert(! thr->waiting_for_event);
+
+	/* If this is the end of a function invoked by %call, then
+	   return to the caller instead of ending the thread. */
+      if (thr->call_depth_ > 0) {
+	    thr->call_depth_ -= 1;
+	    vthread_s::call_frame_s&frame = thr->call_stack_[thr->call_depth_];
+	    thr->pc = frame.ret_pc;
+	    thr->bits4.swap(frame.bits4);
+	    memcpy(thr->words, frame.words, sizeof thr->words);
+	    return true;
+      }
+
       thr->i_have_ended = 1;
       thr->pc = codespace_null();
 
 	/* Fully detach any detached children. */
-      while (! thr->detached_children.empty()) {
-	    vthread_t child = *(thr->detached_children.begin());
-	    assert(child);
+      while (vthread_t child = thr->detached_children) {
 	    assert(child->parent == thr);
 	    assert(child->i_am_detached);
+	    sib_remove(child);
 	    child->parent = 0;
 	    child->i_am_detached = 0;
-	    thr->detached_children.erase(thr->detached_children.begin());
       }
 
 	/* It is an error to still have active children running at this
 	 * point in time. They should have all been detached or joined. */
-      assert(thr->children.empty());
+      assert(thr->children == 0);
 
 	/* If I have a parent who is waiting for me, then mark that I
 	   have ended, and schedule that parent. Also, finish the
@@ -2622,12 +3610,11 @@ bool of_END(vthread_t thr, vvp_code_t)
       if (thr->i_am_detached) {
 	    vthread_t tmp = thr->parent;
 	    assert(tmp);
-	    size_t res = tmp->detached_children.erase(thr);
-	    assert(res == 1);
+	    sib_remove(thr);
 	      /* If the parent is waiting for the detached children to
 	       * finish then the last detached child needs to tell the
 	       * parent to wake up when it is finished. */
-	    if (tmp->i_am_waiting && tmp->detached_children.empty()) {
+	    if (tmp->i_am_waiting && tmp->detached_children == 0) {
 		  tmp->i_am_waiting = 0;
 		  schedule_vthread(tmp, 0, true);
 	    }
@@ -2803,19 +3790,21 @@ bool of_FORK(vthread_t thr, vvp_code_t cp)
       }
 
       child->parent = thr;
-      thr->children.insert(child);
+      sib_insert(thr->children, child);
 
 	/* If the child scope is not the same as the current scope,
 	   infer that this is a task or function call. */
       switch (cp->scope->get_type_code()) {
 	  case vpiFunction:
-	    thr->task_func_children.insert(child);
+	    assert(thr->task_func_child == 0);
+	    thr->task_func_child = child;
 	    child->is_scheduled = 1;
 	    vthread_run(child);
 	    running_thread = thr;
 	    break;
 	  case vpiTask:
-	    thr->task_func_children.insert(child);
+	    assert(thr->task_func_child == 0);
+	    thr->task_func_child = child;
 	    schedule_vthread(child, 0, true);
 	    break;
 	  default:
@@ -3134,8 +4123,7 @@ bool of_JMP1(vthread_t thr, vvp_code_t cp)
 
 static bool test_joinable(vthread_t thr, vthread_t child)
 {
-      set<vthread_t>::iterator cur = thr->task_func_children.find(child);
-      if (! thr->task_func_children.empty() && cur == thr->task_func_children.end())
+      if (thr->task_func_child && thr->task_func_child != child)
 	    return false;
 
       return true;
@@ -3145,8 +4133,9 @@ static void do_join(vthread_t thr, vthread_t child)
 {
       assert(child->parent == thr);
 
-	/* Remove the thread from the task/function set if needed. */
-      thr->task_func_children.erase(child);
+	/* Clear the task/function child if this is it. */
+      if (thr->task_func_child == child)
+	    thr->task_func_child = 0;
 
         /* If the immediate child thread is in an automatic scope... */
       if (child->wt_context) {
@@ -3168,13 +4157,11 @@ static void do_join(vthread_t thr, vthread_t child)
 bool of_JOIN(vthread_t thr, vvp_code_t)
 {
       assert( !thr->i_am_joining );
-      assert( !thr->children.empty());
+      assert(thr->children);
 
 	// Are there any children that have already ended? If so, then
 	// join with that one.
-      for (set<vthread_t>::iterator cur = thr->children.begin()
-		 ; cur != thr->children.end() ; ++cur) {
-	    vthread_t curp = *cur;
+      for (vthread_t curp = thr->children ; curp ; curp = curp->sib_next) {
 	    if (! curp->i_have_ended)
 		  continue;
 
@@ -3200,12 +4187,12 @@ bool of_JOIN_DETACH(vthread_t thr, vvp_code_t cp)
 {
       unsigned long count = cp->number;
 
-      assert(thr->task_func_children.empty());
-      assert(count == thr->children.size());
+      assert(thr->task_func_child == 0);
 
-      while (! thr->children.empty()) {
-	    vthread_t child = *thr->children.begin();
+      while (vthread_t child = thr->children) {
 	    assert(child->parent == thr);
+	    assert(count > 0);
+	    count -= 1;
 
 	      // We cannot detach automatic tasks/functions within an
 	      // automatic scope. If we try to do that, we might make
@@ -3217,12 +4204,12 @@ bool of_JOIN_DETACH(vthread_t thr, vvp_code_t cp)
 		  vthread_reap(child);
 
 	    } else {
-		  size_t res = child->parent->children.erase(child);
-		  assert(res == 1);
+		  sib_remove(child);
 		  child->i_am_detached = 1;
-		  thr->detached_children.insert(child);
+		  sib_insert(thr->detached_children, child);
 	    }
       }
+      assert(count == 0);
 
       return true;
 }
@@ -4066,6 +5053,9 @@ bool of_MOVI(vthread_t thr, vvp_code_t cp)
 
 bool of_MUL(vthread_t thr, vvp_code_t cp)
 {
+      if (word_op_wants(cp))
+	    return word_op_replace(thr, cp, &of_MUL_word, &of_MUL_check);
+
       unsigned adra = cp->bit_idx[0];
       unsigned adrb = cp->bit_idx[1];
       unsigned wid = cp->number;
@@ -4133,6 +5123,9 @@ bool of_MUL_WR(vthread_t thr, vvp_code_t)
 
 bool of_MULI(vthread_t thr, vvp_code_t cp)
 {
+      if (word_op_wants(cp))
+	    return word_op_replace(thr, cp, &of_MULI_word, &of_MULI_check);
+
       unsigned adr = cp->bit_idx[0];
       unsigned long imm = cp->bit_idx[1];
       unsigned wid = cp->number;
@@ -4225,36 +5218,18 @@ bool of_NEW_COBJ(vthread_t thr, vvp_code_t cp)
       return true;
 }
 
+/*
+ * %new/darray <idx>, "<type>"
+ *
+ * The type string was resolved to a type code when the code was
+ * loaded, so all that is left is to make the object.
+ */
 bool of_NEW_DARRAY(vthread_t thr, vvp_code_t cp)
 {
-      const char*text = cp->text;
       size_t size = thr->words[cp->bit_idx[0]].w_int;
 
       vvp_object_t obj;
-      if (strcmp(text,"b8") == 0) {
-	    obj = new vvp_darray_atom<uint8_t>(size);
-      } else if (strcmp(text,"b16") == 0) {
-	    obj = new vvp_darray_atom<uint16_t>(size);
-      } else if (strcmp(text,"b32") == 0) {
-	    obj = new vvp_darray_atom<uint32_t>(size);
-      } else if (strcmp(text,"b64") == 0) {
-	    obj = new vvp_darray_atom<uint64_t>(size);
-      } else if (strcmp(text,"sb8") == 0) {
-	    obj = new vvp_darray_atom<int8_t>(size);
-      } else if (strcmp(text,"sb16") == 0) {
-	    obj = new vvp_darray_atom<int16_t>(size);
-      } else if (strcmp(text,"sb32") == 0) {
-	    obj = new vvp_darray_atom<int32_t>(size);
-      } else if (strcmp(text,"sb64") == 0) {
-	    obj = new vvp_darray_atom<int64_t>(size);
-      } else if (strcmp(text,"r") == 0) {
-	    obj = new vvp_darray_real(size);
-      } else if (strcmp(text,"S") == 0) {
-	    obj = new vvp_darray_string(size);
-      } else {
-	    obj = new vvp_darray (size);
-      }
-
+      obj = vvp_darray_new(cp->number, size);
       thr->push_object(obj);
 
       return true;
@@ -5411,6 +6386,9 @@ bool of_STORE_STRA(vthread_t thr, vvp_code_t cp)
 
 bool of_SUB(vthread_t thr, vvp_code_t cp)
 {
+      if (word_op_wants(cp))
+	    return word_op_replace(thr, cp, &of_SUB_word, &of_SUB_check);
+
       assert(cp->bit_idx[0] >= 4);
 
       unsigned long*lva = vector_to_array(thr, cp->bit_idx[0], cp->number);
@@ -5454,6 +6432,9 @@ bool of_SUB_WR(vthread_t thr, vvp_code_t)
 
 bool of_SUBI(vthread_t thr, vvp_code_t cp)
 {
+      if (word_op_wants(cp))
+	    return word_op_replace(thr, cp, &of_SUBI_word, &of_SUBI_check);
+
       assert(cp->bit_idx[0] >= 4);
 
       unsigned word_count = (cp->number+CPU_WORD_BITS-1)/CPU_WORD_BITS;
@@ -5620,11 +6601,11 @@ bool of_WAIT_FORK(vthread_t thr, vvp_code_t)
       assert(! thr->i_am_waiting);
 
 	/* There should be no active children when waiting. */
-      assert(thr->children.empty());
+      assert(thr->children == 0);
 
 	/* If there are no detached children then there is nothing to
 	 * wait for. */
-      if (thr->detached_children.empty()) return true;
+      if (thr->detached_children == 0) return true;
 
 	/* Flag that this process is waiting for the detached children
 	 * to finish and suspend it. */
@@ -5695,7 +6676,7 @@ bool of_XOR(vthread_t thr, vvp_code_t cp)
 bool of_ZOMBIE(vthread_t thr, vvp_code_t)
 {
       thr->pc = codespace_null();
-      if ((thr->parent == 0) && (thr->children.empty())) {
+      if ((thr->parent == 0) && (thr->children == 0)) {
 	    if (thr->delay_delete)
 		  schedule_del_thr(thr);
 	    else
@@ -5716,7 +6697,7 @@ bool of_EXEC_UFUNC(vthread_t thr, vvp_code_t cp)
       struct __vpiScope*child_scope = cp->ufunc_core_ptr->func_scope();
       assert(child_scope);
 
-      assert(thr->children.empty());
+      assert(thr->children == 0);
 
         /* We can take a number of shortcuts because we know that a
            continuous assignment can only occur in a static scope. */
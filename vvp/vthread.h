@@ -116,6 +116,13 @@ extern vvp_context_item_t vthread_get_rd_context_item(unsigned context_idx);
 extern vvp_bit4_t vthread_get_bit(struct vthread_s*thr, unsigned addr);
 extern void vthread_put_bit(struct vthread_s*thr, unsigned addr, vvp_bit4_t bit);
 
+/*
+ * Put a 2-state value of up to 64 bits into the thread's bit
+ * space. Bits past the 64th are set to 0.
+ */
+extern void vthread_put_word(struct vthread_s*thr, unsigned addr, unsigned wid,
+			     uint64_t val);
+
 extern void vthread_push_real(struct vthread_s*thr, double val);
 
 extern void vthread_pop_str(struct vthread_s*thr, unsigned count);
@@ -131,4 +138,28 @@ extern double vthread_get_real_stack(struct vthread_s*thr, unsigned depth);
 /* This is used to actually delete a thread once we are done with it. */
 extern void vthread_delete(vthread_t thr);
 
+/*
+ * These are thread counters for the sake of performance
+ * measurements: the number of threads created, the number of thread
+ * objects that had to be allocated (the rest came from the free
+ * list), the number of functions invoked by %call and the number
+ * of instructions executed.
+ */
+extern unsigned long count_vthreads;
+extern unsigned long count_vthread_allocs;
+extern unsigned long count_vthread_calls;
+extern unsigned long count_vthread_instructions;
+
+/*
+ * These flags control the word-sized opcode variants (see
+ * vthread.cc). They are off by default, the +word-ops extended
+ * argument turns them on and +word-ops=check cross-checks them. The
+ * counters are the number of opcodes that were replaced, and the
+ * number of results that did not match in the check mode.
+ */
+extern bool vthread_word_ops;
+extern bool vthread_word_check;
+extern unsigned long count_word_opcodes;
+extern unsigned long count_word_mismatches;
+
 #endif
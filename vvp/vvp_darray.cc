@@ -21,6 +21,9 @@
 # include  "vvp_net.h"
 # include  <iostream>
 # include  <typeinfo>
+# include  <cstdlib>
+# include  <cstring>
+# include  <cassert>
 
 using namespace std;
 
@@ -137,3 +140,163 @@ void vvp_darray_string::get_word(unsigned adr, string&value)
 
       value = array_[adr];
 }
+
+/*
+ * Store a vector into a pair of planes. The vector is resized to the
+ * array word width if necessary, and 2-state words have their X and
+ * Z bits changed to 0.
+ */
+static void store_planes(unsigned long*abits, unsigned long*bbits,
+			 unsigned word_wid, unsigned word_cnt, bool two_state,
+			 const vvp_vector4_t&value)
+{
+      if (value.size() == word_wid) {
+	    value.get_planes(abits, bbits);
+      } else {
+	    vvp_vector4_t tmp (value);
+	    tmp.resize(word_wid);
+	    tmp.get_planes(abits, bbits);
+      }
+
+      if (two_state) {
+	    for (unsigned idx = 0 ;  idx < word_cnt ;  idx += 1) {
+		  abits[idx] &= ~bbits[idx];
+		  bbits[idx] = 0;
+	    }
+      }
+}
+
+static void fetch_planes(const unsigned long*abits, const unsigned long*bbits,
+			 unsigned word_wid, vvp_vector4_t&value)
+{
+      if (value.size() != word_wid)
+	    value = vvp_vector4_t(word_wid);
+      value.set_planes(abits, bbits);
+}
+
+static const unsigned BITS_PER_PLANE_WORD = 8*sizeof(unsigned long);
+
+vvp_darray_vec4::vvp_darray_vec4(size_t siz, unsigned word_wid, bool two_state)
+: vvp_darray(siz), word_wid_(word_wid), two_state_(two_state)
+{
+      assert(word_wid_ > 0);
+      word_cnt_ = (word_wid_ + BITS_PER_PLANE_WORD - 1) / BITS_PER_PLANE_WORD;
+
+	/* Make the initial value (0 or X) of a word, then replicate
+	   it through the planes. */
+      vvp_vector4_t init (word_wid_, two_state_? BIT4_0 : BIT4_X);
+      std::vector<unsigned long> inita (word_cnt_), initb (word_cnt_);
+      init.get_planes(&inita[0], &initb[0]);
+
+      abits_.resize(siz * word_cnt_);
+      bbits_.resize(siz * word_cnt_);
+      for (size_t idx = 0 ;  idx < siz ;  idx += 1) {
+	    for (unsigned wdx = 0 ;  wdx < word_cnt_ ;  wdx += 1) {
+		  abits_[idx*word_cnt_ + wdx] = inita[wdx];
+		  bbits_[idx*word_cnt_ + wdx] = initb[wdx];
+	    }
+      }
+}
+
+vvp_darray_vec4::~vvp_darray_vec4()
+{
+}
+
+void vvp_darray_vec4::set_word(unsigned adr, const vvp_vector4_t&value)
+{
+      if (adr >= get_size())
+	    return;
+
+      size_t off = adr * word_cnt_;
+      store_planes(&abits_[off], &bbits_[off], word_wid_, word_cnt_,
+		   two_state_, value);
+}
+
+void vvp_darray_vec4::get_word(unsigned adr, vvp_vector4_t&value)
+{
+      if (adr >= get_size()) {
+	    value = vvp_vector4_t(word_wid_, two_state_? BIT4_0 : BIT4_X);
+	    return;
+      }
+
+      size_t off = adr * word_cnt_;
+      fetch_planes(&abits_[off], &bbits_[off], word_wid_, value);
+}
+
+/*
+ * The type code keeps the kind of element in the low bits and the
+ * vector width (if any) in the rest.
+ */
+enum darray_type_kind_t {
+      DAR_NONE = 0,
+      DAR_BOOL,
+      DAR_SBOOL,
+      DAR_LOGIC,
+      DAR_REAL,
+      DAR_STRING
+};
+
+static const unsigned DAR_KIND_BITS = 4;
+
+unsigned long vvp_darray_type_code(const char*text)
+{
+      darray_type_kind_t kind = DAR_NONE;
+
+      if (strcmp(text,"r") == 0)
+	    return DAR_REAL;
+      if (strcmp(text,"S") == 0)
+	    return DAR_STRING;
+
+      if (text[0] == 'b') {
+	    kind = DAR_BOOL;
+	    text += 1;
+      } else if (text[0] == 's' && text[1] == 'b') {
+	    kind = DAR_SBOOL;
+	    text += 2;
+      } else if (text[0] == 'v') {
+	    kind = DAR_LOGIC;
+	    text += 1;
+      } else {
+	    return DAR_NONE;
+      }
+
+      char*ep;
+      unsigned long wid = strtoul(text, &ep, 10);
+      if (ep == text || *ep != 0 || wid == 0)
+	    return DAR_NONE;
+
+      return (wid << DAR_KIND_BITS) | kind;
+}
+
+vvp_darray* vvp_darray_new(unsigned long type_code, size_t size)
+{
+      unsigned long wid = type_code >> DAR_KIND_BITS;
+
+      switch (type_code & ((1UL << DAR_KIND_BITS) - 1)) {
+	  case DAR_BOOL:
+	    switch (wid) {
+		case 8:  return new vvp_darray_atom<uint8_t>(size);
+		case 16: return new vvp_darray_atom<uint16_t>(size);
+		case 32: return new vvp_darray_atom<uint32_t>(size);
+		case 64: return new vvp_darray_atom<uint64_t>(size);
+		default: return new vvp_darray_vec4(size, wid, true);
+	    }
+	  case DAR_SBOOL:
+	    switch (wid) {
+		case 8:  return new vvp_darray_atom<int8_t>(size);
+		case 16: return new vvp_darray_atom<int16_t>(size);
+		case 32: return new vvp_darray_atom<int32_t>(size);
+		case 64: return new vvp_darray_atom<int64_t>(size);
+		default: return new vvp_darray_vec4(size, wid, true);
+	    }
+	  case DAR_LOGIC:
+	    return new vvp_darray_vec4(size, wid, false);
+	  case DAR_REAL:
+	    return new vvp_darray_real(size);
+	  case DAR_STRING:
+	    return new vvp_darray_string(size);
+	  default:
+	    assert(0);
+	    return 0;
+      }
+}
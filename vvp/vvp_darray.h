@@ -59,6 +59,32 @@ template <class TYPE> class vvp_darray_atom : public vvp_darray {
       std::vector<TYPE> array_;
 };
 
+/*
+ * This is a dynamic array of packed vectors of any width. The words
+ * are stored in a pair of contiguous word planes that hold the
+ * abits and bbits of each array word back to back, so an element is
+ * a straight copy of a few words in and out of a vvp_vector4_t. The
+ * same class holds 4-state (logic) and 2-state (bit) elements that
+ * do not fit one of the atom types.
+ */
+class vvp_darray_vec4 : public vvp_darray {
+
+    public:
+      vvp_darray_vec4(size_t siz, unsigned word_wid, bool two_state);
+      ~vvp_darray_vec4();
+
+      void set_word(unsigned adr, const vvp_vector4_t&value);
+      void get_word(unsigned adr, vvp_vector4_t&value);
+
+    private:
+      unsigned word_wid_;
+	// Number of unsigned longs per plane for each array word.
+      unsigned word_cnt_;
+      bool two_state_;
+      std::vector<unsigned long> abits_;
+      std::vector<unsigned long> bbits_;
+};
+
 class vvp_darray_real : public vvp_darray {
 
     public:
@@ -85,5 +111,13 @@ class vvp_darray_string : public vvp_darray {
       std::vector<std::string> array_;
 };
 
+/*
+ * The element type of a dynamic array is passed to the %new/darray
+ * instruction as a type string. The loader parses the string once
+ * into a type code (0 if the string is not valid) and the
+ * instruction uses the code to make objects.
+ */
+extern unsigned long vvp_darray_type_code(const char*text);
+extern vvp_darray* vvp_darray_new(unsigned long type_code, size_t size);
 
 #endif
@@ -36,11 +36,12 @@ static bool at_EOS = false;
 
 void island_send_value(vvp_net_t*net, const vvp_vector8_t&val)
 {
-      vvp_island_port*fun = dynamic_cast<vvp_island_port*>(net->fun);
+      vvp_island_port*fun = island_port(net);
       if (fun->outvalue .eeq(val))
 	    return;
 
       fun->outvalue = val;
+      fun->note_outvalue_changed();
       net->send_vec8(fun->outvalue);
 }
 
@@ -68,8 +69,19 @@ vvp_island::~vvp_island()
       }
 }
 
-void vvp_island::flag_island()
+void vvp_island::note_changed(vvp_island_port*port)
 {
+      if (port->changed)
+	    return;
+
+      port->changed = true;
+      changed_ports_.push_back(port);
+}
+
+void vvp_island::flag_island(vvp_island_port*port)
+{
+      note_changed(port);
+
       if (flagged_ == true)
 	    return;
 
@@ -137,6 +149,12 @@ void vvp_island::add_branch(vvp_island_branch*branch, const char*pa, const char*
 	    bnodes_->sym_set_value(pb, branch);
       }
 
+	// Give each port a way into its node of branch ends.
+      if (island_port(branch->a)->node.nil())
+	    island_port(branch->a)->node = ptra;
+      if (island_port(branch->b)->node.nil())
+	    island_port(branch->b)->node = ptrb;
+
       branch->next_branch = branches_;
       branches_ = branch;
 }
@@ -162,7 +180,7 @@ void vvp_island::compile_cleanup()
 }
 
 vvp_island_port::vvp_island_port(vvp_island*ip)
-: island_(ip)
+: ctrl_branches(0), changed(false), mark(0), island_(ip)
 {
 }
 
@@ -178,7 +196,7 @@ void vvp_island_port::recv_vec4(vvp_net_ptr_t, const vvp_vector4_t&bit,
 	    return;
 
       invalue = tmp;
-      island_->flag_island();
+      island_->flag_island(this);
 }
 
 void vvp_island_port::recv_vec4_pv(vvp_net_ptr_t port, const vvp_vector4_t&bit,
@@ -196,7 +214,7 @@ void vvp_island_port::recv_vec8(vvp_net_ptr_t, const vvp_vector8_t&bit)
 	    return;
 
       invalue = bit;
-      island_->flag_island();
+      island_->flag_island(this);
 }
 
 void vvp_island_port::recv_vec8_pv(vvp_net_ptr_t, const vvp_vector8_t&bit,
@@ -214,12 +232,12 @@ void vvp_island_port::recv_vec8_pv(vvp_net_ptr_t, const vvp_vector8_t&bit,
 	    }
       }
 
-      island_->flag_island();
+      island_->flag_island(this);
 }
 
 void vvp_island_port::force_flag(void)
 {
-      island_->flag_island();
+      island_->flag_island(this);
 }
 
 vvp_island_branch::~vvp_island_branch()
@@ -25,6 +25,7 @@
 # include  "symbols.h"
 # include  "schedule.h"
 # include  <list>
+# include  <vector>
 # include  <cassert>
 
 /*
@@ -57,6 +58,8 @@
 struct vvp_island_branch;
 class vvp_island_port;
 
+typedef vvp_sub_pointer_t<vvp_island_branch> vvp_branch_ptr_t;
+
 class vvp_island  : private vvp_gen_event_s {
 
     public:
@@ -66,8 +69,14 @@ class vvp_island  : private vvp_gen_event_s {
 	// Ports call this method to flag that something happened at
 	// the input. The island will use this to create an active
 	// event. The run_run() method will then be called by the
-	// scheduler to process whatever happened.
-      void flag_island();
+	// scheduler to process whatever happened. The port is also
+	// added to the list of changed ports.
+      void flag_island(vvp_island_port*port);
+
+	// Add the port to the list of changed ports without
+	// scheduling the island. The change is noticed the next time
+	// the island runs for some other reason.
+      void note_changed(vvp_island_port*port);
 
 	// This is the method that is called, eventually, to process
 	// whatever happened. The derived island class implements this
@@ -84,6 +93,11 @@ class vvp_island  : private vvp_gen_event_s {
 	// scanning the mesh.
       vvp_island_branch*branches_;
 
+	// These are the ports that have changed since the island last
+	// ran. The derived class is responsible for clearing the list
+	// (and the changed flags of the ports) when it runs.
+      std::vector<vvp_island_port*> changed_ports_;
+
     public: /* These methods are used during linking. */
 
 	// Add a port to the island. The key is added to the island
@@ -145,6 +159,26 @@ class vvp_island_port  : public vvp_net_fun_t {
       vvp_vector8_t outvalue;
       vvp_vector8_t value;
 
+	// One of the branch ends attached to this port, or nil if no
+	// branches are attached. This is the way into the node of
+	// branch ends for the port.
+      vvp_branch_ptr_t node;
+	// The branches that use this port as a control (enable)
+	// input. The list is linked through the branches and is
+	// maintained by the island implementation.
+      vvp_island_branch*ctrl_branches;
+	// Used by the island to mark ports that have changed, and to
+	// mark ports visited while scanning the mesh.
+      bool changed;
+      unsigned long mark;
+
+	// Note a change to the outvalue of this port. This matters if
+	// the port is also used as a control input.
+      inline void note_outvalue_changed()
+      {
+	    if (ctrl_branches) island_->note_changed(this);
+      }
+
     private:
       vvp_island*island_;
 
@@ -159,9 +193,18 @@ class vvp_island_port  : public vvp_net_fun_t {
       vvp_island_port& operator = (const vvp_island_port&);
 };
 
+/*
+ * The functor of a net that is a port of an island is always a
+ * vvp_island_port, so this cast is safe for any branch end.
+ */
+inline vvp_island_port* island_port(vvp_net_t*net)
+{
+      return static_cast<vvp_island_port*>(net->fun);
+}
+
 inline vvp_vector8_t island_get_value(vvp_net_t*net)
 {
-      vvp_island_port*fun = dynamic_cast<vvp_island_port*>(net->fun);
+      vvp_island_port*fun = island_port(net);
       vvp_wire_vec8*fil = dynamic_cast<vvp_wire_vec8*>(net->fil);
 
       if (fil == 0) {
@@ -184,7 +227,7 @@ inline vvp_vector8_t island_get_value(vvp_net_t*net)
 
 inline vvp_vector8_t island_get_sent_value(vvp_net_t*net)
 {
-      vvp_island_port*fun = dynamic_cast<vvp_island_port*>(net->fun);
+      vvp_island_port*fun = island_port(net);
       return fun->outvalue;
 }
 
@@ -198,8 +241,6 @@ extern void island_send_value(vvp_net_t*net, const vvp_vector8_t&val);
 * of the island.
 */
 
-typedef vvp_sub_pointer_t<vvp_island_branch> vvp_branch_ptr_t;
-
 struct vvp_island_branch {
       virtual ~vvp_island_branch();
 	// Keep a list of branches in the island.
@@ -25,6 +25,7 @@
 # include  "resolv.h"
 # include  "schedule.h"
 # include  "statistics.h"
+# include  "checkpoint.h"
 # include  <cstdio>
 # include  <cstring>
 # include  <cstdlib>
@@ -1015,6 +1016,90 @@ unsigned long* vvp_vector4_t::subarray(unsigned adr, unsigned wid) const
       return 0;
 }
 
+void vvp_vector4_t::get_planes(unsigned long*abits, unsigned long*bbits) const
+{
+      if (size_ > BITS_PER_WORD) {
+	    unsigned cnt = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
+	    memcpy(abits, abits_ptr_, cnt*sizeof(unsigned long));
+	    memcpy(bbits, bbits_ptr_, cnt*sizeof(unsigned long));
+      } else {
+	    abits[0] = abits_val_;
+	    bbits[0] = bbits_val_;
+      }
+}
+
+void vvp_vector4_t::set_planes(const unsigned long*abits, const unsigned long*bbits)
+{
+      if (size_ > BITS_PER_WORD) {
+	    unsigned cnt = (size_ + BITS_PER_WORD - 1) / BITS_PER_WORD;
+	    memcpy(abits_ptr_, abits, cnt*sizeof(unsigned long));
+	    memcpy(bbits_ptr_, bbits, cnt*sizeof(unsigned long));
+      } else {
+	    abits_val_ = abits[0];
+	    bbits_val_ = bbits[0];
+      }
+}
+
+bool vvp_vector4_t::get_word(unsigned adr, unsigned wid, unsigned long&val) const
+{
+      assert(wid > 0 && wid <= BITS_PER_WORD);
+      assert(adr+wid <= size_);
+
+      unsigned long atmp, btmp;
+      if (size_ <= BITS_PER_WORD) {
+	    atmp = abits_val_ >> adr;
+	    btmp = bbits_val_ >> adr;
+      } else {
+	    unsigned ptr = adr / BITS_PER_WORD;
+	    unsigned off = adr % BITS_PER_WORD;
+	    atmp = abits_ptr_[ptr] >> off;
+	    btmp = bbits_ptr_[ptr] >> off;
+	      // The subvector may straddle two words.
+	    if (off > 0 && (off+wid) > BITS_PER_WORD) {
+		  atmp |= abits_ptr_[ptr+1] << (BITS_PER_WORD-off);
+		  btmp |= bbits_ptr_[ptr+1] << (BITS_PER_WORD-off);
+	    }
+      }
+
+      if (wid < BITS_PER_WORD) {
+	    unsigned long mask = (1UL << wid) - 1UL;
+	    atmp &= mask;
+	    btmp &= mask;
+      }
+
+      if (btmp)
+	    return false;
+
+      val = atmp;
+      return true;
+}
+
+void vvp_vector4_t::set_word(unsigned adr, unsigned wid, unsigned long val)
+{
+      assert(wid > 0 && wid <= BITS_PER_WORD);
+      assert(adr+wid <= size_);
+
+      unsigned long mask = (wid < BITS_PER_WORD)? (1UL << wid) - 1UL : -1UL;
+      val &= mask;
+
+      if (size_ <= BITS_PER_WORD) {
+	    abits_val_ = (abits_val_ & ~(mask << adr)) | (val << adr);
+	    bbits_val_ &= ~(mask << adr);
+	    return;
+      }
+
+      unsigned ptr = adr / BITS_PER_WORD;
+      unsigned off = adr % BITS_PER_WORD;
+      abits_ptr_[ptr] = (abits_ptr_[ptr] & ~(mask << off)) | (val << off);
+      bbits_ptr_[ptr] &= ~(mask << off);
+
+      if (off > 0 && (off+wid) > BITS_PER_WORD) {
+	    unsigned sh = BITS_PER_WORD - off;
+	    abits_ptr_[ptr+1] = (abits_ptr_[ptr+1] & ~(mask >> sh)) | (val >> sh);
+	    bbits_ptr_[ptr+1] &= ~(mask >> sh);
+      }
+}
+
 void vvp_vector4_t::setarray(unsigned adr, unsigned wid, const unsigned long*val)
 {
       assert(adr+wid <= size_);
@@ -1967,6 +2052,27 @@ void vvp_vector4array_aa::free_instance(vvp_context_t context)
 }
 #endif
 
+/*
+ * Arrays of narrow words keep the words in place, so they can live
+ * in the context image. Wide words point to storage of their own.
+ */
+size_t vvp_vector4array_aa::image_size() const
+{
+      if (width_ > vvp_vector4_t::BITS_PER_WORD)
+	    return 0;
+
+      return words_ * sizeof(v4cell);
+}
+
+void vvp_vector4array_aa::init_image(void*img) const
+{
+      v4cell*array = static_cast<v4cell*>(img);
+      for (unsigned idx = 0 ; idx < words_ ; idx += 1) {
+	    array[idx].abits_val_ = vvp_vector4_t::WORD_X_ABITS;
+	    array[idx].bbits_val_ = vvp_vector4_t::WORD_X_BBITS;
+      }
+}
+
 void vvp_vector4array_aa::set_word(unsigned index, const vvp_vector4_t&that)
 {
       assert(index < words_);
@@ -1990,6 +2096,32 @@ vvp_vector4_t vvp_vector4array_aa::get_word(unsigned index) const
       return get_word_(cell);
 }
 
+void vvp_vector4array_aa::checkpoint_save(vvp_context_t context,
+					  checkpoint_out&out) const
+{
+      v4cell*cell = static_cast<v4cell*>
+            (vvp_get_context_item(context, context_idx_));
+
+      for (unsigned idx = 0 ; idx < words_ ; idx += 1)
+	    out.put_vec4(get_word_(cell + idx));
+}
+
+void vvp_vector4array_aa::checkpoint_restore(vvp_context_t context,
+					     checkpoint_in&in)
+{
+      v4cell*cell = static_cast<v4cell*>
+            (vvp_get_context_item(context, context_idx_));
+
+      for (unsigned idx = 0 ; idx < words_ && in.ok() ; idx += 1) {
+	    vvp_vector4_t val = in.get_vec4();
+	    if (val.size() != width_) {
+		  in.corrupt("an automatic array does not match the design");
+		  return;
+	    }
+	    set_word_(cell + idx, val);
+      }
+}
+
 vvp_vector2_t::vvp_vector2_t()
 {
       vec_ = 0;
@@ -3305,6 +3437,86 @@ vvp_scalar_t fully_featured_resolv_(vvp_scalar_t a, vvp_scalar_t b)
       return res;
 }
 
+/*
+ * Vector resolution works on the raw scalar encodings. Each byte of a
+ * vvp_vector8_t is a complete scalar, so the result for any pair of
+ * bytes can be looked up in a table of all 256x256 results. The bytes
+ * are further processed 8 at a time as a 64bit word: the words where
+ * each bit pair is trivial (one side HiZ or both sides equal, which
+ * is nearly always the case for a tri-state bus) are merged with
+ * word-wide masks and never reach the table.
+ */
+static unsigned char resolv_table[256][256];
+static bool resolv_table_ready = false;
+
+  /* Return a word with 0xff in each byte where the byte of val is
+     zero, and 0x00 elsewhere. This is exact (no borrows between
+     bytes). */
+static inline uint64_t zero_byte_mask(uint64_t val)
+{
+      const uint64_t low7 = 0x7f7f7f7f7f7f7f7fULL;
+      uint64_t tmp = ((val & low7) + low7) | val | low7;
+      tmp = ~tmp;
+	// tmp now has the MSB set in each zero byte.
+      return (tmp >> 7) * 0xff;
+}
+
+void vvp_vector8_t::resolve_bytes_(unsigned char*a, const unsigned char*b,
+				   unsigned cnt)
+{
+      const uint64_t str_mask = 0x7777777777777777ULL;
+
+      if (! resolv_table_ready) {
+	    for (unsigned adx = 0 ; adx < 256 ; adx += 1) {
+		  for (unsigned bdx = 0 ; bdx < 256 ; bdx += 1) {
+			vvp_scalar_t res = resolve(vvp_scalar_t(adx),
+						   vvp_scalar_t(bdx));
+			resolv_table[adx][bdx] = res.raw();
+		  }
+	    }
+	    resolv_table_ready = true;
+      }
+
+      unsigned idx = 0;
+      for ( ; idx+8 <= cnt ; idx += 8) {
+	    uint64_t wa, wb;
+	    memcpy(&wa, a+idx, 8);
+	    memcpy(&wb, b+idx, 8);
+	    if (wa == wb)
+		  continue;
+
+	      // Bytes where a is HiZ take the b value, bytes where b is
+	      // HiZ (or equal to a) keep the a value.
+	    uint64_t a_hiz = zero_byte_mask(wa & str_mask);
+	    uint64_t keep = zero_byte_mask(wb & str_mask) | zero_byte_mask(wa ^ wb);
+	    if ((a_hiz | keep) == ~(uint64_t)0) {
+		  wa = (wb & a_hiz) | (wa & ~a_hiz);
+		  memcpy(a+idx, &wa, 8);
+		  continue;
+	    }
+
+	    for (unsigned bdx = idx ; bdx < idx+8 ; bdx += 1)
+		  a[bdx] = resolv_table[a[bdx]][b[bdx]];
+      }
+
+      for ( ; idx < cnt ; idx += 1)
+	    a[idx] = resolv_table[a[idx]][b[idx]];
+}
+
+vvp_vector8_t resolve(const vvp_vector8_t&a, const vvp_vector8_t&b)
+{
+      assert(a.size() == b.size());
+      vvp_vector8_t out (a);
+      vvp_vector8_t::resolve_bytes_(out.bytes_(), b.bytes_(), out.size());
+      return out;
+}
+
+void resolve_in_place(vvp_vector8_t&a, const vvp_vector8_t&b)
+{
+      assert(a.size() == b.size());
+      vvp_vector8_t::resolve_bytes_(a.bytes_(), b.bytes_(), a.size());
+}
+
 vvp_vector8_t resistive_reduction(const vvp_vector8_t&that)
 {
       static unsigned rstr[8] = {
@@ -53,6 +53,10 @@ class  vvp_net_t;
 class  vvp_net_fun_t;
 class  vvp_net_fil_t;
 
+/* The checkpoint streams (see checkpoint.h). */
+class  checkpoint_out;
+class  checkpoint_in;
+
 /* Core net function types. */
 class  vvp_fun_concat;
 class  vvp_fun_drive;
@@ -122,6 +126,24 @@ struct automatic_hooks_s {
 #ifdef CHECK_WITH_VALGRIND
       virtual void free_instance(vvp_context_t context) = 0;
 #endif
+
+	// An item whose instance state is plain data (no pointers
+	// to storage of its own) may instead have that state placed
+	// in the context block itself. Such an item returns the
+	// size of its state from image_size, and init_image writes
+	// the initial state. The context allocator then creates and
+	// resets all these items with a single block copy, and does
+	// not call the *_instance methods for them.
+      virtual size_t image_size() const { return 0; }
+      virtual void init_image(void*) const { }
+
+	// Save and restore the state of the instance in the context,
+	// for a checkpoint. The threads that wait on an event are
+	// not part of this state; the thread module puts them back.
+      virtual void checkpoint_save(vvp_context_t context,
+				   checkpoint_out&out) const = 0;
+      virtual void checkpoint_restore(vvp_context_t context,
+				      checkpoint_in&in) = 0;
 };
 
 /*
@@ -252,6 +274,18 @@ class vvp_vector4_t {
 	// in the array.
       unsigned long*subarray(unsigned idx, unsigned size) const;
       void setarray(unsigned idx, unsigned size, const unsigned long*val);
+	// Copy the whole vector out to, or in from, a pair of word
+	// planes. The planes use the same encoding as the vector, so
+	// this is a straight copy of (size+W-1)/W words each, where W
+	// is the number of bits in an unsigned long.
+      void get_planes(unsigned long*abits, unsigned long*bbits) const;
+      void set_planes(const unsigned long*abits, const unsigned long*bbits);
+	// Get or set a subvector of up to one word (W bits) as a
+	// 2-value word. The get_word returns false if any of the bits
+	// is X or Z. These do not allocate, so they are cheaper than
+	// subarray/setarray for narrow vectors.
+      bool get_word(unsigned idx, unsigned size, unsigned long&val) const;
+      void set_word(unsigned idx, unsigned size, unsigned long val);
 
 	// Set a 4-value bit or subvector into the vector. Return true
 	// if any bits of the vector change as a result of this operation.
@@ -261,6 +295,10 @@ class vvp_vector4_t {
         // Get the bits from another vector, but keep my size.
       void copy_bits(const vvp_vector4_t&that);
 
+	// Exchange the contents of this vector with that vector. This
+	// never allocates.
+      void swap(vvp_vector4_t&that);
+
 	// Move bits within this vector.
       void mov(unsigned dst, unsigned src, unsigned cnt);
 
@@ -344,6 +382,19 @@ inline vvp_vector4_t::vvp_vector4_t(const vvp_vector4_t&that)
       copy_from_(that);
 }
 
+inline void vvp_vector4_t::swap(vvp_vector4_t&that)
+{
+      unsigned tmp_size = size_;
+      size_ = that.size_;
+      that.size_ = tmp_size;
+      unsigned long*tmp = abits_ptr_;
+      abits_ptr_ = that.abits_ptr_;
+      that.abits_ptr_ = tmp;
+      tmp = bbits_ptr_;
+      bbits_ptr_ = that.bbits_ptr_;
+      that.bbits_ptr_ = tmp;
+}
+
 inline vvp_vector4_t::vvp_vector4_t(const vvp_vector4_t&that, bool invert_flag)
 {
       if (invert_flag)
@@ -591,10 +642,15 @@ class vvp_vector4array_aa : public vvp_vector4array_t, public automatic_hooks_s
 #ifdef CHECK_WITH_VALGRIND
       void free_instance(vvp_context_t context);
 #endif
+      size_t image_size() const;
+      void init_image(void*img) const;
 
       vvp_vector4_t get_word(unsigned idx) const;
       void set_word(unsigned idx, const vvp_vector4_t&that);
 
+      void checkpoint_save(vvp_context_t context, checkpoint_out&out) const;
+      void checkpoint_restore(vvp_context_t context, checkpoint_in&in);
+
     private:
       unsigned context_idx_;
 };
@@ -771,8 +827,11 @@ class vvp_scalar_t {
     private:
 	// This class and the vvp_vector8_t class are closely related,
 	// so allow vvp_vector8_t access to the raw encoding so that
-	// it can do compact vectoring of vvp_scalar_t objects.
+	// it can do compact vectoring of vvp_scalar_t objects. The
+	// checkpoint streams save and restore the raw encoding.
       friend class vvp_vector8_t;
+      friend class checkpoint_out;
+      friend class checkpoint_in;
       explicit vvp_scalar_t(unsigned char val) : value_(val) { }
       unsigned char raw() const { return value_; }
 
@@ -858,6 +917,8 @@ extern ostream& operator<< (ostream&, vvp_scalar_t);
 class vvp_vector8_t {
 
       friend vvp_vector8_t part_expand(const vvp_vector8_t&, unsigned, unsigned);
+      friend vvp_vector8_t resolve(const vvp_vector8_t&, const vvp_vector8_t&);
+      friend void resolve_in_place(vvp_vector8_t&, const vvp_vector8_t&);
 
     public:
       explicit vvp_vector8_t(unsigned size =0);
@@ -889,6 +950,15 @@ class vvp_vector8_t {
       vvp_vector8_t& operator= (const vvp_vector8_t&that);
 
     private:
+	// The raw encoded scalars, wherever they are stored.
+      unsigned char*bytes_()
+      { return size_ <= sizeof(val_)? val_ : ptr_; }
+      const unsigned char*bytes_() const
+      { return size_ <= sizeof(val_)? val_ : ptr_; }
+	// Resolve cnt raw scalars of b into a.
+      static void resolve_bytes_(unsigned char*a, const unsigned char*b,
+				 unsigned cnt);
+
       unsigned size_;
       union {
 	    unsigned char*ptr_;
@@ -897,18 +967,11 @@ class vvp_vector8_t {
 };
 
   /* Resolve uses the default Verilog resolver algorithm to resolve
-     two drive vectors to a single output. */
-inline vvp_vector8_t resolve(const vvp_vector8_t&a, const vvp_vector8_t&b)
-{
-      assert(a.size() == b.size());
-      vvp_vector8_t out (a.size());
-
-      for (unsigned idx = 0 ;  idx < out.size() ;  idx += 1) {
-	    out.set_bit(idx, resolve(a.value(idx), b.value(idx)));
-      }
-
-      return out;
-}
+     two drive vectors to a single output. The resolve_in_place
+     version resolves b into a, which saves a temporary when
+     resolving many drivers. */
+extern vvp_vector8_t resolve(const vvp_vector8_t&a, const vvp_vector8_t&b);
+extern void resolve_in_place(vvp_vector8_t&a, const vvp_vector8_t&b);
 
   /* This function implements the strength reduction implied by
      Verilog standard resistive devices. */
@@ -1108,6 +1171,9 @@ class vvp_net_t {
     public: // Method to support $countdrivers
       void count_drivers(unsigned idx, unsigned counts[4]);
 
+    public: // Head of the fan-out list, for netlist analysis.
+      vvp_net_ptr_t fanout() const { return out_; }
+
     private:
       vvp_net_ptr_t out_;
 
@@ -1249,6 +1315,9 @@ class vvp_net_fil_t  : public vvp_vpi_callback {
 
       virtual unsigned filter_size() const =0;
 
+	// True if any bit of the filter is forced.
+      bool force_active() const { return ! test_force_mask_is_zero(); }
+
     public:
 	// Support for force methods. These are called by the
 	// vvp_net_t::force_* methods to set the force value and mask
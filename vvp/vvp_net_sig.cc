@@ -22,6 +22,7 @@
 # include  "vvp_net_sig.h"
 # include  "statistics.h"
 # include  "vpi_priv.h"
+# include  "checkpoint.h"
 # include  <vector>
 # include  <cassert>
 #ifdef CHECK_WITH_VALGRIND
@@ -373,6 +374,29 @@ void vvp_fun_signal4_aa::free_instance(vvp_context_t context)
  * Continuous and forced assignments are not permitted on automatic
  * variables. So we only expect to receive on port 0.
  */
+void vvp_fun_signal4_aa::checkpoint_save(vvp_context_t context,
+					 checkpoint_out&out) const
+{
+      vvp_vector4_t*bits = static_cast<vvp_vector4_t*>
+            (vvp_get_context_item(context, context_idx_));
+
+      out.put_vec4(*bits);
+}
+
+void vvp_fun_signal4_aa::checkpoint_restore(vvp_context_t context,
+					    checkpoint_in&in)
+{
+      vvp_vector4_t*bits = static_cast<vvp_vector4_t*>
+            (vvp_get_context_item(context, context_idx_));
+
+      vvp_vector4_t val = in.get_vec4();
+      if (val.size() != size_) {
+	    in.corrupt("an automatic variable does not match the design");
+	    return;
+      }
+      *bits = val;
+}
+
 void vvp_fun_signal4_aa::recv_vec4(vvp_net_ptr_t ptr, const vvp_vector4_t&bit,
                                    vvp_context_t context)
 {
@@ -531,6 +555,16 @@ void vvp_fun_signal_real_aa::free_instance(vvp_context_t context)
 }
 #endif
 
+size_t vvp_fun_signal_real_aa::image_size() const
+{
+      return sizeof(double);
+}
+
+void vvp_fun_signal_real_aa::init_image(void*img) const
+{
+      *static_cast<double*>(img) = 0.0;
+}
+
 double vvp_fun_signal_real_aa::real_unfiltered_value() const
 {
       double*bits = static_cast<double*>
@@ -544,6 +578,24 @@ double vvp_fun_signal_real_aa::real_value() const
       return real_unfiltered_value();
 }
 
+void vvp_fun_signal_real_aa::checkpoint_save(vvp_context_t context,
+					     checkpoint_out&out) const
+{
+      double*bits = static_cast<double*>
+            (vvp_get_context_item(context, context_idx_));
+
+      out.put_real(*bits);
+}
+
+void vvp_fun_signal_real_aa::checkpoint_restore(vvp_context_t context,
+						checkpoint_in&in)
+{
+      double*bits = static_cast<double*>
+            (vvp_get_context_item(context, context_idx_));
+
+      *bits = in.get_real();
+}
+
 void vvp_fun_signal_real_aa::recv_real(vvp_net_ptr_t ptr, double bit,
                                        vvp_context_t context)
 {
@@ -648,6 +700,24 @@ void vvp_fun_signal_string_aa::free_instance(vvp_context_t context)
 }
 #endif
 
+void vvp_fun_signal_string_aa::checkpoint_save(vvp_context_t context,
+					       checkpoint_out&out) const
+{
+      string*bits = static_cast<std::string*>
+	    (vvp_get_context_item(context, context_idx_));
+
+      out.put_str(*bits);
+}
+
+void vvp_fun_signal_string_aa::checkpoint_restore(vvp_context_t context,
+						  checkpoint_in&in)
+{
+      string*bits = static_cast<std::string*>
+	    (vvp_get_context_item(context, context_idx_));
+
+      *bits = in.get_str();
+}
+
 void vvp_fun_signal_string_aa::recv_string(vvp_net_ptr_t ptr, const std::string&bit, vvp_context_t context)
 {
       assert(ptr.port() == 0);
@@ -773,6 +843,24 @@ vvp_object_t vvp_fun_signal_object_aa::get_object() const
       return *bits;
 }
 
+/*
+ * Objects are not saved (see checkpoint_save_var) so an automatic
+ * object variable can only be part of a checkpoint while it is nil.
+ */
+void vvp_fun_signal_object_aa::checkpoint_save(vvp_context_t context,
+					       checkpoint_out&out) const
+{
+      vvp_object_t*bits = static_cast<vvp_object_t*>
+	    (vvp_get_context_item(context, context_idx_));
+
+      if (! bits->test_nil())
+	    out.refuse("an automatic variable holds a class object or dynamic array");
+}
+
+void vvp_fun_signal_object_aa::checkpoint_restore(vvp_context_t, checkpoint_in&)
+{
+}
+
 void vvp_fun_signal_object_aa::recv_object(vvp_net_ptr_t ptr, vvp_object_t bit,
 					   vvp_context_t context)
 {
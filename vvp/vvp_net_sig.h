@@ -75,6 +75,10 @@ class vvp_fun_signal_base : public vvp_net_fun_t {
       void deassign();
       void deassign_pv(unsigned base, unsigned wid);
 
+	// True if any bit is in continuous assign mode.
+      bool cassign_active() const
+      { return continuous_assign_active_ || ! assign_mask_.is_zero(); }
+
     public:
 
 	/* The %cassign/link instruction needs a place to write the
@@ -171,6 +175,8 @@ class vvp_fun_signal4_aa : public vvp_fun_signal_vec, public automatic_signal_ba
 #ifdef CHECK_WITH_VALGRIND
       void free_instance(vvp_context_t context);
 #endif
+      void checkpoint_save(vvp_context_t context, checkpoint_out&out) const;
+      void checkpoint_restore(vvp_context_t context, checkpoint_in&in);
 
       void recv_vec4(vvp_net_ptr_t port, const vvp_vector4_t&bit,
                      vvp_context_t context);
@@ -239,6 +245,10 @@ class vvp_fun_signal_real_aa : public vvp_fun_signal_real, public automatic_sign
 #ifdef CHECK_WITH_VALGRIND
       void free_instance(vvp_context_t context);
 #endif
+      size_t image_size() const;
+      void init_image(void*img) const;
+      void checkpoint_save(vvp_context_t context, checkpoint_out&out) const;
+      void checkpoint_restore(vvp_context_t context, checkpoint_in&in);
 
       void recv_real(vvp_net_ptr_t port, double bit,
                      vvp_context_t context);
@@ -307,6 +317,8 @@ class vvp_fun_signal_string_aa : public vvp_fun_signal_string, public automatic_
 #ifdef CHECK_WITH_VALGRIND
       void free_instance(vvp_context_t context);
 #endif
+      void checkpoint_save(vvp_context_t context, checkpoint_out&out) const;
+      void checkpoint_restore(vvp_context_t context, checkpoint_in&in);
       void recv_string(vvp_net_ptr_t port, const std::string&bit,
 		       vvp_context_t context);
 
@@ -367,6 +379,8 @@ class vvp_fun_signal_object_aa : public vvp_fun_signal_object, public automatic_
 #ifdef CHECK_WITH_VALGRIND
       void free_instance(vvp_context_t context);
 #endif
+      void checkpoint_save(vvp_context_t context, checkpoint_out&out) const;
+      void checkpoint_restore(vvp_context_t context, checkpoint_in&in);
 
       void recv_object(vvp_net_ptr_t port, vvp_object_t bit,
 		    vvp_context_t context);